@@ -0,0 +1,197 @@
+#include "activity_estimator.h"
+
+#include <math.h>
+
+#include "h264_nal.h"
+
+#define LOG_TAG "ActivityEstimator"
+#include "native_log.h"
+
+const int ActivityEstimator::kWarmupFrames;
+const int ActivityEstimator::kActiveEnterScore;
+const int ActivityEstimator::kActiveLeaveScore;
+const int64_t ActivityEstimator::kActiveHoldMs;
+
+// 基线跟随下降的速度远快于上升，持续运动时基线不会被抬高
+static const double kBaselineDownAlpha = 0.10;
+static const double kBaselineUpAlpha = 0.005;
+static const double kRecentAlpha = 0.30;
+static const double kVarianceAlpha = 0.10;
+
+static int clampScore(double value) {
+    return value < 0 ? 0 : (value > 100 ? 100 : (int)(value + 0.5));
+}
+
+void ActivityEstimator::updateParameterSets(Device& device, const uint8_t* nal, int size, uint8_t type) {
+    if (type == H264_NAL_SPS) {
+        H264Sps sps;
+        if (h264ParseSps(nal, size, sps)) {
+            device.sps[sps.spsId] = sps;
+        }
+    } else if (type == H264_NAL_PPS) {
+        H264Pps pps;
+        if (h264ParsePps(nal, size, pps)) {
+            device.pps[pps.ppsId] = pps;
+        }
+    }
+}
+
+// 返回本 slice 开头跳过的宏块数，无法得知时返回 -1
+int ActivityEstimator::leadingSkippedMbs(Device& device, const uint8_t* nal, int size) const {
+    uint32_t ppsId = 0;
+    if (!h264PeekSlicePpsId(nal, size, ppsId)) {
+        return -1;
+    }
+    auto ppsIt = device.pps.find(ppsId);
+    if (ppsIt == device.pps.end() || ppsIt->second.entropyCodingMode) {
+        return -1;
+    }
+    auto spsIt = device.sps.find(ppsIt->second.spsId);
+    if (spsIt == device.sps.end()) {
+        return -1;
+    }
+    H264SliceHeader header;
+    if (!h264ParseSliceHeader(nal, size, spsIt->second, ppsIt->second, header) || header.firstSkipRun < 0) {
+        return -1;
+    }
+    return header.firstSkipRun;
+}
+
+int ActivityEstimator::computeScore(const Device& device) {
+    if (device.frames < kWarmupFrames || device.baseline <= 0) {
+        return 0;
+    }
+    // 近期 P 帧是基线的 2 倍记 50 分，4 倍记 100 分
+    double sizeScore = log2(device.recent / device.baseline) * 50.0;
+    // 变异系数超过 0.15 开始加分：运动时帧大小随运动量起伏，静止画面很平稳
+    double cv = device.mean > 0 ? sqrt(device.variance) / device.mean : 0;
+    double varianceScore = (cv - 0.15) * 200.0;
+    if (device.skipRatio < 0) {
+        return clampScore(0.75 * sizeScore + 0.25 * varianceScore);
+    }
+    // 静止画面几乎整帧都是跳过宏块
+    double skipScore = (1.0 - device.skipRatio) * 100.0;
+    return clampScore(0.6 * sizeScore + 0.2 * varianceScore + 0.2 * skipScore);
+}
+
+bool ActivityEstimator::onAccessUnit(const std::string& devId, const uint8_t* data, int length, int64_t nowMs,
+                                     CameraActivity* changed) {
+    if (!data || length <= 0) {
+        return false;
+    }
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device& device = m_devices[devId];
+    uint32_t sliceBytes = 0;
+    bool idr = false;
+    bool interSlice = false;
+    int skippedMbs = 0;
+    bool skipKnown = true;
+    uint32_t picSizeInMbs = 0;
+    for (const H264NalUnit& nal : nals) {
+        if (nal.type == H264_NAL_SPS || nal.type == H264_NAL_PPS) {
+            updateParameterSets(device, nal.data, nal.size, nal.type);
+        } else if (nal.type == H264_NAL_IDR) {
+            idr = true;
+            sliceBytes += (uint32_t)nal.size;
+        } else if (nal.type == H264_NAL_SLICE) {
+            interSlice = true;
+            sliceBytes += (uint32_t)nal.size;
+            if (skipKnown) {
+                int skipped = leadingSkippedMbs(device, nal.data, nal.size);
+                if (skipped < 0) {
+                    skipKnown = false;
+                } else {
+                    skippedMbs += skipped;
+                }
+            }
+        }
+    }
+    if (idr || !interSlice) {
+        // IDR 的大小反映的是画面复杂度而不是运动，不参与估计
+        return false;
+    }
+    if (skipKnown && !device.sps.empty()) {
+        picSizeInMbs = device.sps.begin()->second.picSizeInMbs;
+    }
+
+    const double size = sliceBytes;
+    device.frames++;
+    if (device.frames == 1) {
+        device.baseline = size;
+        device.recent = size;
+        device.mean = size;
+    } else {
+        double alpha = size < device.baseline ? kBaselineDownAlpha : kBaselineUpAlpha;
+        device.baseline += (size - device.baseline) * alpha;
+        device.recent += (size - device.recent) * kRecentAlpha;
+        double delta = size - device.mean;
+        device.mean += delta * kVarianceAlpha;
+        device.variance = (1.0 - kVarianceAlpha) * (device.variance + kVarianceAlpha * delta * delta);
+    }
+    if (picSizeInMbs > 0) {
+        double ratio = (double)skippedMbs / picSizeInMbs;
+        ratio = ratio > 1.0 ? 1.0 : ratio;
+        device.skipRatio = device.skipRatio < 0 ? ratio : device.skipRatio + (ratio - device.skipRatio) * kRecentAlpha;
+    } else {
+        device.skipRatio = -1;
+    }
+
+    CameraActivity& info = device.info;
+    info.devId = devId;
+    info.score = computeScore(device);
+    info.frameBytes = sliceBytes;
+    info.baselineBytes = (uint32_t)device.baseline;
+    info.skipPermille = device.skipRatio < 0 ? -1 : (int)(device.skipRatio * 1000);
+
+    bool wasActive = info.active;
+    if (info.score >= kActiveEnterScore) {
+        info.active = true;
+        device.belowSinceMs = 0;
+    } else if (info.active && info.score < kActiveLeaveScore) {
+        if (device.belowSinceMs == 0) {
+            device.belowSinceMs = nowMs;
+        } else if (nowMs - device.belowSinceMs >= kActiveHoldMs) {
+            info.active = false;
+            device.belowSinceMs = 0;
+        }
+    } else {
+        device.belowSinceMs = 0;
+    }
+    if (info.active == wasActive) {
+        return false;
+    }
+    info.changedMs = nowMs;
+    LOGI("onAccessUnit: %s %s, score=%d, frame=%u, baseline=%u, skip=%d‰", devId.c_str(),
+         info.active ? "active" : "idle", info.score, info.frameBytes, info.baselineBytes, info.skipPermille);
+    if (changed) {
+        *changed = info;
+    }
+    return true;
+}
+
+bool ActivityEstimator::get(const std::string& devId, CameraActivity& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        return false;
+    }
+    out = it->second.info;
+    return true;
+}
+
+std::vector<CameraActivity> ActivityEstimator::snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<CameraActivity> result;
+    for (const auto& entry : m_devices) {
+        result.push_back(entry.second.info);
+    }
+    return result;
+}
+
+void ActivityEstimator::drop(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.erase(devId);
+}
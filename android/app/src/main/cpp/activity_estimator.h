@@ -0,0 +1,63 @@
+#ifndef ACTIVITY_ESTIMATOR_H
+#define ACTIVITY_ESTIMATOR_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "h264_bitstream.h"
+
+struct CameraActivity {
+    std::string devId;
+    int score = 0;              // 0..100
+    bool active = false;
+    int64_t changedMs = 0;      // active 最近一次变化的时间
+    uint32_t frameBytes = 0;    // 最近一个 P 帧的大小
+    uint32_t baselineBytes = 0; // 静止画面下 P 帧大小的基线
+    int skipPermille = -1;      // 跳过宏块的千分比，CABAC 码流为 -1
+};
+
+// 压缩域活动度估计：不解码，只看码流。
+// P 帧大小相对滚动基线的比值是主要依据，再结合近期帧大小的离散程度，
+// CAVLC 码流额外读取 slice 开头的 mb_skip_run 估计跳过宏块的比例。
+// 每帧只解析 slice 头，代价与帧大小无关，可以直接放在接收路径上。
+class ActivityEstimator {
+public:
+    static const int kWarmupFrames = 10;          // 基线建立前不给出分数
+    static const int kActiveEnterScore = 40;
+    static const int kActiveLeaveScore = 25;
+    static const int64_t kActiveHoldMs = 3000;    // 分数回落后保持活跃的时间
+
+    // 接收线程调用：送入一个 Annex-B 访问单元；活跃状态变化时返回 true 并填充 changed
+    bool onAccessUnit(const std::string& devId, const uint8_t* data, int length, int64_t nowMs, CameraActivity* changed);
+
+    bool get(const std::string& devId, CameraActivity& out) const;
+    std::vector<CameraActivity> snapshot() const;
+    void drop(const std::string& devId);
+
+private:
+    struct Device {
+        std::map<uint32_t, H264Sps> sps;
+        std::map<uint32_t, H264Pps> pps;
+        double baseline = 0;     // 静止时 P 帧大小，下降快、上升慢
+        double recent = 0;       // 近期 P 帧大小
+        double mean = 0;         // 帧大小的滑动均值和方差
+        double variance = 0;
+        double skipRatio = -1;
+        int frames = 0;
+        int64_t belowSinceMs = 0;
+        CameraActivity info;
+    };
+
+    void updateParameterSets(Device& device, const uint8_t* nal, int size, uint8_t type);
+    int leadingSkippedMbs(Device& device, const uint8_t* nal, int size) const;
+    static int computeScore(const Device& device);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Device> m_devices;
+};
+
+#endif // ACTIVITY_ESTIMATOR_H
@@ -0,0 +1,167 @@
+#include "audio_benchmark.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "audio_sink.h"
+
+#define LOG_TAG "AudioBenchmark"
+#include "native_log.h"
+
+namespace {
+
+struct SimulatedPacket {
+    int offset;
+    int length;
+    int64_t arrivalUs;
+};
+
+bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[64 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return true;
+}
+
+double elapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+AudioBenchmarkResult runAudioBenchmark(const std::string& path, const AudioBenchmarkOptions& options) {
+    AudioBenchmarkResult result;
+    std::vector<uint8_t> stream;
+    if (!readFile(path, stream) || stream.empty()) {
+        LOGE("无法读取音频文件: %s", path.c_str());
+        return result;
+    }
+
+    // 切包并计算每包的发送时间
+    std::vector<std::pair<int, int>> units;
+    std::vector<int64_t> sendUs;
+    if (options.codec == AUDIO_CODEC_AAC) {
+        splitAdtsFrames(stream.data(), (int)stream.size(), units);
+        AdtsHeader header;
+        for (size_t i = 0; i < units.size(); i++) {
+            parseAdtsHeader(stream.data() + units[i].first, units[i].second, header);
+            sendUs.push_back((int64_t)i * 1024 * 1000000 / header.sampleRate);
+        }
+    } else {
+        const int packetBytes = std::max(1, options.sampleRate * options.packetMs / 1000);
+        for (int offset = 0; offset < (int)stream.size(); offset += packetBytes) {
+            units.push_back(std::make_pair(offset, std::min(packetBytes, (int)stream.size() - offset)));
+            sendUs.push_back((int64_t)offset * 1000000 / options.sampleRate);
+        }
+    }
+    if (units.empty()) {
+        LOGE("文件中没有可用的 %s 音频: %s", audioCodecName(options.codec), path.c_str());
+        return result;
+    }
+
+    std::mt19937 random(options.seed);
+    std::vector<SimulatedPacket> packets;
+    int64_t lastArrivalUs = 0;
+    for (size_t i = 0; i < units.size(); i++) {
+        if (options.lossPercent > 0 && (int)(random() % 100) < options.lossPercent) {
+            result.lostPackets++;
+            continue;
+        }
+        const int64_t delayUs = options.jitterMs > 0 ? (int64_t)(random() % (options.jitterMs * 1000 + 1)) : 0;
+        SimulatedPacket packet;
+        packet.offset = units[i].first;
+        packet.length = units[i].second;
+        packet.arrivalUs = std::max(lastArrivalUs, sendUs[i] + delayUs);
+        lastArrivalUs = packet.arrivalUs;
+        packets.push_back(packet);
+    }
+
+    std::unique_ptr<AudioDecoder> decoder = createAudioDecoder(options.codec);
+    if (!decoder || !decoder->open(options.codec, options.sampleRate)) {
+        return result;
+    }
+    std::unique_ptr<AudioSink> sink = createAudioSink(options.outputPath.empty() ? "null" : "file", options.outputPath);
+    if (!sink) {
+        return result;
+    }
+
+    AudioJitterBuffer jitter;
+    jitter.configure(options.jitter);
+    AudioSinkConfig sinkConfig;
+    sinkConfig.sampleRate = options.outputRate;
+    sinkConfig.framesPerBuffer = options.framesPerBuffer;
+    sinkConfig.realtime = false;
+    const int64_t bufferUs = (int64_t)options.framesPerBuffer * 1000000 / options.outputRate;
+    // 最后一包到达后再放一段，让缓冲排空
+    const int64_t endUs = lastArrivalUs + (int64_t)options.jitter.maxDelayMs * 1000 * 2 + 200000;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+    int64_t nowUs = 0;
+    size_t next = 0;
+    std::vector<int16_t> pcm;
+    double decodeUs = 0;
+    double readUs = 0;
+    uint64_t reads = 0;
+    // 输出线程每次回调推进一个缓冲的虚拟时间，先送入这段时间内到达的包，再读取
+    auto render = [&](int16_t* out, int frames) {
+        if (nowUs >= endUs) {
+            // 已结束，等待主线程关闭输出
+            std::fill(out, out + frames, 0);
+            return;
+        }
+        nowUs += bufferUs;
+        while (next < packets.size() && packets[next].arrivalUs <= nowUs) {
+            const SimulatedPacket& packet = packets[next++];
+            pcm.clear();
+            int rate = 0;
+            const auto start = std::chrono::steady_clock::now();
+            if (decoder->decode(stream.data() + packet.offset, packet.length, pcm, &rate) && !pcm.empty()) {
+                decodeUs += elapsedUs(start);
+                jitter.push(pcm.data(), (int)pcm.size(), rate, packet.arrivalUs);
+            }
+        }
+        const auto start = std::chrono::steady_clock::now();
+        jitter.read(out, frames, options.outputRate, nowUs, 0);
+        readUs += elapsedUs(start);
+        reads++;
+        if (nowUs >= endUs) {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            done.notify_one();
+        }
+    };
+
+    if (!sink->open(sinkConfig, render)) {
+        return result;
+    }
+    const auto wallStart = std::chrono::steady_clock::now();
+    sink->start();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&finished]() { return finished; });
+    }
+    sink->close();
+
+    result.ok = true;
+    result.packets = packets.size();
+    result.audioMs = nowUs / 1000;
+    result.wallSeconds = elapsedUs(wallStart) / 1000000;
+    result.decodeUsPerPacket = packets.empty() ? 0 : decodeUs / packets.size();
+    result.readUsPerBuffer = reads == 0 ? 0 : readUs / reads;
+    result.jitter = jitter.stats();
+    return result;
+}
@@ -0,0 +1,38 @@
+#ifndef AUDIO_BENCHMARK_H
+#define AUDIO_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+
+#include "audio_codec.h"
+#include "audio_jitter_buffer.h"
+
+struct AudioBenchmarkOptions {
+    AudioCodec codec = AUDIO_CODEC_PCMU;
+    int sampleRate = 8000;        // G.711 的采样率；AAC 从 ADTS 头取得
+    int packetMs = 20;            // G.711 按这个时长切包
+    int jitterMs = 0;             // 到达时间叠加 0~jitterMs 的均匀随机延迟（保持顺序，和 P2P 通道一致）
+    int lossPercent = 0;          // 随机丢包比例
+    int outputRate = 48000;
+    int framesPerBuffer = 480;
+    std::string outputPath;       // 非空时把输出写成 WAV，否则用 null 输出
+    unsigned seed = 1;
+    AudioJitterConfig jitter;
+};
+
+struct AudioBenchmarkResult {
+    bool ok = false;
+    uint64_t packets = 0;
+    uint64_t lostPackets = 0;
+    int64_t audioMs = 0;          // 输出的音频总时长
+    double wallSeconds = 0;
+    double decodeUsPerPacket = 0;
+    double readUsPerBuffer = 0;   // 抖动缓冲每次读取（含变速重采样）的耗时
+    AudioJitterStats jitter;
+};
+
+// 无界面音频基准：把 G.711 裸流或 ADTS 文件切包，按模拟的到达时间送入解码和抖动缓冲，
+// 由非实时的 null/file 输出尽快拉取。时间用虚拟时钟推进，结果与机器快慢无关，只有耗时统计取真实时间。
+AudioBenchmarkResult runAudioBenchmark(const std::string& path, const AudioBenchmarkOptions& options);
+
+#endif // AUDIO_BENCHMARK_H
@@ -0,0 +1,257 @@
+#include "audio_codec.h"
+
+#include <algorithm>
+
+#define LOG_TAG "AudioCodec"
+#include "native_log.h"
+
+#ifdef HAVE_MEDIANDK
+std::unique_ptr<AudioDecoder> createMediaCodecAacDecoder();
+#endif
+
+static const int kAdtsSampleRates[16] = {
+    96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350, 0, 0, 0,
+};
+
+const char* audioCodecName(AudioCodec codec) {
+    switch (codec) {
+        case AUDIO_CODEC_PCMU: return "pcmu";
+        case AUDIO_CODEC_PCMA: return "pcma";
+        case AUDIO_CODEC_AAC: return "aac";
+        default: return "none";
+    }
+}
+
+AudioCodec audioCodecFromName(const std::string& name) {
+    if (name == "pcmu" || name == "g711u" || name == "ulaw") {
+        return AUDIO_CODEC_PCMU;
+    }
+    if (name == "pcma" || name == "g711a" || name == "alaw") {
+        return AUDIO_CODEC_PCMA;
+    }
+    if (name == "aac") {
+        return AUDIO_CODEC_AAC;
+    }
+    return AUDIO_CODEC_NONE;
+}
+
+// ITU-T G.711 解码：段号决定移位，段内 4 位尾数线性
+int16_t g711UlawDecode(uint8_t value) {
+    value = ~value;
+    int magnitude = (((value & 0x0F) << 3) + 0x84) << ((value & 0x70) >> 4);
+    return (int16_t)((value & 0x80) ? (0x84 - magnitude) : (magnitude - 0x84));
+}
+
+int16_t g711AlawDecode(uint8_t value) {
+    value ^= 0x55;
+    int magnitude = (value & 0x0F) << 4;
+    const int segment = (value & 0x70) >> 4;
+    if (segment == 0) {
+        magnitude += 8;
+    } else {
+        magnitude += 0x108;
+        if (segment > 1) {
+            magnitude <<= segment - 1;
+        }
+    }
+    return (int16_t)((value & 0x80) ? magnitude : -magnitude);
+}
+
+// G.711 编码：加偏置后最高位所在的段作为指数，其后 4 位作为尾数
+uint8_t g711UlawEncode(int16_t sample) {
+    int value = sample;
+    uint8_t sign = 0;
+    if (value < 0) {
+        value = -value;
+        sign = 0x80;
+    }
+    value = std::min(value, 32635) + 0x84;
+    int exponent = 7;
+    for (int mask = 0x4000; !(value & mask) && exponent > 0; mask >>= 1) {
+        exponent--;
+    }
+    const int mantissa = (value >> (exponent + 3)) & 0x0F;
+    return (uint8_t)~(sign | (exponent << 4) | mantissa);
+}
+
+uint8_t g711AlawEncode(int16_t sample) {
+    // A 律按 13 位量化
+    int value = sample >> 3;
+    uint8_t mask = 0xD5;
+    if (value < 0) {
+        value = -value - 1;
+        mask = 0x55;
+    }
+    int segment = 0;
+    while (segment < 8 && value > (0x20 << segment) - 1) {
+        segment++;
+    }
+    if (segment >= 8) {
+        return (uint8_t)(0x7F ^ mask);
+    }
+    const int mantissa = segment < 2 ? (value >> 1) & 0x0F : (value >> segment) & 0x0F;
+    return (uint8_t)(((segment << 4) | mantissa) ^ mask);
+}
+
+bool parseAdtsHeader(const uint8_t* data, int length, AdtsHeader& header) {
+    // 12 位同步字 0xFFF，layer 固定为 0
+    if (!data || length < 7 || data[0] != 0xFF || (data[1] & 0xF6) != 0xF0) {
+        return false;
+    }
+    header.headerLength = (data[1] & 0x01) ? 7 : 9;
+    header.profile = data[2] >> 6;
+    header.sampleRateIndex = (data[2] >> 2) & 0x0F;
+    header.sampleRate = kAdtsSampleRates[header.sampleRateIndex];
+    header.channels = ((data[2] & 0x01) << 2) | (data[3] >> 6);
+    header.frameLength = ((data[3] & 0x03) << 11) | (data[4] << 3) | (data[5] >> 5);
+    return header.sampleRate > 0 && header.frameLength > header.headerLength;
+}
+
+void splitAdtsFrames(const uint8_t* data, int length, std::vector<std::pair<int, int>>& frames) {
+    frames.clear();
+    int offset = 0;
+    AdtsHeader header;
+    while (offset < length && parseAdtsHeader(data + offset, length - offset, header)) {
+        if (offset + header.frameLength > length) {
+            break;
+        }
+        frames.push_back(std::make_pair(offset, header.frameLength));
+        offset += header.frameLength;
+    }
+}
+
+void adtsAudioSpecificConfig(const AdtsHeader& header, uint8_t out[2]) {
+    const int objectType = header.profile + 1;
+    out[0] = (uint8_t)((objectType << 3) | (header.sampleRateIndex >> 1));
+    out[1] = (uint8_t)(((header.sampleRateIndex & 0x01) << 7) | (header.channels << 3));
+}
+
+namespace {
+
+// G.711 按字节查表解码，开销可以忽略，所有平台都可用
+class G711Decoder : public AudioDecoder {
+public:
+    G711Decoder() : m_sampleRate(8000) {}
+
+    const char* name() const override {
+        return "g711";
+    }
+
+    bool open(AudioCodec codec, int sampleRate) override {
+        if (codec != AUDIO_CODEC_PCMU && codec != AUDIO_CODEC_PCMA) {
+            return false;
+        }
+        for (int i = 0; i < 256; i++) {
+            m_table[i] = codec == AUDIO_CODEC_PCMU ? g711UlawDecode((uint8_t)i) : g711AlawDecode((uint8_t)i);
+        }
+        m_sampleRate = sampleRate > 0 ? sampleRate : 8000;
+        m_stats = AudioDecoderStats();
+        return true;
+    }
+
+    bool decode(const uint8_t* data, int length, std::vector<int16_t>& pcm, int* sampleRate) override {
+        if (!data || length <= 0) {
+            m_stats.errors++;
+            return false;
+        }
+        const size_t base = pcm.size();
+        pcm.resize(base + length);
+        for (int i = 0; i < length; i++) {
+            pcm[base + i] = m_table[data[i]];
+        }
+        m_stats.packets++;
+        m_stats.samples += length;
+        if (sampleRate) {
+            *sampleRate = m_sampleRate;
+        }
+        return true;
+    }
+
+    void close() override {
+    }
+
+    AudioDecoderStats stats() const override {
+        return m_stats;
+    }
+
+private:
+    int16_t m_table[256];
+    int m_sampleRate;
+    AudioDecoderStats m_stats;
+};
+
+// G.711 编码：每个样本一个字节
+class G711Encoder : public AudioEncoder {
+public:
+    G711Encoder() : m_ulaw(true) {}
+
+    const char* name() const override {
+        return "g711";
+    }
+
+    bool open(AudioCodec codec, int /* sampleRate */) override {  // G.711 与采样率无关
+        if (codec != AUDIO_CODEC_PCMU && codec != AUDIO_CODEC_PCMA) {
+            return false;
+        }
+        m_ulaw = codec == AUDIO_CODEC_PCMU;
+        return true;
+    }
+
+    int encode(const int16_t* pcm, int samples, uint8_t* out, int capacity) override {
+        if (!pcm || !out || samples < 0 || capacity < samples) {
+            return -1;
+        }
+        if (m_ulaw) {
+            for (int i = 0; i < samples; i++) {
+                out[i] = g711UlawEncode(pcm[i]);
+            }
+        } else {
+            for (int i = 0; i < samples; i++) {
+                out[i] = g711AlawEncode(pcm[i]);
+            }
+        }
+        return samples;
+    }
+
+    int maxEncodedBytes(int samples) const override {
+        return samples;
+    }
+
+    void close() override {
+    }
+
+private:
+    bool m_ulaw;
+};
+
+} // namespace
+
+std::unique_ptr<AudioEncoder> createAudioEncoder(AudioCodec codec) {
+    switch (codec) {
+        case AUDIO_CODEC_PCMU:
+        case AUDIO_CODEC_PCMA:
+            return std::unique_ptr<AudioEncoder>(new G711Encoder());
+        default:
+            break;
+    }
+    LOGE("没有可用的音频编码后端: %s", audioCodecName(codec));
+    return nullptr;
+}
+
+std::unique_ptr<AudioDecoder> createAudioDecoder(AudioCodec codec) {
+    switch (codec) {
+        case AUDIO_CODEC_PCMU:
+        case AUDIO_CODEC_PCMA:
+            return std::unique_ptr<AudioDecoder>(new G711Decoder());
+        case AUDIO_CODEC_AAC:
+#ifdef HAVE_MEDIANDK
+            return createMediaCodecAacDecoder();
+#else
+            break;
+#endif
+        default:
+            break;
+    }
+    LOGE("没有可用的音频解码后端: %s", audioCodecName(codec));
+    return nullptr;
+}
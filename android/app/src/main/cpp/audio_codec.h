@@ -0,0 +1,86 @@
+#ifndef AUDIO_CODEC_H
+#define AUDIO_CODEC_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 摄像头音频编码：对讲/监听常见 G.711（8kHz 单声道），新款设备也有 ADTS 封装的 AAC-LC
+enum AudioCodec {
+    AUDIO_CODEC_NONE = 0,
+    AUDIO_CODEC_PCMU = 1,   // G.711 μ-law
+    AUDIO_CODEC_PCMA = 2,   // G.711 A-law
+    AUDIO_CODEC_AAC = 3,    // ADTS 封装的 AAC
+};
+
+const char* audioCodecName(AudioCodec codec);
+// 不认识的名称返回 AUDIO_CODEC_NONE
+AudioCodec audioCodecFromName(const std::string& name);
+
+int16_t g711UlawDecode(uint8_t value);
+int16_t g711AlawDecode(uint8_t value);
+uint8_t g711UlawEncode(int16_t sample);
+uint8_t g711AlawEncode(int16_t sample);
+
+struct AdtsHeader {
+    int profile = 0;        // audio object type - 1，AAC-LC 为 1
+    int sampleRateIndex = 0;
+    int sampleRate = 0;
+    int channels = 0;
+    int headerLength = 0;   // 7，带 CRC 时为 9
+    int frameLength = 0;    // 含头部的整帧长度
+};
+
+// 解析 data 开头的 ADTS 头，同步字或长度不合法时返回 false
+bool parseAdtsHeader(const uint8_t* data, int length, AdtsHeader& header);
+
+// 把一段数据按 ADTS 帧切开，返回每帧的 (偏移, 长度)；开头不是 ADTS 时返回空
+void splitAdtsFrames(const uint8_t* data, int length, std::vector<std::pair<int, int>>& frames);
+
+// 由 ADTS 头生成 MediaCodec 需要的 AudioSpecificConfig（csd-0）
+void adtsAudioSpecificConfig(const AdtsHeader& header, uint8_t out[2]);
+
+struct AudioDecoderStats {
+    uint64_t packets = 0;
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+};
+
+// 可插拔的音频解码后端，输出 16 位单声道 PCM（多声道在解码器内混缩）。
+// 同一个实例只能在一个线程上使用。
+class AudioDecoder {
+public:
+    virtual ~AudioDecoder() {}
+
+    virtual const char* name() const = 0;
+    // sampleRate 对 G.711 有效；AAC 从 ADTS 头取得
+    virtual bool open(AudioCodec codec, int sampleRate) = 0;
+    // 送入一个编码帧（AAC 含 ADTS 头），解出的样本追加到 pcm，sampleRate 返回输出采样率
+    virtual bool decode(const uint8_t* data, int length, std::vector<int16_t>& pcm, int* sampleRate) = 0;
+    virtual void close() = 0;
+    virtual AudioDecoderStats stats() const = 0;
+};
+
+// 按编码创建解码后端；当前构建没有对应后端时返回空指针
+std::unique_ptr<AudioDecoder> createAudioDecoder(AudioCodec codec);
+
+// 对讲上行的编码后端：输入 16 位单声道 PCM，输出写入调用方的缓冲，编码过程中不分配内存。
+// 同一个实例只能在一个线程上使用。
+class AudioEncoder {
+public:
+    virtual ~AudioEncoder() {}
+
+    virtual const char* name() const = 0;
+    virtual bool open(AudioCodec codec, int sampleRate) = 0;
+    // 编码 samples 个样本，返回写入 out 的字节数；capacity 不够或出错时返回 -1
+    virtual int encode(const int16_t* pcm, int samples, uint8_t* out, int capacity) = 0;
+    // samples 个样本编码后的最大字节数，用于预分配输出缓冲
+    virtual int maxEncodedBytes(int samples) const = 0;
+    virtual void close() = 0;
+};
+
+// 按编码创建编码后端；当前只有 G.711，其它编码返回空指针
+std::unique_ptr<AudioEncoder> createAudioEncoder(AudioCodec codec);
+
+#endif // AUDIO_CODEC_H
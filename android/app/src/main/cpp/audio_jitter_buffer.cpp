@@ -0,0 +1,287 @@
+#include "audio_jitter_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define LOG_TAG "AudioJitterBuffer"
+#include "native_log.h"
+
+const int AudioJitterBuffer::kStretchPercent;
+const int64_t AudioJitterBuffer::kConcealFadeUs;
+const int64_t AudioJitterBuffer::kUnderrunBoostUs;
+const int64_t AudioJitterBuffer::kResetGapUs;
+
+AudioJitterBuffer::AudioJitterBuffer() {
+    reset();
+}
+
+void AudioJitterBuffer::configure(const AudioJitterConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    m_config.minDelayMs = std::max(0, config.minDelayMs);
+    m_config.maxDelayMs = std::max(m_config.minDelayMs, config.maxDelayMs);
+    LOGI("configure: minDelayMs=%d maxDelayMs=%d", m_config.minDelayMs, m_config.maxDelayMs);
+}
+
+void AudioJitterBuffer::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_samples.clear();
+    m_segments.clear();
+    m_sampleRate = 0;
+    m_position = 0;
+    m_playing = false;
+    m_underrun = false;
+    m_stretch = 0;
+    m_mediaSamples = 0;
+    m_firstArrivalUs = 0;
+    m_lastArrivalUs = 0;
+    m_lastTransitUs = 0;
+    m_jitterUs = 0;
+    m_packetUs = 0;
+    m_readUs = 0;
+    m_boostUs = 0;
+    m_history.clear();
+    m_concealFrames = 0;
+    m_concealedUs = 0;
+    m_droppedUs = 0;
+    m_stretchedUs = 0;
+    m_latencyUs = 0;
+    m_maxLatencyUs = 0;
+    m_hasPlayout = false;
+    m_playoutMediaUs = 0;
+    m_playoutUs = 0;
+    m_stats = AudioJitterStats();
+}
+
+int64_t AudioJitterBuffer::bufferedUsLocked() const {
+    if (m_sampleRate <= 0) {
+        return 0;
+    }
+    return (int64_t)((m_samples.size() - m_position) * 1000000.0 / m_sampleRate);
+}
+
+// 至少容纳一包加一次读取，再按抖动和欠载加深
+int64_t AudioJitterBuffer::targetDelayUsLocked() const {
+    const int64_t minUs = (int64_t)m_config.minDelayMs * 1000;
+    const int64_t maxUs = (int64_t)m_config.maxDelayMs * 1000;
+    const int64_t floorUs = m_packetUs + m_readUs;
+    int64_t target = floorUs + (int64_t)(m_jitterUs * 3) + m_boostUs;
+    target = std::max(minUs, std::min(target, maxUs));
+    // 包长本身超过上限时（低采样率的 AAC）只能按包长缓冲
+    return std::max(target, floorUs);
+}
+
+void AudioJitterBuffer::dropFrontLocked(int samples) {
+    samples = std::min(samples, (int)m_samples.size());
+    m_samples.erase(m_samples.begin(), m_samples.begin() + samples);
+    while (samples > 0 && !m_segments.empty()) {
+        const int n = std::min(samples, m_segments.front().samples);
+        m_segments.front().samples -= n;
+        m_segments.front().offset += n;
+        samples -= n;
+        if (m_segments.front().samples == 0) {
+            m_segments.pop_front();
+        }
+    }
+}
+
+void AudioJitterBuffer::push(const int16_t* pcm, int samples, int sampleRate, int64_t arrivalUs) {
+    if (!pcm || samples <= 0 || sampleRate <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (sampleRate != m_sampleRate) {
+        if (m_sampleRate != 0) {
+            LOGI("采样率变化 %d -> %d，清空缓冲", m_sampleRate, sampleRate);
+        }
+        m_samples.clear();
+        m_segments.clear();
+        m_position = 0;
+        m_playing = false;
+        m_sampleRate = sampleRate;
+        m_mediaSamples = 0;
+    } else if (m_lastArrivalUs > 0 && arrivalUs - m_lastArrivalUs > kResetGapUs) {
+        // 设备停发后重新开始，媒体时间重新对齐
+        m_mediaSamples = 0;
+    }
+    m_lastArrivalUs = arrivalUs;
+
+    // 传输时间 = 到达时间 - 媒体时间，相邻两包传输时间之差即抖动样本
+    if (m_mediaSamples == 0) {
+        m_firstArrivalUs = arrivalUs;
+    }
+    const int64_t mediaUs = (int64_t)(m_mediaSamples * 1000000 / m_sampleRate);
+    const int64_t transitUs = arrivalUs - m_firstArrivalUs - mediaUs;
+    if (m_mediaSamples > 0) {
+        m_jitterUs += (llabs(transitUs - m_lastTransitUs) - m_jitterUs) / 16;
+    }
+    m_lastTransitUs = transitUs;
+    m_mediaSamples += samples;
+    m_packetUs = (int64_t)samples * 1000000 / sampleRate;
+
+    m_samples.insert(m_samples.end(), pcm, pcm + samples);
+    Segment segment;
+    segment.arrivalUs = arrivalUs;
+    segment.samples = samples;
+    segment.offset = 0;
+    m_segments.push_back(segment);
+    m_stats.packets++;
+
+    // 输出设备没有在读时也不能无限增长
+    const int64_t limitUs = targetDelayUsLocked() + (int64_t)m_config.maxDelayMs * 1000 * 4;
+    const int64_t bufferedUs = bufferedUsLocked();
+    if (bufferedUs > limitUs) {
+        const int drop = (int)((bufferedUs - targetDelayUsLocked()) * m_sampleRate / 1000000);
+        dropFrontLocked(drop);
+        m_position = 0;
+        m_stats.overruns++;
+        m_droppedUs += (double)drop * 1000000 / m_sampleRate;
+    }
+}
+
+void AudioJitterBuffer::concealLocked(int16_t* out, int frames, int outRate) {
+    const int64_t fadeFrames = kConcealFadeUs * outRate / 1000000;
+    for (int i = 0; i < frames; i++, m_concealFrames++) {
+        if (m_history.empty() || m_concealFrames >= fadeFrames) {
+            out[i] = 0;
+            continue;
+        }
+        const double gain = 1.0 - (double)m_concealFrames / fadeFrames;
+        out[i] = (int16_t)(m_history[m_concealFrames % m_history.size()] * gain);
+    }
+    m_concealedUs += (double)frames * 1000000 / outRate;
+}
+
+void AudioJitterBuffer::read(int16_t* out, int frames, int outRate, int64_t nowUs, int64_t sinkLatencyUs) {
+    if (!out || frames <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (outRate <= 0) {
+        memset(out, 0, frames * sizeof(int16_t));
+        return;
+    }
+    m_readUs = (int64_t)frames * 1000000 / outRate;
+    const int64_t targetUs = targetDelayUsLocked();
+
+    if (!m_playing) {
+        if (m_sampleRate <= 0 || bufferedUsLocked() < targetUs) {
+            if (m_underrun) {
+                concealLocked(out, frames, outRate);
+            } else {
+                memset(out, 0, frames * sizeof(int16_t));
+            }
+            return;
+        }
+        m_playing = true;
+        m_underrun = false;
+        m_stretch = 0;
+    }
+
+    // 积压远超目标（网络恢复后的突发）时变速追不上，直接丢到目标深度
+    int64_t bufferedUs = bufferedUsLocked();
+    if (bufferedUs > targetUs + (int64_t)m_config.maxDelayMs * 1000) {
+        const int drop = (int)((bufferedUs - targetUs) * m_sampleRate / 1000000);
+        dropFrontLocked(drop);
+        m_position = 0;
+        m_stats.overruns++;
+        m_droppedUs += (double)drop * 1000000 / m_sampleRate;
+        LOGW("积压 %lldms，丢弃到目标深度 %lldms", (long long)(bufferedUs / 1000), (long long)(targetUs / 1000));
+        bufferedUs = bufferedUsLocked();
+    }
+
+    // 带回差的变速：偏离目标四分之一以上开始变速，回到目标后恢复原速
+    if (bufferedUs > targetUs + targetUs / 4 + 10000) {
+        m_stretch = 1;
+    } else if (bufferedUs < targetUs * 3 / 4) {
+        m_stretch = -1;
+    } else if ((m_stretch > 0 && bufferedUs <= targetUs) || (m_stretch < 0 && bufferedUs >= targetUs)) {
+        m_stretch = 0;
+    }
+    const double step = (double)m_sampleRate / outRate * (1.0 + m_stretch * kStretchPercent / 100.0);
+
+    if (!m_segments.empty()) {
+        const Segment& front = m_segments.front();
+        const int64_t latencyUs = nowUs + sinkLatencyUs - front.arrivalUs;
+        m_latencyUs = m_latencyUs == 0 ? latencyUs : m_latencyUs * 0.95 + latencyUs * 0.05;
+        m_maxLatencyUs = std::max(m_maxLatencyUs, latencyUs);
+        // 包内样本按采样间隔排在包的到达时间之后
+        m_playoutMediaUs = front.arrivalUs + (int64_t)((front.offset + m_position) * 1000000 / m_sampleRate);
+        m_playoutUs = nowUs + sinkLatencyUs;
+        m_hasPlayout = true;
+    }
+
+    int produced = 0;
+    while (produced < frames) {
+        const size_t index = (size_t)m_position;
+        if (index + 1 >= m_samples.size()) {
+            break;
+        }
+        const double frac = m_position - index;
+        out[produced++] = (int16_t)(m_samples[index] * (1.0 - frac) + m_samples[index + 1] * frac);
+        m_position += step;
+    }
+    const int consumed = std::min((int)m_position, (int)m_samples.size());
+    dropFrontLocked(consumed);
+    m_position -= consumed;
+
+    if (produced > 0) {
+        const double producedUs = (double)produced * 1000000 / outRate;
+        if (m_stretch != 0) {
+            m_stretchedUs += producedUs;
+        }
+        // 稳定播放每秒回落 1ms
+        m_boostUs = std::max<int64_t>(0, m_boostUs - (int64_t)(producedUs / 1000));
+        m_concealFrames = 0;
+
+        const size_t historyFrames = (size_t)std::max(1, outRate / 100);
+        if ((size_t)produced >= historyFrames) {
+            m_history.assign(out + produced - historyFrames, out + produced);
+        } else {
+            m_history.insert(m_history.end(), out, out + produced);
+            if (m_history.size() > historyFrames) {
+                m_history.erase(m_history.begin(), m_history.end() - historyFrames);
+            }
+        }
+    }
+
+    if (produced < frames) {
+        // 读空：补齐本次输出，然后重新缓冲；下一次目标深度加深
+        m_stats.concealmentEvents++;
+        m_boostUs = std::min(m_boostUs + kUnderrunBoostUs, (int64_t)m_config.maxDelayMs * 1000);
+        m_playing = false;
+        m_underrun = true;
+        m_hasPlayout = false;
+        concealLocked(out + produced, frames - produced, outRate);
+        LOGW("欠载，补齐 %d 帧，目标深度 %lldms", frames - produced, (long long)(targetDelayUsLocked() / 1000));
+    }
+}
+
+bool AudioJitterBuffer::playoutPosition(int64_t* mediaUs, int64_t* playoutUs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasPlayout) {
+        return false;
+    }
+    if (mediaUs) {
+        *mediaUs = m_playoutMediaUs;
+    }
+    if (playoutUs) {
+        *playoutUs = m_playoutUs;
+    }
+    return true;
+}
+
+AudioJitterStats AudioJitterBuffer::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AudioJitterStats result = m_stats;
+    result.concealedMs = (int64_t)(m_concealedUs / 1000);
+    result.droppedMs = (int64_t)(m_droppedUs / 1000);
+    result.stretchedMs = (int64_t)(m_stretchedUs / 1000);
+    result.jitterMs = (int64_t)(m_jitterUs / 1000);
+    result.targetDelayMs = targetDelayUsLocked() / 1000;
+    result.bufferedMs = bufferedUsLocked() / 1000;
+    result.latencyMs = (int64_t)(m_latencyUs / 1000);
+    result.maxLatencyMs = m_maxLatencyUs / 1000;
+    return result;
+}
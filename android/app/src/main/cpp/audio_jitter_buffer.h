@@ -0,0 +1,99 @@
+#ifndef AUDIO_JITTER_BUFFER_H
+#define AUDIO_JITTER_BUFFER_H
+
+#include <stdint.h>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+struct AudioJitterConfig {
+    int minDelayMs = 20;    // 目标缓冲下限
+    int maxDelayMs = 120;   // 目标缓冲上限，加上网络和输出延迟仍在 150ms 以内
+};
+
+struct AudioJitterStats {
+    uint64_t packets = 0;
+    uint64_t concealmentEvents = 0;   // 欠载次数，每次用上一段波形衰减补齐
+    int64_t concealedMs = 0;          // 补齐的总时长
+    uint64_t overruns = 0;            // 积压超过上限后直接丢弃
+    int64_t droppedMs = 0;
+    int64_t stretchedMs = 0;          // 以非原速播放的总时长
+    int64_t jitterMs = 0;             // 到达抖动（RFC 3550 的算法）
+    int64_t targetDelayMs = 0;
+    int64_t bufferedMs = 0;
+    int64_t latencyMs = 0;            // 样本从到达到离开扬声器的平均时间（含输出设备延迟）
+    int64_t maxLatencyMs = 0;
+};
+
+// 自适应音频抖动缓冲：接收线程按包写入解码后的 PCM，输出设备的回调线程按固定帧数读取。
+// 目标缓冲深度按到达抖动和最近的欠载自动调整；实际深度偏离目标时以 ±kStretchPercent 的速率
+// 变速播放（线性插值重采样）慢慢拉回，不直接丢弃或插入样本。读空时用最近 10ms 的输出
+// 衰减重复补齐，然后重新缓冲到目标深度。读取时顺带完成解码采样率到输出采样率的转换。
+class AudioJitterBuffer {
+public:
+    static const int kStretchPercent = 5;           // 变速幅度，听感上察觉不到
+    static const int64_t kConcealFadeUs = 40000;    // 补齐波形在这段时间内衰减到静音
+    static const int64_t kUnderrunBoostUs = 10000;  // 每次欠载目标深度增加的量
+    static const int64_t kResetGapUs = 1000000;     // 到达间隔超过该值视为新的一段流
+
+    AudioJitterBuffer();
+
+    void configure(const AudioJitterConfig& config);
+
+    // 接收线程调用：写入一包解码后的单声道 PCM
+    void push(const int16_t* pcm, int samples, int sampleRate, int64_t arrivalUs);
+
+    // 输出线程调用：读 frames 个 outRate 采样率的样本，总是填满 out。
+    // sinkLatencyUs 为输出设备自身的延迟，只用于延迟统计
+    void read(int16_t* out, int frames, int outRate, int64_t nowUs, int64_t sinkLatencyUs);
+
+    // 最近一次读到真实样本时，第一个样本的到达域时间戳和播放时间（微秒），供音视频同步使用；
+    // 还没播放或正在欠载补齐时返回 false
+    bool playoutPosition(int64_t* mediaUs, int64_t* playoutUs) const;
+
+    void reset();
+    AudioJitterStats stats() const;
+
+private:
+    struct Segment {
+        int64_t arrivalUs;
+        int samples;   // 尚未读取的样本数
+        int offset;    // 已读取的样本数
+    };
+
+    int64_t bufferedUsLocked() const;
+    int64_t targetDelayUsLocked() const;
+    void dropFrontLocked(int samples);
+    void concealLocked(int16_t* out, int frames, int outRate);
+
+    mutable std::mutex m_mutex;
+    AudioJitterConfig m_config;
+    std::deque<int16_t> m_samples;
+    std::deque<Segment> m_segments;   // 每包样本的到达时间，用于延迟统计
+    int m_sampleRate;
+    double m_position;                // 读位置在 m_samples 开头之后的小数偏移
+    bool m_playing;                   // false 时在预缓冲
+    bool m_underrun;                  // 预缓冲是由欠载引起的，期间输出补齐波形
+    int m_stretch;                    // -1 减速，0 原速，1 加速
+    uint64_t m_mediaSamples;          // 按样本数累计的媒体时间
+    int64_t m_firstArrivalUs;
+    int64_t m_lastArrivalUs;
+    int64_t m_lastTransitUs;
+    double m_jitterUs;
+    int64_t m_packetUs;               // 最近一包的时长
+    int64_t m_readUs;                 // 输出设备每次读取的时长
+    int64_t m_boostUs;                // 欠载带来的额外深度，稳定播放时逐渐回落
+    std::vector<int16_t> m_history;   // 最近 10ms 的输出，欠载时用来补齐
+    int64_t m_concealFrames;          // 本次欠载已补齐的帧数
+    double m_concealedUs;
+    double m_droppedUs;
+    double m_stretchedUs;
+    double m_latencyUs;
+    int64_t m_maxLatencyUs;
+    bool m_hasPlayout;
+    int64_t m_playoutMediaUs;
+    int64_t m_playoutUs;
+    AudioJitterStats m_stats;
+};
+
+#endif // AUDIO_JITTER_BUFFER_H
@@ -0,0 +1,188 @@
+#include "audio_pipeline.h"
+
+#include <chrono>
+
+#include "h264_nal.h"
+
+#define LOG_TAG "AudioPipeline"
+#include "native_log.h"
+
+static int64_t steadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AudioPipeline::AudioPipeline()
+    : m_codec(AUDIO_CODEC_NONE),
+      m_sampleRate(0),
+      m_decodedRate(0),
+      m_decoderCodec(AUDIO_CODEC_NONE),
+      m_sinkLatencyUs(0),
+      m_packets(0),
+      m_decodeErrors(0),
+      m_decodeUs(0) {
+}
+
+AudioPipeline::~AudioPipeline() {
+    stop();
+}
+
+void AudioPipeline::configureJitter(const AudioJitterConfig& config) {
+    m_jitter.configure(config);
+}
+
+void AudioPipeline::setPlayoutListener(const PlayoutListener& listener) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_playoutListener = listener;
+}
+
+bool AudioPipeline::start(const std::string& devId, AudioCodec codec, int sampleRate, const std::string& sinkName,
+                          const std::string& sinkPath, const AudioSinkConfig& sinkConfig) {
+    stop();
+    std::unique_ptr<AudioSink> sink = createAudioSink(sinkName, sinkPath);
+    if (!sink) {
+        return false;
+    }
+    m_jitter.reset();
+    const int outputRate = sinkConfig.sampleRate;
+    PlayoutListener listener;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        listener = m_playoutListener;
+    }
+    // 输出回调只访问抖动缓冲，不取 m_mutex，接收线程解码耗时不会阻塞播放；
+    // m_sinkLatencyUs 在输出启动前写好，回调期间不变
+    if (!sink->open(sinkConfig, [this, outputRate, listener](int16_t* out, int frames) {
+            m_jitter.read(out, frames, outputRate, steadyTimeUs(), m_sinkLatencyUs);
+            int64_t mediaUs = 0;
+            int64_t playoutUs = 0;
+            if (listener && m_jitter.playoutPosition(&mediaUs, &playoutUs)) {
+                listener(mediaUs, playoutUs);
+            }
+        })) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devId = devId;
+    m_codec = codec;
+    m_sampleRate = sampleRate;
+    m_decodedRate = 0;
+    m_decoder.reset();
+    m_decoderCodec = AUDIO_CODEC_NONE;
+    m_sinkConfig = sinkConfig;
+    m_sinkLatencyUs = sink->latencyUs();
+    m_packets = 0;
+    m_decodeErrors = 0;
+    m_decodeUs = 0;
+    if (!sink->start()) {
+        LOGE("启动音频输出失败: %s", sink->name());
+        sink->close();
+        m_devId.clear();
+        return false;
+    }
+    m_sink = std::move(sink);
+    LOGI("start: devId=%s codec=%s %dHz -> %s %dHz/%d 帧", devId.c_str(), audioCodecName(codec), sampleRate,
+         m_sink->name(), sinkConfig.sampleRate, sinkConfig.framesPerBuffer);
+    return true;
+}
+
+void AudioPipeline::stop() {
+    std::unique_ptr<AudioSink> sink;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sink = std::move(m_sink);
+        m_devId.clear();
+        if (m_decoder) {
+            m_decoder->close();
+            m_decoder.reset();
+        }
+        m_decoderCodec = AUDIO_CODEC_NONE;
+    }
+    // 输出线程可能正在回调，不持锁关闭
+    if (sink) {
+        sink->close();
+        LOGI("stop");
+    }
+}
+
+bool AudioPipeline::decodeLocked(AudioCodec codec, const uint8_t* data, int length, int64_t arrivalUs) {
+    // 创建失败后不再重试，直到下一次 start
+    if (m_decoderCodec != codec) {
+        m_decoder = createAudioDecoder(codec);
+        m_decoderCodec = codec;
+        if (m_decoder && !m_decoder->open(codec, m_sampleRate)) {
+            m_decoder.reset();
+        }
+    }
+    if (!m_decoder) {
+        m_decodeErrors++;
+        return false;
+    }
+    const int64_t startUs = steadyTimeUs();
+    m_pcm.clear();
+    int rate = 0;
+    if (!m_decoder->decode(data, length, m_pcm, &rate)) {
+        m_decodeErrors++;
+        return false;
+    }
+    const int64_t costUs = steadyTimeUs() - startUs;
+    m_packets++;
+    m_decodeUs = m_decodeUs == 0 ? costUs : m_decodeUs * 0.95 + costUs * 0.05;
+    if (rate > 0) {
+        m_decodedRate = rate;
+    }
+    // AAC 解码器首帧可能还没有输出
+    if (!m_pcm.empty() && m_decodedRate > 0) {
+        m_jitter.push(m_pcm.data(), (int)m_pcm.size(), m_decodedRate, arrivalUs);
+    }
+    return true;
+}
+
+bool AudioPipeline::onPacket(const std::string& devId, const uint8_t* data, int length, int64_t arrivalUs) {
+    if (!data || length <= 0) {
+        return false;
+    }
+    std::vector<std::pair<int, int>> frames;
+    splitAdtsFrames(data, length, frames);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool playing = m_sink && devId == m_devId;
+    if (!frames.empty()) {
+        if (playing && (m_codec == AUDIO_CODEC_AAC || m_codec == AUDIO_CODEC_NONE)) {
+            for (const auto& frame : frames) {
+                decodeLocked(AUDIO_CODEC_AAC, data + frame.first, frame.second, arrivalUs);
+            }
+        }
+        return true;
+    }
+    // G.711 没有同步字，只对声明了 G.711 的设备按排除法识别
+    if (playing && (m_codec == AUDIO_CODEC_PCMU || m_codec == AUDIO_CODEC_PCMA) &&
+        h264FindStartCode(data, length, 0, nullptr) != 0) {
+        decodeLocked(m_codec, data, length, arrivalUs);
+        return true;
+    }
+    return false;
+}
+
+bool AudioPipeline::isActive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sink != nullptr;
+}
+
+AudioPipelineStats AudioPipeline::stats() const {
+    AudioPipelineStats result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        result.active = m_sink != nullptr;
+        result.codec = m_decoderCodec != AUDIO_CODEC_NONE ? m_decoderCodec : m_codec;
+        result.sampleRate = m_decodedRate;
+        result.outputRate = m_sink ? m_sinkConfig.sampleRate : 0;
+        result.packets = m_packets;
+        result.decodeErrors = m_decodeErrors;
+        result.decodeUs = (int64_t)m_decodeUs;
+        result.sinkLatencyMs = m_sinkLatencyUs / 1000;
+    }
+    result.jitter = m_jitter.stats();
+    return result;
+}
@@ -0,0 +1,73 @@
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "audio_codec.h"
+#include "audio_jitter_buffer.h"
+#include "audio_sink.h"
+
+struct AudioPipelineStats {
+    bool active = false;
+    int codec = AUDIO_CODEC_NONE;
+    int sampleRate = 0;          // 解码输出采样率
+    int outputRate = 0;          // 输出设备采样率
+    uint64_t packets = 0;
+    uint64_t decodeErrors = 0;
+    int64_t decodeUs = 0;        // 平均每包解码耗时
+    int64_t sinkLatencyMs = 0;
+    AudioJitterStats jitter;
+};
+
+// 音频接收：从 P2P 接收回调里分出音频包（ADTS 同步字识别 AAC；声明为 G.711 的设备，
+// 不以 Annex-B 起始码开头的包按 G.711 处理），在接收线程上解码后写入抖动缓冲，
+// 输出设备的回调线程从抖动缓冲拉取。同一时间只播放一个设备，其它设备的音频包直接丢弃。
+class AudioPipeline {
+public:
+    // 输出线程每次写出真实样本后回调：第一个样本的到达域时间戳和播放时间，用于音视频同步
+    typedef std::function<void(int64_t mediaUs, int64_t playoutUs)> PlayoutListener;
+
+    AudioPipeline();
+    ~AudioPipeline();
+
+    // codec 为 AUDIO_CODEC_NONE 时只接收 ADTS 封装的 AAC；sinkName 为空时用平台默认输出
+    bool start(const std::string& devId, AudioCodec codec, int sampleRate, const std::string& sinkName,
+               const std::string& sinkPath, const AudioSinkConfig& sinkConfig);
+    void stop();
+    void configureJitter(const AudioJitterConfig& config);
+    // 在下一次 start 时生效
+    void setPlayoutListener(const PlayoutListener& listener);
+
+    // 接收线程调用：返回 true 表示是音频包（已处理或丢弃），调用方不再按视频处理
+    bool onPacket(const std::string& devId, const uint8_t* data, int length, int64_t arrivalUs);
+
+    bool isActive() const;
+    AudioPipelineStats stats() const;
+
+private:
+    bool decodeLocked(AudioCodec codec, const uint8_t* data, int length, int64_t arrivalUs);
+
+    mutable std::mutex m_mutex;
+    std::string m_devId;
+    AudioCodec m_codec;
+    int m_sampleRate;
+    int m_decodedRate;
+    std::unique_ptr<AudioDecoder> m_decoder;
+    AudioCodec m_decoderCodec;
+    std::unique_ptr<AudioSink> m_sink;
+    AudioSinkConfig m_sinkConfig;
+    PlayoutListener m_playoutListener;
+    int64_t m_sinkLatencyUs;
+    AudioJitterBuffer m_jitter;
+    std::vector<int16_t> m_pcm;
+    uint64_t m_packets;
+    uint64_t m_decodeErrors;
+    double m_decodeUs;
+};
+
+#endif // AUDIO_PIPELINE_H
@@ -0,0 +1,161 @@
+#include "audio_sink.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define LOG_TAG "AudioSink"
+#include "native_log.h"
+
+#ifdef HAVE_OPENSLES
+std::unique_ptr<AudioSink> createOpenSlAudioSink();
+#endif
+
+namespace {
+
+void writeLe16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void writeLe32(uint8_t* p, uint32_t v) {
+    writeLe16(p, v);
+    writeLe16(p + 2, v >> 16);
+}
+
+// 16 位单声道 PCM 的 WAV 头，dataBytes 在关闭时回填
+void buildWavHeader(uint8_t header[44], int sampleRate, uint32_t dataBytes) {
+    memcpy(header, "RIFF", 4);
+    writeLe32(header + 4, 36 + dataBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    writeLe32(header + 16, 16);
+    writeLe16(header + 20, 1);
+    writeLe16(header + 22, 1);
+    writeLe32(header + 24, sampleRate);
+    writeLe32(header + 28, sampleRate * 2);
+    writeLe16(header + 32, 2);
+    writeLe16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    writeLe32(header + 40, dataBytes);
+}
+
+// null/file 输出：内部线程按缓冲时长定时拉取，非实时模式下不等待
+class PacedAudioSink : public AudioSink {
+public:
+    explicit PacedAudioSink(const std::string& path) : m_path(path), m_file(nullptr), m_dataBytes(0), m_running(false) {}
+
+    ~PacedAudioSink() override {
+        close();
+    }
+
+    const char* name() const override {
+        return m_path.empty() ? "null" : "file";
+    }
+
+    bool open(const AudioSinkConfig& config, const AudioRenderCallback& callback) override {
+        close();
+        if (config.sampleRate <= 0 || config.framesPerBuffer <= 0 || !callback) {
+            return false;
+        }
+        if (!m_path.empty()) {
+            m_file = fopen(m_path.c_str(), "wb");
+            if (!m_file) {
+                LOGE("无法创建输出文件: %s", m_path.c_str());
+                return false;
+            }
+            uint8_t header[44];
+            buildWavHeader(header, config.sampleRate, 0);
+            fwrite(header, 1, sizeof(header), m_file);
+            m_dataBytes = 0;
+        }
+        m_config = config;
+        m_callback = callback;
+        return true;
+    }
+
+    bool start() override {
+        if (!m_callback || m_running.exchange(true)) {
+            return false;
+        }
+        m_thread = std::thread([this]() { run(); });
+        return true;
+    }
+
+    void stop() override {
+        if (m_running.exchange(false) && m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    void close() override {
+        stop();
+        if (m_file) {
+            uint8_t header[44];
+            buildWavHeader(header, m_config.sampleRate, m_dataBytes);
+            fseek(m_file, 0, SEEK_SET);
+            fwrite(header, 1, sizeof(header), m_file);
+            fclose(m_file);
+            m_file = nullptr;
+        }
+        m_callback = nullptr;
+    }
+
+    int64_t latencyUs() const override {
+        return (int64_t)m_config.framesPerBuffer * 1000000 / m_config.sampleRate;
+    }
+
+private:
+    void run() {
+        std::vector<int16_t> buffer(m_config.framesPerBuffer);
+        const auto period = std::chrono::microseconds(latencyUs());
+        auto next = std::chrono::steady_clock::now();
+        while (m_running.load()) {
+            m_callback(buffer.data(), m_config.framesPerBuffer);
+            if (m_file) {
+                m_dataBytes += (uint32_t)fwrite(buffer.data(), sizeof(int16_t), buffer.size(), m_file) * sizeof(int16_t);
+            }
+            if (m_config.realtime) {
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+        }
+    }
+
+    std::string m_path;
+    FILE* m_file;
+    uint32_t m_dataBytes;
+    AudioSinkConfig m_config;
+    AudioRenderCallback m_callback;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+} // namespace
+
+std::unique_ptr<AudioSink> createAudioSink(const std::string& name, const std::string& path) {
+#ifdef HAVE_OPENSLES
+    if (name.empty() || name == "opensl") {
+        return createOpenSlAudioSink();
+    }
+#endif
+    if (name.empty() || name == "null") {
+        return std::unique_ptr<AudioSink>(new PacedAudioSink(std::string()));
+    }
+    if (name == "file" && !path.empty()) {
+        return std::unique_ptr<AudioSink>(new PacedAudioSink(path));
+    }
+    LOGE("没有可用的音频输出: %s", name.empty() ? "(默认)" : name.c_str());
+    return nullptr;
+}
+
+std::vector<std::string> audioSinkBackends() {
+    std::vector<std::string> names;
+#ifdef HAVE_OPENSLES
+    names.push_back("opensl");
+#endif
+    names.push_back("null");
+    names.push_back("file");
+    return names;
+}
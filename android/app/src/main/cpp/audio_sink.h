@@ -0,0 +1,41 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 输出设备的回调：填满 frames 个 16 位单声道样本，在输出线程上调用，不能阻塞
+typedef std::function<void(int16_t* out, int frames)> AudioRenderCallback;
+
+struct AudioSinkConfig {
+    int sampleRate = 48000;      // Android 上用设备原生采样率才能走低延迟通路
+    int framesPerBuffer = 480;   // 每次回调的帧数，10ms
+    bool realtime = true;        // 非实时的 null/file 输出不等待，按最快速度回调，用于基准测试
+};
+
+// 可插拔的音频输出。Android 上用 OpenSL ES 的低延迟通路；桌面和基准测试用 null/file 输出，
+// 由内部线程按缓冲时长定时拉取，file 输出把拉到的 PCM 写成 WAV。
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+
+    virtual const char* name() const = 0;
+    virtual bool open(const AudioSinkConfig& config, const AudioRenderCallback& callback) = 0;
+    virtual bool start() = 0;
+    // 返回后不会再有回调
+    virtual void stop() = 0;
+    virtual void close() = 0;
+    // 样本从回调写出到离开设备的估计时间
+    virtual int64_t latencyUs() const = 0;
+};
+
+// 按名称创建输出："opensl"（仅 Android）、"null"、"file"（path 为 WAV 文件路径）；名称为空时返回平台默认输出
+std::unique_ptr<AudioSink> createAudioSink(const std::string& name, const std::string& path);
+
+// 当前构建中可用的输出名称
+std::vector<std::string> audioSinkBackends();
+
+#endif // AUDIO_SINK_H
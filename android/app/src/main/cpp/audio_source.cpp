@@ -0,0 +1,195 @@
+#include "audio_source.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define LOG_TAG "AudioSource"
+#include "native_log.h"
+
+#ifdef HAVE_OPENSLES
+std::unique_ptr<AudioSource> createOpenSlAudioSource();
+#endif
+
+namespace {
+
+int64_t steadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t readLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint16_t readLe16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// file 输入：WAV（16 位 PCM）或 16 位小端单声道裸 PCM，内部线程按缓冲时长定时读取，非实时模式下不等待
+class FileAudioSource : public AudioSource {
+public:
+    explicit FileAudioSource(const std::string& path) : m_path(path), m_file(nullptr), m_channels(1), m_running(false) {}
+
+    ~FileAudioSource() override {
+        close();
+    }
+
+    const char* name() const override {
+        return "file";
+    }
+
+    bool open(const AudioSourceConfig& config, const AudioCaptureCallback& callback) override {
+        close();
+        if (config.sampleRate <= 0 || config.framesPerBuffer <= 0 || !callback) {
+            return false;
+        }
+        m_file = fopen(m_path.c_str(), "rb");
+        if (!m_file) {
+            LOGE("无法打开输入文件: %s", m_path.c_str());
+            return false;
+        }
+        m_channels = 1;
+        if (!skipWavHeader(config.sampleRate)) {
+            close();
+            return false;
+        }
+        m_config = config;
+        m_callback = callback;
+        m_raw.assign((size_t)config.framesPerBuffer * m_channels, 0);
+        m_buffer.assign(config.framesPerBuffer, 0);
+        return true;
+    }
+
+    bool start() override {
+        if (!m_callback || m_running.exchange(true)) {
+            return false;
+        }
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        m_thread = std::thread([this]() { run(); });
+        return true;
+    }
+
+    // 读到文件末尾时线程自行退出，这里仍要回收
+    void stop() override {
+        m_running.store(false);
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    void close() override {
+        stop();
+        if (m_file) {
+            fclose(m_file);
+            m_file = nullptr;
+        }
+        m_callback = nullptr;
+    }
+
+private:
+    // 不是 WAV 时回到文件开头按裸 PCM 处理；是 WAV 时定位到 data 块
+    bool skipWavHeader(int sampleRate) {
+        uint8_t riff[12];
+        if (fread(riff, 1, sizeof(riff), m_file) != sizeof(riff) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+            fseek(m_file, 0, SEEK_SET);
+            return true;
+        }
+        uint8_t chunk[8];
+        while (fread(chunk, 1, sizeof(chunk), m_file) == sizeof(chunk)) {
+            const uint32_t size = readLe32(chunk + 4);
+            if (memcmp(chunk, "data", 4) == 0) {
+                return true;
+            }
+            if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+                uint8_t fmt[16];
+                if (fread(fmt, 1, sizeof(fmt), m_file) != sizeof(fmt)) {
+                    break;
+                }
+                const int format = readLe16(fmt);
+                const int channels = readLe16(fmt + 2);
+                const int rate = (int)readLe32(fmt + 4);
+                const int bits = readLe16(fmt + 14);
+                if (format != 1 || bits != 16 || channels <= 0) {
+                    LOGE("只支持 16 位 PCM 的 WAV: format=%d bits=%d", format, bits);
+                    return false;
+                }
+                if (rate != sampleRate) {
+                    LOGE("WAV 采样率 %d 与采集配置 %d 不一致", rate, sampleRate);
+                    return false;
+                }
+                m_channels = channels;
+                fseek(m_file, (long)(size - sizeof(fmt) + (size & 1)), SEEK_CUR);
+                continue;
+            }
+            fseek(m_file, (long)(size + (size & 1)), SEEK_CUR);
+        }
+        LOGE("WAV 文件没有 data 块: %s", m_path.c_str());
+        return false;
+    }
+
+    void run() {
+        const auto period = std::chrono::microseconds((int64_t)m_config.framesPerBuffer * 1000000 / m_config.sampleRate);
+        auto next = std::chrono::steady_clock::now();
+        while (m_running.load()) {
+            if (m_config.realtime) {
+                // 缓冲采满之后才能交出，先等一个缓冲时长
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+            const size_t frames = fread(m_raw.data(), sizeof(int16_t) * m_channels, m_config.framesPerBuffer, m_file);
+            if (frames == 0) {
+                m_callback(m_buffer.data(), 0, steadyTimeUs());
+                break;
+            }
+            // 多声道取平均混成单声道
+            for (size_t i = 0; i < frames; i++) {
+                int sum = 0;
+                for (int c = 0; c < m_channels; c++) {
+                    sum += m_raw[i * m_channels + c];
+                }
+                m_buffer[i] = (int16_t)(sum / m_channels);
+            }
+            m_callback(m_buffer.data(), (int)frames, steadyTimeUs());
+        }
+        m_running.store(false);
+    }
+
+    std::string m_path;
+    FILE* m_file;
+    int m_channels;
+    AudioSourceConfig m_config;
+    AudioCaptureCallback m_callback;
+    std::vector<int16_t> m_raw;
+    std::vector<int16_t> m_buffer;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+} // namespace
+
+std::unique_ptr<AudioSource> createAudioSource(const std::string& name, const std::string& path) {
+#ifdef HAVE_OPENSLES
+    if (name.empty() || name == "opensl") {
+        return createOpenSlAudioSource();
+    }
+#endif
+    if (name == "file" && !path.empty()) {
+        return std::unique_ptr<AudioSource>(new FileAudioSource(path));
+    }
+    LOGE("没有可用的音频输入: %s", name.empty() ? "(默认)" : name.c_str());
+    return nullptr;
+}
+
+std::vector<std::string> audioSourceBackends() {
+    std::vector<std::string> names;
+#ifdef HAVE_OPENSLES
+    names.push_back("opensl");
+#endif
+    names.push_back("file");
+    return names;
+}
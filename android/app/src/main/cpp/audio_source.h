@@ -0,0 +1,40 @@
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 采集设备的回调：frames 个 16 位单声道样本，captureUs 为最后一个样本的采集时间（CLOCK_MONOTONIC 微秒）。
+// 在采集线程上调用，不能阻塞；frames 为 0 表示输入结束（只有 file 输入会出现）
+typedef std::function<void(const int16_t* pcm, int frames, int64_t captureUs)> AudioCaptureCallback;
+
+struct AudioSourceConfig {
+    int sampleRate = 8000;       // 直接按编码采样率采集，免去重采样
+    int framesPerBuffer = 80;    // 每次回调的帧数，10ms
+    bool realtime = true;        // 非实时的 file 输入不等待，按最快速度回调，用于基准测试
+};
+
+// 可插拔的音频采集。Android 上用 OpenSL ES 录音（VOICE_COMMUNICATION 预设，带回声消除）；
+// 桌面和基准测试用 file 输入，由内部线程按缓冲时长定时读取 WAV 或 16 位小端裸 PCM 文件。
+class AudioSource {
+public:
+    virtual ~AudioSource() {}
+
+    virtual const char* name() const = 0;
+    virtual bool open(const AudioSourceConfig& config, const AudioCaptureCallback& callback) = 0;
+    virtual bool start() = 0;
+    // 返回后不会再有回调
+    virtual void stop() = 0;
+    virtual void close() = 0;
+};
+
+// 按名称创建输入："opensl"（仅 Android）、"file"（path 为 WAV 或裸 PCM 文件路径）；名称为空时返回平台默认输入
+std::unique_ptr<AudioSource> createAudioSource(const std::string& name, const std::string& path);
+
+// 当前构建中可用的输入名称
+std::vector<std::string> audioSourceBackends();
+
+#endif // AUDIO_SOURCE_H
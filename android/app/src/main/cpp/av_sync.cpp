@@ -0,0 +1,99 @@
+#include "av_sync.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+#define LOG_TAG "AvSync"
+#include "native_log.h"
+
+const int64_t AvSyncClock::kAudioStaleUs;
+const int64_t AvSyncClock::kResyncThresholdUs;
+const int AvSyncClock::kFollowShift;
+
+// 音频延迟跳变超过该值（重新缓冲）时不平滑，直接采用
+static const int64_t kAudioDelayJumpUs = 200000;
+
+AvSyncClock::AvSyncClock()
+    : m_hasAudio(false),
+      m_audioDelayUs(0),
+      m_audioUpdatedUs(0),
+      m_syncing(false),
+      m_correctionUs(0) {
+}
+
+void AvSyncClock::onAudioPlayout(int64_t mediaUs, int64_t playoutUs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int64_t delayUs = playoutUs - mediaUs;
+    if (!m_hasAudio || llabs(delayUs - m_audioDelayUs) > kAudioDelayJumpUs) {
+        m_audioDelayUs = delayUs;
+    } else {
+        // 包内样本的到达时间是按包估计的，逐次读取会有一包以内的锯齿，平滑掉
+        m_audioDelayUs += (delayUs - m_audioDelayUs) / 16;
+    }
+    m_hasAudio = true;
+    m_audioUpdatedUs = playoutUs;
+}
+
+void AvSyncClock::resetAudio() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hasAudio = false;
+    m_syncing = false;
+    m_correctionUs = 0;
+}
+
+bool AvSyncClock::audioActiveLocked(int64_t nowUs) const {
+    return m_hasAudio && nowUs - m_audioUpdatedUs < kAudioStaleUs;
+}
+
+void AvSyncClock::recordOffsetLocked(int64_t offsetUs) {
+    m_stats.offsetUs = (m_stats.offsetUs * 15 + offsetUs) / 16;
+    m_stats.maxOffsetUs = std::max(m_stats.maxOffsetUs, (int64_t)llabs(offsetUs));
+}
+
+int64_t AvSyncClock::syncVideo(int64_t ptsUs, int64_t naturalTargetUs, int64_t frameIntervalUs, int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!audioActiveLocked(nowUs) || ptsUs <= 0) {
+        if (m_syncing) {
+            LOGI("音频时钟不可用，视频按自身时钟显示");
+        }
+        m_syncing = false;
+        return naturalTargetUs;
+    }
+
+    const int64_t audioTargetUs = ptsUs + m_audioDelayUs;
+    const int64_t desiredUs = audioTargetUs - naturalTargetUs;
+    const int64_t errorUs = desiredUs - m_correctionUs;
+    m_stats.syncedFrames++;
+    if (!m_syncing || llabs(errorUs) > kResyncThresholdUs) {
+        if (m_syncing) {
+            m_stats.resyncs++;
+            LOGW("唇音偏差 %lldms，直接对齐", (long long)(errorUs / 1000));
+        }
+        m_syncing = true;
+        m_correctionUs = desiredUs;
+    } else if (errorUs < -frameIntervalUs) {
+        // 视频落后：丢掉这一帧，显示时间整体提前一个帧间隔
+        m_correctionUs -= frameIntervalUs;
+        m_stats.droppedFrames++;
+        recordOffsetLocked(-errorUs);
+        return -1;
+    } else if (errorUs > frameIntervalUs) {
+        // 视频超前：这一帧推迟一个帧间隔，上一帧在屏幕上多停留一次
+        m_correctionUs += frameIntervalUs;
+        m_stats.repeatedFrames++;
+    } else {
+        m_correctionUs += errorUs >> kFollowShift;
+    }
+
+    const int64_t targetUs = naturalTargetUs + m_correctionUs;
+    recordOffsetLocked(targetUs - audioTargetUs);
+    return targetUs;
+}
+
+AvSyncStats AvSyncClock::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AvSyncStats result = m_stats;
+    result.audioDelayUs = m_audioDelayUs;
+    result.audioActive = m_hasAudio && m_syncing;
+    return result;
+}
@@ -0,0 +1,55 @@
+#ifndef AV_SYNC_H
+#define AV_SYNC_H
+
+#include <stdint.h>
+#include <mutex>
+
+struct AvSyncStats {
+    uint64_t syncedFrames = 0;     // 按音频时钟调度的视频帧
+    uint64_t droppedFrames = 0;    // 视频落后音频超过一帧，丢帧追赶
+    uint64_t repeatedFrames = 0;   // 视频超前音频超过一帧，上一帧多停留一个帧间隔
+    uint64_t resyncs = 0;          // 偏差过大（音频重新缓冲、切换设备）时直接对齐
+    int64_t offsetUs = 0;          // 唇音偏差的平滑值：视频显示时间 - 对应音频播放时间，正值表示视频滞后
+    int64_t maxOffsetUs = 0;       // 偏差绝对值的最大值（对齐之后）
+    int64_t audioDelayUs = 0;      // 音频从到达到播放的延迟
+    bool audioActive = false;
+};
+
+// 音视频同步：音频为主时钟。音频输出线程报告正在播放的样本在到达时钟上的时间戳和它离开扬声器的时间，
+// 得到音频从到达到播放的延迟；视频帧的 PTS 同在到达时钟域（StreamClock），对应音频的播放时间即
+// PTS + 音频延迟。显示调度算出自己的目标时间后交给这里校正：偏差在一帧以内时平滑跟随，
+// 超前超过一帧时把上一帧多留一个帧间隔，落后超过一帧时丢掉当前帧，每帧的校正量不超过一个帧间隔。
+// 没有音频或音频停止超过 kAudioStaleUs 时不做校正。
+class AvSyncClock {
+public:
+    static const int64_t kAudioStaleUs = 500000;
+    static const int64_t kResyncThresholdUs = 1000000;   // 校正量与目标相差超过该值时直接对齐
+    static const int kFollowShift = 3;                   // 一帧以内的偏差每帧消除 1/8
+
+    AvSyncClock();
+
+    // 音频输出线程调用：mediaUs 为刚写出的第一个样本的到达域时间戳，playoutUs 为它的播放时间（均为微秒）
+    void onAudioPlayout(int64_t mediaUs, int64_t playoutUs);
+    // 音频停止或切换设备
+    void resetAudio();
+
+    // 显示调度调用：naturalTargetUs 为调度器按视频自身时钟算出的显示时间，
+    // 返回校正后的显示时间，-1 表示为追赶音频丢弃该帧
+    int64_t syncVideo(int64_t ptsUs, int64_t naturalTargetUs, int64_t frameIntervalUs, int64_t nowUs);
+
+    AvSyncStats stats() const;
+
+private:
+    bool audioActiveLocked(int64_t nowUs) const;
+    void recordOffsetLocked(int64_t offsetUs);
+
+    mutable std::mutex m_mutex;
+    bool m_hasAudio;
+    int64_t m_audioDelayUs;
+    int64_t m_audioUpdatedUs;
+    bool m_syncing;               // 上一帧是否按音频校正过
+    int64_t m_correctionUs;       // 当前加在调度目标上的校正量
+    AvSyncStats m_stats;
+};
+
+#endif // AV_SYNC_H
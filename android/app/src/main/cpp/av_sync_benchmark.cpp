@@ -0,0 +1,200 @@
+#include "av_sync_benchmark.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "av_sync.h"
+#include "presentation_scheduler.h"
+
+#define LOG_TAG "AvSyncBenchmark"
+#include "native_log.h"
+
+namespace {
+
+const int64_t kStartUs = 1000000;             // 虚拟时钟起点，PTS 为 0 表示缓存回放帧，要避开
+const int64_t kAudioReportUs = 20000;         // 音频输出线程每个缓冲报告一次
+const int64_t kAudioDelayUs = 250000;         // 音频从到达到播放的延迟
+const int64_t kVideoDelayUs = 150000;         // 显示调度按视频自身时钟给出的延迟
+const int64_t kDecodeUs = 30000;              // 帧到达后解码完成、交给显示调度的时间
+const int64_t kSettleUs = 3000000;            // 开始和每次扰动之后的收敛期，不计入稳定段偏差
+
+// 一个人为制造的音视频时间线
+struct Scenario {
+    const char* name;
+    int64_t videoDriftPpm;      // 显示调度的时钟相对音频时钟的漂移
+    int64_t audioStepUs;        // 中点处音频延迟的跳变（重新缓冲、切换输出设备）
+    int64_t reportJitterUs;     // 播放报告里到达时间戳的锯齿幅度（按包估计样本到达时间）
+    int64_t audioGapUs;         // 中点处音频停止的时长
+    int offsetLimitDivisor;     // 稳定段偏差上限为帧间隔除以该值
+    int maxCorrections;         // 丢帧加重复帧次数的上限，负值表示按跳变量推算
+    uint64_t expectedResyncs;
+};
+
+// 跳变小于 kResyncThresholdUs 时：音频延迟本身被平滑，大部分偏差由逐帧跟随消除，帧率低时可能完全不需要
+// 丢帧或重复帧；每次校正一个帧间隔，次数超过跳变量除以帧间隔说明校正过头来回振荡
+const Scenario kScenarios[] = {
+    {"steady", 0, 0, 0, 0, 8, 0, 0},
+    {"drift +1%", 10000, 0, 0, 0, 4, 0, 0},
+    {"drift -1%", -10000, 0, 0, 0, 4, 0, 0},
+    {"report jitter 20ms", 0, 0, 20000, 0, 4, 0, 0},
+    {"audio delay +120ms", 0, 120000, 0, 0, 4, -1, 0},
+    {"audio delay -120ms", 0, -120000, 0, 0, 4, -1, 0},
+    {"drift +1% delay -120ms", 10000, -120000, 0, 0, 4, -1, 0},
+    {"audio gap 1s", 0, 0, 0, 1000000, 8, 0, 0},
+    {"audio delay +1500ms", 0, 1500000, 0, 0, 8, 0, 1},
+};
+
+AvSyncBenchmarkCase runScenario(const Scenario& scenario, int fps, int seconds) {
+    AvSyncBenchmarkCase c;
+    c.name = scenario.name;
+    const int64_t intervalUs = 1000000 / fps;
+    const int64_t endUs = kStartUs + (int64_t)seconds * 1000000;
+    const int64_t disturbUs = kStartUs + (int64_t)seconds * 1000000 / 2;
+    const bool disturbed = scenario.audioStepUs != 0 || scenario.audioGapUs > 0;
+    c.offsetLimitUs = intervalUs / scenario.offsetLimitDivisor;
+    c.maxCorrections = scenario.maxCorrections < 0 ? (uint64_t)(llabs(scenario.audioStepUs) / intervalUs)
+                                                   : (uint64_t)scenario.maxCorrections;
+
+    AvSyncClock clock;
+    int64_t nextAudioUs = kStartUs;
+    int64_t ptsUs = kStartUs;
+    while (nextAudioUs < endUs || ptsUs + kDecodeUs < endUs) {
+        const int64_t videoUs = ptsUs + kDecodeUs;
+        if (nextAudioUs <= videoUs) {
+            const int64_t nowUs = nextAudioUs;
+            nextAudioUs += kAudioReportUs;
+            if (nowUs >= disturbUs && nowUs < disturbUs + scenario.audioGapUs) {
+                continue;
+            }
+            const int64_t delayUs = kAudioDelayUs + (nowUs >= disturbUs ? scenario.audioStepUs : 0);
+            // 锯齿：每 4 个缓冲从 -J/2 爬升到 +J/2
+            const int64_t phaseUs = (nowUs - kStartUs) % (kAudioReportUs * 4);
+            const int64_t jitterUs = scenario.reportJitterUs * phaseUs / (kAudioReportUs * 4) - scenario.reportJitterUs / 2;
+            clock.onAudioPlayout(nowUs - delayUs + jitterUs, nowUs);
+            continue;
+        }
+
+        const int64_t nowUs = videoUs;
+        const int64_t naturalUs = ptsUs + kVideoDelayUs + (ptsUs - kStartUs) * scenario.videoDriftPpm / 1000000;
+        const int64_t targetUs = clock.syncVideo(ptsUs, naturalUs, intervalUs, nowUs);
+        c.frames++;
+        const bool audioPlaying = !(nowUs >= disturbUs && nowUs < disturbUs + scenario.audioGapUs);
+        const bool settling = nowUs < kStartUs + kSettleUs ||
+                              (disturbed && nowUs >= disturbUs && nowUs < disturbUs + scenario.audioGapUs + kSettleUs);
+        if (targetUs >= 0 && audioPlaying && !settling) {
+            const int64_t delayUs = kAudioDelayUs + (nowUs >= disturbUs ? scenario.audioStepUs : 0);
+            c.maxOffsetUs = std::max(c.maxOffsetUs, (int64_t)llabs(targetUs - (ptsUs + delayUs)));
+        }
+        ptsUs += intervalUs;
+    }
+
+    const AvSyncStats stats = clock.stats();
+    c.droppedFrames = stats.droppedFrames;
+    c.repeatedFrames = stats.repeatedFrames;
+    c.resyncs = stats.resyncs;
+    const uint64_t corrections = stats.droppedFrames + stats.repeatedFrames;
+    c.passed = c.maxOffsetUs <= c.offsetLimitUs && corrections <= c.maxCorrections &&
+               stats.resyncs == scenario.expectedResyncs;
+    return c;
+}
+
+// 直播中进入快放，快放中途重启音频，再回到直播，走 native-lib 用的同一个 MasterClockSwitch。
+// 快放帧只按显示调度自身的时钟（PTS + 目标延迟），不能被音频时钟校正；回到直播后重新跟随音频。
+// maxOffsetUs 同时计入快放帧偏离自身时钟的量和直播稳定段的唇音偏差
+AvSyncBenchmarkCase runTrickPlayScenario(int fps, int seconds) {
+    AvSyncBenchmarkCase c;
+    c.name = "audio restart in trick";
+    const int64_t intervalUs = 1000000 / fps;
+    const int64_t durationUs = (int64_t)seconds * 1000000;
+    const int64_t endUs = kStartUs + durationUs;
+    const int64_t enterUs = kStartUs + durationUs * 4 / 10;
+    const int64_t restartUs = kStartUs + durationUs / 2;
+    const int64_t leaveUs = kStartUs + durationUs * 6 / 10;
+    const int64_t targetDelayUs = (int64_t)PresentationScheduler::kDefaultTargetDelayMs * 1000;
+    c.offsetLimitUs = intervalUs / 4;
+    // 开始和回到直播时各从调度器自身的延迟校正到音频延迟一次
+    c.maxCorrections = (uint64_t)(2 * (kAudioDelayUs - targetDelayUs) / intervalUs);
+
+    PresentationScheduler scheduler;
+    AvSyncClock clock;
+    MasterClockSwitch clockSwitch(scheduler, clock);
+    clockSwitch.onAudioStart();
+    bool restarted = false;
+    uint64_t trickSyncedFrames = 0;
+    int64_t nextAudioUs = kStartUs;
+    int64_t ptsUs = kStartUs;
+    while (nextAudioUs < endUs || ptsUs + kDecodeUs < endUs) {
+        const int64_t videoUs = ptsUs + kDecodeUs;
+        if (nextAudioUs <= videoUs) {
+            const int64_t nowUs = nextAudioUs;
+            nextAudioUs += kAudioReportUs;
+            if (!restarted && nowUs >= restartUs) {
+                clockSwitch.onAudioStart();
+                restarted = true;
+            }
+            // 直播音频在快放期间照常播放
+            clock.onAudioPlayout(nowUs - kAudioDelayUs, nowUs);
+            continue;
+        }
+
+        const int64_t nowUs = videoUs;
+        const bool trick = nowUs >= enterUs && nowUs < leaveUs;
+        if (trick != clockSwitch.inTrickPlay()) {
+            scheduler.reset();
+            if (trick) {
+                clockSwitch.enterTrickPlay();
+            } else {
+                clockSwitch.leaveTrickPlay();
+            }
+        }
+        const uint64_t syncedBefore = clock.stats().syncedFrames;
+        const int64_t targetNs = scheduler.schedule(ptsUs, nowUs * 1000);
+        c.frames++;
+        if (trick) {
+            trickSyncedFrames += clock.stats().syncedFrames - syncedBefore;
+            if (targetNs >= 0) {
+                c.maxOffsetUs = std::max(c.maxOffsetUs, (int64_t)llabs(targetNs / 1000 - (ptsUs + targetDelayUs)));
+            }
+        } else if (targetNs >= 0 && nowUs >= kStartUs + kSettleUs && !(nowUs >= leaveUs && nowUs < leaveUs + kSettleUs)) {
+            c.maxOffsetUs = std::max(c.maxOffsetUs, (int64_t)llabs(targetNs / 1000 - (ptsUs + kAudioDelayUs)));
+        }
+        ptsUs += intervalUs;
+    }
+
+    const AvSyncStats stats = clock.stats();
+    c.droppedFrames = stats.droppedFrames;
+    c.repeatedFrames = stats.repeatedFrames;
+    c.resyncs = stats.resyncs;
+    c.passed = trickSyncedFrames == 0 && c.maxOffsetUs <= c.offsetLimitUs &&
+               stats.droppedFrames + stats.repeatedFrames <= c.maxCorrections && stats.resyncs == 0;
+    if (trickSyncedFrames > 0) {
+        LOGE("%s: 快放期间 %llu 帧被音频时钟校正", c.name.c_str(), (unsigned long long)trickSyncedFrames);
+    }
+    return c;
+}
+
+} // namespace
+
+AvSyncBenchmarkResult runAvSyncBenchmark(const AvSyncBenchmarkOptions& options) {
+    AvSyncBenchmarkResult result;
+    if (options.fps <= 0 || options.fps > 120 || options.seconds < 10) {
+        LOGE("参数无效: fps=%d seconds=%d（至少 10 秒，留出收敛期）", options.fps, options.seconds);
+        return result;
+    }
+    const size_t scenarioCount = sizeof(kScenarios) / sizeof(kScenarios[0]);
+    for (size_t i = 0; i <= scenarioCount; i++) {
+        AvSyncBenchmarkCase c = i < scenarioCount ? runScenario(kScenarios[i], options.fps, options.seconds)
+                                                  : runTrickPlayScenario(options.fps, options.seconds);
+        if (!c.passed) {
+            result.failedCases++;
+            LOGE("%s: 偏差 %lldus（上限 %lldus），丢帧 %llu、重复 %llu（合计上限 %llu），重新对齐 %llu",
+                 c.name.c_str(), (long long)c.maxOffsetUs, (long long)c.offsetLimitUs,
+                 (unsigned long long)c.droppedFrames, (unsigned long long)c.repeatedFrames,
+                 (unsigned long long)c.maxCorrections,
+                 (unsigned long long)c.resyncs);
+        }
+        result.cases.push_back(c);
+    }
+    result.ok = true;
+    return result;
+}
@@ -0,0 +1,38 @@
+#ifndef AV_SYNC_BENCHMARK_H
+#define AV_SYNC_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct AvSyncBenchmarkOptions {
+    int fps = 25;
+    int seconds = 60;       // 每个场景模拟的时长
+};
+
+// 一个场景的结果和检查的上下限
+struct AvSyncBenchmarkCase {
+    std::string name;
+    uint64_t frames = 0;
+    uint64_t droppedFrames = 0;
+    uint64_t repeatedFrames = 0;
+    uint64_t resyncs = 0;
+    int64_t maxOffsetUs = 0;        // 稳定段（开始和每次扰动后的收敛期之外）唇音偏差绝对值的最大值
+    int64_t offsetLimitUs = 0;
+    uint64_t maxCorrections = 0;    // 丢帧加重复帧次数的上限
+    bool passed = false;
+};
+
+struct AvSyncBenchmarkResult {
+    bool ok = false;
+    std::vector<AvSyncBenchmarkCase> cases;
+    uint64_t failedCases = 0;
+};
+
+// 无界面唇音同步检查：在虚拟时钟上模拟音频输出线程的播放报告和显示调度，按场景人为制造
+// 视频时钟漂移、音频延迟跳变、播放报告抖动和音频中断，经 AvSyncClock 校正后检查稳定段的
+// 偏差以及丢帧、重复帧次数是否在预期范围内；另有一个场景在快放期间重启音频，检查录像帧不被音频时钟校正。
+// 不依赖实际时间，结果可复现。
+AvSyncBenchmarkResult runAvSyncBenchmark(const AvSyncBenchmarkOptions& options);
+
+#endif // AV_SYNC_BENCHMARK_H
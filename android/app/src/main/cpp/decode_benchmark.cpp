@@ -0,0 +1,93 @@
+#include "decode_benchmark.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <chrono>
+#include <vector>
+
+#include "h264_nal.h"
+#include "video_decoder.h"
+
+#define LOG_TAG "DecodeBenchmark"
+#include "native_log.h"
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[64 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static double processCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+DecodeBenchmarkResult runDecodeBenchmark(const std::string& path, const DecodeBenchmarkOptions& options) {
+    DecodeBenchmarkResult result;
+    std::vector<uint8_t> stream;
+    if (!readFile(path, stream) || stream.empty()) {
+        LOGE("无法读取码流文件: %s", path.c_str());
+        return result;
+    }
+    std::vector<std::pair<int, int>> units;
+    h264SplitAccessUnits(stream.data(), (int)stream.size(), units);
+    if (units.empty()) {
+        LOGE("文件中没有 H.264 访问单元: %s", path.c_str());
+        return result;
+    }
+
+    std::unique_ptr<VideoDecoder> decoder = createVideoDecoder(options.backend);
+    if (!decoder) {
+        return result;
+    }
+    VideoDecoderConfig config;
+    config.threads = options.threads;
+    config.lowDelay = options.lowDelay;
+    if (!decoder->open(config, [&result](const DecodedFrame& frame) {
+            result.width = frame.planes.width;
+            result.height = frame.planes.height;
+        })) {
+        return result;
+    }
+
+    const double cpuStart = processCpuSeconds();
+    const auto wallStart = std::chrono::steady_clock::now();
+    // 按 25fps 编造时间戳，只用于保持单调
+    int64_t ptsUs = 0;
+    const int loops = options.loops > 0 ? options.loops : 1;
+    for (int loop = 0; loop < loops; loop++) {
+        for (const auto& unit : units) {
+            decoder->decode(stream.data() + unit.first, unit.second, ptsUs);
+            ptsUs += 40000;
+        }
+        // 每轮结束排空帧线程中的延迟帧，下一轮从 IDR 重新开始
+        decoder->flush();
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double cpu = processCpuSeconds() - cpuStart;
+
+    VideoDecoderStats stats = decoder->stats();
+    result.ok = true;
+    result.backend = decoder->name();
+    result.threads = stats.threads;
+    result.accessUnits = (uint64_t)units.size() * loops;
+    result.frames = stats.frames;
+    result.errors = stats.errors;
+    result.wallSeconds = wall;
+    result.cpuSeconds = cpu;
+    result.fps = wall > 0 ? stats.frames / wall : 0;
+    result.fpsPerCore = cpu > 0 ? stats.frames / cpu : 0;
+    LOGI("%s: %llu 帧 %dx%d, 墙钟 %.2fs %.1f fps, CPU %.2fs %.1f fps/核",
+         result.backend.c_str(), (unsigned long long)result.frames, result.width, result.height,
+         wall, result.fps, cpu, result.fpsPerCore);
+    return result;
+}
@@ -0,0 +1,32 @@
+#ifndef DECODE_BENCHMARK_H
+#define DECODE_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+
+struct DecodeBenchmarkOptions {
+    std::string backend;    // 为空时使用默认后端
+    int threads = 0;        // 0 表示按 CPU 核数
+    int loops = 1;          // 整段码流重复解码的次数
+    bool lowDelay = false;  // 默认用帧线程追求吞吐
+};
+
+struct DecodeBenchmarkResult {
+    bool ok = false;
+    std::string backend;
+    int threads = 0;
+    uint64_t accessUnits = 0;
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+    int width = 0;
+    int height = 0;
+    double wallSeconds = 0;
+    double cpuSeconds = 0;
+    double fps = 0;            // 按墙钟时间
+    double fpsPerCore = 0;     // 按进程 CPU 时间，即单核吞吐
+};
+
+// 无界面解码基准：把 Annex-B 码流文件切分成访问单元，尽可能快地解码，输出丢弃
+DecodeBenchmarkResult runDecodeBenchmark(const std::string& path, const DecodeBenchmarkOptions& options);
+
+#endif // DECODE_BENCHMARK_H
@@ -0,0 +1,294 @@
+#include "fmp4_muxer.h"
+#include "h264_bitstream.h"
+#include "h264_nal.h"
+
+// ISO BMFF box 写入辅助，box 长度在 end 时回填
+class BoxWriter {
+public:
+    explicit BoxWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    size_t begin(const char* type) {
+        size_t offset = m_out.size();
+        u32(0);
+        bytes(type, 4);
+        return offset;
+    }
+
+    size_t beginFull(const char* type, uint8_t version, uint32_t flags) {
+        size_t offset = begin(type);
+        u32(((uint32_t)version << 24) | (flags & 0x00FFFFFF));
+        return offset;
+    }
+
+    void end(size_t offset) {
+        patch32(offset, (uint32_t)(m_out.size() - offset));
+    }
+
+    void u8(uint8_t v) { m_out.push_back(v); }
+    void u16(uint16_t v) { u8((uint8_t)(v >> 8)); u8((uint8_t)v); }
+    void u32(uint32_t v) { u16((uint16_t)(v >> 16)); u16((uint16_t)v); }
+    void u64(uint64_t v) { u32((uint32_t)(v >> 32)); u32((uint32_t)v); }
+    void zeros(size_t n) { m_out.insert(m_out.end(), n, 0); }
+    void bytes(const void* data, size_t n) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        m_out.insert(m_out.end(), p, p + n);
+    }
+    void patch32(size_t offset, uint32_t v) {
+        m_out[offset] = (uint8_t)(v >> 24);
+        m_out[offset + 1] = (uint8_t)(v >> 16);
+        m_out[offset + 2] = (uint8_t)(v >> 8);
+        m_out[offset + 3] = (uint8_t)v;
+    }
+    size_t size() const { return m_out.size(); }
+
+private:
+    std::vector<uint8_t>& m_out;
+};
+
+static void writeMatrix(BoxWriter& w) {
+    static const uint32_t kUnityMatrix[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+    for (uint32_t v : kUnityMatrix) {
+        w.u32(v);
+    }
+}
+
+static int64_t toTimescale(int64_t us) {
+    return us * Fmp4Muxer::kTimescale / 1000000;
+}
+
+bool Fmp4Muxer::buildInitSegment(const std::vector<uint8_t>& sps, const std::vector<uint8_t>& pps, std::vector<uint8_t>& out) {
+    out.clear();
+    H264Sps info;
+    if (sps.size() < 4 || pps.empty() || !h264ParseSps(sps.data(), (int)sps.size(), info)) {
+        return false;
+    }
+
+    BoxWriter w(out);
+    size_t ftyp = w.begin("ftyp");
+    w.bytes("iso5", 4);
+    w.u32(512);
+    w.bytes("iso5", 4);
+    w.bytes("iso6", 4);
+    w.bytes("avc1", 4);
+    w.bytes("mp41", 4);
+    w.end(ftyp);
+
+    size_t moov = w.begin("moov");
+
+    size_t mvhd = w.beginFull("mvhd", 0, 0);
+    w.u32(0);            // creation_time
+    w.u32(0);            // modification_time
+    w.u32(1000);         // timescale
+    w.u32(0);            // duration，由分片决定
+    w.u32(0x00010000);   // rate
+    w.u16(0x0100);       // volume
+    w.zeros(10);
+    writeMatrix(w);
+    w.zeros(24);         // pre_defined
+    w.u32(2);            // next_track_ID
+    w.end(mvhd);
+
+    size_t trak = w.begin("trak");
+    size_t tkhd = w.beginFull("tkhd", 0, 0x000003);
+    w.u32(0);
+    w.u32(0);
+    w.u32(1);            // track_ID
+    w.u32(0);
+    w.u32(0);            // duration
+    w.zeros(8);
+    w.u16(0);            // layer
+    w.u16(0);            // alternate_group
+    w.u16(0);            // volume
+    w.u16(0);
+    writeMatrix(w);
+    w.u32((uint32_t)info.width << 16);
+    w.u32((uint32_t)info.height << 16);
+    w.end(tkhd);
+
+    size_t mdia = w.begin("mdia");
+    size_t mdhd = w.beginFull("mdhd", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    w.u32(kTimescale);
+    w.u32(0);
+    w.u16(0x55C4);       // language "und"
+    w.u16(0);
+    w.end(mdhd);
+
+    size_t hdlr = w.beginFull("hdlr", 0, 0);
+    w.u32(0);
+    w.bytes("vide", 4);
+    w.zeros(12);
+    w.bytes("VideoHandler", 13);
+    w.end(hdlr);
+
+    size_t minf = w.begin("minf");
+    size_t vmhd = w.beginFull("vmhd", 0, 1);
+    w.zeros(8);
+    w.end(vmhd);
+
+    size_t dinf = w.begin("dinf");
+    size_t dref = w.beginFull("dref", 0, 0);
+    w.u32(1);
+    size_t url = w.beginFull("url ", 0, 1);
+    w.end(url);
+    w.end(dref);
+    w.end(dinf);
+
+    size_t stbl = w.begin("stbl");
+    size_t stsd = w.beginFull("stsd", 0, 0);
+    w.u32(1);
+    size_t avc1 = w.begin("avc1");
+    w.zeros(6);
+    w.u16(1);            // data_reference_index
+    w.zeros(16);
+    w.u16((uint16_t)info.width);
+    w.u16((uint16_t)info.height);
+    w.u32(0x00480000);   // 72 dpi
+    w.u32(0x00480000);
+    w.u32(0);
+    w.u16(1);            // frame_count
+    w.zeros(32);         // compressorname
+    w.u16(0x0018);       // depth
+    w.u16(0xFFFF);
+
+    size_t avcC = w.begin("avcC");
+    w.u8(1);
+    w.u8(sps[1]);        // profile
+    w.u8(sps[2]);        // profile compatibility
+    w.u8(sps[3]);        // level
+    w.u8(0xFF);          // 4 字节长度前缀
+    w.u8(0xE1);          // 1 个 SPS
+    w.u16((uint16_t)sps.size());
+    w.bytes(sps.data(), sps.size());
+    w.u8(1);             // 1 个 PPS
+    w.u16((uint16_t)pps.size());
+    w.bytes(pps.data(), pps.size());
+    if (info.profileIdc == 100 || info.profileIdc == 110 || info.profileIdc == 122 || info.profileIdc == 144) {
+        w.u8((uint8_t)(0xFC | (info.chromaFormatIdc & 0x03)));
+        w.u8(0xF8);      // bit_depth_luma_minus8 = 0
+        w.u8(0xF8);      // bit_depth_chroma_minus8 = 0
+        w.u8(0);
+    }
+    w.end(avcC);
+    w.end(avc1);
+    w.end(stsd);
+
+    // 分片文件中样本表为空
+    size_t stts = w.beginFull("stts", 0, 0);
+    w.u32(0);
+    w.end(stts);
+    size_t stsc = w.beginFull("stsc", 0, 0);
+    w.u32(0);
+    w.end(stsc);
+    size_t stsz = w.beginFull("stsz", 0, 0);
+    w.u32(0);
+    w.u32(0);
+    w.end(stsz);
+    size_t stco = w.beginFull("stco", 0, 0);
+    w.u32(0);
+    w.end(stco);
+    w.end(stbl);
+    w.end(minf);
+    w.end(mdia);
+    w.end(trak);
+
+    size_t mvex = w.begin("mvex");
+    size_t trex = w.beginFull("trex", 0, 0);
+    w.u32(1);            // track_ID
+    w.u32(1);            // default_sample_description_index
+    w.u32(0);
+    w.u32(0);
+    w.u32(0);
+    w.end(trex);
+    w.end(mvex);
+
+    w.end(moov);
+    return true;
+}
+
+void Fmp4Muxer::buildFragment(const std::vector<Fmp4Sample>& samples, int64_t lastDurationUs, std::vector<uint8_t>& out,
+                              Fmp4FragmentLayout* layout) {
+    out.clear();
+    if (samples.empty()) {
+        return;
+    }
+    if (!m_hasBaseTime) {
+        m_firstPtsUs = samples.front().ptsUs;
+        m_hasBaseTime = true;
+    }
+
+    // 先把 Annex-B 转成 4 字节长度前缀，参数集和 AUD 已在 avcC 中或无需保留
+    std::vector<uint32_t> sizes;
+    sizes.reserve(samples.size());
+    m_sampleScratch.clear();
+    std::vector<H264NalUnit> nals;
+    for (const Fmp4Sample& sample : samples) {
+        size_t before = m_sampleScratch.size();
+        h264SplitNalUnits(sample.data.data(), (int)sample.data.size(), nals);
+        for (const H264NalUnit& nal : nals) {
+            if (nal.type == H264_NAL_SPS || nal.type == H264_NAL_PPS || nal.type == H264_NAL_AUD) {
+                continue;
+            }
+            uint32_t len = (uint32_t)nal.size;
+            uint8_t prefix[4] = {(uint8_t)(len >> 24), (uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len};
+            m_sampleScratch.insert(m_sampleScratch.end(), prefix, prefix + 4);
+            m_sampleScratch.insert(m_sampleScratch.end(), nal.data, nal.data + nal.size);
+        }
+        sizes.push_back((uint32_t)(m_sampleScratch.size() - before));
+    }
+
+    out.reserve(m_sampleScratch.size() + samples.size() * 12 + 128);
+    BoxWriter w(out);
+    size_t moof = w.begin("moof");
+    size_t mfhd = w.beginFull("mfhd", 0, 0);
+    w.u32(++m_sequence);
+    w.end(mfhd);
+
+    size_t traf = w.begin("traf");
+    size_t tfhd = w.beginFull("tfhd", 0, 0x020000);  // default-base-is-moof
+    w.u32(1);
+    w.end(tfhd);
+
+    size_t tfdt = w.beginFull("tfdt", 1, 0);
+    w.u64((uint64_t)toTimescale(samples.front().ptsUs - m_firstPtsUs));
+    w.end(tfdt);
+
+    // data-offset | sample-duration | sample-size | sample-flags
+    size_t trun = w.beginFull("trun", 0, 0x000701);
+    w.u32((uint32_t)samples.size());
+    size_t dataOffsetPos = w.size();
+    w.u32(0);
+    for (size_t i = 0; i < samples.size(); i++) {
+        int64_t start = toTimescale(samples[i].ptsUs - m_firstPtsUs);
+        int64_t next = i + 1 < samples.size()
+                ? toTimescale(samples[i + 1].ptsUs - m_firstPtsUs)
+                : toTimescale(samples[i].ptsUs + lastDurationUs - m_firstPtsUs);
+        int64_t duration = next - start;
+        w.u32(duration > 0 ? (uint32_t)duration : 1);
+        w.u32(sizes[i]);
+        w.u32(samples[i].sync ? 0x02000000 : 0x01010000);
+    }
+    w.end(trun);
+    w.end(traf);
+    w.end(moof);
+
+    // data_offset 相对 moof 起点，指向 mdat 载荷
+    const uint32_t payloadOffset = (uint32_t)(w.size() - moof + 8);
+    w.patch32(dataOffsetPos, payloadOffset);
+    size_t mdat = w.begin("mdat");
+    w.bytes(m_sampleScratch.data(), m_sampleScratch.size());
+    w.end(mdat);
+
+    if (layout) {
+        layout->payloadOffset = payloadOffset;
+        layout->sampleSizes.swap(sizes);
+    }
+}
+
+void Fmp4Muxer::reset() {
+    m_sequence = 0;
+    m_hasBaseTime = false;
+    m_firstPtsUs = 0;
+    m_sampleScratch.clear();
+}
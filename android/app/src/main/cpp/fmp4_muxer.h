@@ -0,0 +1,42 @@
+#ifndef FMP4_MUXER_H
+#define FMP4_MUXER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// 一个待封装的 H.264 访问单元（Annex-B 原始数据，不重新编码）
+struct Fmp4Sample {
+    std::vector<uint8_t> data;
+    int64_t ptsUs = 0;
+    bool sync = false;
+};
+
+// 分片内样本的位置，偏移相对分片（moof）起点
+struct Fmp4FragmentLayout {
+    uint32_t payloadOffset = 0;          // mdat 载荷即第一个样本的偏移
+    std::vector<uint32_t> sampleSizes;   // 转成长度前缀、去掉参数集之后的样本大小
+};
+
+// 分片 MP4 封装：生成 ftyp+moov 初始化段和 moof+mdat 分片，只输出内存缓冲，不做文件 IO
+class Fmp4Muxer {
+public:
+    static const uint32_t kTimescale = 90000;
+
+    // 根据 SPS/PPS（不含起始码）生成初始化段，avcC 由参数集构造；SPS 无法解析时返回 false
+    bool buildInitSegment(const std::vector<uint8_t>& sps, const std::vector<uint8_t>& pps, std::vector<uint8_t>& out);
+
+    // 把一组样本封装成一个分片，lastDurationUs 为最后一个样本的时长；layout 非空时返回样本位置
+    void buildFragment(const std::vector<Fmp4Sample>& samples, int64_t lastDurationUs, std::vector<uint8_t>& out,
+                       Fmp4FragmentLayout* layout = nullptr);
+
+    void reset();
+
+private:
+    uint32_t m_sequence = 0;
+    bool m_hasBaseTime = false;
+    int64_t m_firstPtsUs = 0;
+    std::vector<uint8_t> m_sampleScratch;
+};
+
+#endif // FMP4_MUXER_H
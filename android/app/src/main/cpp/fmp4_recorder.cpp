@@ -0,0 +1,386 @@
+#include "fmp4_recorder.h"
+#include "h264_nal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "Fmp4Recorder"
+#include "native_log.h"
+
+const size_t Fmp4Recorder::kDefaultPreallocateBytes;
+const size_t Fmp4Recorder::kMaxFragmentBytes;
+const size_t Fmp4Recorder::kMaxPendingFragments;
+
+static const int64_t kDefaultFrameDurationUs = 40000;
+
+static int64_t monotonicUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Fmp4Recorder::Fmp4Recorder()
+    : m_recording(false),
+      m_segmentIndex(0),
+      m_fd(-1),
+      m_preallocateBytes(kDefaultPreallocateBytes),
+      m_fileOffset(0),
+      m_allocatedEnd(0),
+      m_currentBytes(0),
+      m_fragmentLimit(kMaxFragmentBytes),
+      m_lastFrameDurationUs(kDefaultFrameDurationUs),
+      m_queuedBytes(0),
+      m_pendingMaxQueuedBytes(0),
+      m_maxQueuedBytes(0),
+      m_stopWriter(false),
+      m_initWritten(false) {
+}
+
+Fmp4Recorder::~Fmp4Recorder() {
+    stop();
+}
+
+bool Fmp4Recorder::start(const std::string& path, size_t preallocateBytes) {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (m_recording.load()) {
+        LOGW("start: already recording to %s", m_path.c_str());
+        return false;
+    }
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGE("start: open %s failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    m_path = path;
+    m_segmentPath = path;
+    m_segmentIndex = 0;
+    m_fd = fd;
+    m_preallocateBytes = preallocateBytes;
+    m_fileOffset = 0;
+    m_allocatedEnd = 0;
+    m_muxer.reset();
+    m_initWritten = false;
+    m_initSps.clear();
+    m_initPps.clear();
+    m_keyframeCallback = m_pendingKeyframeCallback;
+    m_segmentCallback = m_pendingSegmentCallback;
+    m_maxQueuedBytes = m_pendingMaxQueuedBytes;
+    m_fragmentLimit = m_maxQueuedBytes > 0 ? std::max<size_t>(1, std::min(m_maxQueuedBytes / 2, kMaxFragmentBytes))
+                                           : kMaxFragmentBytes;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.clear();
+        m_queuedBytes = 0;
+        m_stopWriter = false;
+        m_stats = Fmp4RecorderStats();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pushMutex);
+        m_current = Fragment();
+        m_currentBytes = 0;
+        m_lastFrameDurationUs = kDefaultFrameDurationUs;
+    }
+    m_writer = std::thread(&Fmp4Recorder::writerLoop, this);
+    m_recording.store(true);
+    LOGI("start: path=%s, preallocate=%zu", path.c_str(), preallocateBytes);
+    return true;
+}
+
+void Fmp4Recorder::stop() {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (!m_recording.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pushMutex);
+        if (!m_current.samples.empty()) {
+            enqueueFragmentLocked(m_current.samples.back().ptsUs + m_lastFrameDurationUs);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopWriter = true;
+    }
+    m_queueCond.notify_all();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+
+    closeFile();
+    Fmp4RecorderStats s = stats();
+    LOGI("stop: path=%s, segments=%llu, bytes=%llu, fragments=%llu, frames=%llu, dropped=%llu",
+         m_path.c_str(), (unsigned long long)s.segments, (unsigned long long)s.bytesWritten,
+         (unsigned long long)s.fragmentsWritten, (unsigned long long)s.framesWritten,
+         (unsigned long long)s.droppedFragments);
+}
+
+void Fmp4Recorder::closeFile() {
+    // 释放预分配但未使用的空间
+    if (m_fd >= 0) {
+        if (ftruncate(m_fd, (off_t)m_fileOffset) != 0) {
+            LOGW("closeFile: ftruncate failed: %s", strerror(errno));
+        }
+        fsync(m_fd);
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+std::string Fmp4Recorder::segmentPath(const std::string& path, uint32_t index) {
+    if (index == 0) {
+        return path;
+    }
+    const size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = path.size();
+    }
+    return path.substr(0, dot) + "_" + std::to_string(index) + path.substr(dot);
+}
+
+// 写线程调用：结束当前文件，之后的分片写到下一个文件，从新的初始化段开始
+bool Fmp4Recorder::rollSegment() {
+    closeFile();
+    m_segmentIndex++;
+    m_segmentPath = segmentPath(m_path, m_segmentIndex);
+    m_fileOffset = 0;
+    m_allocatedEnd = 0;
+    m_muxer.reset();
+    m_initWritten = false;
+    m_fd = open(m_segmentPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        LOGE("rollSegment: open %s failed: %s", m_segmentPath.c_str(), strerror(errno));
+        return false;
+    }
+    LOGI("rollSegment: parameter sets changed, continuing in %s", m_segmentPath.c_str());
+    return true;
+}
+
+void Fmp4Recorder::setKeyframeCallback(const KeyframeCallback& callback) {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    m_pendingKeyframeCallback = callback;
+}
+
+void Fmp4Recorder::setSegmentCallback(const SegmentCallback& callback) {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    m_pendingSegmentCallback = callback;
+}
+
+void Fmp4Recorder::setMaxQueuedBytes(size_t maxQueuedBytes) {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    m_pendingMaxQueuedBytes = maxQueuedBytes;
+}
+
+void Fmp4Recorder::setParameterSets(const std::vector<uint8_t>& sps, const std::vector<uint8_t>& pps) {
+    std::lock_guard<std::mutex> lock(m_pushMutex);
+    if (!sps.empty()) m_sps = sps;
+    if (!pps.empty()) m_pps = pps;
+}
+
+void Fmp4Recorder::push(const uint8_t* data, int length, int64_t ptsUs) {
+    if (!m_recording.load() || !data || length <= 0) {
+        return;
+    }
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+    bool hasIdr = false;
+    bool hasSlice = false;
+
+    std::lock_guard<std::mutex> lock(m_pushMutex);
+    for (const H264NalUnit& nal : nals) {
+        if (nal.type == H264_NAL_SPS) {
+            m_sps.assign(nal.data, nal.data + nal.size);
+        } else if (nal.type == H264_NAL_PPS) {
+            m_pps.assign(nal.data, nal.data + nal.size);
+        } else if (nal.type == H264_NAL_IDR) {
+            hasIdr = true;
+            hasSlice = true;
+        } else if (nal.type == H264_NAL_SLICE) {
+            hasSlice = true;
+        }
+    }
+    if (!hasSlice) {
+        return;
+    }
+    if (m_current.samples.empty() && !hasIdr) {
+        // 第一个分片必须从 IDR 开始
+        return;
+    }
+
+    // 每个 GOP 一个分片，GOP 过大时提前切分
+    if (!m_current.samples.empty() && (hasIdr || m_currentBytes + (size_t)length > m_fragmentLimit)) {
+        enqueueFragmentLocked(ptsUs);
+    }
+
+    if (!m_current.samples.empty()) {
+        int64_t duration = ptsUs - m_current.samples.back().ptsUs;
+        if (duration > 0) {
+            m_lastFrameDurationUs = duration;
+        }
+    }
+    if (m_current.samples.empty()) {
+        // 参数集随分片开头的 IDR 一起到达，分片按开始时的参数集封装
+        m_current.sps = m_sps;
+        m_current.pps = m_pps;
+    }
+    Fmp4Sample sample;
+    sample.data.assign(data, data + length);
+    sample.ptsUs = ptsUs;
+    sample.sync = hasIdr;
+    m_current.samples.push_back(std::move(sample));
+    m_currentBytes += (size_t)length;
+}
+
+void Fmp4Recorder::enqueueFragmentLocked(int64_t nextPtsUs) {
+    int64_t lastDuration = nextPtsUs - m_current.samples.back().ptsUs;
+    m_current.lastDurationUs = lastDuration > 0 ? lastDuration : m_lastFrameDurationUs;
+    m_current.bytes = m_currentBytes;
+    {
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        if (m_maxQueuedBytes > 0) {
+            // 背压：等写线程取走之前的分片，内存有界且不丢数据
+            m_spaceCond.wait(lock, [this]() {
+                return m_queuedBytes == 0 || m_queuedBytes + m_current.bytes <= m_maxQueuedBytes;
+            });
+        } else if (m_queue.size() >= kMaxPendingFragments) {
+            // 写盘跟不上时丢弃最旧的分片，保证内存有界且不阻塞接收线程
+            m_queuedBytes -= m_queue.front().bytes;
+            m_queue.pop_front();
+            m_stats.droppedFragments++;
+        }
+        m_queuedBytes += m_current.bytes;
+        m_queue.push_back(std::move(m_current));
+    }
+    m_queueCond.notify_one();
+    m_current = Fragment();
+    m_currentBytes = 0;
+}
+
+bool Fmp4Recorder::writeBuffer(const std::vector<uint8_t>& buffer) {
+    if (m_fileOffset + buffer.size() > m_allocatedEnd && m_preallocateBytes > 0) {
+        uint64_t chunk = buffer.size() > m_preallocateBytes ? buffer.size() : m_preallocateBytes;
+#ifdef FALLOC_FL_KEEP_SIZE
+        // 预分配不改变文件长度，崩溃后文件末尾不会出现空洞数据
+        if (fallocate(m_fd, FALLOC_FL_KEEP_SIZE, (off_t)m_allocatedEnd, (off_t)chunk) != 0) {
+            LOGW("writeBuffer: fallocate failed: %s", strerror(errno));
+        }
+#endif
+        m_allocatedEnd += chunk;
+    }
+
+    const uint8_t* p = buffer.data();
+    size_t remaining = buffer.size();
+    uint64_t offset = m_fileOffset;
+    while (remaining > 0) {
+        ssize_t n = pwrite(m_fd, p, remaining, (off_t)offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOGE("writeBuffer: pwrite failed: %s", strerror(errno));
+            return false;
+        }
+        p += n;
+        offset += (uint64_t)n;
+        remaining -= (size_t)n;
+    }
+    m_fileOffset = offset;
+    return true;
+}
+
+void Fmp4Recorder::writerLoop() {
+    std::vector<uint8_t> buffer;
+    for (;;) {
+        Fragment fragment;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCond.wait(lock, [this]() { return m_stopWriter || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                break;
+            }
+            fragment = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_queuedBytes -= fragment.bytes;
+        }
+        m_spaceCond.notify_all();
+
+        int64_t muxStart = monotonicUs();
+        bool ok = true;
+        size_t bytes = 0;
+        bool newSegment = false;
+        // 参数集变化只可能从 IDR 开始生效：当前文件的 avcC 已不适用，切到新文件
+        if (m_initWritten && fragment.samples.front().sync && !fragment.sps.empty() &&
+            (fragment.sps != m_initSps || fragment.pps != m_initPps)) {
+            rollSegment();
+        }
+        if (m_fd < 0) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_stats.droppedFragments++;
+            continue;
+        }
+        if (!m_initWritten) {
+            if (!m_muxer.buildInitSegment(fragment.sps, fragment.pps, buffer)) {
+                LOGW("writerLoop: no valid SPS/PPS yet, dropping fragment");
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                m_stats.droppedFragments++;
+                continue;
+            }
+            ok = writeBuffer(buffer);
+            bytes += buffer.size();
+            m_initWritten = ok;
+            if (ok) {
+                m_initSps = fragment.sps;
+                m_initPps = fragment.pps;
+                newSegment = true;
+                if (m_segmentCallback) {
+                    m_segmentCallback(m_segmentPath);
+                }
+            }
+        }
+        int64_t writeTime = monotonicUs() - muxStart;
+        int64_t fragmentStart = monotonicUs();
+        m_muxer.buildFragment(fragment.samples, fragment.lastDurationUs, buffer, &m_layout);
+        int64_t muxTime = monotonicUs() - fragmentStart;
+
+        int64_t writeStart = monotonicUs();
+        const uint64_t fragmentOffset = m_fileOffset;
+        ok = ok && writeBuffer(buffer);
+        // 每个分片落盘一次，崩溃时最多丢失尚未写出的分片
+        if (ok) {
+            fdatasync(m_fd);
+        }
+        writeTime += monotonicUs() - writeStart;
+        bytes += buffer.size();
+
+        // 分片落盘之后才报告关键帧位置，索引不会指向未写出的数据
+        if (ok && m_keyframeCallback && fragment.samples.front().sync && !m_layout.sampleSizes.empty()) {
+            Fmp4KeyframeInfo info;
+            info.ptsUs = fragment.samples.front().ptsUs;
+            info.fragmentOffset = fragmentOffset;
+            info.sampleOffset = fragmentOffset + m_layout.payloadOffset;
+            info.sampleSize = m_layout.sampleSizes.front();
+            m_keyframeCallback(info);
+        }
+
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stats.muxTimeUs += (uint64_t)muxTime;
+        m_stats.writeTimeUs += (uint64_t)writeTime;
+        if (newSegment) {
+            m_stats.segments++;
+        }
+        if (ok) {
+            m_stats.bytesWritten += bytes;
+            m_stats.fragmentsWritten++;
+            m_stats.framesWritten += fragment.samples.size();
+        } else {
+            m_stats.droppedFragments++;
+        }
+    }
+}
+
+Fmp4RecorderStats Fmp4Recorder::stats() const {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_stats;
+}
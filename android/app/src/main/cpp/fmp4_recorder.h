@@ -0,0 +1,131 @@
+#ifndef FMP4_RECORDER_H
+#define FMP4_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmp4_muxer.h"
+
+struct Fmp4RecorderStats {
+    uint64_t bytesWritten = 0;
+    uint64_t fragmentsWritten = 0;
+    uint64_t framesWritten = 0;
+    uint64_t droppedFragments = 0;
+    uint64_t segments = 0;     // 写出的录像文件数，参数集变化时切换到新文件
+    uint64_t muxTimeUs = 0;    // 写线程封装耗时
+    uint64_t writeTimeUs = 0;  // 写线程 write + fdatasync 耗时
+};
+
+// 以 IDR 开头的分片落盘后回调，偏移都是录像文件中的绝对位置
+struct Fmp4KeyframeInfo {
+    int64_t ptsUs = 0;
+    uint64_t fragmentOffset = 0;   // 分片 moof 的偏移
+    uint64_t sampleOffset = 0;     // IDR 样本在 mdat 中的偏移
+    uint32_t sampleSize = 0;
+};
+
+// 本地录像：接收线程只拷贝访问单元，每个 GOP 在写线程封装成一个 fMP4 分片，
+// 一次大块顺序写入预分配的文件并落盘，进程崩溃最多丢失正在累积的一个分片。
+// 初始化段（avcC）每个文件只有一份：SPS/PPS 变化（如切换分辨率）时结束当前文件，
+// 从新参数集的 IDR 开始写到 segmentPath(path, 1)、segmentPath(path, 2)……
+class Fmp4Recorder {
+public:
+    typedef std::function<void(const Fmp4KeyframeInfo&)> KeyframeCallback;
+    typedef std::function<void(const std::string& path)> SegmentCallback;
+
+    static const size_t kDefaultPreallocateBytes = 32 * 1024 * 1024;
+    static const size_t kMaxFragmentBytes = 8 * 1024 * 1024;
+    static const size_t kMaxPendingFragments = 8;
+
+    Fmp4Recorder();
+    ~Fmp4Recorder();
+
+    bool start(const std::string& path, size_t preallocateBytes = kDefaultPreallocateBytes);
+    // 在写线程上回调，在下一次 start 时生效
+    void setKeyframeCallback(const KeyframeCallback& callback);
+    // 每个录像文件写入初始化段后在写线程上回调，之后的关键帧回调都属于这个文件；在下一次 start 时生效
+    void setSegmentCallback(const SegmentCallback& callback);
+    // 写盘跟不上时的策略：默认队列满 kMaxPendingFragments 时丢弃最旧的分片，push 从不阻塞；
+    // maxQueuedBytes 非零时改为背压，未写盘的分片超过这个字节数时 push 等待写线程，不丢数据，
+    // 分片也按它的一半提前切分。只用于可以阻塞的调用线程（如报警录像的事件线程）；在下一次 start 时生效
+    void setMaxQueuedBytes(size_t maxQueuedBytes);
+    void stop();
+    bool isRecording() const { return m_recording.load(); }
+
+    // 录像开始前已知的参数集（不含起始码），设备只在流开头发送 SPS/PPS 时需要
+    void setParameterSets(const std::vector<uint8_t>& sps, const std::vector<uint8_t>& pps);
+
+    // 接收线程调用：送入一个 Annex-B 访问单元
+    void push(const uint8_t* data, int length, int64_t ptsUs);
+
+    Fmp4RecorderStats stats() const;
+
+    // 参数集变化后续写的第 index 个文件：rec.mp4 -> rec_1.mp4，index 为 0 时即 path
+    static std::string segmentPath(const std::string& path, uint32_t index);
+
+private:
+    struct Fragment {
+        std::vector<Fmp4Sample> samples;
+        int64_t lastDurationUs = 0;
+        std::vector<uint8_t> sps;
+        std::vector<uint8_t> pps;
+        size_t bytes = 0;
+    };
+
+    void enqueueFragmentLocked(int64_t nextPtsUs);
+    void writerLoop();
+    bool writeBuffer(const std::vector<uint8_t>& buffer);
+    bool rollSegment();
+    void closeFile();
+
+    std::mutex m_controlMutex;  // 串行化 start/stop
+    std::atomic<bool> m_recording;
+    std::string m_path;
+    std::string m_segmentPath;   // 正在写的文件
+    uint32_t m_segmentIndex;
+    int m_fd;
+    size_t m_preallocateBytes;
+    uint64_t m_fileOffset;
+    uint64_t m_allocatedEnd;
+
+    // 接收线程状态
+    std::mutex m_pushMutex;
+    Fragment m_current;
+    size_t m_currentBytes;
+    size_t m_fragmentLimit;
+    int64_t m_lastFrameDurationUs;
+    std::vector<uint8_t> m_sps;
+    std::vector<uint8_t> m_pps;
+
+    // 写线程队列
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queueCond;
+    std::condition_variable m_spaceCond;
+    std::deque<Fragment> m_queue;
+    size_t m_queuedBytes;
+    size_t m_pendingMaxQueuedBytes;
+    size_t m_maxQueuedBytes;
+    bool m_stopWriter;
+    std::thread m_writer;
+
+    Fmp4Muxer m_muxer;
+    Fmp4FragmentLayout m_layout;
+    bool m_initWritten;
+    std::vector<uint8_t> m_initSps;   // 当前文件初始化段使用的参数集
+    std::vector<uint8_t> m_initPps;
+    KeyframeCallback m_pendingKeyframeCallback;
+    KeyframeCallback m_keyframeCallback;  // 录像期间只由写线程读取
+    SegmentCallback m_pendingSegmentCallback;
+    SegmentCallback m_segmentCallback;
+    Fmp4RecorderStats m_stats;
+};
+
+#endif // FMP4_RECORDER_H
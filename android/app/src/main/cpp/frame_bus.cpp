@@ -0,0 +1,240 @@
+#include "frame_bus.h"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+#define LOG_TAG "FrameBus"
+#include "native_log.h"
+
+std::shared_ptr<const std::vector<uint8_t>> busFramePayload(const BusFrameRef& frame) {
+    if (!frame) {
+        return nullptr;
+    }
+    // 别名构造：指向 frame->data，但与 frame 共享引用计数
+    return std::shared_ptr<const std::vector<uint8_t>>(frame, &frame->data);
+}
+
+struct FrameBus::Subscriber {
+    int id = 0;
+    std::string name;
+    BusSubscriberOptions options;
+    Handler handler;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<BusFrameRef> queue;
+    size_t queuedBytes = 0;
+    bool waitingKeyframe = false;
+    bool stop = false;
+    std::thread thread;
+
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t maxQueuedFrames = 0;
+
+    bool fitsLocked(const BusFrame& frame) const {
+        return queue.size() < options.maxFrames && queuedBytes + frame.data.size() <= options.maxBytes;
+    }
+
+    void clearLocked() {
+        dropped += queue.size();
+        queue.clear();
+        queuedBytes = 0;
+    }
+
+    // 按丢帧策略入队，返回是否需要唤醒投递线程
+    bool enqueueLocked(const BusFrameRef& frame) {
+        if (waitingKeyframe) {
+            if (!frame->keyframe) {
+                dropped++;
+                return false;
+            }
+            waitingKeyframe = false;
+        }
+        if (!fitsLocked(*frame)) {
+            switch (options.dropPolicy) {
+            case BUS_DROP_NEWEST:
+                dropped++;
+                return false;
+            case BUS_DROP_UNTIL_KEYFRAME:
+                clearLocked();
+                if (!frame->keyframe) {
+                    waitingKeyframe = true;
+                    dropped++;
+                    return false;
+                }
+                break;
+            case BUS_DROP_OLDEST:
+            default:
+                while (!queue.empty() && !fitsLocked(*frame)) {
+                    queuedBytes -= queue.front()->data.size();
+                    queue.pop_front();
+                    dropped++;
+                }
+                break;
+            }
+        }
+        queue.push_back(frame);
+        queuedBytes += frame->data.size();
+        if (queue.size() > maxQueuedFrames) {
+            maxQueuedFrames = queue.size();
+        }
+        return true;
+    }
+};
+
+FrameBus::FrameBus()
+    : m_subscribers(std::make_shared<const SubscriberList>()),
+      m_nextId(1),
+      m_nextSeq(0) {}
+
+FrameBus::~FrameBus() {
+    std::shared_ptr<const SubscriberList> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        subscribers = m_subscribers;
+        m_subscribers = std::make_shared<const SubscriberList>();
+    }
+    for (const auto& subscriber : *subscribers) {
+        stopSubscriber(*subscriber);
+    }
+}
+
+int FrameBus::subscribe(const std::string& name, const BusSubscriberOptions& options, const Handler& handler) {
+    if (!handler) {
+        return 0;
+    }
+    std::shared_ptr<Subscriber> subscriber = std::make_shared<Subscriber>();
+    subscriber->name = name;
+    subscriber->options = options;
+    if (subscriber->options.maxFrames == 0) {
+        subscriber->options.maxFrames = 1;
+    }
+    subscriber->handler = handler;
+    if (!options.inlineDelivery) {
+        subscriber->thread = std::thread(&FrameBus::deliverLoop, subscriber);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    subscriber->id = m_nextId++;
+    std::shared_ptr<SubscriberList> list = std::make_shared<SubscriberList>(*m_subscribers);
+    list->push_back(subscriber);
+    m_subscribers = list;
+    LOGI("subscribe: %s id=%d, maxFrames=%zu, maxBytes=%zu, policy=%d, %s", name.c_str(), subscriber->id,
+         subscriber->options.maxFrames, options.maxBytes, (int)options.dropPolicy,
+         options.inlineDelivery ? "inline" : "queued");
+    return subscriber->id;
+}
+
+void FrameBus::unsubscribe(int id) {
+    std::shared_ptr<Subscriber> removed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::shared_ptr<SubscriberList> list = std::make_shared<SubscriberList>();
+        for (const auto& subscriber : *m_subscribers) {
+            if (subscriber->id == id) {
+                removed = subscriber;
+            } else {
+                list->push_back(subscriber);
+            }
+        }
+        m_subscribers = list;
+    }
+    if (removed) {
+        stopSubscriber(*removed);
+    }
+}
+
+void FrameBus::stopSubscriber(Subscriber& subscriber) {
+    {
+        std::lock_guard<std::mutex> lock(subscriber.mutex);
+        subscriber.stop = true;
+        subscriber.clearLocked();
+    }
+    subscriber.cond.notify_all();
+    if (subscriber.thread.joinable()) {
+        subscriber.thread.join();
+    }
+}
+
+BusFrameRef FrameBus::publish(const std::string& devId, const uint8_t* data, int length, bool keyframe, int64_t arrivalUs,
+                              int64_t ptsUs) {
+    if (!data || length <= 0) {
+        return nullptr;
+    }
+    std::shared_ptr<BusFrame> frame = std::make_shared<BusFrame>();
+    frame->devId = devId;
+    frame->data.assign(data, data + length);
+    frame->keyframe = keyframe;
+    frame->arrivalUs = arrivalUs;
+    frame->ptsUs = ptsUs;
+
+    std::shared_ptr<const SubscriberList> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        frame->seq = m_nextSeq++;
+        subscribers = m_subscribers;
+    }
+    BusFrameRef ref = frame;
+
+    for (const auto& subscriber : *subscribers) {
+        if (subscriber->options.inlineDelivery) {
+            subscriber->handler(ref);
+            std::lock_guard<std::mutex> lock(subscriber->mutex);
+            subscriber->delivered++;
+            continue;
+        }
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(subscriber->mutex);
+            wake = !subscriber->stop && subscriber->enqueueLocked(ref);
+        }
+        if (wake) {
+            subscriber->cond.notify_one();
+        }
+    }
+    return ref;
+}
+
+void FrameBus::deliverLoop(std::shared_ptr<Subscriber> subscriber) {
+    for (;;) {
+        BusFrameRef frame;
+        {
+            std::unique_lock<std::mutex> lock(subscriber->mutex);
+            subscriber->cond.wait(lock, [&subscriber]() { return subscriber->stop || !subscriber->queue.empty(); });
+            if (subscriber->stop) {
+                break;
+            }
+            frame = std::move(subscriber->queue.front());
+            subscriber->queue.pop_front();
+            subscriber->queuedBytes -= frame->data.size();
+        }
+        subscriber->handler(frame);
+        std::lock_guard<std::mutex> lock(subscriber->mutex);
+        subscriber->delivered++;
+    }
+    LOGI("deliverLoop: %s stopped, delivered=%llu, dropped=%llu", subscriber->name.c_str(),
+         (unsigned long long)subscriber->delivered, (unsigned long long)subscriber->dropped);
+}
+
+std::vector<BusSubscriberStats> FrameBus::stats() const {
+    std::shared_ptr<const SubscriberList> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        subscribers = m_subscribers;
+    }
+    std::vector<BusSubscriberStats> result;
+    for (const auto& subscriber : *subscribers) {
+        std::lock_guard<std::mutex> lock(subscriber->mutex);
+        BusSubscriberStats stats;
+        stats.name = subscriber->name;
+        stats.delivered = subscriber->delivered;
+        stats.dropped = subscriber->dropped;
+        stats.queuedFrames = subscriber->queue.size();
+        stats.queuedBytes = subscriber->queuedBytes;
+        stats.maxQueuedFrames = subscriber->maxQueuedFrames;
+        result.push_back(stats);
+    }
+    return result;
+}
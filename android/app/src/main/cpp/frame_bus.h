@@ -0,0 +1,85 @@
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 总线上的一个访问单元，发布时只拷贝一次，所有订阅者共享同一份只读数据
+struct BusFrame {
+    std::string devId;
+    std::vector<uint8_t> data;
+    bool keyframe = false;
+    int64_t arrivalUs = 0;   // 接收回调入口的单调时钟
+    int64_t ptsUs = 0;       // StreamClock 生成的平滑 PTS，与 arrivalUs 同一时钟域
+    uint64_t seq = 0;
+};
+
+typedef std::shared_ptr<const BusFrame> BusFrameRef;
+
+// 与 BusFrameRef 共享引用计数的载荷视图，交给按 shared_ptr<vector> 保存帧的模块（如报警预录）
+std::shared_ptr<const std::vector<uint8_t>> busFramePayload(const BusFrameRef& frame);
+
+// 订阅者队列满时的处理方式
+enum BusDropPolicy {
+    BUS_DROP_OLDEST = 0,          // 丢弃队首的旧帧，适合只关心最新数据的消费者
+    BUS_DROP_NEWEST = 1,          // 丢弃新到的帧
+    BUS_DROP_UNTIL_KEYFRAME = 2,  // 清空队列并丢帧直到下一个关键帧，适合解码器和录像，避免参考帧缺失
+};
+
+struct BusSubscriberOptions {
+    size_t maxFrames = 60;
+    size_t maxBytes = 4 * 1024 * 1024;
+    BusDropPolicy dropPolicy = BUS_DROP_OLDEST;
+    // 在发布线程上直接回调，不经过队列；只用于不会阻塞的轻量消费者
+    bool inlineDelivery = false;
+};
+
+struct BusSubscriberStats {
+    std::string name;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t queuedFrames = 0;
+    uint64_t queuedBytes = 0;
+    uint64_t maxQueuedFrames = 0;  // 队列深度的历史最大值
+};
+
+// 单路接入、多路消费的帧总线：每个访问单元存一份，订阅者拿到引用。
+// 非 inline 订阅者各有独立的队列、上限、丢帧策略和投递线程，慢的录像不会拖住实时显示。
+class FrameBus {
+public:
+    typedef std::function<void(const BusFrameRef&)> Handler;
+
+    FrameBus();
+    ~FrameBus();
+
+    // 返回订阅 id；非 inline 订阅者会启动自己的投递线程
+    int subscribe(const std::string& name, const BusSubscriberOptions& options, const Handler& handler);
+    // 停止投递线程，丢弃未投递的帧
+    void unsubscribe(int id);
+
+    // 接收线程调用：拷贝一次数据并分发给所有订阅者，返回总线上的帧引用
+    BusFrameRef publish(const std::string& devId, const uint8_t* data, int length, bool keyframe, int64_t arrivalUs,
+                        int64_t ptsUs);
+
+    std::vector<BusSubscriberStats> stats() const;
+
+private:
+    struct Subscriber;
+    typedef std::vector<std::shared_ptr<Subscriber>> SubscriberList;
+
+    static void deliverLoop(std::shared_ptr<Subscriber> subscriber);
+    static void stopSubscriber(Subscriber& subscriber);
+
+    mutable std::mutex m_mutex;
+    // 写时复制：发布线程只在锁内取一份列表引用，投递在锁外进行
+    std::shared_ptr<const SubscriberList> m_subscribers;
+    int m_nextId;
+    uint64_t m_nextSeq;
+};
+
+#endif // FRAME_BUS_H
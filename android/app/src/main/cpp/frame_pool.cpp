@@ -0,0 +1,195 @@
+#include "frame_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#define LOG_TAG "FramePool"
+#include "native_log.h"
+
+const size_t FramePool::kAlignment;
+const int FramePool::kDefaultMaxFreePerClass;
+
+Yuv420Planes PooledFrame::planes() const {
+    Yuv420Planes planes;
+    planes.y = y;
+    planes.u = u;
+    planes.v = v;
+    planes.yRowStride = width;
+    planes.uvRowStride = chromaWidth;
+    planes.uvPixelStride = 1;
+    planes.width = width;
+    planes.height = height;
+    return planes;
+}
+
+static size_t alignUp(size_t value) {
+    return (value + FramePool::kAlignment - 1) & ~(FramePool::kAlignment - 1);
+}
+
+static uint64_t sizeClassKey(int width, int height) {
+    return ((uint64_t)(uint32_t)width << 32) | (uint32_t)height;
+}
+
+static void freeFrame(PooledFrame* frame) {
+    free(frame->y);
+    delete frame;
+}
+
+// 按行跨度/像素跨度读取一个平面，写成紧凑排列
+static void copyPlane(const uint8_t* src, int rowStride, int pixelStride, int width, int height, uint8_t* dst) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t* in = src + (long)row * rowStride;
+        if (pixelStride == 1) {
+            memcpy(dst, in, (size_t)width);
+        } else {
+            for (int x = 0; x < width; x++) {
+                dst[x] = in[(long)x * pixelStride];
+            }
+        }
+        dst += width;
+    }
+}
+
+struct FramePool::State {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<PooledFrame*>> freeLists;
+    int maxFreePerClass = kDefaultMaxFreePerClass;
+    Stats stats;
+
+    ~State() {
+        for (auto& entry : freeLists) {
+            for (PooledFrame* frame : entry.second) {
+                freeFrame(frame);
+            }
+        }
+    }
+
+    void updateHighWaterLocked() {
+        uint64_t bytes = stats.bytesInUse + stats.bytesFree;
+        uint64_t buffers = stats.buffersInUse + stats.buffersFree;
+        if (bytes > stats.highWaterBytes) {
+            stats.highWaterBytes = bytes;
+        }
+        if (buffers > stats.highWaterBuffers) {
+            stats.highWaterBuffers = buffers;
+        }
+    }
+
+    void recycle(PooledFrame* frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.buffersInUse--;
+        stats.bytesInUse -= frame->bytes;
+        std::vector<PooledFrame*>& list = freeLists[sizeClassKey(frame->width, frame->height)];
+        if ((int)list.size() >= maxFreePerClass) {
+            stats.releases++;
+            freeFrame(frame);
+            return;
+        }
+        frame->ptsUs = 0;
+        list.push_back(frame);
+        stats.buffersFree++;
+        stats.bytesFree += frame->bytes;
+    }
+};
+
+FramePool::FramePool() : m_state(std::make_shared<State>()) {}
+
+FramePool::~FramePool() {}
+
+FrameRef FramePool::acquire(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    PooledFrame* frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        auto it = m_state->freeLists.find(sizeClassKey(width, height));
+        if (it != m_state->freeLists.end() && !it->second.empty()) {
+            frame = it->second.back();
+            it->second.pop_back();
+            m_state->stats.buffersFree--;
+            m_state->stats.bytesFree -= frame->bytes;
+            m_state->stats.reuses++;
+        }
+    }
+
+    if (!frame) {
+        const int chromaW = (width + 1) / 2;
+        const int chromaH = (height + 1) / 2;
+        const size_t ySize = alignUp((size_t)width * height);
+        const size_t uvSize = alignUp((size_t)chromaW * chromaH);
+        void* memory = nullptr;
+        if (posix_memalign(&memory, kAlignment, ySize + uvSize * 2) != 0) {
+            LOGE("acquire: 分配 %dx%d 失败", width, height);
+            return nullptr;
+        }
+        frame = new PooledFrame();
+        frame->y = static_cast<uint8_t*>(memory);
+        frame->u = frame->y + ySize;
+        frame->v = frame->u + uvSize;
+        frame->width = width;
+        frame->height = height;
+        frame->chromaWidth = chromaW;
+        frame->chromaHeight = chromaH;
+        frame->bytes = ySize + uvSize * 2;
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->stats.allocations++;
+        // 首次出现的分辨率登记为新的尺寸类
+        m_state->freeLists[sizeClassKey(width, height)];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->stats.buffersInUse++;
+        m_state->stats.bytesInUse += frame->bytes;
+        m_state->updateHighWaterLocked();
+    }
+    // 删除器持有池状态，池先销毁时缓冲仍能安全归还
+    std::shared_ptr<State> state = m_state;
+    return FrameRef(frame, [state](PooledFrame* released) {
+        state->recycle(released);
+    });
+}
+
+FrameRef FramePool::importFrame(const Yuv420Planes& planes, int64_t ptsUs) {
+    if (!planes.y || !planes.u || !planes.v) {
+        return nullptr;
+    }
+    FrameRef frame = acquire(planes.width, planes.height);
+    if (!frame) {
+        return nullptr;
+    }
+    copyPlane(planes.y, planes.yRowStride, 1, frame->width, frame->height, frame->y);
+    copyPlane(planes.u, planes.uvRowStride, planes.uvPixelStride, frame->chromaWidth, frame->chromaHeight, frame->u);
+    copyPlane(planes.v, planes.uvRowStride, planes.uvPixelStride, frame->chromaWidth, frame->chromaHeight, frame->v);
+    frame->ptsUs = ptsUs;
+    return frame;
+}
+
+void FramePool::setMaxFreePerClass(int count) {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->maxFreePerClass = count > 0 ? count : 0;
+}
+
+void FramePool::trim() {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    for (auto& entry : m_state->freeLists) {
+        for (PooledFrame* frame : entry.second) {
+            m_state->stats.releases++;
+            freeFrame(frame);
+        }
+        entry.second.clear();
+    }
+    m_state->stats.buffersFree = 0;
+    m_state->stats.bytesFree = 0;
+}
+
+FramePool::Stats FramePool::stats() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    Stats stats = m_state->stats;
+    stats.sizeClasses = m_state->freeLists.size();
+    return stats;
+}
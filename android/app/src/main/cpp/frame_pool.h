@@ -0,0 +1,69 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+
+#include "yuv_convert.h"
+
+// 池化的 I420 帧。三个平面起始地址按 kAlignment 对齐，行紧凑排列（GLES2 上传不支持行跨度）。
+// 通过 FrameRef 共享，渲染、录像、分析各自持有引用而不是拷贝；持有引用期间只读。
+struct PooledFrame {
+    uint8_t* y = nullptr;
+    uint8_t* u = nullptr;
+    uint8_t* v = nullptr;
+    int width = 0;
+    int height = 0;
+    int chromaWidth = 0;
+    int chromaHeight = 0;
+    int64_t ptsUs = 0;
+    size_t bytes = 0;  // 三个平面加对齐填充的总字节数
+
+    Yuv420Planes planes() const;
+};
+
+// 最后一个引用释放时缓冲回到池中
+typedef std::shared_ptr<PooledFrame> FrameRef;
+
+// 解码帧缓冲池：按分辨率分尺寸类，每类保留有限个空闲缓冲，统计内存水位。
+// 池对象先于帧销毁也安全，未归还的帧在最后一个引用释放时直接释放内存。
+class FramePool {
+public:
+    static const size_t kAlignment = 64;
+    static const int kDefaultMaxFreePerClass = 4;
+
+    struct Stats {
+        uint64_t allocations = 0;   // 新分配的缓冲数
+        uint64_t reuses = 0;        // 从空闲列表复用的次数
+        uint64_t releases = 0;      // 超过空闲上限或 trim 时释放的缓冲数
+        uint64_t sizeClasses = 0;
+        uint64_t buffersInUse = 0;
+        uint64_t buffersFree = 0;
+        uint64_t bytesInUse = 0;
+        uint64_t bytesFree = 0;
+        uint64_t highWaterBytes = 0;    // 在用加空闲的历史最大值
+        uint64_t highWaterBuffers = 0;
+    };
+
+    FramePool();
+    ~FramePool();
+
+    // 取一个指定尺寸的空白帧，内容未初始化；分配失败返回空
+    FrameRef acquire(int width, int height);
+    // 把任意跨度的 YUV420 平面拷进池化帧，拷贝只发生这一次
+    FrameRef importFrame(const Yuv420Planes& planes, int64_t ptsUs);
+
+    // 每个尺寸类最多保留的空闲缓冲数，多余的在归还时释放
+    void setMaxFreePerClass(int count);
+    // 释放所有空闲缓冲，例如切换分辨率或进入后台时
+    void trim();
+
+    Stats stats() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+};
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,161 @@
+#include "frame_ring.h"
+
+#include <string.h>
+#include <algorithm>
+
+#define LOG_TAG "FrameRing"
+#include "native_log.h"
+
+namespace {
+
+// 与 dart_native_api.h 中 Dart_CObject 的内存布局一致（type 为 int 枚举，value 联合体按 8 字节对齐），
+// 只用到 Dart_CObject_kInt64，避免为一个结构体引入整套 Dart SDK 头文件
+struct DartInt64Message {
+    int32_t type;
+    int64_t value;
+};
+
+const int32_t kDartCObjectInt64 = 3;
+
+} // namespace
+
+FrameRing::FrameRing()
+    : m_position(0),
+      m_readSeq(0),
+      m_post(nullptr),
+      m_port(0),
+      m_notifyPending(false) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+bool FrameRing::open(PostCObjectFn post, int64_t port, size_t capacity) {
+    if (capacity == 0) {
+        capacity = kDefaultCapacity;
+    }
+    if (capacity > UINT32_MAX) {
+        LOGE("环形缓冲容量过大: %zu", capacity);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_data.assign(capacity, 0);
+    m_records.assign(kMaxRecords, Record());
+    m_position = 0;
+    m_readSeq = 0;
+    memset(&m_header, 0, sizeof(m_header));
+    m_header.capacity = static_cast<uint32_t>(capacity);
+    m_post = post;
+    m_port = port;
+    m_notifyPending.store(false);
+    LOGI("帧环形缓冲已打开: 容量 %zu 字节, 端口 %lld", capacity, (long long)port);
+    return true;
+}
+
+void FrameRing::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_post = nullptr;
+    m_port = 0;
+    m_data.clear();
+    m_data.shrink_to_fit();
+    m_records.clear();
+    m_header.capacity = 0;
+    m_notifyPending.store(false);
+}
+
+void FrameRing::push(const uint8_t* data, int length, bool keyframe, int64_t ptsUs) {
+    if (data == nullptr || length <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_data.empty() || static_cast<size_t>(length) > m_data.size()) {
+        return;
+    }
+
+    const uint64_t seq = m_header.writeSeq;
+    Record& record = m_records[seq % m_records.size()];
+    if (record.size > 0 && record.seq >= m_readSeq) {
+        m_header.overwrittenFrames++;
+    }
+
+    // 数据区按累计字节位置取模写入，允许跨越末尾回绕
+    const size_t capacity = m_data.size();
+    const size_t offset = static_cast<size_t>(m_position % capacity);
+    const size_t first = std::min(static_cast<size_t>(length), capacity - offset);
+    memcpy(m_data.data() + offset, data, first);
+    if (first < static_cast<size_t>(length)) {
+        memcpy(m_data.data(), data + first, length - first);
+    }
+
+    record.seq = seq;
+    record.position = m_position;
+    record.size = static_cast<uint32_t>(length);
+    record.keyframe = keyframe;
+    record.ptsUs = ptsUs;
+    m_position += length;
+
+    m_header.writeSeq = seq + 1;
+    m_header.writeBytes = m_position;
+    m_header.lastPtsUs = ptsUs;
+    m_header.lastFrameSize = static_cast<uint32_t>(length);
+    if (keyframe) {
+        m_header.keyframes++;
+        m_header.lastKeyframeSeq = seq;
+    }
+
+    if (!m_notifyPending.load()) {
+        postLocked(seq, keyframe);
+    }
+}
+
+int32_t FrameRing::read(uint64_t seq, uint8_t* dst, int32_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_records.empty() || seq >= m_header.writeSeq) {
+        return -1;
+    }
+    const Record& record = m_records[seq % m_records.size()];
+    // 槽位已被新帧复用，或数据区已被后续写入覆盖
+    if (record.seq != seq || record.size == 0 || m_position - record.position > m_data.size()) {
+        return -1;
+    }
+    if (dst == nullptr || capacity < static_cast<int32_t>(record.size)) {
+        return -static_cast<int32_t>(record.size) - 1;
+    }
+
+    const size_t ringSize = m_data.size();
+    const size_t offset = static_cast<size_t>(record.position % ringSize);
+    const size_t first = std::min(static_cast<size_t>(record.size), ringSize - offset);
+    memcpy(dst, m_data.data() + offset, first);
+    if (first < record.size) {
+        memcpy(dst + first, m_data.data(), record.size - first);
+    }
+    return static_cast<int32_t>(record.size);
+}
+
+void FrameRing::ack(uint64_t seenSeq) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readSeq = std::min(seenSeq + 1, m_header.writeSeq);
+    m_notifyPending.store(false);
+    // Dart 处理期间又有新帧到达，立即补发一次合并通知
+    if (m_readSeq < m_header.writeSeq) {
+        const uint64_t latest = m_header.writeSeq - 1;
+        postLocked(latest, m_header.keyframes > 0 && m_header.lastKeyframeSeq >= m_readSeq);
+    }
+}
+
+void FrameRing::postLocked(uint64_t seq, bool keyframe) {
+    if (m_post == nullptr || m_port == 0) {
+        return;
+    }
+    DartInt64Message message;
+    message.type = kDartCObjectInt64;
+    message.value = static_cast<int64_t>((seq << 1) | (keyframe ? 1 : 0));
+    // Dart_PostCObject 会拷贝消息，栈上对象即可
+    if (m_post(m_port, &message)) {
+        m_notifyPending.store(true);
+        m_header.postedEvents++;
+    } else {
+        LOGE("通知 Dart 端口失败，端口可能已关闭");
+        m_post = nullptr;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// 共享给 Dart（dart:ffi）读取的计数器，布局与 lib/services/native_frame_ring.dart 中的 Struct 一致，
+// 只追加字段，不要调整顺序
+struct FrameRingHeader {
+    uint64_t writeSeq;          // 已写入的帧数，最新帧的序号为 writeSeq - 1
+    uint64_t writeBytes;        // 已写入的字节总数
+    uint64_t keyframes;         // 已写入的关键帧数
+    uint64_t lastKeyframeSeq;   // 最近关键帧的序号
+    uint64_t overwrittenFrames; // 未被读取就被覆盖的帧数
+    uint64_t postedEvents;      // 已发给 Dart 的通知数
+    int64_t lastPtsUs;          // 最新帧的接收时间
+    uint32_t lastFrameSize;
+    uint32_t capacity;          // 数据区字节数
+};
+
+// 接收线程写入 H.264 访问单元的共享环形缓冲，帧数据不经过平台通道。
+// 有新帧时通过 Dart_PostCObject 向 Dart 端口发一个 int64（序号 << 1 | 关键帧），
+// Dart 处理完调用 ack 之前不会再发，期间的新帧合并成一次通知。
+class FrameRing {
+public:
+    static const size_t kDefaultCapacity = 4 * 1024 * 1024;
+    static const size_t kMaxRecords = 256;
+
+    // Dart_PostCObject 的函数签名，由 Dart 侧通过 NativeApi.postCObject 传入
+    typedef bool (*PostCObjectFn)(int64_t port, void* message);
+
+    FrameRing();
+
+    bool open(PostCObjectFn post, int64_t port, size_t capacity);
+    void close();
+
+    // 接收线程调用
+    void push(const uint8_t* data, int length, bool keyframe, int64_t ptsUs);
+
+    // Dart 侧按序号取帧，帧已被覆盖或不存在时返回 -1，缓冲区不足时返回所需大小的相反数减一
+    int32_t read(uint64_t seq, uint8_t* dst, int32_t capacity);
+
+    // Dart 已处理到 seenSeq，允许发送下一次通知
+    void ack(uint64_t seenSeq);
+
+    const FrameRingHeader* header() const { return &m_header; }
+
+private:
+    struct Record {
+        uint64_t seq = 0;
+        uint64_t position = 0;  // 写入时的累计字节位置
+        uint32_t size = 0;
+        bool keyframe = false;
+        int64_t ptsUs = 0;
+    };
+
+    void postLocked(uint64_t seq, bool keyframe);
+
+    std::mutex m_mutex;
+    FrameRingHeader m_header;
+    std::vector<uint8_t> m_data;
+    std::vector<Record> m_records;
+    uint64_t m_position;
+    uint64_t m_readSeq;  // Dart 最近一次 ack 时已看到的序号
+
+    PostCObjectFn m_post;
+    int64_t m_port;
+    std::atomic<bool> m_notifyPending;
+};
+
+#endif // FRAME_RING_H
@@ -0,0 +1,304 @@
+#include "gl_yuv_renderer.h"
+
+#define LOG_TAG "GlYuvRenderer"
+#include "native_log.h"
+
+static const char* kVertexShader =
+        "attribute vec2 aPosition;\n"
+        "attribute vec2 aTexCoord;\n"
+        "varying vec2 vTexCoord;\n"
+        "void main() {\n"
+        "    gl_Position = vec4(aPosition, 0.0, 1.0);\n"
+        "    vTexCoord = aTexCoord;\n"
+        "}\n";
+
+// BT.601 有限范围，与 yuv_convert.cpp 的 CPU 实现系数一致
+static const char* kFragmentShader =
+        "precision mediump float;\n"
+        "varying vec2 vTexCoord;\n"
+        "uniform sampler2D uTexY;\n"
+        "uniform sampler2D uTexU;\n"
+        "uniform sampler2D uTexV;\n"
+        "void main() {\n"
+        "    float y = (texture2D(uTexY, vTexCoord).r - 0.0625) * 1.164;\n"
+        "    float u = texture2D(uTexU, vTexCoord).r - 0.5;\n"
+        "    float v = texture2D(uTexV, vTexCoord).r - 0.5;\n"
+        "    gl_FragColor = vec4(clamp(vec3(y + 1.596 * v,\n"
+        "                                   y - 0.392 * u - 0.813 * v,\n"
+        "                                   y + 2.017 * u), 0.0, 1.0), 1.0);\n"
+        "}\n";
+
+// 全屏四边形，纹理第一行对应画面顶部
+static const GLfloat kQuadPositions[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+static const GLfloat kQuadTexCoords[] = {0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    if (!shader) {
+        return 0;
+    }
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        LOGE("compileShader failed: %s", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GlYuvRenderer::GlYuvRenderer()
+    : m_running(false),
+      m_stop(false),
+      m_renderedFrames(0),
+      m_droppedFrames(0),
+      m_display(EGL_NO_DISPLAY),
+      m_surface(EGL_NO_SURFACE),
+      m_context(EGL_NO_CONTEXT),
+      m_program(0),
+      m_positionLoc(-1),
+      m_texCoordLoc(-1),
+      m_texWidth(0),
+      m_texHeight(0) {
+    m_textures[0] = m_textures[1] = m_textures[2] = 0;
+}
+
+GlYuvRenderer::~GlYuvRenderer() {
+    detach();
+}
+
+bool GlYuvRenderer::attach(ANativeWindow* window) {
+    if (!window) {
+        return false;
+    }
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (m_running.load()) {
+        LOGW("attach: already attached");
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_stop = false;
+        m_pending.reset();
+    }
+    ANativeWindow_acquire(window);
+    m_running.store(true);
+    m_thread = std::thread(&GlYuvRenderer::renderLoop, this, window);
+    return true;
+}
+
+void GlYuvRenderer::detach() {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_stop = true;
+    }
+    m_frameCond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false);
+}
+
+bool GlYuvRenderer::submitFrame(const FrameRef& frame) {
+    if (!m_running.load() || !frame) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        if (m_stop) {
+            return false;
+        }
+        if (m_pending) {
+            // 渲染线程还没取走上一帧，直接覆盖，保证显示的总是最新画面；旧帧的引用在这里归还
+            m_droppedFrames++;
+        }
+        m_pending = frame;
+    }
+    m_frameCond.notify_one();
+    return true;
+}
+
+bool GlYuvRenderer::initEgl(ANativeWindow* window) {
+    m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, nullptr, nullptr)) {
+        LOGE("initEgl: eglInitialize failed: 0x%x", eglGetError());
+        return false;
+    }
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(m_display, configAttribs, &config, 1, &numConfigs) || numConfigs <= 0) {
+        LOGE("initEgl: eglChooseConfig failed: 0x%x", eglGetError());
+        return false;
+    }
+    const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (m_context == EGL_NO_CONTEXT) {
+        LOGE("initEgl: eglCreateContext failed: 0x%x", eglGetError());
+        return false;
+    }
+    m_surface = eglCreateWindowSurface(m_display, config, (EGLNativeWindowType)window, nullptr);
+    if (m_surface == EGL_NO_SURFACE) {
+        LOGE("initEgl: eglCreateWindowSurface failed: 0x%x", eglGetError());
+        return false;
+    }
+    if (!eglMakeCurrent(m_display, m_surface, m_surface, m_context)) {
+        LOGE("initEgl: eglMakeCurrent failed: 0x%x", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+void GlYuvRenderer::releaseEgl() {
+    if (m_display == EGL_NO_DISPLAY) {
+        return;
+    }
+    if (m_context != EGL_NO_CONTEXT && m_surface != EGL_NO_SURFACE) {
+        eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+        if (m_textures[0]) {
+            glDeleteTextures(3, m_textures);
+        }
+        if (m_program) {
+            glDeleteProgram(m_program);
+        }
+    }
+    m_textures[0] = m_textures[1] = m_textures[2] = 0;
+    m_program = 0;
+    m_texWidth = 0;
+    m_texHeight = 0;
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_surface != EGL_NO_SURFACE) {
+        eglDestroySurface(m_display, m_surface);
+        m_surface = EGL_NO_SURFACE;
+    }
+    if (m_context != EGL_NO_CONTEXT) {
+        eglDestroyContext(m_display, m_context);
+        m_context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(m_display);
+    m_display = EGL_NO_DISPLAY;
+}
+
+bool GlYuvRenderer::initGl() {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, kVertexShader);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return false;
+    }
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint linked = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        LOGE("initGl: program link failed");
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+    glUseProgram(m_program);
+    m_positionLoc = glGetAttribLocation(m_program, "aPosition");
+    m_texCoordLoc = glGetAttribLocation(m_program, "aTexCoord");
+    glUniform1i(glGetUniformLocation(m_program, "uTexY"), 0);
+    glUniform1i(glGetUniformLocation(m_program, "uTexU"), 1);
+    glUniform1i(glGetUniformLocation(m_program, "uTexV"), 2);
+
+    glGenTextures(3, m_textures);
+    for (int i = 0; i < 3; i++) {
+        glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glVertexAttribPointer((GLuint)m_positionLoc, 2, GL_FLOAT, GL_FALSE, 0, kQuadPositions);
+    glEnableVertexAttribArray((GLuint)m_positionLoc);
+    glVertexAttribPointer((GLuint)m_texCoordLoc, 2, GL_FLOAT, GL_FALSE, 0, kQuadTexCoords);
+    glEnableVertexAttribArray((GLuint)m_texCoordLoc);
+    return true;
+}
+
+void GlYuvRenderer::drawFrame(const PooledFrame& frame) {
+    // 池化帧的行是紧凑排列的，GLES2 没有 UNPACK_ROW_LENGTH 也能直接上传
+    const uint8_t* planes[3] = {frame.y, frame.u, frame.v};
+    const int widths[3] = {frame.width, frame.chromaWidth, frame.chromaWidth};
+    const int heights[3] = {frame.height, frame.chromaHeight, frame.chromaHeight};
+    // 尺寸变化时重新分配纹理，否则只更新内容
+    bool realloc = frame.width != m_texWidth || frame.height != m_texHeight;
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+        if (realloc) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, widths[i], heights[i], 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, planes[i]);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, widths[i], heights[i], GL_LUMINANCE, GL_UNSIGNED_BYTE, planes[i]);
+        }
+    }
+    m_texWidth = frame.width;
+    m_texHeight = frame.height;
+
+    glViewport(0, 0, frame.width, frame.height);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    if (!eglSwapBuffers(m_display, m_surface)) {
+        LOGW("drawFrame: eglSwapBuffers failed: 0x%x", eglGetError());
+        return;
+    }
+    m_renderedFrames++;
+}
+
+void GlYuvRenderer::renderLoop(ANativeWindow* window) {
+    if (!initEgl(window) || !initGl()) {
+        LOGE("renderLoop: GL init failed");
+        releaseEgl();
+        ANativeWindow_release(window);
+        m_running.store(false);
+        return;
+    }
+    LOGI("renderLoop: started");
+
+    for (;;) {
+        FrameRef current;
+        {
+            std::unique_lock<std::mutex> lock(m_frameMutex);
+            m_frameCond.wait(lock, [this]() { return m_stop || m_pending; });
+            if (m_stop) {
+                break;
+            }
+            // 只转移引用，帧数据在池中不拷贝
+            current = std::move(m_pending);
+        }
+        if (current->width != m_texWidth || current->height != m_texHeight) {
+            // SurfaceTexture 的缓冲尺寸跟随视频尺寸，Flutter 侧按纹理比例缩放显示
+            ANativeWindow_setBuffersGeometry(window, current->width, current->height, 0);
+        }
+        drawFrame(*current);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_pending.reset();
+    }
+
+    releaseEgl();
+    ANativeWindow_release(window);
+    LOGI("renderLoop: stopped, rendered=%llu, dropped=%llu",
+         (unsigned long long)m_renderedFrames.load(), (unsigned long long)m_droppedFrames.load());
+}
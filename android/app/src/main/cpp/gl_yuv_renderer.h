@@ -0,0 +1,66 @@
+#ifndef GL_YUV_RENDERER_H
+#define GL_YUV_RENDERER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <android/native_window.h>
+
+#include "frame_pool.h"
+
+// GPU 渲染 YUV 帧：Y/U/V 三个平面作为 GL_LUMINANCE 纹理上传，颜色转换在片元着色器完成，
+// 直接绘制到 Flutter SurfaceTexture 对应的 ANativeWindow 上。
+// EGL 上下文只在渲染线程使用；送帧线程只把池化帧的引用放进待渲染槽位，新帧覆盖未渲染的旧帧。
+class GlYuvRenderer {
+public:
+    GlYuvRenderer();
+    ~GlYuvRenderer();
+
+    // 绑定输出窗口并启动渲染线程，窗口引用由渲染器持有
+    bool attach(ANativeWindow* window);
+    void detach();
+    bool isAttached() const { return m_running.load(); }
+
+    // 任意线程调用：提交一帧池化帧，渲染器只持有引用，渲染完成后释放
+    bool submitFrame(const FrameRef& frame);
+
+    uint64_t renderedFrames() const { return m_renderedFrames.load(); }
+    uint64_t droppedFrames() const { return m_droppedFrames.load(); }
+
+private:
+    void renderLoop(ANativeWindow* window);
+    bool initEgl(ANativeWindow* window);
+    void releaseEgl();
+    bool initGl();
+    void drawFrame(const PooledFrame& frame);
+
+    std::mutex m_controlMutex;  // 串行化 attach/detach
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    std::mutex m_frameMutex;
+    std::condition_variable m_frameCond;
+    FrameRef m_pending;
+    bool m_stop;
+
+    std::atomic<uint64_t> m_renderedFrames;
+    std::atomic<uint64_t> m_droppedFrames;
+
+    // 以下只在渲染线程访问
+    EGLDisplay m_display;
+    EGLSurface m_surface;
+    EGLContext m_context;
+    GLuint m_program;
+    GLuint m_textures[3];
+    GLint m_positionLoc;
+    GLint m_texCoordLoc;
+    int m_texWidth;
+    int m_texHeight;
+};
+
+#endif // GL_YUV_RENDERER_H
@@ -0,0 +1,202 @@
+#include "gop_cache.h"
+#include "h264_nal.h"
+
+#define LOG_TAG "GopCache"
+#include "native_log.h"
+
+static const uint8_t kStartCode[4] = {0x00, 0x00, 0x00, 0x01};
+
+static void appendNal(std::vector<uint8_t>& out, const std::vector<uint8_t>& nal) {
+    out.insert(out.end(), kStartCode, kStartCode + 4);
+    out.insert(out.end(), nal.begin(), nal.end());
+}
+
+GopCache::GopCache()
+    : m_totalBudget(kDefaultTotalBudget),
+      m_deviceBudget(kDefaultDeviceBudget),
+      m_totalBytes(0) {
+}
+
+void GopCache::configure(size_t totalBudgetBytes, size_t deviceBudgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_totalBudget = totalBudgetBytes;
+    m_deviceBudget = deviceBudgetBytes < totalBudgetBytes ? deviceBudgetBytes : totalBudgetBytes;
+    evictLocked(std::string());
+    LOGI("configure: total=%zu, perDevice=%zu", m_totalBudget, m_deviceBudget);
+}
+
+GopCache::DeviceGop& GopCache::touchLocked(const std::string& devId) {
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        m_lru.push_front(devId);
+        DeviceGop& gop = m_devices[devId];
+        gop.lruIt = m_lru.begin();
+        return gop;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruIt);
+    return it->second;
+}
+
+void GopCache::resetGopLocked(DeviceGop& gop) {
+    size_t frameBytes = 0;
+    for (const auto& frame : gop.frames) {
+        frameBytes += frame.size();
+    }
+    gop.frames.clear();
+    gop.bytes -= frameBytes;
+    m_totalBytes -= frameBytes;
+}
+
+void GopCache::evictLocked(const std::string& keep) {
+    while (m_totalBytes > m_totalBudget && !m_lru.empty()) {
+        const std::string victim = m_lru.back();
+        if (victim == keep) {
+            // 只剩正在写入的设备，单设备预算已保证它不会超过总预算
+            break;
+        }
+        auto it = m_devices.find(victim);
+        m_totalBytes -= it->second.bytes;
+        m_devices.erase(it);
+        m_lru.pop_back();
+        LOGI("evict: devId=%s, total=%zu", victim.c_str(), m_totalBytes);
+    }
+}
+
+void GopCache::beginSession(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it != m_devices.end()) {
+        it->second.accepting = false;
+    }
+}
+
+void GopCache::push(const std::string& devId, const uint8_t* data, int length) {
+    if (devId.empty() || !data || length <= 0) {
+        return;
+    }
+
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+    bool hasIdr = false;
+    bool hasSlice = false;
+    bool hasSps = false;
+    const H264NalUnit* sps = nullptr;
+    const H264NalUnit* pps = nullptr;
+    for (const H264NalUnit& nal : nals) {
+        switch (nal.type) {
+            case H264_NAL_IDR: hasIdr = true; hasSlice = true; break;
+            case H264_NAL_SLICE: hasSlice = true; break;
+            case H264_NAL_SPS: hasSps = true; sps = &nal; break;
+            case H264_NAL_PPS: pps = &nal; break;
+            default: break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    DeviceGop& gop = touchLocked(devId);
+
+    // 参数集单独保存，IDR 访问单元里没有时在缓存中补上
+    if (sps) {
+        m_totalBytes -= gop.sps.size();
+        gop.bytes -= gop.sps.size();
+        gop.sps.assign(sps->data, sps->data + sps->size);
+        m_totalBytes += gop.sps.size();
+        gop.bytes += gop.sps.size();
+    }
+    if (pps) {
+        m_totalBytes -= gop.pps.size();
+        gop.bytes -= gop.pps.size();
+        gop.pps.assign(pps->data, pps->data + pps->size);
+        m_totalBytes += gop.pps.size();
+        gop.bytes += gop.pps.size();
+    }
+    if (!hasSlice) {
+        return;
+    }
+
+    if (hasIdr) {
+        resetGopLocked(gop);
+        std::vector<uint8_t> frame;
+        if (!hasSps && !gop.sps.empty() && !gop.pps.empty()) {
+            frame.reserve(gop.sps.size() + gop.pps.size() + 8 + length);
+            appendNal(frame, gop.sps);
+            appendNal(frame, gop.pps);
+        }
+        frame.insert(frame.end(), data, data + length);
+        if (gop.bytes + frame.size() > m_deviceBudget) {
+            // IDR 本身就超出单设备预算，不缓存
+            gop.accepting = false;
+            LOGW("push: IDR too large for budget, devId=%s, size=%d", devId.c_str(), length);
+            return;
+        }
+        gop.bytes += frame.size();
+        m_totalBytes += frame.size();
+        gop.frames.push_back(std::move(frame));
+        gop.accepting = true;
+    } else {
+        if (!gop.accepting) {
+            return;
+        }
+        if (gop.bytes + (size_t)length > m_deviceBudget) {
+            // 超出预算后停止追加，已缓存的前缀仍然可以独立解码
+            gop.accepting = false;
+            return;
+        }
+        gop.frames.emplace_back(data, data + length);
+        gop.bytes += length;
+        m_totalBytes += length;
+    }
+
+    evictLocked(devId);
+}
+
+bool GopCache::snapshot(const std::string& devId, std::vector<std::vector<uint8_t>>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end() || it->second.frames.empty()) {
+        return false;
+    }
+    DeviceGop& gop = touchLocked(devId);
+    out = gop.frames;
+    return true;
+}
+
+bool GopCache::latestKeyframe(const std::string& devId, std::vector<uint8_t>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end() || it->second.frames.empty()) {
+        return false;
+    }
+    out = it->second.frames.front();
+    return true;
+}
+
+void GopCache::drop(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        return;
+    }
+    m_totalBytes -= it->second.bytes;
+    m_lru.erase(it->second.lruIt);
+    m_devices.erase(it);
+}
+
+void GopCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.clear();
+    m_lru.clear();
+    m_totalBytes = 0;
+}
+
+size_t GopCache::totalBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalBytes;
+}
+
+size_t GopCache::deviceCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_devices.size();
+}
@@ -0,0 +1,64 @@
+#ifndef GOP_CACHE_H
+#define GOP_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 按设备缓存最近一个 GOP（IDR + 其后的帧），重新打开画面时先把缓存送进解码器，
+// 这样不用等设备的下一个 IDR 就能看到最近的画面。
+// 总字节预算和单设备字节预算都有上限，超出总预算时按 LRU 淘汰设备。
+class GopCache {
+public:
+    static const size_t kDefaultTotalBudget = 16 * 1024 * 1024;
+    static const size_t kDefaultDeviceBudget = 4 * 1024 * 1024;
+
+    GopCache();
+
+    void configure(size_t totalBudgetBytes, size_t deviceBudgetBytes);
+
+    // 新的观看会话开始：在下一个 IDR 到来前忽略该设备的非 IDR 帧，避免把新会话的帧接到旧 GOP 后面
+    void beginSession(const std::string& devId);
+
+    // 送入一个 Annex-B 访问单元
+    void push(const std::string& devId, const uint8_t* data, int length);
+
+    // 取出缓存的 GOP，第一项是 SPS/PPS + IDR；没有可用 GOP 时返回 false
+    bool snapshot(const std::string& devId, std::vector<std::vector<uint8_t>>& out);
+
+    // 取出最近的关键帧访问单元（已补齐 SPS/PPS），没有时返回 false
+    bool latestKeyframe(const std::string& devId, std::vector<uint8_t>& out);
+
+    void drop(const std::string& devId);
+    void clear();
+
+    size_t totalBytes() const;
+    size_t deviceCount() const;
+
+private:
+    struct DeviceGop {
+        std::vector<uint8_t> sps;
+        std::vector<uint8_t> pps;
+        std::vector<std::vector<uint8_t>> frames;
+        size_t bytes = 0;
+        bool accepting = false;  // 当前 GOP 是否还在接收后续帧
+        std::list<std::string>::iterator lruIt;
+    };
+
+    DeviceGop& touchLocked(const std::string& devId);
+    void evictLocked(const std::string& keep);
+    void resetGopLocked(DeviceGop& gop);
+
+    mutable std::mutex m_mutex;
+    size_t m_totalBudget;
+    size_t m_deviceBudget;
+    size_t m_totalBytes;
+    std::list<std::string> m_lru;  // 队首为最近使用
+    std::unordered_map<std::string, DeviceGop> m_devices;
+};
+
+#endif // GOP_CACHE_H
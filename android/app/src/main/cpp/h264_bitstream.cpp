@@ -0,0 +1,518 @@
+#include "h264_bitstream.h"
+
+H264BitReader::H264BitReader(const uint8_t* nal, int size, int maxBytes)
+    : m_pos(0), m_overrun(false) {
+    if (maxBytes > 0 && size > maxBytes) {
+        size = maxBytes;
+    }
+    m_rbsp.reserve(size > 0 ? size : 0);
+    int zeros = 0;
+    for (int i = 0; i < size; i++) {
+        if (zeros >= 2 && nal[i] == 0x03) {
+            zeros = 0;
+            continue;
+        }
+        zeros = nal[i] == 0x00 ? zeros + 1 : 0;
+        m_rbsp.push_back(nal[i]);
+    }
+}
+
+uint32_t H264BitReader::readBits(int n) {
+    uint32_t value = 0;
+    for (int i = 0; i < n; i++) {
+        if (m_pos >= m_rbsp.size() * 8) {
+            m_overrun = true;
+            return 0;
+        }
+        uint8_t byte = m_rbsp[m_pos >> 3];
+        value = (value << 1) | ((byte >> (7 - (m_pos & 7))) & 0x01);
+        m_pos++;
+    }
+    return value;
+}
+
+uint32_t H264BitReader::readUe() {
+    int leadingZeros = 0;
+    while (!readBit()) {
+        if (m_overrun || ++leadingZeros > 31) {
+            m_overrun = true;
+            return 0;
+        }
+    }
+    if (leadingZeros == 0) {
+        return 0;
+    }
+    return ((1u << leadingZeros) - 1) + readBits(leadingZeros);
+}
+
+int32_t H264BitReader::readSe() {
+    uint32_t codeNum = readUe();
+    if (codeNum & 0x01) {
+        return (int32_t)((codeNum + 1) >> 1);
+    }
+    return -(int32_t)(codeNum >> 1);
+}
+
+void H264BitReader::skipBits(int n) {
+    m_pos += n;
+    if (m_pos > m_rbsp.size() * 8) {
+        m_overrun = true;
+        m_pos = m_rbsp.size() * 8;
+    }
+}
+
+// 读取 hrd_parameters()，只保留 pic_timing 中各字段的位宽
+static void parseHrdParameters(H264BitReader& br, H264Sps& sps) {
+    uint32_t cpbCount = br.readUe() + 1;
+    br.skipBits(8);  // bit_rate_scale, cpb_size_scale
+    for (uint32_t i = 0; i < cpbCount && !br.overrun(); i++) {
+        br.readUe();  // bit_rate_value_minus1
+        br.readUe();  // cpb_size_value_minus1
+        br.skipBits(1);  // cbr_flag
+    }
+    br.skipBits(5);  // initial_cpb_removal_delay_length_minus1
+    sps.cpbRemovalDelayLength = br.readBits(5) + 1;
+    sps.dpbOutputDelayLength = br.readBits(5) + 1;
+    sps.timeOffsetLength = br.readBits(5);
+}
+
+static void skipScalingList(H264BitReader& br, int size) {
+    int lastScale = 8;
+    int nextScale = 8;
+    for (int j = 0; j < size; j++) {
+        if (nextScale != 0) {
+            int32_t delta = br.readSe();
+            nextScale = (lastScale + delta + 256) % 256;
+        }
+        lastScale = nextScale == 0 ? lastScale : nextScale;
+    }
+}
+
+bool h264ParseSps(const uint8_t* nal, int size, H264Sps& sps) {
+    sps = H264Sps();
+    if (!nal || size < 4 || (nal[0] & 0x1F) != 7) {
+        return false;
+    }
+    H264BitReader br(nal + 1, size - 1);
+    sps.profileIdc = (uint8_t)br.readBits(8);
+    sps.constraintFlags = (uint8_t)br.readBits(8);
+    sps.levelIdc = (uint8_t)br.readBits(8);
+    sps.spsId = br.readUe();
+
+    switch (sps.profileIdc) {
+        case 100: case 110: case 122: case 244: case 44:
+        case 83: case 86: case 118: case 128: case 138: case 139: case 134: case 135: {
+            sps.chromaFormatIdc = br.readUe();
+            if (sps.chromaFormatIdc == 3) {
+                sps.separateColourPlane = br.readBit();
+            }
+            br.readUe();  // bit_depth_luma_minus8
+            br.readUe();  // bit_depth_chroma_minus8
+            br.skipBits(1);  // qpprime_y_zero_transform_bypass_flag
+            if (br.readBit()) {  // seq_scaling_matrix_present_flag
+                int count = sps.chromaFormatIdc != 3 ? 8 : 12;
+                for (int i = 0; i < count; i++) {
+                    if (br.readBit()) {
+                        skipScalingList(br, i < 6 ? 16 : 64);
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    sps.log2MaxFrameNum = br.readUe() + 4;
+    sps.picOrderCntType = br.readUe();
+    if (sps.picOrderCntType == 0) {
+        sps.log2MaxPocLsb = br.readUe() + 4;
+    } else if (sps.picOrderCntType == 1) {
+        sps.deltaPicOrderAlwaysZero = br.readBit();
+        br.readSe();  // offset_for_non_ref_pic
+        br.readSe();  // offset_for_top_to_bottom_field
+        uint32_t cycle = br.readUe();
+        for (uint32_t i = 0; i < cycle && !br.overrun(); i++) {
+            br.readSe();
+        }
+    }
+    sps.maxNumRefFrames = br.readUe();
+    sps.gapsInFrameNumAllowed = br.readBit();
+    uint32_t widthInMbs = br.readUe() + 1;
+    uint32_t heightInMapUnits = br.readUe() + 1;
+    sps.frameMbsOnly = br.readBit();
+    if (!sps.frameMbsOnly) {
+        br.skipBits(1);  // mb_adaptive_frame_field_flag
+    }
+    br.skipBits(1);  // direct_8x8_inference_flag
+
+    uint32_t cropLeft = 0, cropRight = 0, cropTop = 0, cropBottom = 0;
+    if (br.readBit()) {
+        cropLeft = br.readUe();
+        cropRight = br.readUe();
+        cropTop = br.readUe();
+        cropBottom = br.readUe();
+    }
+    int frameHeightFactor = sps.frameMbsOnly ? 1 : 2;
+    int cropUnitX = sps.chromaFormatIdc == 0 ? 1 : (sps.chromaFormatIdc == 3 ? 1 : 2);
+    int cropUnitY = (sps.chromaFormatIdc == 1 ? 2 : 1) * frameHeightFactor;
+    sps.width = (int)(widthInMbs * 16) - cropUnitX * (int)(cropLeft + cropRight);
+    sps.height = (int)(heightInMapUnits * 16) * frameHeightFactor - cropUnitY * (int)(cropTop + cropBottom);
+    sps.picSizeInMbs = widthInMbs * heightInMapUnits * frameHeightFactor;
+
+    if (br.overrun() || sps.width <= 0 || sps.height <= 0) {
+        return false;
+    }
+    sps.valid = true;
+
+    if (br.readBit()) {  // vui_parameters_present_flag
+        if (br.readBit()) {  // aspect_ratio_info_present_flag
+            if (br.readBits(8) == 255) {  // Extended_SAR
+                br.skipBits(32);
+            }
+        }
+        if (br.readBit()) {  // overscan_info_present_flag
+            br.skipBits(1);
+        }
+        if (br.readBit()) {  // video_signal_type_present_flag
+            br.skipBits(4);
+            if (br.readBit()) {  // colour_description_present_flag
+                br.skipBits(24);
+            }
+        }
+        if (br.readBit()) {  // chroma_loc_info_present_flag
+            br.readUe();
+            br.readUe();
+        }
+        sps.timingInfoPresent = br.readBit();
+        if (sps.timingInfoPresent) {
+            sps.numUnitsInTick = br.readBits(32);
+            sps.timeScale = br.readBits(32);
+            sps.fixedFrameRate = br.readBit();
+        }
+        bool nalHrd = br.readBit();
+        if (nalHrd) {
+            parseHrdParameters(br, sps);
+        }
+        bool vclHrd = br.readBit();
+        if (vclHrd) {
+            parseHrdParameters(br, sps);
+        }
+        sps.cpbDpbDelaysPresent = nalHrd || vclHrd;
+        if (sps.cpbDpbDelaysPresent) {
+            br.skipBits(1);  // low_delay_hrd_flag
+        }
+        sps.picStructPresent = br.readBit();
+    }
+
+    if (br.overrun()) {
+        // VUI 被截断时只丢弃时间信息，分辨率等字段仍然有效
+        sps.timingInfoPresent = false;
+        sps.cpbDpbDelaysPresent = false;
+        sps.picStructPresent = false;
+    }
+    return true;
+}
+
+bool h264ParsePps(const uint8_t* nal, int size, H264Pps& pps) {
+    pps = H264Pps();
+    if (!nal || size < 2 || (nal[0] & 0x1F) != 8) {
+        return false;
+    }
+    H264BitReader br(nal + 1, size - 1);
+    pps.ppsId = br.readUe();
+    pps.spsId = br.readUe();
+    pps.entropyCodingMode = br.readBit();
+    pps.bottomFieldPicOrderPresent = br.readBit();
+    pps.numSliceGroups = br.readUe() + 1;
+    if (pps.numSliceGroups > 1) {
+        // FMO 只在 Baseline 的扩展用法中出现，监控摄像头不使用
+        return false;
+    }
+    pps.numRefIdxL0Default = br.readUe() + 1;
+    pps.numRefIdxL1Default = br.readUe() + 1;
+    pps.weightedPred = br.readBit();
+    pps.weightedBipredIdc = br.readBits(2);
+    br.readSe();  // pic_init_qp_minus26
+    br.readSe();  // pic_init_qs_minus26
+    br.readSe();  // chroma_qp_index_offset
+    pps.deblockingFilterControlPresent = br.readBit();
+    br.skipBits(1);  // constrained_intra_pred_flag
+    pps.redundantPicCntPresent = br.readBit();
+    if (br.overrun() || pps.ppsId > 255 || pps.spsId > 31) {
+        return false;
+    }
+    pps.valid = true;
+    return true;
+}
+
+bool h264PeekSlicePpsId(const uint8_t* nal, int size, uint32_t& ppsId) {
+    if (!nal || size < 2) {
+        return false;
+    }
+    H264BitReader br(nal + 1, size - 1, 16);
+    br.readUe();  // first_mb_in_slice
+    br.readUe();  // slice_type
+    ppsId = br.readUe();
+    return !br.overrun();
+}
+
+static void skipRefPicListModification(H264BitReader& br) {
+    if (!br.readBit()) {  // ref_pic_list_modification_flag
+        return;
+    }
+    for (int i = 0; i < 64 && !br.overrun(); i++) {
+        uint32_t idc = br.readUe();
+        if (idc == 3) {
+            return;
+        }
+        br.readUe();  // abs_diff_pic_num_minus1 / long_term_pic_num
+    }
+}
+
+static void skipPredWeightTable(H264BitReader& br, const H264Sps& sps, uint32_t numL0, uint32_t numL1, bool bSlice) {
+    bool hasChroma = sps.chromaFormatIdc != 0 && !sps.separateColourPlane;
+    br.readUe();  // luma_log2_weight_denom
+    if (hasChroma) {
+        br.readUe();  // chroma_log2_weight_denom
+    }
+    for (int list = 0; list < (bSlice ? 2 : 1); list++) {
+        uint32_t count = list == 0 ? numL0 : numL1;
+        for (uint32_t i = 0; i < count && !br.overrun(); i++) {
+            if (br.readBit()) {  // luma_weight_flag
+                br.readSe();
+                br.readSe();
+            }
+            if (hasChroma && br.readBit()) {  // chroma_weight_flag
+                for (int j = 0; j < 4; j++) {
+                    br.readSe();
+                }
+            }
+        }
+    }
+}
+
+// dec_ref_pic_marking，返回是否出现 MMCO 5
+static bool skipDecRefPicMarking(H264BitReader& br, bool idr) {
+    if (idr) {
+        br.skipBits(2);  // no_output_of_prior_pics_flag, long_term_reference_flag
+        return false;
+    }
+    bool mmco5 = false;
+    if (!br.readBit()) {  // adaptive_ref_pic_marking_mode_flag
+        return false;
+    }
+    for (int i = 0; i < 64 && !br.overrun(); i++) {
+        uint32_t op = br.readUe();
+        if (op == 0) {
+            break;
+        }
+        if (op == 1 || op == 3) {
+            br.readUe();  // difference_of_pic_nums_minus1
+        }
+        if (op == 2) {
+            br.readUe();  // long_term_pic_num
+        }
+        if (op == 3 || op == 6) {
+            br.readUe();  // long_term_frame_idx
+        }
+        if (op == 4) {
+            br.readUe();  // max_long_term_frame_idx_plus1
+        }
+        if (op == 5) {
+            mmco5 = true;
+        }
+    }
+    return mmco5;
+}
+
+bool h264ParseSliceHeader(const uint8_t* nal, int size, const H264Sps& sps, const H264Pps& pps, H264SliceHeader& header) {
+    header = H264SliceHeader();
+    if (!nal || size < 2 || !sps.valid || !pps.valid) {
+        return false;
+    }
+    uint8_t nalType = nal[0] & 0x1F;
+    if (nalType != 1 && nalType != 5) {
+        return false;
+    }
+    header.idr = nalType == 5;
+    header.nalRefIdc = (nal[0] >> 5) & 0x03;
+    // slice 头加上第一个 mb_skip_run 一般不超过几十字节
+    H264BitReader br(nal + 1, size - 1, 256);
+    header.firstMb = br.readUe();
+    header.sliceType = br.readUe() % 5;
+    header.ppsId = br.readUe();
+    if (sps.separateColourPlane) {
+        br.skipBits(2);  // colour_plane_id
+    }
+    header.frameNum = br.readBits((int)sps.log2MaxFrameNum);
+    if (!sps.frameMbsOnly) {
+        header.fieldPic = br.readBit();
+        if (header.fieldPic) {
+            header.bottomField = br.readBit();
+        }
+    }
+    if (header.idr) {
+        header.idrPicId = br.readUe();
+    }
+    if (sps.picOrderCntType == 0) {
+        header.pocLsb = br.readBits((int)sps.log2MaxPocLsb);
+        if (pps.bottomFieldPicOrderPresent && !header.fieldPic) {
+            header.deltaPocBottom = br.readSe();
+        }
+    } else if (sps.picOrderCntType == 1 && !sps.deltaPicOrderAlwaysZero) {
+        header.deltaPoc[0] = br.readSe();
+        if (pps.bottomFieldPicOrderPresent && !header.fieldPic) {
+            header.deltaPoc[1] = br.readSe();
+        }
+    }
+    if (pps.redundantPicCntPresent) {
+        br.readUe();  // redundant_pic_cnt
+    }
+
+    const uint32_t type = header.sliceType;
+    const bool bSlice = type == H264_SLICE_B;
+    const bool interSlice = type == H264_SLICE_P || type == H264_SLICE_SP || bSlice;
+    if (bSlice) {
+        br.skipBits(1);  // direct_spatial_mv_pred_flag
+    }
+    uint32_t numL0 = pps.numRefIdxL0Default;
+    uint32_t numL1 = pps.numRefIdxL1Default;
+    if (interSlice && br.readBit()) {  // num_ref_idx_active_override_flag
+        numL0 = br.readUe() + 1;
+        if (bSlice) {
+            numL1 = br.readUe() + 1;
+        }
+    }
+    if (type != H264_SLICE_I && type != H264_SLICE_SI) {
+        skipRefPicListModification(br);
+        if (bSlice) {
+            skipRefPicListModification(br);
+        }
+    }
+    if ((pps.weightedPred && (type == H264_SLICE_P || type == H264_SLICE_SP)) ||
+        (pps.weightedBipredIdc == 1 && bSlice)) {
+        skipPredWeightTable(br, sps, numL0, numL1, bSlice);
+    }
+    if (header.nalRefIdc != 0) {
+        header.hasMmco5 = skipDecRefPicMarking(br, header.idr);
+    }
+    if (br.overrun()) {
+        return false;
+    }
+
+    // 以下字段只影响 firstSkipRun，读不到时头部信息仍然有效
+    if (pps.entropyCodingMode || !interSlice) {
+        return true;
+    }
+    br.readSe();  // slice_qp_delta
+    if (type == H264_SLICE_SP) {
+        br.skipBits(1);  // sp_for_switch_flag
+        br.readSe();  // slice_qs_delta
+    }
+    if (pps.deblockingFilterControlPresent) {
+        if (br.readUe() != 1) {  // disable_deblocking_filter_idc
+            br.readSe();
+            br.readSe();
+        }
+    }
+    uint32_t skipRun = br.readUe();
+    if (!br.overrun()) {
+        header.firstSkipRun = (int32_t)skipRun;
+    }
+    return true;
+}
+
+// pic_struct 对应的 clock timestamp 个数（表 D-1）
+static const int kNumClockTs[9] = {1, 1, 1, 2, 2, 3, 3, 2, 3};
+
+static bool parsePicTiming(H264BitReader& br, const H264Sps& sps, H264ClockTimestamp& clock) {
+    if (sps.cpbDpbDelaysPresent) {
+        br.skipBits(sps.cpbRemovalDelayLength);
+        br.skipBits(sps.dpbOutputDelayLength);
+    }
+    if (!sps.picStructPresent) {
+        return false;
+    }
+    uint32_t picStruct = br.readBits(4);
+    if (picStruct > 8) {
+        return false;
+    }
+    for (int i = 0; i < kNumClockTs[picStruct]; i++) {
+        if (!br.readBit()) {  // clock_timestamp_flag
+            continue;
+        }
+        br.skipBits(2);  // ct_type
+        clock.fieldBased = br.readBit();
+        br.skipBits(5);  // counting_type
+        bool fullTimestamp = br.readBit();
+        br.skipBits(1);  // discontinuity_flag
+        br.skipBits(1);  // cnt_dropped_flag
+        clock.nFrames = br.readBits(8);
+        if (fullTimestamp) {
+            clock.seconds = br.readBits(6);
+            clock.minutes = br.readBits(6);
+            clock.hours = br.readBits(5);
+        } else if (br.readBit()) {  // seconds_flag
+            clock.seconds = br.readBits(6);
+            if (br.readBit()) {  // minutes_flag
+                clock.minutes = br.readBits(6);
+                if (br.readBit()) {  // hours_flag
+                    clock.hours = br.readBits(5);
+                }
+            }
+        }
+        clock.timeOffset = 0;
+        if (sps.timeOffsetLength > 0) {
+            uint32_t raw = br.readBits(sps.timeOffsetLength);
+            // time_offset 是有符号数
+            uint32_t sign = 1u << (sps.timeOffsetLength - 1);
+            clock.timeOffset = (int32_t)(raw ^ sign) - (int32_t)sign;
+        }
+        if (br.overrun()) {
+            return false;
+        }
+        clock.valid = true;
+        return true;
+    }
+    return false;
+}
+
+bool h264ParsePicTimingClock(const uint8_t* nal, int size, const H264Sps& sps, H264ClockTimestamp& clock) {
+    if (!nal || size < 2 || (nal[0] & 0x1F) != 6 || !sps.valid || !sps.timingInfoPresent || !sps.picStructPresent) {
+        return false;
+    }
+    // time_scale 或 num_units_in_tick 为 0 的 VUI 无法换算时间，调用方会以 time_scale 作除数
+    if (sps.timeScale == 0 || sps.numUnitsInTick == 0) {
+        return false;
+    }
+    H264BitReader br(nal + 1, size - 1);
+    // 逐条读取 sei_message：payloadType 和 payloadSize 都是 0xFF 累加的变长编码
+    while (br.bitsLeft() > 16 && !br.overrun()) {
+        uint32_t payloadType = 0;
+        uint32_t byte;
+        while ((byte = br.readBits(8)) == 0xFF) {
+            payloadType += 255;
+        }
+        payloadType += byte;
+        uint32_t payloadSize = 0;
+        while ((byte = br.readBits(8)) == 0xFF) {
+            payloadSize += 255;
+        }
+        payloadSize += byte;
+        if (br.overrun()) {
+            return false;
+        }
+        if (payloadType == 1) {
+            return parsePicTiming(br, sps, clock);
+        }
+        br.skipBits((int)payloadSize * 8);
+    }
+    return false;
+}
+
+int64_t h264ClockTimestampTicks(const H264ClockTimestamp& clock, const H264Sps& sps) {
+    const int64_t seconds = ((int64_t)clock.hours * 60 + clock.minutes) * 60 + clock.seconds;
+    return seconds * sps.timeScale + (int64_t)clock.nFrames * sps.numUnitsInTick * (clock.fieldBased ? 2 : 1) +
+           clock.timeOffset;
+}
@@ -0,0 +1,134 @@
+#ifndef H264_BITSTREAM_H
+#define H264_BITSTREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// 去掉防竞争字节 (00 00 03) 后的 RBSP 位读取器
+class H264BitReader {
+public:
+    // maxBytes > 0 时只去除前 maxBytes 个字节的防竞争字节，只读头部字段时避免拷贝整个 slice
+    H264BitReader(const uint8_t* nal, int size, int maxBytes = 0);
+
+    uint32_t readBits(int n);
+    bool readBit() { return readBits(1) != 0; }
+    uint32_t readUe();
+    int32_t readSe();
+    void skipBits(int n);
+    bool overrun() const { return m_overrun; }
+    int bitsLeft() const { return (int)m_rbsp.size() * 8 - (int)m_pos; }
+
+private:
+    std::vector<uint8_t> m_rbsp;
+    size_t m_pos;
+    bool m_overrun;
+};
+
+// SPS 中解码、封装和时间戳需要的字段
+struct H264Sps {
+    bool valid = false;
+    uint8_t profileIdc = 0;
+    uint8_t constraintFlags = 0;
+    uint8_t levelIdc = 0;
+    uint32_t spsId = 0;
+    uint32_t chromaFormatIdc = 1;
+    bool separateColourPlane = false;
+    uint32_t log2MaxFrameNum = 4;
+    uint32_t picOrderCntType = 0;
+    uint32_t log2MaxPocLsb = 4;
+    bool deltaPicOrderAlwaysZero = false;
+    uint32_t maxNumRefFrames = 0;
+    bool gapsInFrameNumAllowed = false;
+    bool frameMbsOnly = true;
+    int width = 0;
+    int height = 0;
+    uint32_t picSizeInMbs = 0;  // 一帧的宏块数
+    // VUI timing_info
+    bool timingInfoPresent = false;
+    uint32_t numUnitsInTick = 0;
+    uint32_t timeScale = 0;
+    bool fixedFrameRate = false;
+    // 解析 pic_timing SEI 需要的 HRD 字段
+    bool cpbDpbDelaysPresent = false;
+    uint32_t cpbRemovalDelayLength = 24;
+    uint32_t dpbOutputDelayLength = 24;
+    uint32_t timeOffsetLength = 24;
+    bool picStructPresent = false;
+};
+
+// 解析 SPS NAL（data 指向 NAL 头，不含起始码）
+bool h264ParseSps(const uint8_t* nal, int size, H264Sps& sps);
+
+// PPS 中解析 slice 头需要的字段
+struct H264Pps {
+    bool valid = false;
+    uint32_t ppsId = 0;
+    uint32_t spsId = 0;
+    bool entropyCodingMode = false;  // true 为 CABAC
+    bool bottomFieldPicOrderPresent = false;
+    uint32_t numSliceGroups = 1;
+    uint32_t numRefIdxL0Default = 1;
+    uint32_t numRefIdxL1Default = 1;
+    bool weightedPred = false;
+    uint32_t weightedBipredIdc = 0;
+    bool deblockingFilterControlPresent = false;
+    bool redundantPicCntPresent = false;
+};
+
+// 解析 PPS NAL；使用 slice group（FMO）的 PPS 返回 false
+bool h264ParsePps(const uint8_t* nal, int size, H264Pps& pps);
+
+enum H264SliceType {
+    H264_SLICE_P = 0,
+    H264_SLICE_B = 1,
+    H264_SLICE_I = 2,
+    H264_SLICE_SP = 3,
+    H264_SLICE_SI = 4,
+};
+
+struct H264SliceHeader {
+    uint32_t firstMb = 0;
+    uint32_t sliceType = 0;   // 已对 5 取余，见 H264SliceType
+    uint32_t ppsId = 0;
+    uint32_t frameNum = 0;
+    bool idr = false;
+    uint8_t nalRefIdc = 0;
+    bool fieldPic = false;
+    bool bottomField = false;
+    uint32_t idrPicId = 0;
+    uint32_t pocLsb = 0;
+    int32_t deltaPocBottom = 0;
+    int32_t deltaPoc[2] = {0, 0};
+    bool hasMmco5 = false;    // memory_management_control_operation 5，POC/frame_num 在此之后归零
+    // CAVLC 的 P/B slice 中 slice_data 开头的 mb_skip_run；CABAC 或解析不到时为 -1
+    int32_t firstSkipRun = -1;
+};
+
+// 解析 slice NAL（类型 1 或 5）的 slice 头，sps/pps 必须是该 slice 引用的参数集。
+// 只读取头部附近的字节，代价与 slice 大小无关。
+bool h264ParseSliceHeader(const uint8_t* nal, int size, const H264Sps& sps, const H264Pps& pps, H264SliceHeader& header);
+
+// 只读取 slice 头开头的 pps_id，用于查找对应的参数集
+bool h264PeekSlicePpsId(const uint8_t* nal, int size, uint32_t& ppsId);
+
+// pic_timing SEI 中的 clock timestamp；未携带的时、分、秒沿用上一次的值，调用方需按设备保存
+struct H264ClockTimestamp {
+    bool valid = false;
+    uint32_t hours = 0;
+    uint32_t minutes = 0;
+    uint32_t seconds = 0;
+    uint32_t nFrames = 0;
+    bool fieldBased = false;
+    int32_t timeOffset = 0;
+};
+
+// 在 SEI NAL 中查找 pic_timing 并读取第一个 clock timestamp，成功时返回 true。
+// 只有 SPS 的 VUI 带 timing_info 且 pic_struct_present_flag 为 1 时码流才可能携带；
+// time_scale 或 num_units_in_tick 为 0 时不解析，返回 false。
+bool h264ParsePicTimingClock(const uint8_t* nal, int size, const H264Sps& sps, H264ClockTimestamp& clock);
+
+// clock timestamp 换算成以 time_scale 为单位的时间
+int64_t h264ClockTimestampTicks(const H264ClockTimestamp& clock, const H264Sps& sps);
+
+#endif // H264_BITSTREAM_H
@@ -0,0 +1,131 @@
+#ifndef H264_NAL_H
+#define H264_NAL_H
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+// H.264 NAL 单元类型
+enum H264NalType {
+    H264_NAL_SLICE = 1,
+    H264_NAL_IDR = 5,
+    H264_NAL_SEI = 6,
+    H264_NAL_SPS = 7,
+    H264_NAL_PPS = 8,
+    H264_NAL_AUD = 9,
+};
+
+// Annex-B 码流中的一个 NAL 单元（data 指向起始码之后的 NAL 头）
+struct H264NalUnit {
+    const uint8_t* data;
+    int size;
+    uint8_t type;
+};
+
+// 从 from 开始查找起始码 (00 00 01 或 00 00 00 01)，返回起始码位置，找不到返回 -1
+inline int h264FindStartCode(const uint8_t* data, int length, int from, int* startCodeLen) {
+    for (int i = from; i + 2 < length; i++) {
+        if (data[i] == 0x00 && data[i + 1] == 0x00) {
+            if (data[i + 2] == 0x01) {
+                if (startCodeLen) *startCodeLen = 3;
+                return i;
+            }
+            if (i + 3 < length && data[i + 2] == 0x00 && data[i + 3] == 0x01) {
+                if (startCodeLen) *startCodeLen = 4;
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+// 把一个访问单元拆分成 NAL 单元列表，返回 NAL 个数
+inline int h264SplitNalUnits(const uint8_t* data, int length, std::vector<H264NalUnit>& out) {
+    out.clear();
+    if (!data || length <= 0) {
+        return 0;
+    }
+    int scLen = 0;
+    int pos = h264FindStartCode(data, length, 0, &scLen);
+    while (pos >= 0) {
+        int nalStart = pos + scLen;
+        int nextLen = 0;
+        int next = h264FindStartCode(data, length, nalStart, &nextLen);
+        int nalEnd = next >= 0 ? next : length;
+        // 去掉尾部补零 (trailing_zero_8bits)
+        while (nalEnd > nalStart && data[nalEnd - 1] == 0x00 && next >= 0) {
+            nalEnd--;
+        }
+        if (nalEnd > nalStart) {
+            H264NalUnit nal;
+            nal.data = data + nalStart;
+            nal.size = nalEnd - nalStart;
+            nal.type = data[nalStart] & 0x1F;
+            out.push_back(nal);
+        }
+        pos = next;
+        scLen = nextLen;
+    }
+    return (int)out.size();
+}
+
+// 把 Annex-B 基本流（例如录制的 .h264 文件）切分成访问单元，输出 (偏移, 长度)，返回访问单元个数。
+// 遇到 AUD、或已有 slice 之后出现 SPS/PPS/SEI、或 first_mb_in_slice 为 0 的 slice 时开始新的访问单元。
+inline int h264SplitAccessUnits(const uint8_t* data, int length, std::vector<std::pair<int, int>>& out) {
+    out.clear();
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+    int auStart = -1;
+    bool auHasSlice = false;
+    for (const H264NalUnit& nal : nals) {
+        // 回退到起始码位置，访问单元保留起始码
+        int nalPos = (int)(nal.data - data);
+        nalPos -= (nalPos >= 4 && data[nalPos - 4] == 0x00) ? 4 : 3;
+        const bool isSlice = nal.type == H264_NAL_SLICE || nal.type == H264_NAL_IDR;
+        // first_mb_in_slice 为 ue(v)，值为 0 时编码为单个 1 比特
+        const bool firstSlice = isSlice && nal.size > 1 && (nal.data[1] & 0x80) != 0;
+        const bool startsNew = nal.type == H264_NAL_AUD ||
+                               (auHasSlice && (firstSlice || nal.type == H264_NAL_SPS ||
+                                               nal.type == H264_NAL_PPS || nal.type == H264_NAL_SEI));
+        if (auStart < 0) {
+            auStart = nalPos;
+        } else if (startsNew) {
+            out.push_back(std::make_pair(auStart, nalPos - auStart));
+            auStart = nalPos;
+            auHasSlice = false;
+        }
+        if (isSlice) {
+            auHasSlice = true;
+        }
+    }
+    if (auStart >= 0) {
+        out.push_back(std::make_pair(auStart, length - auStart));
+    }
+    return (int)out.size();
+}
+
+// 访问单元概要信息
+struct H264AccessUnitInfo {
+    bool hasIdr = false;
+    bool hasSlice = false;
+    bool hasSps = false;
+    bool hasPps = false;
+};
+
+inline H264AccessUnitInfo h264InspectAccessUnit(const uint8_t* data, int length) {
+    H264AccessUnitInfo info;
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+    for (const H264NalUnit& nal : nals) {
+        switch (nal.type) {
+            case H264_NAL_IDR: info.hasIdr = true; info.hasSlice = true; break;
+            case H264_NAL_SLICE: info.hasSlice = true; break;
+            case H264_NAL_SPS: info.hasSps = true; break;
+            case H264_NAL_PPS: info.hasPps = true; break;
+            default: break;
+        }
+    }
+    return info;
+}
+
+#endif // H264_NAL_H
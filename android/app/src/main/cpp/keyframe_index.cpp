@@ -0,0 +1,486 @@
+#include "keyframe_index.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <map>
+
+#define LOG_TAG "KeyframeIndex"
+#include "native_log.h"
+
+const size_t KeyframeIndex::kHeaderBytes;
+const size_t KeyframeIndex::kRecordBytes;
+const size_t KeyframeIndex::kGrowRecords;
+
+namespace {
+
+const char kMagic[4] = {'K', 'F', 'I', 'X'};
+const uint32_t kVersion = 1;
+
+// 文件中的记录，按主机字节序（Android 和桌面都是小端）
+struct Record {
+    int64_t timeUs;
+    uint64_t fragmentOffset;
+    uint32_t sampleDelta;     // sampleOffset - fragmentOffset
+    uint32_t sampleSize;
+    uint32_t segmentId;
+    uint32_t checksum;
+};
+static_assert(sizeof(Record) == KeyframeIndex::kRecordBytes, "记录必须是 32 字节");
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordBytes;
+    uint32_t reserved;
+    char devId[48];
+};
+static_assert(sizeof(Header) == KeyframeIndex::kHeaderBytes, "文件头必须是 64 字节");
+
+// FNV-1a，覆盖校验和之前的 28 字节
+uint32_t recordChecksum(const Record& record) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool isEmptyRecord(const uint8_t* p) {
+    for (size_t i = 0; i < KeyframeIndex::kRecordBytes; i++) {
+        if (p[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 录像文件已被删除；所在目录也不存在时（外部存储未挂载）不当作删除
+bool segmentFileRemoved(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 || errno != ENOENT) {
+        return false;
+    }
+    const size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? std::string(".") : path.substr(0, slash > 0 ? slash : 1);
+    return stat(dir.c_str(), &st) == 0;
+}
+
+} // namespace
+
+KeyframeIndex::KeyframeIndex()
+    : m_fd(-1),
+      m_map(nullptr),
+      m_mapBytes(0),
+      m_capacity(0),
+      m_count(0),
+      m_lastTimeUs(0) {
+}
+
+KeyframeIndex::~KeyframeIndex() {
+    close();
+}
+
+bool KeyframeIndex::open(const std::string& dir, const std::string& devId) {
+    close();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (devId.empty() || devId.size() >= sizeof(Header().devId)) {
+        LOGE("open: 设备号不合法: %s", devId.c_str());
+        return false;
+    }
+    const std::string base = (dir.empty() ? std::string(".") : dir) + "/" + devId;
+    const std::string path = base + ".kfi";
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        LOGE("open: %s 失败: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    m_devId = devId;
+    m_indexPath = path;
+    m_segmentsPath = base + ".kfs";
+    m_stats = KeyframeIndexStats();
+    if (!openLocked(path)) {
+        unmapLocked();
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    pruneLocked();
+    LOGI("open: %s, %zu 条记录, %zu 个录像文件, 丢弃残缺记录 %llu", path.c_str(), m_count, m_segments.size(),
+         (unsigned long long)m_stats.recoveredRecords);
+    return true;
+}
+
+bool KeyframeIndex::openLocked(const std::string& path) {
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+        LOGE("open: fstat 失败: %s", strerror(errno));
+        return false;
+    }
+    Header header;
+    if ((size_t)st.st_size < kHeaderBytes) {
+        // 新文件：写文件头，记录区预扩展一块
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.recordBytes = kRecordBytes;
+        strncpy(header.devId, m_devId.c_str(), sizeof(header.devId) - 1);
+        st.st_size = (off_t)(kHeaderBytes + kGrowRecords * kRecordBytes);
+        if (ftruncate(m_fd, 0) != 0 || pwrite(m_fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            ftruncate(m_fd, st.st_size) != 0 || fsync(m_fd) != 0) {
+            LOGE("open: 初始化 %s 失败: %s", path.c_str(), strerror(errno));
+            return false;
+        }
+    } else if (pread(m_fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+               memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+               header.recordBytes != kRecordBytes) {
+        LOGE("open: %s 不是可识别的索引文件", path.c_str());
+        return false;
+    }
+    return mapLocked(((size_t)st.st_size - kHeaderBytes) / kRecordBytes) && recoverLocked() && loadSegmentsLocked();
+}
+
+void KeyframeIndex::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unmapLocked();
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_count = 0;
+    m_lastTimeUs = 0;
+    m_segments.clear();
+    m_segmentValid.clear();
+}
+
+bool KeyframeIndex::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_map != nullptr;
+}
+
+bool KeyframeIndex::mapLocked(size_t capacity) {
+    unmapLocked();
+    const size_t bytes = kHeaderBytes + capacity * kRecordBytes;
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        LOGE("mmap %zu 字节失败: %s", bytes, strerror(errno));
+        return false;
+    }
+    m_map = static_cast<uint8_t*>(map);
+    m_mapBytes = bytes;
+    m_capacity = capacity;
+    return true;
+}
+
+void KeyframeIndex::unmapLocked() {
+    if (m_map) {
+        munmap(m_map, m_mapBytes);
+        m_map = nullptr;
+        m_mapBytes = 0;
+        m_capacity = 0;
+    }
+}
+
+// 记录只追加，非空记录总是连续的前缀：二分找第一条全零记录，再从尾部去掉校验失败的记录
+bool KeyframeIndex::recoverLocked() {
+    uint8_t* records = m_map + kHeaderBytes;
+    size_t lo = 0;
+    size_t hi = m_capacity;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (isEmptyRecord(records + mid * kRecordBytes)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    m_count = lo;
+    while (m_count > 0) {
+        Record record;
+        memcpy(&record, records + (m_count - 1) * kRecordBytes, sizeof(record));
+        if (record.checksum == recordChecksum(record)) {
+            m_lastTimeUs = record.timeUs;
+            break;
+        }
+        memset(records + (m_count - 1) * kRecordBytes, 0, kRecordBytes);
+        m_count--;
+        m_stats.recoveredRecords++;
+    }
+    if (m_stats.recoveredRecords > 0) {
+        msync(m_map, m_mapBytes, MS_SYNC);
+        LOGW("丢弃 %llu 条残缺的尾部记录", (unsigned long long)m_stats.recoveredRecords);
+    }
+    return true;
+}
+
+// 末尾没有换行的行是写到一半崩溃留下的，截掉；同一路径出现多次时只有最后一次有效
+bool KeyframeIndex::loadSegmentsLocked() {
+    m_segments.clear();
+    m_segmentValid.clear();
+    FILE* file = fopen(m_segmentsPath.c_str(), "rb");
+    if (!file) {
+        return errno == ENOENT;
+    }
+    std::string content;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.append(buffer, n);
+    }
+    fclose(file);
+
+    size_t start = 0;
+    size_t end;
+    while ((end = content.find('\n', start)) != std::string::npos) {
+        m_segments.push_back(content.substr(start, end - start));
+        start = end + 1;
+    }
+    if (start < content.size() && truncate(m_segmentsPath.c_str(), (off_t)start) != 0) {
+        LOGW("截断 %s 失败: %s", m_segmentsPath.c_str(), strerror(errno));
+    }
+    m_segmentValid.assign(m_segments.size(), true);
+    std::map<std::string, size_t> lastSeen;
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        auto it = lastSeen.find(m_segments[i]);
+        if (it != lastSeen.end()) {
+            m_segmentValid[it->second] = false;
+            it->second = i;
+        } else {
+            lastSeen[m_segments[i]] = i;
+        }
+    }
+    return true;
+}
+
+bool KeyframeIndex::beginSegment(const std::string& path, uint32_t* segmentId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_map || path.empty() || path.find('\n') != std::string::npos) {
+        return false;
+    }
+    // 录像文件打开时已截断，同一路径之前的记录指向的数据不存在了
+    if (invalidateLocked(path)) {
+        compactLocked();
+    }
+    // 文件路径先落盘，之后追加的记录才会引用它
+    const int fd = ::open(m_segmentsPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGE("beginSegment: 打开 %s 失败: %s", m_segmentsPath.c_str(), strerror(errno));
+        return false;
+    }
+    const std::string line = path + "\n";
+    const bool ok = write(fd, line.data(), line.size()) == (ssize_t)line.size() && fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        LOGE("beginSegment: 写入 %s 失败: %s", m_segmentsPath.c_str(), strerror(errno));
+        return false;
+    }
+    m_segments.push_back(path);
+    m_segmentValid.push_back(true);
+    if (segmentId) {
+        *segmentId = (uint32_t)(m_segments.size() - 1);
+    }
+    return true;
+}
+
+size_t KeyframeIndex::removeSegment(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_map || !invalidateLocked(path)) {
+        return 0;
+    }
+    return compactLocked();
+}
+
+size_t KeyframeIndex::prune() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_map ? pruneLocked() : 0;
+}
+
+bool KeyframeIndex::invalidateLocked(const std::string& path) {
+    bool changed = false;
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        if (m_segmentValid[i] && m_segments[i] == path) {
+            m_segmentValid[i] = false;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+size_t KeyframeIndex::pruneLocked() {
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        if (m_segmentValid[i] && segmentFileRemoved(m_segments[i])) {
+            m_segmentValid[i] = false;
+        }
+    }
+    return compactLocked();
+}
+
+// 把引用有效录像文件的记录按原顺序写进临时文件，再改名替换索引文件，中途崩溃时原索引不受影响。
+// segmentId 不变，.kfs 不用重写；返回删掉的记录数
+size_t KeyframeIndex::compactLocked() {
+    const uint8_t* records = m_map + kHeaderBytes;
+    std::vector<uint8_t> kept;
+    int64_t lastTimeUs = 0;
+    for (size_t i = 0; i < m_count; i++) {
+        const uint8_t* p = records + i * kRecordBytes;
+        uint32_t segmentId;
+        memcpy(&segmentId, p + offsetof(Record, segmentId), sizeof(segmentId));
+        if (segmentId < m_segmentValid.size() && m_segmentValid[segmentId]) {
+            kept.insert(kept.end(), p, p + kRecordBytes);
+            memcpy(&lastTimeUs, p + offsetof(Record, timeUs), sizeof(lastTimeUs));
+        }
+    }
+    const size_t keptCount = kept.size() / kRecordBytes;
+    const size_t removed = m_count - keptCount;
+    if (removed == 0) {
+        return 0;
+    }
+
+    const size_t capacity = (keptCount / kGrowRecords + 1) * kGrowRecords;
+    const std::string tmpPath = m_indexPath + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    const bool ok = fd >= 0 && pwrite(fd, m_map, kHeaderBytes, 0) == (ssize_t)kHeaderBytes &&
+                    (kept.empty() || pwrite(fd, kept.data(), kept.size(), kHeaderBytes) == (ssize_t)kept.size()) &&
+                    ftruncate(fd, (off_t)(kHeaderBytes + capacity * kRecordBytes)) == 0 && fsync(fd) == 0 &&
+                    rename(tmpPath.c_str(), m_indexPath.c_str()) == 0;
+    if (!ok) {
+        LOGE("compact: 重写 %s 失败: %s", m_indexPath.c_str(), strerror(errno));
+        if (fd >= 0) {
+            ::close(fd);
+            unlink(tmpPath.c_str());
+        }
+        return 0;
+    }
+    unmapLocked();
+    ::close(m_fd);
+    m_fd = fd;
+    if (!mapLocked(capacity)) {
+        m_count = 0;
+        return removed;
+    }
+    m_count = keptCount;
+    m_lastTimeUs = keptCount > 0 ? lastTimeUs : 0;
+    m_stats.prunedRecords += removed;
+    LOGI("compact: 删除 %zu 条失效记录，剩余 %zu 条", removed, keptCount);
+    return removed;
+}
+
+bool KeyframeIndex::append(const KeyframeEntry& entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_map || entry.segmentId >= m_segments.size() || entry.sampleOffset < entry.fragmentOffset ||
+        entry.sampleOffset - entry.fragmentOffset > UINT32_MAX) {
+        return false;
+    }
+    if (m_count == m_capacity) {
+        // 先扩展文件再重新映射，扩展出的部分全为零
+        const size_t capacity = m_capacity + kGrowRecords;
+        if (ftruncate(m_fd, (off_t)(kHeaderBytes + capacity * kRecordBytes)) != 0 || !mapLocked(capacity)) {
+            LOGE("append: 扩展索引失败: %s", strerror(errno));
+            if (!m_map) {
+                mapLocked(m_count);
+            }
+            return false;
+        }
+    }
+
+    Record record;
+    memset(&record, 0, sizeof(record));
+    record.timeUs = entry.timeUs;
+    if (m_count > 0 && record.timeUs < m_lastTimeUs) {
+        // 墙上时间被回拨：按上一条的时间写入，保持有序
+        record.timeUs = m_lastTimeUs;
+        m_stats.clampedRecords++;
+    }
+    record.fragmentOffset = entry.fragmentOffset;
+    record.sampleDelta = (uint32_t)(entry.sampleOffset - entry.fragmentOffset);
+    record.sampleSize = entry.sampleSize;
+    record.segmentId = entry.segmentId;
+    record.checksum = recordChecksum(record);
+
+    uint8_t* p = m_map + kHeaderBytes + m_count * kRecordBytes;
+    memcpy(p, &record, sizeof(record));
+    // 只同步记录所在的页
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    const size_t offset = (size_t)(p - m_map);
+    const size_t pageStart = offset - offset % (size_t)pageSize;
+    msync(m_map + pageStart, offset + kRecordBytes - pageStart, MS_SYNC);
+    m_count++;
+    m_lastTimeUs = record.timeUs;
+    return true;
+}
+
+size_t KeyframeIndex::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+bool KeyframeIndex::readLocked(size_t index, KeyframeEntry* entry) const {
+    if (!m_map || index >= m_count) {
+        return false;
+    }
+    Record record;
+    memcpy(&record, m_map + kHeaderBytes + index * kRecordBytes, sizeof(record));
+    if (entry) {
+        entry->timeUs = record.timeUs;
+        entry->segmentId = record.segmentId;
+        entry->fragmentOffset = record.fragmentOffset;
+        entry->sampleOffset = record.fragmentOffset + record.sampleDelta;
+        entry->sampleSize = record.sampleSize;
+    }
+    return true;
+}
+
+bool KeyframeIndex::entryAt(size_t index, KeyframeEntry* entry) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return readLocked(index, entry);
+}
+
+long KeyframeIndex::seek(int64_t timeUs, KeyframeEntry* entry) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_map || m_count == 0) {
+        return -1;
+    }
+    // 第一条 timeUs 大于目标的记录，它的前一条即所求
+    const uint8_t* records = m_map + kHeaderBytes;
+    size_t lo = 0;
+    size_t hi = m_count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        int64_t midTimeUs;
+        memcpy(&midTimeUs, records + mid * kRecordBytes + offsetof(Record, timeUs), sizeof(midTimeUs));
+        if (midTimeUs <= timeUs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const size_t index = lo > 0 ? lo - 1 : 0;
+    readLocked(index, entry);
+    return (long)index;
+}
+
+std::string KeyframeIndex::segmentPath(uint32_t segmentId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return segmentId < m_segments.size() && m_segmentValid[segmentId] ? m_segments[segmentId] : std::string();
+}
+
+KeyframeIndexStats KeyframeIndex::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    KeyframeIndexStats result = m_stats;
+    result.entries = m_count;
+    result.segments = m_segments.size();
+    result.fileBytes = m_mapBytes;
+    KeyframeEntry entry;
+    if (readLocked(0, &entry)) {
+        result.firstTimeUs = entry.timeUs;
+    }
+    if (m_count > 0) {
+        result.lastTimeUs = m_lastTimeUs;
+    }
+    return result;
+}
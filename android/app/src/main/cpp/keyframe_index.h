@@ -0,0 +1,93 @@
+#ifndef KEYFRAME_INDEX_H
+#define KEYFRAME_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 一个 IDR 在录像文件里的位置
+struct KeyframeEntry {
+    int64_t timeUs = 0;           // 墙上时间（Unix 纪元微秒）
+    uint32_t segmentId = 0;       // 录像文件编号，见 KeyframeIndex::segmentPath
+    uint64_t fragmentOffset = 0;  // IDR 所在 fMP4 分片（moof）的文件偏移，按 1 倍速播放从这里开始
+    uint64_t sampleOffset = 0;    // IDR 样本（4 字节长度前缀的 NAL）在 mdat 中的文件偏移
+    uint32_t sampleSize = 0;
+};
+
+struct KeyframeIndexStats {
+    uint64_t entries = 0;
+    uint64_t segments = 0;
+    uint64_t recoveredRecords = 0;  // 打开时丢弃的残缺尾部记录
+    uint64_t clampedRecords = 0;    // 墙上时间回拨、按上一条时间写入的记录
+    uint64_t prunedRecords = 0;     // 录像文件被重新录制或删除后删掉的记录
+    int64_t firstTimeUs = 0;
+    int64_t lastTimeUs = 0;
+    uint64_t fileBytes = 0;
+};
+
+// 录像关键帧索引：每个设备一个只追加的索引文件 <dir>/<devId>.kfi，整个映射进内存。
+// 文件头之后是定长 32 字节记录，按墙上时间递增，查找时二分，不扫描录像文件。
+// 每条记录带校验和；文件按块预扩展，扩展出的部分全为零，打开时二分找到第一条全零记录即得记录数，
+// 再丢弃末尾校验失败的残缺记录，崩溃或掉电后不需要重建。
+// 录像文件路径按出现顺序逐行记在 <dir>/<devId>.kfs，行号即记录中的 segmentId。
+// 录像按路径截断重写，同一路径只有最后一次出现有效；引用失效或已删除文件的记录通过重写索引文件删掉。
+class KeyframeIndex {
+public:
+    static const size_t kHeaderBytes = 64;
+    static const size_t kRecordBytes = 32;
+    static const size_t kGrowRecords = 4096;   // 每次扩展 128KB
+
+    KeyframeIndex();
+    ~KeyframeIndex();
+
+    bool open(const std::string& dir, const std::string& devId);
+    void close();
+    bool isOpen() const;
+
+    // 开始写一个录像文件（打开时已截断），返回新的 segmentId；同一路径之前的记录随之删除
+    bool beginSegment(const std::string& path, uint32_t* segmentId);
+    // 录像文件被删除或即将截断重写：删除引用它的记录，返回删除的条数
+    size_t removeSegment(const std::string& path);
+    // 删除所引用录像文件已不存在的记录，返回删除的条数；open 时执行一次
+    size_t prune();
+
+    // 录像写线程调用：IDR 所在分片落盘之后再追加，索引不会指向文件中不存在的数据
+    bool append(const KeyframeEntry& entry);
+
+    size_t size() const;
+    bool entryAt(size_t index, KeyframeEntry* entry) const;
+    // 不晚于 timeUs 的最近一个关键帧；timeUs 早于第一条时返回第一条。返回记录下标，索引为空时返回 -1
+    long seek(int64_t timeUs, KeyframeEntry* entry) const;
+    std::string segmentPath(uint32_t segmentId) const;
+
+    KeyframeIndexStats stats() const;
+
+private:
+    bool openLocked(const std::string& path);
+    bool mapLocked(size_t capacity);
+    void unmapLocked();
+    bool loadSegmentsLocked();
+    bool recoverLocked();
+    bool readLocked(size_t index, KeyframeEntry* entry) const;
+    bool invalidateLocked(const std::string& path);
+    size_t pruneLocked();
+    size_t compactLocked();
+
+    mutable std::mutex m_mutex;
+    std::string m_devId;
+    std::string m_indexPath;
+    std::string m_segmentsPath;
+    int m_fd;
+    uint8_t* m_map;
+    size_t m_mapBytes;
+    size_t m_capacity;
+    size_t m_count;
+    int64_t m_lastTimeUs;
+    std::vector<std::string> m_segments;
+    std::vector<bool> m_segmentValid;   // 与 m_segments 对应，false 表示文件已重新录制或删除
+    KeyframeIndexStats m_stats;
+};
+
+#endif // KEYFRAME_INDEX_H
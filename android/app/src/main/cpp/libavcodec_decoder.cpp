@@ -0,0 +1,152 @@
+// libavcodec 软解后端，只在构建时找到 libavcodec 的平台（Linux 桌面）编译
+
+#include "video_decoder.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+#define LOG_TAG "LibavcodecDecoder"
+#include "native_log.h"
+
+namespace {
+
+class LibavcodecDecoder : public VideoDecoder {
+public:
+    LibavcodecDecoder() : m_context(nullptr), m_frame(nullptr), m_packet(nullptr) {}
+
+    ~LibavcodecDecoder() override {
+        close();
+    }
+
+    const char* name() const override {
+        return "libavcodec";
+    }
+
+    bool open(const VideoDecoderConfig& config, const DecodedFrameCallback& callback) override {
+        close();
+        const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+        if (!codec) {
+            LOGE("open: 未找到 H.264 解码器");
+            return false;
+        }
+        m_context = avcodec_alloc_context3(codec);
+        m_frame = av_frame_alloc();
+        m_packet = av_packet_alloc();
+        if (!m_context || !m_frame || !m_packet) {
+            close();
+            return false;
+        }
+
+        // thread_count 为 0 时 libavcodec 按 CPU 核数创建线程
+        m_context->thread_count = config.threads > 0 ? config.threads : 0;
+        if (config.lowDelay) {
+            m_context->thread_type = FF_THREAD_SLICE;
+            m_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        } else {
+            m_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+        int ret = avcodec_open2(m_context, codec, nullptr);
+        if (ret < 0) {
+            LOGE("open: avcodec_open2 失败 %d", ret);
+            close();
+            return false;
+        }
+        m_callback = callback;
+        m_stats = VideoDecoderStats();
+        m_stats.threads = m_context->thread_count;
+        LOGI("open: threads=%d, %s", m_context->thread_count, config.lowDelay ? "slice" : "frame+slice");
+        return true;
+    }
+
+    bool decode(const uint8_t* data, int length, int64_t ptsUs) override {
+        if (!m_context || !data || length <= 0) {
+            return false;
+        }
+        // 非引用计数的数据，send_packet 内部会拷贝
+        m_packet->data = const_cast<uint8_t*>(data);
+        m_packet->size = length;
+        m_packet->pts = ptsUs;
+        int ret = avcodec_send_packet(m_context, m_packet);
+        if (ret == AVERROR(EAGAIN)) {
+            // 输出队列已满，包没有被接收：先取走已解码的帧再重新送同一个包
+            receiveFrames();
+            ret = avcodec_send_packet(m_context, m_packet);
+        }
+        m_packet->data = nullptr;
+        m_packet->size = 0;
+        m_stats.packets++;
+        if (ret < 0) {
+            m_stats.errors++;
+            return false;
+        }
+        receiveFrames();
+        return true;
+    }
+
+    void flush() override {
+        if (!m_context) {
+            return;
+        }
+        avcodec_send_packet(m_context, nullptr);
+        receiveFrames();
+        avcodec_flush_buffers(m_context);
+    }
+
+    void close() override {
+        if (m_packet) {
+            av_packet_free(&m_packet);
+        }
+        if (m_frame) {
+            av_frame_free(&m_frame);
+        }
+        if (m_context) {
+            avcodec_free_context(&m_context);
+        }
+        m_callback = nullptr;
+    }
+
+    VideoDecoderStats stats() const override {
+        return m_stats;
+    }
+
+private:
+    void receiveFrames() {
+        // 输出帧引用 libavcodec 内部缓冲池的缓冲，unref 后回到池中复用
+        while (avcodec_receive_frame(m_context, m_frame) == 0) {
+            if (m_frame->format == AV_PIX_FMT_YUV420P || m_frame->format == AV_PIX_FMT_YUVJ420P) {
+                DecodedFrame out;
+                out.planes.y = m_frame->data[0];
+                out.planes.u = m_frame->data[1];
+                out.planes.v = m_frame->data[2];
+                out.planes.yRowStride = m_frame->linesize[0];
+                out.planes.uvRowStride = m_frame->linesize[1];
+                out.planes.uvPixelStride = 1;
+                out.planes.width = m_frame->width;
+                out.planes.height = m_frame->height;
+                out.ptsUs = m_frame->pts;
+                m_stats.frames++;
+                if (m_callback) {
+                    m_callback(out);
+                }
+            } else {
+                // 高位深等格式暂不支持
+                m_stats.errors++;
+            }
+            av_frame_unref(m_frame);
+        }
+    }
+
+    AVCodecContext* m_context;
+    AVFrame* m_frame;
+    AVPacket* m_packet;
+    DecodedFrameCallback m_callback;
+    VideoDecoderStats m_stats;
+};
+
+} // namespace
+
+std::unique_ptr<VideoDecoder> createLibavcodecDecoder() {
+    return std::unique_ptr<VideoDecoder>(new LibavcodecDecoder());
+}
@@ -0,0 +1,173 @@
+// AAC 解码后端，使用 NDK MediaCodec，只在 Android 构建中编译
+
+#include "audio_codec.h"
+
+#include <string.h>
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaFormat.h>
+
+#define LOG_TAG "MediaCodecAudio"
+#include "native_log.h"
+
+namespace {
+
+const int64_t kInputTimeoutUs = 10000;
+
+class MediaCodecAacDecoder : public AudioDecoder {
+public:
+    MediaCodecAacDecoder() : m_codec(nullptr), m_sampleRate(0), m_channels(0), m_ptsUs(0) {}
+
+    ~MediaCodecAacDecoder() override {
+        close();
+    }
+
+    const char* name() const override {
+        return "mediacodec";
+    }
+
+    // 编解码器要等第一帧的 ADTS 头才知道采样率和声道数，在 decode 里创建
+    bool open(AudioCodec codec, int sampleRate) override {
+        close();
+        m_stats = AudioDecoderStats();
+        return codec == AUDIO_CODEC_AAC;
+    }
+
+    bool decode(const uint8_t* data, int length, std::vector<int16_t>& pcm, int* sampleRate) override {
+        AdtsHeader header;
+        if (!parseAdtsHeader(data, length, header) || header.frameLength > length) {
+            m_stats.errors++;
+            return false;
+        }
+        if (!m_codec || header.profile != m_header.profile || header.sampleRate != m_header.sampleRate ||
+            header.channels != m_header.channels) {
+            if (!start(header)) {
+                m_stats.errors++;
+                return false;
+            }
+        }
+
+        // MediaCodec 只接受去掉 ADTS 头的原始帧
+        const ssize_t inputIndex = AMediaCodec_dequeueInputBuffer(m_codec, kInputTimeoutUs);
+        if (inputIndex < 0) {
+            m_stats.errors++;
+            return false;
+        }
+        size_t capacity = 0;
+        uint8_t* input = AMediaCodec_getInputBuffer(m_codec, inputIndex, &capacity);
+        const int payload = header.frameLength - header.headerLength;
+        if (!input || (size_t)payload > capacity) {
+            AMediaCodec_queueInputBuffer(m_codec, inputIndex, 0, 0, m_ptsUs, 0);
+            m_stats.errors++;
+            return false;
+        }
+        memcpy(input, data + header.headerLength, payload);
+        AMediaCodec_queueInputBuffer(m_codec, inputIndex, 0, payload, m_ptsUs, 0);
+        // 每帧 1024 个样本
+        m_ptsUs += 1024LL * 1000000 / header.sampleRate;
+        m_stats.packets++;
+
+        drain(pcm);
+        if (sampleRate) {
+            *sampleRate = m_sampleRate;
+        }
+        return true;
+    }
+
+    void close() override {
+        if (m_codec) {
+            AMediaCodec_stop(m_codec);
+            AMediaCodec_delete(m_codec);
+            m_codec = nullptr;
+        }
+    }
+
+    AudioDecoderStats stats() const override {
+        return m_stats;
+    }
+
+private:
+    bool start(const AdtsHeader& header) {
+        close();
+        m_codec = AMediaCodec_createDecoderByType("audio/mp4a-latm");
+        if (!m_codec) {
+            LOGE("创建 AAC 解码器失败");
+            return false;
+        }
+        uint8_t config[2];
+        adtsAudioSpecificConfig(header, config);
+        AMediaFormat* format = AMediaFormat_new();
+        AMediaFormat_setString(format, AMEDIAFORMAT_KEY_MIME, "audio/mp4a-latm");
+        AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, header.sampleRate);
+        AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, header.channels);
+        AMediaFormat_setBuffer(format, "csd-0", config, sizeof(config));
+        media_status_t status = AMediaCodec_configure(m_codec, format, nullptr, nullptr, 0);
+        AMediaFormat_delete(format);
+        if (status != AMEDIA_OK || AMediaCodec_start(m_codec) != AMEDIA_OK) {
+            LOGE("AAC 解码器配置失败: %d", (int)status);
+            AMediaCodec_delete(m_codec);
+            m_codec = nullptr;
+            return false;
+        }
+        m_header = header;
+        m_sampleRate = header.sampleRate;
+        m_channels = header.channels > 0 ? header.channels : 1;
+        LOGI("AAC 解码器启动: profile=%d %dHz %d 声道", header.profile, header.sampleRate, header.channels);
+        return true;
+    }
+
+    // 取出所有已解码的输出，多声道取平均混成单声道
+    void drain(std::vector<int16_t>& pcm) {
+        for (;;) {
+            AMediaCodecBufferInfo info;
+            const ssize_t index = AMediaCodec_dequeueOutputBuffer(m_codec, &info, 0);
+            if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+                AMediaFormat* format = AMediaCodec_getOutputFormat(m_codec);
+                int32_t value = 0;
+                if (AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &value) && value > 0) {
+                    m_sampleRate = value;
+                }
+                if (AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &value) && value > 0) {
+                    m_channels = value;
+                }
+                AMediaFormat_delete(format);
+                continue;
+            }
+            if (index == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+                continue;
+            }
+            if (index < 0) {
+                break;
+            }
+            size_t size = 0;
+            const uint8_t* output = AMediaCodec_getOutputBuffer(m_codec, index, &size);
+            if (output && info.size > 0) {
+                const int16_t* samples = reinterpret_cast<const int16_t*>(output + info.offset);
+                const int frames = info.size / (2 * m_channels);
+                const size_t base = pcm.size();
+                pcm.resize(base + frames);
+                for (int i = 0; i < frames; i++) {
+                    int sum = 0;
+                    for (int c = 0; c < m_channels; c++) {
+                        sum += samples[i * m_channels + c];
+                    }
+                    pcm[base + i] = (int16_t)(sum / m_channels);
+                }
+                m_stats.samples += frames;
+            }
+            AMediaCodec_releaseOutputBuffer(m_codec, index, false);
+        }
+    }
+
+    AMediaCodec* m_codec;
+    AdtsHeader m_header;
+    int m_sampleRate;
+    int m_channels;
+    int64_t m_ptsUs;
+    AudioDecoderStats m_stats;
+};
+
+} // namespace
+
+std::unique_ptr<AudioDecoder> createMediaCodecAacDecoder() {
+    return std::unique_ptr<AudioDecoder>(new MediaCodecAacDecoder());
+}
@@ -0,0 +1,288 @@
+#include "mosaic_compositor.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "MosaicCompositor"
+#include "native_log.h"
+
+MosaicCompositor::MosaicCompositor()
+    : m_running(false),
+      m_stop(false),
+      m_width(0),
+      m_height(0),
+      m_anyDirty(false),
+      m_fullRedraw(false) {
+}
+
+MosaicCompositor::~MosaicCompositor() {
+    detach();
+}
+
+bool MosaicCompositor::attach(ANativeWindow* window, int columns, int rows, int width, int height, int fps) {
+    if (!window || columns <= 0 || rows <= 0 || width < columns || height < rows) {
+        return false;
+    }
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (m_running.load()) {
+        LOGW("attach: already attached");
+        return false;
+    }
+    if (ANativeWindow_setBuffersGeometry(window, width, height, WINDOW_FORMAT_RGBA_8888) != 0) {
+        LOGE("attach: setBuffersGeometry %dx%d failed", width, height);
+        return false;
+    }
+
+    {
+        // 按行优先划分格子，边界按比例取整，保证格子无缝覆盖整个画布
+        std::lock_guard<std::mutex> lock(m_tilesMutex);
+        m_tiles.clear();
+        for (int row = 0; row < rows; row++) {
+            for (int col = 0; col < columns; col++) {
+                std::shared_ptr<Tile> tile = std::make_shared<Tile>();
+                tile->x = col * width / columns;
+                tile->y = row * height / rows;
+                tile->width = (col + 1) * width / columns - tile->x;
+                tile->height = (row + 1) * height / rows - tile->y;
+                tile->pixels.resize((size_t)tile->width * tile->height * 4);
+                clearTileLocked(*tile);
+                m_tiles.push_back(tile);
+            }
+        }
+        // 保留仍落在新格子范围内的设备分配
+        for (auto it = m_deviceTiles.begin(); it != m_deviceTiles.end();) {
+            if (it->second >= (int)m_tiles.size()) {
+                it = m_deviceTiles.erase(it);
+            } else {
+                m_tiles[it->second]->devId = it->first;
+                ++it;
+            }
+        }
+        m_width = width;
+        m_height = height;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = false;
+    }
+    m_fullRedraw.store(true);
+    ANativeWindow_acquire(window);
+    m_running.store(true);
+    m_thread = std::thread(&MosaicCompositor::composeLoop, this, window, std::max(1, std::min(fps, 120)));
+    LOGI("attach: %dx%d, %dx%d tiles, %d fps", width, height, columns, rows, fps);
+    return true;
+}
+
+void MosaicCompositor::detach() {
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wakeCond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false);
+}
+
+bool MosaicCompositor::assignTile(const std::string& devId, int index) {
+    if (devId.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_tilesMutex);
+    if (index < 0 || (!m_tiles.empty() && index >= (int)m_tiles.size())) {
+        return false;
+    }
+    // 目标格子原有的设备和该设备原来的格子都要让出来
+    for (auto it = m_deviceTiles.begin(); it != m_deviceTiles.end();) {
+        if (it->first == devId || it->second == index) {
+            if (it->second < (int)m_tiles.size()) {
+                Tile& old = *m_tiles[it->second];
+                std::lock_guard<std::mutex> tileLock(old.mutex);
+                old.devId.clear();
+                clearTileLocked(old);
+            }
+            it = m_deviceTiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_deviceTiles[devId] = index;
+    if (index < (int)m_tiles.size()) {
+        std::lock_guard<std::mutex> tileLock(m_tiles[index]->mutex);
+        m_tiles[index]->devId = devId;
+    }
+    m_anyDirty.store(true);
+    return true;
+}
+
+void MosaicCompositor::removeTile(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_tilesMutex);
+    auto it = m_deviceTiles.find(devId);
+    if (it == m_deviceTiles.end()) {
+        return;
+    }
+    if (it->second < (int)m_tiles.size()) {
+        Tile& tile = *m_tiles[it->second];
+        std::lock_guard<std::mutex> tileLock(tile.mutex);
+        tile.devId.clear();
+        clearTileLocked(tile);
+        m_anyDirty.store(true);
+    }
+    m_deviceTiles.erase(it);
+}
+
+bool MosaicCompositor::hasTile(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_tilesMutex);
+    return m_deviceTiles.find(devId) != m_deviceTiles.end();
+}
+
+bool MosaicCompositor::submitFrame(const std::string& devId, const Yuv420Planes& planes) {
+    if (!m_running.load() || !planes.y || !planes.u || !planes.v || planes.width <= 0 || planes.height <= 0) {
+        return false;
+    }
+    std::shared_ptr<Tile> tile;
+    {
+        std::lock_guard<std::mutex> lock(m_tilesMutex);
+        auto it = m_deviceTiles.find(devId);
+        if (it == m_deviceTiles.end() || it->second >= (int)m_tiles.size()) {
+            return false;
+        }
+        tile = m_tiles[it->second];
+    }
+
+    {
+        // 缩放在送帧线程完成，只处理格子大小的像素，合成线程只做拷贝
+        std::lock_guard<std::mutex> tileLock(tile->mutex);
+        if (tile->devId != devId) {
+            return false;
+        }
+        yuv420ToRgbaScale(planes, tile->pixels.data(), tile->width * 4, tile->width, tile->height, YUV_DST_RGBA);
+        tile->dirty = true;
+    }
+    m_anyDirty.store(true);
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.submittedFrames++;
+    return true;
+}
+
+MosaicCompositor::Stats MosaicCompositor::stats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+void MosaicCompositor::clearTileLocked(Tile& tile) {
+    // 不透明黑色
+    uint8_t* p = tile.pixels.data();
+    const size_t count = tile.pixels.size() / 4;
+    for (size_t i = 0; i < count; i++) {
+        p[i * 4] = 0;
+        p[i * 4 + 1] = 0;
+        p[i * 4 + 2] = 0;
+        p[i * 4 + 3] = 255;
+    }
+    tile.dirty = true;
+}
+
+void MosaicCompositor::composeLoop(ANativeWindow* window, int fps) {
+    const std::chrono::microseconds interval(1000000 / fps);
+    auto next = std::chrono::steady_clock::now();
+    while (true) {
+        next += interval;
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            if (m_wakeCond.wait_until(lock, next, [this] { return m_stop; })) {
+                break;
+            }
+        }
+        // 合成耗时超过一个周期时不追帧，从当前时间重新计时
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + interval) {
+            next = now;
+        }
+        if (!m_anyDirty.load() && !m_fullRedraw.load()) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.skippedTicks++;
+            continue;
+        }
+        composeOnce(window);
+    }
+    ANativeWindow_release(window);
+    LOGI("composeLoop exit");
+}
+
+bool MosaicCompositor::composeOnce(ANativeWindow* window) {
+    // 先清标志再扫描，扫描期间新到的帧会在下个周期处理
+    m_anyDirty.store(false);
+    const bool full = m_fullRedraw.exchange(false);
+
+    std::vector<std::shared_ptr<Tile>> tiles;
+    int width;
+    int height;
+    {
+        std::lock_guard<std::mutex> lock(m_tilesMutex);
+        tiles = m_tiles;
+        width = m_width;
+        height = m_height;
+    }
+
+    ARect dirty = {width, height, 0, 0};
+    for (const auto& tile : tiles) {
+        std::lock_guard<std::mutex> tileLock(tile->mutex);
+        if (full || tile->dirty) {
+            dirty.left = std::min(dirty.left, tile->x);
+            dirty.top = std::min(dirty.top, tile->y);
+            dirty.right = std::max(dirty.right, tile->x + tile->width);
+            dirty.bottom = std::max(dirty.bottom, tile->y + tile->height);
+        }
+    }
+    if (dirty.left >= dirty.right || dirty.top >= dirty.bottom) {
+        return false;
+    }
+
+    // 窗口会保留脏区域以外的上一帧内容，必要时扩大脏区域，以返回的区域为准
+    ANativeWindow_Buffer buffer;
+    if (ANativeWindow_lock(window, &buffer, &dirty) != 0) {
+        LOGE("composeOnce: ANativeWindow_lock failed");
+        m_fullRedraw.store(true);
+        return false;
+    }
+    if (buffer.width != width || buffer.height != height) {
+        dirty.left = 0;
+        dirty.top = 0;
+        dirty.right = std::min(width, (int)buffer.width);
+        dirty.bottom = std::min(height, (int)buffer.height);
+    }
+
+    uint64_t redrawn = 0;
+    uint8_t* dst = static_cast<uint8_t*>(buffer.bits);
+    const size_t dstStride = (size_t)buffer.stride * 4;
+    for (const auto& tile : tiles) {
+        const int left = std::max(dirty.left, tile->x);
+        const int top = std::max(dirty.top, tile->y);
+        const int right = std::min(dirty.right, tile->x + tile->width);
+        const int bottom = std::min(dirty.bottom, tile->y + tile->height);
+        if (left >= right || top >= bottom) {
+            continue;
+        }
+        std::lock_guard<std::mutex> tileLock(tile->mutex);
+        const size_t srcStride = (size_t)tile->width * 4;
+        const size_t rowBytes = (size_t)(right - left) * 4;
+        for (int y = top; y < bottom; y++) {
+            memcpy(dst + (size_t)y * dstStride + (size_t)left * 4,
+                   tile->pixels.data() + (size_t)(y - tile->y) * srcStride + (size_t)(left - tile->x) * 4,
+                   rowBytes);
+        }
+        tile->dirty = false;
+        redrawn++;
+    }
+    ANativeWindow_unlockAndPost(window);
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.composedFrames++;
+    m_stats.redrawnTiles += redrawn;
+    return true;
+}
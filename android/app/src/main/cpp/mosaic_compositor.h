@@ -0,0 +1,85 @@
+#ifndef MOSAIC_COMPOSITOR_H
+#define MOSAIC_COMPOSITOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android/native_window.h>
+
+#include "yuv_convert.h"
+
+// 多路画面拼接：每路解码帧缩小后写入共享画布中对应的格子，合成线程按显示刷新率
+// 只把有变化的格子区域提交到一个 ANativeWindow（Flutter SurfaceTexture），
+// 多画面墙只占用一个纹理，开销基本与路数无关。
+class MosaicCompositor {
+public:
+    struct Stats {
+        uint64_t submittedFrames = 0;   // 缩放进格子的帧数
+        uint64_t composedFrames = 0;    // 提交到窗口的次数
+        uint64_t skippedTicks = 0;      // 没有脏格子而跳过的刷新
+        uint64_t redrawnTiles = 0;      // 累计重绘的格子数
+    };
+
+    MosaicCompositor();
+    ~MosaicCompositor();
+
+    // 绑定输出窗口，按 columns x rows 划分 width x height 的画布，fps 为合成频率
+    bool attach(ANativeWindow* window, int columns, int rows, int width, int height, int fps);
+    void detach();
+    bool isAttached() const { return m_running.load(); }
+
+    // 把设备分配到第 index 个格子（按行优先），同一设备只占一个格子
+    bool assignTile(const std::string& devId, int index);
+    void removeTile(const std::string& devId);
+    bool hasTile(const std::string& devId);
+
+    // 任意线程调用：缩放并写入该设备的格子，设备未分配格子时返回 false
+    bool submitFrame(const std::string& devId, const Yuv420Planes& planes);
+
+    Stats stats();
+
+private:
+    // 每个格子持有自己缩放后的 RGBA 像素，合成时按窗口脏区域拷贝；格子之间无缝覆盖整个画布
+    struct Tile {
+        std::mutex mutex;  // 串行化该格子的写入与合成拷贝
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;  // RGBA，行跨度 width * 4
+        std::string devId;
+        bool dirty = false;
+    };
+
+    void composeLoop(ANativeWindow* window, int fps);
+    bool composeOnce(ANativeWindow* window);
+    static void clearTileLocked(Tile& tile);
+
+    std::mutex m_controlMutex;  // 串行化 attach/detach
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCond;
+    bool m_stop;
+
+    // 保护格子表与设备映射；重新 attach 时整体替换格子表，送帧线程持有的旧格子由 shared_ptr 保活
+    std::mutex m_tilesMutex;
+    std::vector<std::shared_ptr<Tile>> m_tiles;
+    std::map<std::string, int> m_deviceTiles;
+    int m_width;
+    int m_height;
+    std::atomic<bool> m_anyDirty;
+    std::atomic<bool> m_fullRedraw;  // 新窗口或重新划分后整帧提交
+
+    std::mutex m_statsMutex;
+    Stats m_stats;
+};
+
+#endif // MOSAIC_COMPOSITOR_H
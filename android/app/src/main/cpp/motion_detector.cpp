@@ -0,0 +1,431 @@
+#include "motion_detector.h"
+
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MOTION_HAVE_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define MOTION_HAVE_SSE2 1
+#endif
+
+#define LOG_TAG "MotionDetector"
+#include "native_log.h"
+
+const int MotionDetector::kAnalysisWidth;
+const int MotionDetector::kConfirmFrames;
+const int MotionDetector::kWarmupFrames;
+const int64_t MotionDetector::kEventCooldownMs;
+const int MotionDetector::kLightingResetPermille;
+const int MotionDetector::kBackgroundStep;
+
+// ---------------------------------------------------------------------------
+// 行内核：mask 写 0/1 表示该像素与背景的绝对差是否超过阈值；
+// 背景按近似中值模型向当前帧移动最多 step，慢变化（日照）被吸收，快速运动不会立刻融入背景。
+
+static void motionRowScalar(const uint8_t* cur, uint8_t* bg, uint8_t* mask, int width, uint8_t threshold, uint8_t step) {
+    for (int x = 0; x < width; x++) {
+        int c = cur[x];
+        int b = bg[x];
+        int diff = c > b ? c - b : b - c;
+        mask[x] = diff > threshold ? 1 : 0;
+        if (c > b) {
+            b += diff < step ? diff : step;
+        } else {
+            b -= diff < step ? diff : step;
+        }
+        bg[x] = (uint8_t)b;
+    }
+}
+
+static int sumRowScalar(const uint8_t* mask, int width) {
+    int sum = 0;
+    for (int x = 0; x < width; x++) {
+        sum += mask[x];
+    }
+    return sum;
+}
+
+#if defined(MOTION_HAVE_NEON)
+
+static void motionRowNeon(const uint8_t* cur, uint8_t* bg, uint8_t* mask, int width, uint8_t threshold, uint8_t step) {
+    const uint8x16_t thr = vdupq_n_u8(threshold);
+    const uint8x16_t stp = vdupq_n_u8(step);
+    const uint8x16_t one = vdupq_n_u8(1);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t c = vld1q_u8(cur + x);
+        uint8x16_t b = vld1q_u8(bg + x);
+        uint8x16_t up = vqsubq_u8(c, b);
+        uint8x16_t down = vqsubq_u8(b, c);
+        uint8x16_t diff = vorrq_u8(up, down);
+        vst1q_u8(mask + x, vandq_u8(vcgtq_u8(diff, thr), one));
+        b = vqsubq_u8(vqaddq_u8(b, vminq_u8(up, stp)), vminq_u8(down, stp));
+        vst1q_u8(bg + x, b);
+    }
+    if (x < width) {
+        motionRowScalar(cur + x, bg + x, mask + x, width - x, threshold, step);
+    }
+}
+
+static int sumRowNeon(const uint8_t* mask, int width) {
+    uint32x4_t acc = vdupq_n_u32(0);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        acc = vpadalq_u16(acc, vpaddlq_u8(vld1q_u8(mask + x)));
+    }
+    uint32_t lanes[4];
+    vst1q_u32(lanes, acc);
+    return (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + sumRowScalar(mask + x, width - x);
+}
+
+#elif defined(MOTION_HAVE_SSE2)
+
+static void motionRowSse2(const uint8_t* cur, uint8_t* bg, uint8_t* mask, int width, uint8_t threshold, uint8_t step) {
+    const __m128i thr = _mm_set1_epi8((char)threshold);
+    const __m128i stp = _mm_set1_epi8((char)step);
+    const __m128i one = _mm_set1_epi8(1);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(cur + x));
+        __m128i b = _mm_loadu_si128((const __m128i*)(bg + x));
+        __m128i up = _mm_subs_epu8(c, b);
+        __m128i down = _mm_subs_epu8(b, c);
+        __m128i diff = _mm_or_si128(up, down);
+        // SSE2 没有无符号比较：diff > thr 等价于 subs(diff, thr) 非零
+        _mm_storeu_si128((__m128i*)(mask + x), _mm_min_epu8(_mm_subs_epu8(diff, thr), one));
+        b = _mm_subs_epu8(_mm_adds_epu8(b, _mm_min_epu8(up, stp)), _mm_min_epu8(down, stp));
+        _mm_storeu_si128((__m128i*)(bg + x), b);
+    }
+    if (x < width) {
+        motionRowScalar(cur + x, bg + x, mask + x, width - x, threshold, step);
+    }
+}
+
+static int sumRowSse2(const uint8_t* mask, int width) {
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(mask + x)), zero));
+    }
+    int sum = _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+    return sum + sumRowScalar(mask + x, width - x);
+}
+
+#endif
+
+typedef void (*MotionRowFunc)(const uint8_t* cur, uint8_t* bg, uint8_t* mask, int width, uint8_t threshold, uint8_t step);
+typedef int (*SumRowFunc)(const uint8_t* mask, int width);
+
+struct MotionKernel {
+    MotionRowFunc motion;
+    SumRowFunc sum;
+    const char* name;
+};
+
+static const MotionKernel& kernel() {
+#if defined(MOTION_HAVE_NEON)
+    static const MotionKernel k = {motionRowNeon, sumRowNeon, "neon"};
+#elif defined(MOTION_HAVE_SSE2)
+    static const MotionKernel k = {motionRowSse2, sumRowSse2, "sse2"};
+#else
+    static const MotionKernel k = {motionRowScalar, sumRowScalar, "scalar"};
+#endif
+    return k;
+}
+
+const char* MotionDetector::kernelName() {
+    return kernel().name;
+}
+
+// 亮度平面按区域平均缩小
+static void downscaleLuma(const uint8_t* src, int rowStride, int width, int height, uint8_t* dst, int dstWidth, int dstHeight) {
+    for (int dy = 0; dy < dstHeight; dy++) {
+        int sy0 = dy * height / dstHeight;
+        int sy1 = (dy + 1) * height / dstHeight;
+        if (sy1 <= sy0) sy1 = sy0 + 1;
+        for (int dx = 0; dx < dstWidth; dx++) {
+            int sx0 = dx * width / dstWidth;
+            int sx1 = (dx + 1) * width / dstWidth;
+            if (sx1 <= sx0) sx1 = sx0 + 1;
+            int sum = 0;
+            for (int sy = sy0; sy < sy1; sy++) {
+                const uint8_t* row = src + (long)sy * rowStride;
+                for (int sx = sx0; sx < sx1; sx++) {
+                    sum += row[sx];
+                }
+            }
+            dst[(long)dy * dstWidth + dx] = (uint8_t)(sum / ((sy1 - sy0) * (sx1 - sx0)));
+        }
+    }
+}
+
+// 灵敏度映射到像素差阈值（12..52）和区域面积阈值（0.5%..5%）
+static uint8_t pixelThreshold(int sensitivity) {
+    return (uint8_t)(12 + (100 - sensitivity) * 40 / 100);
+}
+
+static int areaThresholdPermille(int sensitivity) {
+    return 5 + (100 - sensitivity) * 45 / 100;
+}
+
+MotionDetector::MotionDetector() : m_running(false), m_stop(false) {}
+
+MotionDetector::~MotionDetector() {
+    stop();
+}
+
+void MotionDetector::setEventCallback(const EventCallback& callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callback = callback;
+}
+
+void MotionDetector::configure(const std::string& devId, const MotionConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!config.enabled) {
+        m_devices.erase(devId);
+        LOGI("configure: %s disabled", devId.c_str());
+        return;
+    }
+    Device& device = m_devices[devId];
+    device.config = config;
+    device.config.sensitivity = config.sensitivity < 0 ? 0 : (config.sensitivity > 100 ? 100 : config.sensitivity);
+    device.config.analysisFps = config.analysisFps > 0 ? config.analysisFps : 1;
+    device.generation++;
+    if (!device.analysis) {
+        device.analysis = std::make_shared<Analysis>();
+    }
+    if (!m_running) {
+        m_stop = false;
+        m_running = true;
+        m_thread = std::thread(&MotionDetector::workerLoop, this);
+    }
+    LOGI("configure: %s sensitivity=%d, fps=%d, zones=%zu, kernel=%s", devId.c_str(), device.config.sensitivity,
+         device.config.analysisFps, config.zones.size(), kernelName());
+}
+
+bool MotionDetector::isEnabled(const std::string& devId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_devices.find(devId) != m_devices.end();
+}
+
+bool MotionDetector::shouldSample(const std::string& devId, int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        return false;
+    }
+    Device& device = it->second;
+    m_stats.submittedFrames++;
+    if (nowMs - device.lastSubmitMs < 1000 / device.config.analysisFps) {
+        m_stats.skippedFrames++;
+        return false;
+    }
+    device.lastSubmitMs = nowMs;
+    return true;
+}
+
+bool MotionDetector::submit(const std::string& devId, const FrameRef& frame, int64_t nowMs) {
+    if (!frame || frame->width <= 0 || frame->height <= 0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_devices.find(devId);
+        if (it == m_devices.end()) {
+            return false;
+        }
+        Device& device = it->second;
+        if (device.pending) {
+            m_stats.replacedFrames++;
+        }
+        // 只持有引用，缩小放到分析线程上做
+        device.pending = frame;
+        device.pendingMs = nowMs;
+    }
+    m_cond.notify_one();
+    return true;
+}
+
+MotionStats MotionDetector::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void MotionDetector::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+}
+
+void MotionDetector::workerLoop() {
+    // 分析不影响解码和显示：调低本线程的调度优先级
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+    LOGI("workerLoop: started, kernel=%s", kernelName());
+
+    std::vector<uint8_t> luma;
+    for (;;) {
+        FrameRef frame;
+        std::string devId;
+        MotionConfig config;
+        uint64_t generation = 0;
+        std::shared_ptr<Analysis> analysis;
+        int width = 0;
+        int height = 0;
+        int64_t frameMs = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            Device* next = nullptr;
+            m_cond.wait(lock, [this, &devId, &next]() {
+                if (m_stop) {
+                    return true;
+                }
+                for (auto& entry : m_devices) {
+                    if (entry.second.pending) {
+                        devId = entry.first;
+                        next = &entry.second;
+                        return true;
+                    }
+                }
+                return false;
+            });
+            if (m_stop) {
+                break;
+            }
+            frame.swap(next->pending);
+            frameMs = next->pendingMs;
+            config = next->config;
+            generation = next->generation;
+            analysis = next->analysis;
+        }
+        // 缩小后只有几十 KB，池化帧随即归还
+        width = frame->width < kAnalysisWidth ? frame->width : kAnalysisWidth;
+        height = (int)((int64_t)frame->height * width / frame->width);
+        if (height < 1) height = 1;
+        luma.resize((size_t)width * height);
+        downscaleLuma(frame->y, frame->width, frame->width, frame->height, luma.data(), width, height);
+        frame.reset();
+        analyze(devId, *analysis, config, generation, luma, width, height, frameMs);
+    }
+    LOGI("workerLoop: stopped");
+}
+
+void MotionDetector::analyze(const std::string& devId, Analysis& analysis, const MotionConfig& config, uint64_t generation,
+                             const std::vector<uint8_t>& luma, int width, int height, int64_t nowMs) {
+    const size_t pixels = (size_t)width * height;
+    if (analysis.width != width || analysis.height != height || analysis.generation != generation) {
+        // 分辨率或配置变化：以当前帧为背景重新开始
+        analysis.width = width;
+        analysis.height = height;
+        analysis.generation = generation;
+        analysis.background.assign(luma.begin(), luma.begin() + pixels);
+        analysis.mask.assign(pixels, 0);
+        analysis.warmup = kWarmupFrames;
+        analysis.zones.clear();
+        std::vector<MotionZone> zones = config.zones;
+        if (zones.empty()) {
+            zones.push_back(MotionZone());
+        }
+        for (const MotionZone& zone : zones) {
+            ZoneState state;
+            state.x0 = (int)(zone.x * width);
+            state.y0 = (int)(zone.y * height);
+            state.x1 = (int)((zone.x + zone.width) * width + 0.5f);
+            state.y1 = (int)((zone.y + zone.height) * height + 0.5f);
+            state.x0 = state.x0 < 0 ? 0 : (state.x0 > width ? width : state.x0);
+            state.y0 = state.y0 < 0 ? 0 : (state.y0 > height ? height : state.y0);
+            state.x1 = state.x1 < state.x0 ? state.x0 : (state.x1 > width ? width : state.x1);
+            state.y1 = state.y1 < state.y0 ? state.y0 : (state.y1 > height ? height : state.y1);
+            analysis.zones.push_back(state);
+        }
+        return;
+    }
+
+    const MotionKernel& k = kernel();
+    const uint8_t threshold = pixelThreshold(config.sensitivity);
+    int changed = 0;
+    for (int row = 0; row < height; row++) {
+        size_t offset = (size_t)row * width;
+        k.motion(luma.data() + offset, analysis.background.data() + offset, analysis.mask.data() + offset,
+                 width, threshold, (uint8_t)kBackgroundStep);
+        changed += k.sum(analysis.mask.data() + offset, width);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.analyzedFrames++;
+    }
+    if ((int64_t)changed * 1000 >= (int64_t)pixels * kLightingResetPermille) {
+        // 整个画面大面积变化多半是光照突变，不是移动，直接以当前帧为背景
+        analysis.background.assign(luma.begin(), luma.begin() + pixels);
+        analysis.warmup = kWarmupFrames;
+        for (ZoneState& zone : analysis.zones) {
+            zone.hits = 0;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.lightingResets++;
+        return;
+    }
+    if (analysis.warmup > 0) {
+        analysis.warmup--;
+        return;
+    }
+
+    MotionEvent event;
+    const int areaThreshold = areaThresholdPermille(config.sensitivity);
+    for (size_t i = 0; i < analysis.zones.size(); i++) {
+        ZoneState& zone = analysis.zones[i];
+        int area = (zone.x1 - zone.x0) * (zone.y1 - zone.y0);
+        if (area <= 0) {
+            continue;
+        }
+        int count = 0;
+        for (int row = zone.y0; row < zone.y1; row++) {
+            count += k.sum(analysis.mask.data() + (size_t)row * width + zone.x0, zone.x1 - zone.x0);
+        }
+        int permille = (int)((int64_t)count * 1000 / area);
+        if (permille < areaThreshold) {
+            zone.hits = 0;
+            continue;
+        }
+        // 冷却期内持续的运动停在已确认状态，冷却一结束就上报；上报后重新开始确认
+        if (zone.hits < kConfirmFrames) {
+            zone.hits++;
+        }
+        if (zone.hits >= kConfirmFrames && (zone.lastEventMs == 0 || nowMs - zone.lastEventMs >= kEventCooldownMs)) {
+            zone.lastEventMs = nowMs;
+            zone.hits = 0;
+            event.zones.push_back((int)i);
+            event.areaPermille.push_back(permille);
+        }
+    }
+    if (event.zones.empty()) {
+        return;
+    }
+
+    event.devId = devId;
+    event.timeMs = nowMs;
+    EventCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.events++;
+        callback = m_callback;
+    }
+    LOGI("analyze: %s motion in %zu zone(s), first=%d (%d‰)", devId.c_str(), event.zones.size(), event.zones[0],
+         event.areaPermille[0]);
+    if (callback) {
+        callback(event);
+    }
+}
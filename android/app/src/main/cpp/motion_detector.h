@@ -0,0 +1,121 @@
+#ifndef MOTION_DETECTOR_H
+#define MOTION_DETECTOR_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "frame_pool.h"
+
+// 检测区域，坐标按画面宽高归一化到 0..1
+struct MotionZone {
+    float x = 0;
+    float y = 0;
+    float width = 1;
+    float height = 1;
+};
+
+struct MotionConfig {
+    bool enabled = false;
+    int sensitivity = 50;            // 0..100，越大越灵敏
+    int analysisFps = 2;             // 每秒最多分析的帧数
+    std::vector<MotionZone> zones;   // 为空时整个画面作为 0 号区域
+};
+
+struct MotionEvent {
+    std::string devId;
+    std::vector<int> zones;          // 本次触发的区域下标
+    std::vector<int> areaPermille;   // 对应区域内变化像素的千分比
+    int64_t timeMs = 0;
+};
+
+struct MotionStats {
+    uint64_t submittedFrames = 0;
+    uint64_t skippedFrames = 0;      // 未到分析间隔而跳过
+    uint64_t replacedFrames = 0;     // 分析线程未取走就被新帧覆盖
+    uint64_t analyzedFrames = 0;
+    uint64_t events = 0;
+    uint64_t lightingResets = 0;     // 大面积亮度突变（开关灯、红外切换）时重建背景
+};
+
+// 本地移动侦测：送入的池化帧只持有引用，在低优先级线程上把亮度平面缩小到 kAnalysisWidth 宽，
+// 与背景模型逐像素比较（SIMD 绝对差 + 近似中值背景更新），按区域统计变化面积，
+// 连续几次超过阈值时通过回调上报事件，同一区域有冷却时间。
+class MotionDetector {
+public:
+    static const int kAnalysisWidth = 160;
+    static const int kConfirmFrames = 2;
+    static const int kWarmupFrames = 4;
+    static const int64_t kEventCooldownMs = 10000;
+    static const int kLightingResetPermille = 600;
+    static const int kBackgroundStep = 2;
+
+    typedef std::function<void(const MotionEvent&)> EventCallback;
+
+    MotionDetector();
+    ~MotionDetector();
+
+    // 回调在分析线程上执行
+    void setEventCallback(const EventCallback& callback);
+    void configure(const std::string& devId, const MotionConfig& config);
+    bool isEnabled(const std::string& devId) const;
+
+    // 任意线程调用：未启用或未到分析间隔时返回 false，调用方不必准备帧；返回 true 时占住本次分析
+    bool shouldSample(const std::string& devId, int64_t nowMs);
+    // 送入 shouldSample 放行的帧，分析线程取走之前被新帧替换的旧帧直接归还
+    bool submit(const std::string& devId, const FrameRef& frame, int64_t nowMs);
+
+    MotionStats stats() const;
+    void stop();
+
+    // 当前选用的行内核名称，用于日志
+    static const char* kernelName();
+
+private:
+    struct ZoneState {
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0;  // 分析分辨率下的像素范围
+        int hits = 0;                         // 连续超过阈值的次数
+        int64_t lastEventMs = 0;
+    };
+
+    // 分析线程独占的状态
+    struct Analysis {
+        std::vector<uint8_t> background;
+        std::vector<uint8_t> mask;
+        std::vector<ZoneState> zones;
+        int width = 0;
+        int height = 0;
+        int warmup = 0;
+        uint64_t generation = 0;
+    };
+
+    struct Device {
+        MotionConfig config;
+        uint64_t generation = 0;    // 配置每次变化加一，分析线程据此重建区域
+        int64_t lastSubmitMs = 0;
+        FrameRef pending;
+        int64_t pendingMs = 0;
+        std::shared_ptr<Analysis> analysis;
+    };
+
+    void workerLoop();
+    void analyze(const std::string& devId, Analysis& analysis, const MotionConfig& config, uint64_t generation,
+                 const std::vector<uint8_t>& luma, int width, int height, int64_t nowMs);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::unordered_map<std::string, Device> m_devices;
+    EventCallback m_callback;
+    MotionStats m_stats;
+    std::thread m_thread;
+    bool m_running;
+    bool m_stop;
+};
+
+#endif // MOTION_DETECTOR_H
@@ -1,5 +1,6 @@
 #include <jni.h>
 #include <string>
+#include <cstring>
 #include <android/log.h>
 #include <android/native_window.h>
 #include <android/native_window_jni.h>
@@ -11,8 +12,32 @@
 #include <atomic>
 #include <chrono>
 #include <thread>
+#include <map>
 #include "p2pInterface.h"
 #include "cJSON.h"
+#include "h264_nal.h"
+#include "gop_cache.h"
+#include "thumbnail_cache.h"
+#include "yuv_convert.h"
+#include "fmp4_recorder.h"
+#include "keyframe_index.h"
+#include "pre_event_recorder.h"
+#include "activity_estimator.h"
+#include "frame_bus.h"
+#include "frame_pool.h"
+#include "gl_yuv_renderer.h"
+#include "motion_detector.h"
+#include "picture_health.h"
+#include "frame_ring.h"
+#include "mosaic_compositor.h"
+#include "stream_profile.h"
+#include "stream_continuity.h"
+#include "stream_clock.h"
+#include "audio_pipeline.h"
+#include "av_sync.h"
+#include "talk_uplink.h"
+#include "trick_play.h"
+#include "presentation_scheduler.h"
 
 #define LOG_TAG "NativeLib"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -31,11 +56,148 @@ static std::atomic<int> g_errorCount(0);
 static std::atomic<bool> g_isDisposed(false);
 static jlong g_flutterTextureId = 0;
 static jobject g_mainActivityRef = nullptr;
+static jmethodID g_onCachedVideoFrameMethod = nullptr;
 
-// 空实现的消息回调
-void RecbMsgData(void* pMsgData, int nLen) {
-    LOGI("[MQTT] >>>>>>>>>>>> RecbMsgData called! length: %d", nLen);
-    if (!g_vm || !g_mainActivityRef || !pMsgData || nLen <= 0) {
+// 当前 P2P 设备ID，由 setDevP2p 设置
+static std::mutex g_devIdMutex;
+static std::string g_currentDevId;
+
+// 最近 GOP 缓存：重新打开画面时先回放缓存，直到直播流的 IDR 到达
+static GopCache g_gopCache;
+static std::atomic<bool> g_awaitLiveIdr(false);
+static std::atomic<bool> g_abortGopReplay(false);
+
+// 首页设备缩略图缓存，由最近的 IDR 生成
+static ThumbnailCache g_thumbnailCache;
+
+// 本地录像，直接封装收到的 H.264 访问单元
+static Fmp4Recorder g_recorder;
+
+// 录像关键帧索引：每个设备一个，按墙上时间定位 IDR，拖动时间轴不扫描录像文件
+static std::mutex g_keyframeIndexMutex;
+static std::string g_keyframeIndexDir;
+static std::map<std::string, std::shared_ptr<KeyframeIndex>> g_keyframeIndexes;
+
+// 报警预录：保留最近几秒视频，收到配置的报警消息时写入文件
+static PreEventRecorder g_preEventRecorder;
+
+// 接收线程的帧总线：每个访问单元只存一份，录像、预录等慢消费者各自排队，不会拖住实时显示
+static FrameBus g_frameBus;
+static std::once_flag g_frameBusOnce;
+
+// 压缩域活动度：不解码，只看码流判断哪些画面有运动，供画面墙决定哪些设备完整解码
+static ActivityEstimator g_activityEstimator;
+
+// 本地移动侦测：设备固件没有或误报多时，用解码帧的亮度自行检测
+static MotionDetector g_motionDetector;
+
+// 解码画面健康检查：有数据但画面冻结、全黑或单色时上报，弥补只看是否收到数据的状态判断
+static PictureHealthMonitor g_pictureHealth;
+
+// 解码帧缓冲池：渲染、移动侦测和画面健康检查持有同一帧的引用，不再各自拷贝
+static FramePool g_framePool;
+
+// 软解或原始 YUV 来源的 GPU 渲染，输出到 Flutter SurfaceTexture
+static GlYuvRenderer g_yuvRenderer;
+
+// Dart 通过 dart:ffi 直接读取的帧环形缓冲，帧数据不再逐帧经过 MethodChannel
+static FrameRing g_frameRing;
+
+// 多画面墙：各设备解码帧缩小后拼接到同一个纹理
+static MosaicCompositor g_mosaic;
+
+// 按画面实际尺寸协商设备码流规格
+static StreamProfileNegotiator g_streamProfiles;
+
+// 码流连续性检查：丢包导致参考帧缺失时停送解码并向设备请求关键帧
+static StreamContinuityChecker g_continuity;
+
+// 直播流时间戳：接收入口记录到达时间，生成解码、录像和显示调度共用的 PTS
+static StreamClock g_streamClock;
+
+// P2pVideoView 硬解输出的显示调度
+static PresentationScheduler g_presentationScheduler;
+
+// 音频接收：从 P2P 接收回调分出音频包，解码后经抖动缓冲送到低延迟输出
+static AudioPipeline g_audioPipeline;
+
+// 音视频同步：音频为主时钟，显示调度按它校正视频的显示时间
+static AvSyncClock g_avSync;
+// 直播时显示调度跟随 g_avSync，快放/快退期间断开
+static MasterClockSwitch g_masterClock(g_presentationScheduler, g_avSync);
+
+// 对讲上行：本地采集、编码后发给当前对讲的设备
+static TalkUplink g_talkUplink;
+
+// 录像快放/快退：只按关键帧索引送 IDR，运行期间不送直播帧
+static TrickPlayer g_trickPlayer;
+
+static void setCurrentDevId(const char* devId) {
+    std::lock_guard<std::mutex> lock(g_devIdMutex);
+    g_currentDevId = devId ? devId : "";
+}
+
+static std::string currentDevId() {
+    std::lock_guard<std::mutex> lock(g_devIdMutex);
+    return g_currentDevId;
+}
+
+static int64_t currentTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static int64_t monotonicTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 取设备的关键帧索引，首次使用时打开；没有设置索引目录或打开失败时返回空
+static std::shared_ptr<KeyframeIndex> keyframeIndexFor(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(g_keyframeIndexMutex);
+    auto it = g_keyframeIndexes.find(devId);
+    if (it != g_keyframeIndexes.end()) {
+        return it->second;
+    }
+    if (devId.empty() || g_keyframeIndexDir.empty()) {
+        return nullptr;
+    }
+    std::shared_ptr<KeyframeIndex> index = std::make_shared<KeyframeIndex>();
+    if (!index->open(g_keyframeIndexDir, devId)) {
+        return nullptr;
+    }
+    g_keyframeIndexes[devId] = index;
+    return index;
+}
+
+// 从 MQTT 消息中取出报警类型，命中预录配置时触发写文件
+static void handleAlarmMessage(const char* msg, int len) {
+    std::string text(msg, (size_t)len);
+    cJSON* root = cJSON_Parse(text.c_str());
+    if (!root) {
+        return;
+    }
+    const char* keys[] = {"type", "event", "alarmType"};
+    std::string eventType;
+    for (const char* key : keys) {
+        cJSON* item = cJSON_GetObjectItem(root, key);
+        if (cJSON_IsString(item) && item->valuestring) {
+            eventType = item->valuestring;
+            break;
+        }
+    }
+    if (!eventType.empty() && g_preEventRecorder.isTriggerType(eventType)) {
+        cJSON* dev = cJSON_GetObjectItem(root, "devId");
+        std::string devId = (cJSON_IsString(dev) && dev->valuestring) ? dev->valuestring : currentDevId();
+        LOGI("[预录] 报警消息: type=%s, devId=%s", eventType.c_str(), devId.c_str());
+        g_preEventRecorder.trigger(devId, eventType, monotonicTimeUs());
+    }
+    cJSON_Delete(root);
+}
+
+// 把一条 JSON 消息按 MQTT 消息的同一路径交给 MainActivity.onMqttMessage，Dart 侧统一进入设备事件
+static void postMqttMessageToJava(const char* msg, int len) {
+    if (!g_vm || !g_mainActivityRef || !msg || len <= 0) {
         LOGI("[MQTT] 回调参数无效，忽略");
         return;
     }
@@ -50,10 +212,11 @@ void RecbMsgData(void* pMsgData, int nLen) {
     }
     jclass clazz = env->GetObjectClass(g_mainActivityRef);
     jmethodID onMqttMsg = env->GetMethodID(clazz, "onMqttMessage", "([BI)V");
+    env->DeleteLocalRef(clazz);
     if (onMqttMsg) {
-        jbyteArray jMsg = env->NewByteArray(nLen);
-        env->SetByteArrayRegion(jMsg, 0, nLen, reinterpret_cast<const jbyte*>(pMsgData));
-        env->CallVoidMethod(g_mainActivityRef, onMqttMsg, jMsg, nLen);
+        jbyteArray jMsg = env->NewByteArray(len);
+        env->SetByteArrayRegion(jMsg, 0, len, reinterpret_cast<const jbyte*>(msg));
+        env->CallVoidMethod(g_mainActivityRef, onMqttMsg, jMsg, len);
         env->DeleteLocalRef(jMsg);
         LOGI("[MQTT] 已回调 Java 层 onMqttMessage");
     } else {
@@ -64,9 +227,81 @@ void RecbMsgData(void* pMsgData, int nLen) {
     }
 }
 
+// MQTT 消息回调：报警和移动侦测类消息命中预录配置时触发报警录像，所有消息原样转给 Java 层 onMqttMessage
+void RecbMsgData(void* pMsgData, int nLen) {
+    LOGI("[MQTT] >>>>>>>>>>>> RecbMsgData called! length: %d", nLen);
+    if (pMsgData && nLen > 0) {
+        handleAlarmMessage(reinterpret_cast<const char*>(pMsgData), nLen);
+    }
+    postMqttMessageToJava(reinterpret_cast<const char*>(pMsgData), nLen);
+}
+
+// 本地移动侦测事件：组装成与设备报警相同形式的消息，既能触发报警预录，也走 MQTT 消息通道到 Dart
+static void onMotionEvent(const MotionEvent& event) {
+    cJSON* msg = cJSON_CreateObject();
+    if (!msg) {
+        return;
+    }
+    cJSON_AddStringToObject(msg, "type", "motion");
+    cJSON_AddStringToObject(msg, "source", "local");
+    cJSON_AddStringToObject(msg, "devId", event.devId.c_str());
+    cJSON* zones = cJSON_AddArrayToObject(msg, "zones");
+    cJSON* area = cJSON_AddArrayToObject(msg, "areaPermille");
+    for (size_t i = 0; i < event.zones.size(); i++) {
+        cJSON_AddItemToArray(zones, cJSON_CreateNumber(event.zones[i]));
+        cJSON_AddItemToArray(area, cJSON_CreateNumber(event.areaPermille[i]));
+    }
+    cJSON_AddNumberToObject(msg, "time", (double)event.timeMs);
+    char* text = cJSON_PrintUnformatted(msg);
+    cJSON_Delete(msg);
+    if (!text) {
+        return;
+    }
+    int len = (int)strlen(text);
+    LOGI("[移动侦测] %s", text);
+    handleAlarmMessage(text, len);
+    postMqttMessageToJava(text, len);
+    cJSON_free(text);
+}
+
+// 画面健康状态变化：在送帧线程上回调，转给 Dart 更新状态并决定是否重连
+static void onPictureHealthEvent(const PictureHealthEvent& event) {
+    if (!g_vm || !g_mainActivityRef) {
+        return;
+    }
+    JNIEnv* env;
+    bool needDetach = false;
+    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
+        if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            return;
+        }
+        needDetach = true;
+    }
+    jclass clazz = env->GetObjectClass(g_mainActivityRef);
+    jmethodID onHealth = env->GetMethodID(clazz, "onPictureHealth", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;J)V");
+    env->DeleteLocalRef(clazz);
+    if (onHealth) {
+        jstring jDevId = env->NewStringUTF(event.devId.c_str());
+        jstring jState = env->NewStringUTF(pictureStateName(event.state));
+        jstring jPrevious = env->NewStringUTF(pictureStateName(event.previous));
+        env->CallVoidMethod(g_mainActivityRef, onHealth, jDevId, jState, jPrevious, (jlong)event.durationMs);
+        env->DeleteLocalRef(jDevId);
+        env->DeleteLocalRef(jState);
+        env->DeleteLocalRef(jPrevious);
+    } else {
+        LOGI("[画面检查] 未找到 onPictureHealth 方法");
+        env->ExceptionClear();
+    }
+    if (needDetach) {
+        g_vm->DetachCurrentThread();
+    }
+}
+
 // 独立的摄像头回调函数，避免与P2P回调冲突
 void RecbCameraData(void* data, int length) {
     LOGI("[摄像头] >>>>>>>>>>>> RecbCameraData called! length: %d", length);
+    // 本地摄像头没有设备时间戳，按进入时间打 PTS，与直播帧同在 CLOCK_MONOTONIC 域
+    const int64_t ptsUs = monotonicTimeUs();
     
     if (g_isDisposed || !g_vm || !g_p2pVideoView) {
         LOGI("[摄像头] View is disposed or not available, ignoring camera data");
@@ -117,7 +352,7 @@ void RecbCameraData(void* data, int length) {
             jbyteArray jData = env->NewByteArray(length);
             if (jData) {
                 env->SetByteArrayRegion(jData, 0, length, reinterpret_cast<const jbyte*>(data));
-                env->CallVoidMethod(g_p2pVideoView, g_onVideoFrameMethod, jData);
+                env->CallVoidMethod(g_p2pVideoView, g_onVideoFrameMethod, jData, (jlong)ptsUs);
                 env->DeleteLocalRef(jData);
                 LOGI("[摄像头] Camera frame sent to Java layer successfully");
             }
@@ -139,6 +374,7 @@ Java_com_mainipc_xiebaoxin_MainActivity_bindNative(JNIEnv* env, jobject thiz) {
         env->DeleteGlobalRef(g_mainActivityRef);
     }
     g_mainActivityRef = env->NewGlobalRef(thiz);
+    g_pictureHealth.setEventCallback(onPictureHealthEvent);
     // 可选：env->GetJavaVM(&g_vm);
 }
 
@@ -193,7 +429,359 @@ static void notifyError(const char* message) {
     }
 }
 
+// 收到 IDR 且该设备缩略图已过期时，把关键帧交给 Java 层解码并生成缩略图
+static void requestThumbnail(JNIEnv* env, const std::string& devId) {
+    if (!g_mainActivityRef || !g_thumbnailCache.shouldRefresh(devId, currentTimeMs())) {
+        return;
+    }
+    std::vector<uint8_t> keyframe;
+    if (!g_gopCache.latestKeyframe(devId, keyframe)) {
+        return;
+    }
+    jclass clazz = env->GetObjectClass(g_mainActivityRef);
+    jmethodID onKeyframe = env->GetMethodID(clazz, "onThumbnailKeyframe", "(Ljava/lang/String;[B)V");
+    env->DeleteLocalRef(clazz);
+    if (!onKeyframe) {
+        LOGI("[缩略图] 未找到 onThumbnailKeyframe 方法");
+        return;
+    }
+    jstring jDevId = env->NewStringUTF(devId.c_str());
+    jbyteArray jData = env->NewByteArray((jsize)keyframe.size());
+    if (jDevId && jData) {
+        env->SetByteArrayRegion(jData, 0, (jsize)keyframe.size(), reinterpret_cast<const jbyte*>(keyframe.data()));
+        env->CallVoidMethod(g_mainActivityRef, onKeyframe, jDevId, jData);
+        LOGI("[缩略图] 已提交关键帧: devId=%s, size=%zu", devId.c_str(), keyframe.size());
+    }
+    if (jData) env->DeleteLocalRef(jData);
+    if (jDevId) env->DeleteLocalRef(jDevId);
+}
+
+// 把缓存的GOP送给解码器，直播IDR到达时中止回放
+static void startGopReplay(const std::string& devId) {
+    g_gopCache.beginSession(devId);
+    std::vector<std::vector<uint8_t>> frames;
+    if (!g_gopCache.snapshot(devId, frames) || !g_onCachedVideoFrameMethod) {
+        g_awaitLiveIdr.store(false);
+        return;
+    }
+
+    LOGI("[GOP缓存] 回放缓存GOP: devId=%s, frames=%zu", devId.c_str(), frames.size());
+    g_abortGopReplay.store(false);
+    g_awaitLiveIdr.store(true);
+
+    std::thread([frames]() {
+        JNIEnv* env;
+        if (!g_vm || g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            g_awaitLiveIdr.store(false);
+            return;
+        }
+        size_t sent = 0;
+        for (const auto& frame : frames) {
+            if (g_abortGopReplay.load() || g_isDisposed || !g_p2pVideoView || !g_onCachedVideoFrameMethod) {
+                break;
+            }
+            jbyteArray jData = env->NewByteArray((jsize)frame.size());
+            if (!jData) {
+                break;
+            }
+            env->SetByteArrayRegion(jData, 0, (jsize)frame.size(), reinterpret_cast<const jbyte*>(frame.data()));
+            env->CallVoidMethod(g_p2pVideoView, g_onCachedVideoFrameMethod, jData);
+            env->DeleteLocalRef(jData);
+            sent++;
+        }
+        LOGI("[GOP缓存] 回放结束: %zu/%zu", sent, frames.size());
+        g_vm->DetachCurrentThread();
+    }).detach();
+}
+
+// 发给设备的 MQTT 控制指令（规格切换、关键帧请求）由单独的线程发送：SendJsonMsg 会阻塞在网络上，
+// 而调用方是 SDK 的接收回调线程。队列有界，发送跟不上时丢弃新指令，设备侧重复的指令也没有意义
+static const size_t kMaxPendingDeviceCommands = 32;
+struct DeviceCommand {
+    std::string topic;
+    std::string label;     // 日志用
+    cJSON* msg;
+};
+static std::mutex g_deviceCommandMutex;
+static std::condition_variable g_deviceCommandCond;
+static std::queue<DeviceCommand> g_deviceCommands;
+static bool g_deviceCommandThreadStarted = false;
+
+// 接管 msg 的所有权
+static void postDeviceCommand(const std::string& devId, cJSON* msg, const std::string& label) {
+    std::lock_guard<std::mutex> lock(g_deviceCommandMutex);
+    if (g_deviceCommands.size() >= kMaxPendingDeviceCommands) {
+        LOGE("[MQTT] 指令队列已满，丢弃 %s", label.c_str());
+        cJSON_Delete(msg);
+        return;
+    }
+    g_deviceCommands.push(DeviceCommand{"/yyt/" + devId + "/msg", label, msg});
+    if (!g_deviceCommandThreadStarted) {
+        g_deviceCommandThreadStarted = true;
+        // 与进程同生命周期
+        std::thread([]() {
+            std::unique_lock<std::mutex> lock(g_deviceCommandMutex);
+            while (true) {
+                g_deviceCommandCond.wait(lock, []() { return !g_deviceCommands.empty(); });
+                DeviceCommand command = g_deviceCommands.front();
+                g_deviceCommands.pop();
+                lock.unlock();
+                int ret = SendJsonMsg(command.msg, (char*)command.topic.c_str());
+                cJSON_Delete(command.msg);
+                LOGI("%s, ret=%d", command.label.c_str(), ret);
+                lock.lock();
+            }
+        }).detach();
+    }
+    g_deviceCommandCond.notify_one();
+}
+
+// 把到期的规格切换通过 MQTT 发给设备，与 MqttService._setResolutionViaMqtt 的消息格式一致
+static void negotiateStreamProfiles() {
+    ResolutionRequest request;
+    while (g_streamProfiles.poll(monotonicTimeUs() / 1000, request)) {
+        cJSON* msg = cJSON_CreateObject();
+        if (!msg) {
+            return;
+        }
+        cJSON_AddStringToObject(msg, "cmd", "set_resolution");
+        cJSON_AddNumberToObject(msg, "width", request.width);
+        cJSON_AddNumberToObject(msg, "height", request.height);
+        cJSON_AddStringToObject(msg, "devId", request.devId.c_str());
+        postDeviceCommand(request.devId, msg, "[码流协商] set_resolution devId=" + request.devId + " " +
+                                                  std::to_string(request.width) + "x" + std::to_string(request.height));
+    }
+}
+
+// 参考链断开时请求设备立即编码一个 IDR，消息格式与 set_resolution 相同，走设备的 MQTT 指令主题
+static void sendKeyframeRequest(const std::string& devId) {
+    cJSON* msg = cJSON_CreateObject();
+    if (!msg) {
+        return;
+    }
+    cJSON_AddStringToObject(msg, "cmd", "request_keyframe");
+    cJSON_AddStringToObject(msg, "devId", devId.c_str());
+    postDeviceCommand(devId, msg, "[连续性] request_keyframe devId=" + devId);
+}
+
+static const char kBase64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// out 由调用方复用，避免每包重新分配
+static void base64Encode(const uint8_t* data, int length, std::string& out) {
+    out.clear();
+    out.reserve((length + 2) / 3 * 4);
+    for (int i = 0; i < length; i += 3) {
+        const uint32_t n = (data[i] << 16) | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+        out.push_back(kBase64Chars[(n >> 18) & 0x3F]);
+        out.push_back(kBase64Chars[(n >> 12) & 0x3F]);
+        out.push_back(i + 1 < length ? kBase64Chars[(n >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < length ? kBase64Chars[n & 0x3F] : '=');
+    }
+}
+
+// P2P SDK 没有上行媒体通道，对讲音频和关键帧请求一样走设备消息主题，负载按 base64 编码。
+// 在对讲的普通优先级发送线程上调用，打包线程只负责编码入队；topic 在 startTalk 时拼好。
+static bool sendTalkPacket(const std::string& devId, const std::string& topic, const TalkPacket& packet) {
+    static std::string payload;
+    base64Encode(packet.data, packet.length, payload);
+    cJSON* msg = cJSON_CreateObject();
+    if (!msg) {
+        return false;
+    }
+    cJSON_AddStringToObject(msg, "cmd", "talk_audio");
+    cJSON_AddStringToObject(msg, "devId", devId.c_str());
+    cJSON_AddStringToObject(msg, "codec", audioCodecName(packet.codec));
+    cJSON_AddNumberToObject(msg, "rate", packet.sampleRate);
+    cJSON_AddNumberToObject(msg, "seq", packet.sequence);
+    cJSON_AddNumberToObject(msg, "ts", packet.timestamp);
+    cJSON_AddStringToObject(msg, "data", payload.c_str());
+    int ret = SendJsonMsg(msg, (char*)topic.c_str());
+    cJSON_Delete(msg);
+    if (ret != 0 && packet.sequence % 50 == 0) {
+        LOGE("[对讲] talk_audio 发送失败 devId=%s seq=%u ret=%d", devId.c_str(), packet.sequence, ret);
+    }
+    return ret == 0;
+}
+
+// 开启移动侦测但没有拼接格子的设备，把帧交给 MainActivity 中的分析解码器；有格子时格子的解码输出已送去检测
+static void forwardMotionFrame(JNIEnv* env, const std::string& devId, const uint8_t* data, int length, bool keyframe,
+                               int64_t ptsUs) {
+    if (!g_mainActivityRef || !g_motionDetector.isEnabled(devId) || (g_mosaic.isAttached() && g_mosaic.hasTile(devId))) {
+        return;
+    }
+    jclass clazz = env->GetObjectClass(g_mainActivityRef);
+    jmethodID onFrame = env->GetMethodID(clazz, "onMotionVideoFrame", "(Ljava/lang/String;[BZJ)V");
+    env->DeleteLocalRef(clazz);
+    if (!onFrame) {
+        LOGI("[移动侦测] 未找到 onMotionVideoFrame 方法");
+        env->ExceptionClear();
+        return;
+    }
+    jstring jDevId = env->NewStringUTF(devId.c_str());
+    jbyteArray jData = env->NewByteArray(length);
+    if (jDevId && jData) {
+        env->SetByteArrayRegion(jData, 0, length, reinterpret_cast<const jbyte*>(data));
+        env->CallVoidMethod(g_mainActivityRef, onFrame, jDevId, jData, keyframe ? JNI_TRUE : JNI_FALSE, (jlong)ptsUs);
+    }
+    if (jData) env->DeleteLocalRef(jData);
+    if (jDevId) env->DeleteLocalRef(jDevId);
+}
+
+// 已分配拼接格子的设备，把帧交给 MainActivity 中该设备的格子解码器
+static void forwardMosaicFrame(JNIEnv* env, const std::string& devId, const uint8_t* data, int length, bool keyframe,
+                               int64_t ptsUs) {
+    if (!g_mainActivityRef || !g_mosaic.isAttached() || !g_mosaic.hasTile(devId)) {
+        return;
+    }
+    jclass clazz = env->GetObjectClass(g_mainActivityRef);
+    jmethodID onFrame = env->GetMethodID(clazz, "onMosaicVideoFrame", "(Ljava/lang/String;[BZJ)V");
+    env->DeleteLocalRef(clazz);
+    if (!onFrame) {
+        LOGI("[画面拼接] 未找到 onMosaicVideoFrame 方法");
+        env->ExceptionClear();
+        return;
+    }
+    jstring jDevId = env->NewStringUTF(devId.c_str());
+    jbyteArray jData = env->NewByteArray(length);
+    if (jDevId && jData) {
+        env->SetByteArrayRegion(jData, 0, length, reinterpret_cast<const jbyte*>(data));
+        env->CallVoidMethod(g_mainActivityRef, onFrame, jDevId, jData, keyframe ? JNI_TRUE : JNI_FALSE, (jlong)ptsUs);
+    }
+    if (jData) env->DeleteLocalRef(jData);
+    if (jDevId) env->DeleteLocalRef(jDevId);
+}
+
+// 实时显示：把帧交给 P2pVideoView 解码，回放缓存 GOP 期间丢弃依赖旧参考帧的直播帧，直到直播 IDR 到达
+static void deliverToDisplay(const BusFrameRef& frame) {
+    const uint8_t* h264Data = frame->data.data();
+    const int length = (int)frame->data.size();
+    H264AccessUnitInfo auInfo = h264InspectAccessUnit(h264Data, length);
+    // 参考帧丢失后的帧解出来只有花屏，显示、画墙和移动侦测的解码器都不再喂，直到 IDR
+    bool requestKeyframe = false;
+    bool intact = g_continuity.onAccessUnit(frame->devId, h264Data, length, currentTimeMs(), &requestKeyframe);
+    if (requestKeyframe) {
+        sendKeyframeRequest(frame->devId);
+    }
+    if (!intact) {
+        return;
+    }
+    if (auInfo.hasIdr) {
+        g_abortGopReplay.store(true);
+        g_awaitLiveIdr.store(false);
+    } else if (auInfo.hasSlice && g_awaitLiveIdr.load()) {
+        LOGI("[GOP缓存] 等待直播IDR，丢弃非关键帧");
+        return;
+    }
+    if (!g_vm || !g_p2pVideoView) {
+        return;
+    }
+
+    JNIEnv* env;
+    bool needDetach = false;
+    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
+        if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            LOGI("[自检] Failed to attach thread");
+            return;
+        }
+        needDetach = true;
+    }
+
+    // 强制只走 onVideoFrameMethod 分支
+    if (g_trickPlayer.isActive()) {
+        // 快放/快退期间 P2pVideoView 显示录像，不送直播帧
+    } else if (g_onVideoFrameMethod) {
+        jbyteArray jData = env->NewByteArray(length);
+        if (jData) {
+            env->SetByteArrayRegion(jData, 0, length, reinterpret_cast<const jbyte*>(h264Data));
+            env->CallVoidMethod(g_p2pVideoView, g_onVideoFrameMethod, jData, (jlong)frame->ptsUs);
+            env->DeleteLocalRef(jData);
+            LOGI("[自检] Video frame sent to Java layer successfully (force AndroidView)");
+        }
+    } else {
+        LOGI("[自检] onVideoFrameMethod not available");
+    }
+
+    if (auInfo.hasIdr) {
+        requestThumbnail(env, frame->devId);
+    }
+    forwardMosaicFrame(env, frame->devId, h264Data, length, auInfo.hasIdr, frame->ptsUs);
+    forwardMotionFrame(env, frame->devId, h264Data, length, auInfo.hasIdr, frame->ptsUs);
+
+    if (needDetach) {
+        g_vm->DetachCurrentThread();
+    }
+}
+
+// 设备活跃状态变化时通知 MainActivity，由 Dart 决定是否把该设备提升为完整解码
+static void notifyCameraActivity(const CameraActivity& activity) {
+    if (!g_vm || !g_mainActivityRef) {
+        return;
+    }
+    JNIEnv* env;
+    bool needDetach = false;
+    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
+        if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            return;
+        }
+        needDetach = true;
+    }
+    jclass clazz = env->GetObjectClass(g_mainActivityRef);
+    jmethodID onActivity = env->GetMethodID(clazz, "onCameraActivity", "(Ljava/lang/String;ZI)V");
+    env->DeleteLocalRef(clazz);
+    if (onActivity) {
+        jstring jDevId = env->NewStringUTF(activity.devId.c_str());
+        env->CallVoidMethod(g_mainActivityRef, onActivity, jDevId, activity.active ? JNI_TRUE : JNI_FALSE,
+                            (jint)activity.score);
+        env->DeleteLocalRef(jDevId);
+    } else {
+        LOGI("[活动度] 未找到 onCameraActivity 方法");
+        env->ExceptionClear();
+    }
+    if (needDetach) {
+        g_vm->DetachCurrentThread();
+    }
+}
+
+static void registerFrameBusSubscribers() {
+    // 轻量消费者在接收线程上直接处理，按注册顺序执行
+    BusSubscriberOptions inlineOptions;
+    inlineOptions.inlineDelivery = true;
+    g_frameBus.subscribe("gop_cache", inlineOptions, [](const BusFrameRef& frame) {
+        g_gopCache.push(frame->devId, frame->data.data(), (int)frame->data.size());
+    });
+    g_frameBus.subscribe("frame_ring", inlineOptions, [](const BusFrameRef& frame) {
+        g_frameRing.push(frame->data.data(), (int)frame->data.size(), frame->keyframe, frame->ptsUs);
+    });
+    g_frameBus.subscribe("stream_profiles", inlineOptions, [](const BusFrameRef& frame) {
+        g_streamProfiles.onData(frame->devId, (int)frame->data.size(), frame->arrivalUs / 1000);
+        negotiateStreamProfiles();
+    });
+    g_frameBus.subscribe("activity", inlineOptions, [](const BusFrameRef& frame) {
+        CameraActivity changed;
+        if (g_activityEstimator.onAccessUnit(frame->devId, frame->data.data(), (int)frame->data.size(),
+                                             frame->arrivalUs / 1000, &changed)) {
+            notifyCameraActivity(changed);
+        }
+    });
+    g_frameBus.subscribe("display", inlineOptions, deliverToDisplay);
+
+    // 录像要写盘，各自排队；积压时丢到下一个关键帧，保证写出的文件仍可解码
+    BusSubscriberOptions recorderOptions;
+    recorderOptions.maxBytes = 8 * 1024 * 1024;
+    recorderOptions.dropPolicy = BUS_DROP_UNTIL_KEYFRAME;
+    g_frameBus.subscribe("recorder", recorderOptions, [](const BusFrameRef& frame) {
+        if (g_recorder.isRecording()) {
+            g_recorder.push(frame->data.data(), (int)frame->data.size(), frame->ptsUs);
+        }
+    });
+    g_frameBus.subscribe("pre_event", recorderOptions, [](const BusFrameRef& frame) {
+        g_preEventRecorder.push(frame->devId, busFramePayload(frame), frame->ptsUs);
+    });
+}
+
 void RecbVideoData(void* data, int length) {
+    // 到达时间在入口处记录，不受下面日志和格式检查耗时的影响
+    const int64_t arrivalUs = monotonicTimeUs();
     LOGI("[自检] >>>>>>>>>>>> RecbVideoData called! length: %d", length);
     LOGI("[自检] RecbVideoData: g_p2pVideoView=%p, g_onVideoFrameMethod=%p", g_p2pVideoView, g_onVideoFrameMethod);
     
@@ -207,8 +795,14 @@ void RecbVideoData(void* data, int length) {
         return;
     }
 
-    // 检查H.264格式特征
+    // 不以 Annex-B 起始码开头的包可能是音频，由音频管线识别；识别出的不再进视频总线
     const unsigned char* h264Data = reinterpret_cast<const unsigned char*>(data);
+    if (h264FindStartCode(h264Data, length, 0, nullptr) != 0 &&
+        g_audioPipeline.onPacket(currentDevId(), h264Data, length, arrivalUs)) {
+        return;
+    }
+
+    // 检查H.264格式特征
     bool hasNalStart = false;
     bool hasKeyFrame = false;
     
@@ -231,32 +825,12 @@ void RecbVideoData(void* data, int length) {
         LOGI("[自检] H.264格式验证失败: 未检测到NAL起始码");
     }
 
-    JNIEnv* env;
-    bool needDetach = false;
-    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
-        if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
-            LOGI("[自检] Failed to attach thread");
-            return;
-        }
-        needDetach = true;
-    }
-
-    // 强制只走 onVideoFrameMethod 分支
-    if (g_onVideoFrameMethod) {
-        jbyteArray jData = env->NewByteArray(length);
-        if (jData) {
-            env->SetByteArrayRegion(jData, 0, length, reinterpret_cast<const jbyte*>(data));
-            env->CallVoidMethod(g_p2pVideoView, g_onVideoFrameMethod, jData);
-            env->DeleteLocalRef(jData);
-            LOGI("[自检] Video frame sent to Java layer successfully (force AndroidView)");
-        }
-    } else {
-        LOGI("[自检] onVideoFrameMethod not available");
-    }
-
-    if (needDetach) {
-        g_vm->DetachCurrentThread();
-    }
+    // 数据只拷贝一次进总线，GOP 缓存、Dart 帧环、录像和显示都从总线取引用
+    std::call_once(g_frameBusOnce, registerFrameBusSubscribers);
+    H264AccessUnitInfo auInfo = h264InspectAccessUnit(h264Data, length);
+    const std::string devId = currentDevId();
+    const int64_t ptsUs = g_streamClock.stamp(devId, h264Data, length, arrivalUs);
+    g_frameBus.publish(devId, h264Data, length, auInfo.hasIdr, arrivalUs, ptsUs);
 }
 
 extern "C" JNIEXPORT void JNICALL
@@ -367,6 +941,7 @@ extern "C" JNIEXPORT void JNICALL
 Java_com_xiebaoxin_MainActivity_P2pTestActivity_setDevP2p(JNIEnv* env, jobject /* this */, jstring devId) {
     const char* pDevId = env->GetStringUTFChars(devId, nullptr);
     LOGI("[native] JNI setDevP2p called: %s", pDevId);
+    setCurrentDevId(pDevId);
     SetDevP2p((char*)pDevId);
     env->ReleaseStringUTFChars(devId, pDevId);
     LOGI("[native] setDevP2p completed");
@@ -377,7 +952,7 @@ JNIEXPORT void JNICALL
 Java_com_xiebaoxin_MainActivity_P2pTestActivity_setFlutterTextureId(JNIEnv* env, jobject thiz, jlong textureId) {
     g_flutterTextureId = textureId;
     __android_log_print(ANDROID_LOG_INFO, "NativeLib", "setFlutterTextureId called: %lld", (long long)textureId);
-    // TODO: 这里可以根据 textureId 获取/绑定 Surface/SurfaceTexture
+    // Surface 由 MainActivity.attachYuvRenderer 传入 GlYuvRenderer，这里只记录纹理 id
 }
 
 // 添加P2P连接状态检查函数
@@ -456,9 +1031,10 @@ Java_com_mainipc_xiebaoxin_P2pVideoView_bindNative(
 
     // 获取方法 ID
     jclass clazz = env->GetObjectClass(thiz);
-    g_onVideoFrameMethod = env->GetMethodID(clazz, "onVideoFrame", "([B)V");
+    g_onVideoFrameMethod = env->GetMethodID(clazz, "onVideoFrame", "([BJ)V");
     g_onTextureFrameMethod = env->GetMethodID(clazz, "onTextureFrame", "(JII)V");
     g_onErrorMethod = env->GetMethodID(clazz, "onError", "(Ljava/lang/String;)V");
+    g_onCachedVideoFrameMethod = env->GetMethodID(clazz, "onCachedVideoFrame", "([B)V");
 
     LOGI("P2pVideoView native bind successful, g_p2pVideoView=%p, g_onVideoFrameMethod=%p", g_p2pVideoView, g_onVideoFrameMethod);
 }
@@ -523,6 +1099,9 @@ Java_com_mainipc_xiebaoxin_P2pVideoView_startP2pVideo(
     try {
         g_frameCount.store(0);
         g_errorCount.store(0);
+
+        // 先回放该设备缓存的GOP，让画面在第一个帧间隔内出现
+        startGopReplay(currentDevId());
         
         LOGI("[P2pVideoView] Calling StartP2pVideo...");
         
@@ -616,6 +1195,7 @@ Java_com_mainipc_xiebaoxin_P2pVideoView_release(
     g_onVideoFrameMethod = nullptr;
     g_onTextureFrameMethod = nullptr;
     g_onErrorMethod = nullptr;
+    g_onCachedVideoFrameMethod = nullptr;
     
     LOGI("P2pVideoView native resources released");
 }
@@ -662,6 +1242,7 @@ Java_com_mainipc_xiebaoxin_MainActivity_setDevP2p(
         jstring devId) {
     const char* pDevId = env->GetStringUTFChars(devId, nullptr);
     LOGI("[native] JNI setDevP2p called: %s", pDevId);
+    setCurrentDevId(pDevId);
     SetDevP2p((char*)pDevId);
     env->ReleaseStringUTFChars(devId, pDevId);
     LOGI("[native] setDevP2p completed");
@@ -797,4 +1378,1357 @@ Java_com_mainipc_xiebaoxin_MainActivity_sendJsonMsg(JNIEnv *env, jobject thiz, j
     env->ReleaseStringUTFChars(json, jsonStr);
     env->ReleaseStringUTFChars(topic, topicStr);
     return ret;
-} 
\ No newline at end of file
+} 
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_configureGopCache(
+        JNIEnv* env,
+        jobject thiz,
+        jlong totalBytes,
+        jlong perDeviceBytes) {
+    if (totalBytes < 0 || perDeviceBytes < 0) {
+        LOGE("configureGopCache: invalid budget total=%lld, perDevice=%lld", (long long)totalBytes, (long long)perDeviceBytes);
+        return;
+    }
+    g_gopCache.configure((size_t)totalBytes, (size_t)perDeviceBytes);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_initThumbnailCache(
+        JNIEnv* env,
+        jobject thiz,
+        jstring dir) {
+    const char* dirStr = env->GetStringUTFChars(dir, nullptr);
+    if (!dirStr) {
+        return;
+    }
+    if (!g_thumbnailCache.open(dirStr)) {
+        LOGE("[缩略图] 缓存目录初始化失败: %s", dirStr);
+    }
+    env->ReleaseStringUTFChars(dir, dirStr);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_putThumbnail(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jbyteArray data,
+        jint width,
+        jint height) {
+    if (!devId || !data) {
+        return;
+    }
+    const char* devIdStr = env->GetStringUTFChars(devId, nullptr);
+    jsize length = env->GetArrayLength(data);
+    jbyte* bytes = env->GetByteArrayElements(data, nullptr);
+    if (devIdStr && bytes && length > 0) {
+        ThumbnailInfo info;
+        info.width = width;
+        info.height = height;
+        info.timestampMs = currentTimeMs();
+        g_thumbnailCache.put(devIdStr, reinterpret_cast<const uint8_t*>(bytes), (size_t)length, info);
+        LOGI("[缩略图] 已缓存: devId=%s, %dx%d, size=%d", devIdStr, width, height, length);
+    }
+    if (bytes) env->ReleaseByteArrayElements(data, bytes, JNI_ABORT);
+    if (devIdStr) env->ReleaseStringUTFChars(devId, devIdStr);
+}
+
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getThumbnail(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId) {
+    if (!devId) {
+        return nullptr;
+    }
+    const char* devIdStr = env->GetStringUTFChars(devId, nullptr);
+    if (!devIdStr) {
+        return nullptr;
+    }
+    std::vector<uint8_t> data;
+    bool found = g_thumbnailCache.get(devIdStr, data, nullptr);
+    env->ReleaseStringUTFChars(devId, devIdStr);
+    if (!found || data.empty()) {
+        return nullptr;
+    }
+    jbyteArray jData = env->NewByteArray((jsize)data.size());
+    if (jData) {
+        env->SetByteArrayRegion(jData, 0, (jsize)data.size(), reinterpret_cast<const jbyte*>(data.data()));
+    }
+    return jData;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_ThumbnailGenerator_convertYuvToArgb(
+        JNIEnv* env,
+        jobject thiz,
+        jobject yBuffer,
+        jobject uBuffer,
+        jobject vBuffer,
+        jint yRowStride,
+        jint uvRowStride,
+        jint uvPixelStride,
+        jint width,
+        jint height,
+        jintArray dst,
+        jint dstWidth,
+        jint dstHeight) {
+    Yuv420Planes planes;
+    planes.y = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    planes.u = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer));
+    planes.v = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer));
+    planes.yRowStride = yRowStride;
+    planes.uvRowStride = uvRowStride;
+    planes.uvPixelStride = uvPixelStride;
+    planes.width = width;
+    planes.height = height;
+    if (!planes.y || !planes.u || !planes.v || !dst || env->GetArrayLength(dst) < dstWidth * dstHeight) {
+        LOGE("[缩略图] convertYuvToArgb: invalid buffers");
+        return JNI_FALSE;
+    }
+    void* pixels = env->GetPrimitiveArrayCritical(dst, nullptr);
+    if (!pixels) {
+        return JNI_FALSE;
+    }
+    yuv420ToArgbBoxScale(planes, static_cast<uint32_t*>(pixels), dstWidth, dstHeight);
+    env->ReleasePrimitiveArrayCritical(dst, pixels, 0);
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_startRecording(
+        JNIEnv* env,
+        jobject thiz,
+        jstring path) {
+    if (!path) {
+        return JNI_FALSE;
+    }
+    const char* pathStr = env->GetStringUTFChars(path, nullptr);
+    if (!pathStr) {
+        return JNI_FALSE;
+    }
+
+    // 设备只在流开头发送参数集时，从 GOP 缓存中取最近的 SPS/PPS
+    std::vector<uint8_t> keyframe;
+    if (g_gopCache.latestKeyframe(currentDevId(), keyframe)) {
+        std::vector<H264NalUnit> nals;
+        h264SplitNalUnits(keyframe.data(), (int)keyframe.size(), nals);
+        std::vector<uint8_t> sps;
+        std::vector<uint8_t> pps;
+        for (const H264NalUnit& nal : nals) {
+            if (nal.type == H264_NAL_SPS) sps.assign(nal.data, nal.data + nal.size);
+            if (nal.type == H264_NAL_PPS) pps.assign(nal.data, nal.data + nal.size);
+        }
+        g_recorder.setParameterSets(sps, pps);
+    }
+
+    // 每个以 IDR 开头的分片落盘后追加一条索引；没有设置索引目录时放在录像文件所在目录
+    const std::string devId = currentDevId();
+    const std::string recordingPath = pathStr;
+    {
+        std::lock_guard<std::mutex> lock(g_keyframeIndexMutex);
+        const size_t slash = recordingPath.rfind('/');
+        if (g_keyframeIndexDir.empty() && slash != std::string::npos) {
+            g_keyframeIndexDir = recordingPath.substr(0, slash);
+        }
+    }
+    std::shared_ptr<KeyframeIndex> index = keyframeIndexFor(devId);
+    if (index) {
+        // 录像文件会被截断重写，先删掉上次录到这个路径时留下的记录，避免写入第一个分片前查到旧位置
+        index->removeSegment(recordingPath);
+        // 参数集变化时录像切到新文件，每个文件单独登记；两个回调都在写线程上，共享当前文件编号
+        std::shared_ptr<int64_t> segmentId = std::make_shared<int64_t>(-1);
+        g_recorder.setSegmentCallback([index, segmentId](const std::string& segmentPath) {
+            uint32_t id = 0;
+            *segmentId = index->beginSegment(segmentPath, &id) ? (int64_t)id : -1;
+        });
+        g_recorder.setKeyframeCallback([index, segmentId](const Fmp4KeyframeInfo& info) {
+            if (*segmentId < 0) {
+                return;
+            }
+            KeyframeEntry entry;
+            // PTS 在单调时钟域，按当前两个时钟的差换算成墙上时间
+            entry.timeUs = info.ptsUs + (currentTimeMs() * 1000 - monotonicTimeUs());
+            entry.segmentId = (uint32_t)*segmentId;
+            entry.fragmentOffset = info.fragmentOffset;
+            entry.sampleOffset = info.sampleOffset;
+            entry.sampleSize = info.sampleSize;
+            index->append(entry);
+        });
+    } else {
+        g_recorder.setSegmentCallback(nullptr);
+        g_recorder.setKeyframeCallback(nullptr);
+    }
+
+    bool ok = g_recorder.start(pathStr);
+    LOGI("[录像] startRecording: %s, ok=%d", pathStr, ok);
+    env->ReleaseStringUTFChars(path, pathStr);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_stopRecording(
+        JNIEnv* env,
+        jobject thiz) {
+    // 会等待写线程把剩余分片落盘，Java 层应在后台线程调用
+    g_recorder.stop();
+    LOGI("[录像] stopRecording completed");
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getRecordingStats(
+        JNIEnv* env,
+        jobject thiz) {
+    Fmp4RecorderStats stats = g_recorder.stats();
+    jlong values[7] = {
+        (jlong)stats.bytesWritten,
+        (jlong)stats.fragmentsWritten,
+        (jlong)stats.framesWritten,
+        (jlong)stats.droppedFragments,
+        (jlong)stats.muxTimeUs,
+        (jlong)stats.writeTimeUs,
+        (jlong)stats.segments,
+    };
+    jlongArray result = env->NewLongArray(7);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 7, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_setKeyframeIndexDir(
+        JNIEnv* env,
+        jobject thiz,
+        jstring dir) {
+    const char* pDir = dir ? env->GetStringUTFChars(dir, nullptr) : nullptr;
+    std::lock_guard<std::mutex> lock(g_keyframeIndexMutex);
+    g_keyframeIndexDir = pDir ? pDir : "";
+    // 已打开的索引仍在原目录，下次使用时按新目录重新打开
+    g_keyframeIndexes.clear();
+    LOGI("[录像] setKeyframeIndexDir: %s", g_keyframeIndexDir.c_str());
+    if (pDir) env->ReleaseStringUTFChars(dir, pDir);
+}
+
+// 返回不晚于 timeMs 的最近关键帧：下标（-1 表示索引为空）、时间、录像文件编号、分片偏移、样本偏移、样本大小、查找耗时
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_seekRecording(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jlong timeMs) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const std::string deviceId = pDevId ? pDevId : "";
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+
+    std::shared_ptr<KeyframeIndex> index = keyframeIndexFor(deviceId);
+    KeyframeEntry entry;
+    const int64_t startUs = monotonicTimeUs();
+    const long position = index ? index->seek((int64_t)timeMs * 1000, &entry) : -1;
+    const int64_t lookupUs = monotonicTimeUs() - startUs;
+    jlong values[7] = {
+        position,
+        entry.timeUs / 1000,
+        entry.segmentId,
+        (jlong)entry.fragmentOffset,
+        (jlong)entry.sampleOffset,
+        entry.sampleSize,
+        lookupUs,
+    };
+    jlongArray result = env->NewLongArray(7);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 7, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getRecordingSegmentPath(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jint segmentId) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const std::string deviceId = pDevId ? pDevId : "";
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+
+    std::shared_ptr<KeyframeIndex> index = keyframeIndexFor(deviceId);
+    const std::string path = index && segmentId >= 0 ? index->segmentPath((uint32_t)segmentId) : std::string();
+    return path.empty() ? nullptr : env->NewStringUTF(path.c_str());
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getKeyframeIndexStats(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const std::string deviceId = pDevId ? pDevId : "";
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+
+    std::shared_ptr<KeyframeIndex> index = keyframeIndexFor(deviceId);
+    KeyframeIndexStats stats = index ? index->stats() : KeyframeIndexStats();
+    jlong values[8] = {
+        (jlong)stats.entries,
+        (jlong)stats.segments,
+        (jlong)stats.recoveredRecords,
+        (jlong)stats.clampedRecords,
+        stats.firstTimeUs / 1000,
+        stats.lastTimeUs / 1000,
+        (jlong)stats.fileBytes,
+        (jlong)stats.prunedRecords,
+    };
+    jlongArray result = env->NewLongArray(8);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 8, values);
+    }
+    return result;
+}
+
+// 录像文件被删除后调用：path 非空时删除引用它的记录，为空时删除所有引用已不存在文件的记录；返回删除的条数
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_pruneKeyframeIndex(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jstring path) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const std::string deviceId = pDevId ? pDevId : "";
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    const char* pPath = path ? env->GetStringUTFChars(path, nullptr) : nullptr;
+    const std::string segmentPath = pPath ? pPath : "";
+    if (pPath) env->ReleaseStringUTFChars(path, pPath);
+
+    std::shared_ptr<KeyframeIndex> index = keyframeIndexFor(deviceId);
+    if (!index) {
+        return 0;
+    }
+    const size_t removed = segmentPath.empty() ? index->prune() : index->removeSegment(segmentPath);
+    LOGI("[录像] pruneKeyframeIndex devId=%s path=%s: 删除 %zu 条记录", deviceId.c_str(), segmentPath.c_str(), removed);
+    return (jlong)removed;
+}
+
+// 快放/快退的关键帧送到 P2pVideoView，送帧线程需要临时附加到 JVM
+static void deliverTrickPlayFrame(const uint8_t* data, int length, int64_t ptsUs) {
+    if (!g_vm || !g_p2pVideoView || !g_onVideoFrameMethod) {
+        return;
+    }
+    JNIEnv* env;
+    bool needDetach = false;
+    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
+        if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            LOGE("[快放] Failed to attach thread");
+            return;
+        }
+        needDetach = true;
+    }
+    jbyteArray jData = env->NewByteArray(length);
+    if (jData) {
+        env->SetByteArrayRegion(jData, 0, length, reinterpret_cast<const jbyte*>(data));
+        env->CallVoidMethod(g_p2pVideoView, g_onVideoFrameMethod, jData, (jlong)ptsUs);
+        env->DeleteLocalRef(jData);
+    }
+    if (needDetach) {
+        g_vm->DetachCurrentThread();
+    }
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_startTrickPlay(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jlong startTimeMs,
+        jint speed,
+        jint maxFps) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const std::string deviceId = pDevId ? pDevId : "";
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+
+    std::shared_ptr<KeyframeIndex> index = keyframeIndexFor(deviceId);
+    if (!index) {
+        LOGE("[快放] startTrickPlay devId=%s: 没有关键帧索引", deviceId.c_str());
+        return JNI_FALSE;
+    }
+    // 直播帧的平滑状态不适用于录像帧，从第一帧重新建立；录像帧的 PTS 与直播音频无关，不跟随音频时钟
+    g_presentationScheduler.reset();
+    g_masterClock.enterTrickPlay();
+    bool ok = g_trickPlayer.start(index, (int64_t)startTimeMs * 1000, speed, maxFps, deliverTrickPlayFrame);
+    if (!ok) {
+        g_masterClock.leaveTrickPlay();
+    }
+    LOGI("[快放] startTrickPlay devId=%s speed=%d: %s", deviceId.c_str(), speed, ok ? "ok" : "failed");
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_setTrickPlaySpeed(
+        JNIEnv* env,
+        jobject thiz,
+        jint speed) {
+    return g_trickPlayer.setSpeed(speed) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_stopTrickPlay(
+        JNIEnv* env,
+        jobject thiz) {
+    // stopP2pVideo 每次都会调用；没在快放时不碰显示调度，也不给要离开的设备发关键帧请求
+    if (!g_trickPlayer.isActive()) {
+        return;
+    }
+    g_trickPlayer.stop();
+    // 回到直播：解码器里只有录像的参考帧，等直播 IDR 再送解码；显示调度重新跟随直播到达时间和音频时钟
+    g_awaitLiveIdr.store(true);
+    g_presentationScheduler.reset();
+    g_masterClock.leaveTrickPlay();
+    const std::string deviceId = currentDevId();
+    if (!deviceId.empty()) {
+        sendKeyframeRequest(deviceId);
+    }
+    LOGI("[快放] stopTrickPlay");
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getTrickPlayStats(
+        JNIEnv* env,
+        jobject thiz) {
+    TrickPlayStats stats = g_trickPlayer.stats();
+    jlong values[9] = {
+        stats.active ? 1 : 0,
+        stats.ended ? 1 : 0,
+        stats.speed,
+        (jlong)stats.deliveredFrames,
+        (jlong)stats.skippedKeyframes,
+        (jlong)stats.readErrors,
+        stats.positionUs / 1000,
+        stats.lastFrameTimeUs / 1000,
+        stats.readUs,
+    };
+    jlongArray result = env->NewLongArray(9);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 9, values);
+    }
+    return result;
+}
+
+// 预录文件写完后通知 Java 层，事件线程需要临时附加到 JVM
+static void notifyEventRecordingFinished(const std::string& devId, const std::string& path) {
+    if (!g_vm || !g_mainActivityRef) {
+        return;
+    }
+    JNIEnv* env;
+    bool needDetach = false;
+    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
+        if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+            LOGE("[预录] Failed to attach thread");
+            return;
+        }
+        needDetach = true;
+    }
+    jclass clazz = env->GetObjectClass(g_mainActivityRef);
+    jmethodID onFinished = env->GetMethodID(clazz, "onEventRecordingFinished", "(Ljava/lang/String;Ljava/lang/String;)V");
+    env->DeleteLocalRef(clazz);
+    if (onFinished) {
+        jstring jDevId = env->NewStringUTF(devId.c_str());
+        jstring jPath = env->NewStringUTF(path.c_str());
+        env->CallVoidMethod(g_mainActivityRef, onFinished, jDevId, jPath);
+        env->DeleteLocalRef(jDevId);
+        env->DeleteLocalRef(jPath);
+    } else {
+        env->ExceptionClear();
+        LOGI("[预录] 未找到 onEventRecordingFinished 方法");
+    }
+    if (needDetach) {
+        g_vm->DetachCurrentThread();
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_configurePreEventRecording(
+        JNIEnv* env,
+        jobject thiz,
+        jstring outputDir,
+        jobjectArray eventTypes,
+        jlong perDeviceBytes,
+        jint preSeconds,
+        jint postSeconds) {
+    if (perDeviceBytes < 0) {
+        LOGE("configurePreEventRecording: invalid budget %lld", (long long)perDeviceBytes);
+        return;
+    }
+    if (!g_vm) {
+        env->GetJavaVM(&g_vm);
+    }
+    const char* dirStr = env->GetStringUTFChars(outputDir, nullptr);
+    if (dirStr) {
+        g_preEventRecorder.setOutputDir(dirStr);
+        env->ReleaseStringUTFChars(outputDir, dirStr);
+    }
+
+    std::set<std::string> types;
+    jsize count = eventTypes ? env->GetArrayLength(eventTypes) : 0;
+    for (jsize i = 0; i < count; i++) {
+        jstring jType = (jstring)env->GetObjectArrayElement(eventTypes, i);
+        if (!jType) {
+            continue;
+        }
+        const char* typeStr = env->GetStringUTFChars(jType, nullptr);
+        if (typeStr) {
+            types.insert(typeStr);
+            env->ReleaseStringUTFChars(jType, typeStr);
+        }
+        env->DeleteLocalRef(jType);
+    }
+    g_preEventRecorder.setTriggerTypes(types);
+    g_preEventRecorder.configure((size_t)perDeviceBytes, preSeconds, postSeconds);
+    g_preEventRecorder.setFinishedCallback(notifyEventRecordingFinished);
+    LOGI("[预录] 已配置: types=%zu, perDevice=%lld, pre=%ds, post=%ds",
+         types.size(), (long long)perDeviceBytes, (int)preSeconds, (int)postSeconds);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_attachYuvRenderer(
+        JNIEnv* env,
+        jobject thiz,
+        jobject surface) {
+    ANativeWindow* window = surface ? ANativeWindow_fromSurface(env, surface) : nullptr;
+    if (!window) {
+        LOGE("[GPU渲染] attachYuvRenderer: invalid surface");
+        return JNI_FALSE;
+    }
+    g_yuvRenderer.detach();
+    bool ok = g_yuvRenderer.attach(window);
+    // attach 内部已持有窗口引用
+    ANativeWindow_release(window);
+    LOGI("[GPU渲染] attachYuvRenderer: %s", ok ? "ok" : "failed");
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_detachYuvRenderer(
+        JNIEnv* env,
+        jobject thiz) {
+    g_yuvRenderer.detach();
+    // 渲染器归还最后一帧后，空闲缓冲不再需要
+    g_framePool.trim();
+}
+
+// 移动侦测和画面健康检查任一方到了采样间隔才把帧拷进池化帧（已有池化帧时直接复用），两者共享这一份
+static void submitAnalyticsFrame(const std::string& devId, const Yuv420Planes& planes, FrameRef frame, int64_t nowMs) {
+    const bool motion = g_motionDetector.shouldSample(devId, nowMs);
+    const bool health = g_pictureHealth.shouldSample(devId, nowMs);
+    if (!motion && !health) {
+        return;
+    }
+    if (!frame) {
+        frame = g_framePool.importFrame(planes, nowMs * 1000);
+        if (!frame) {
+            return;
+        }
+    }
+    if (motion) {
+        g_motionDetector.submit(devId, frame, nowMs);
+    }
+    if (health) {
+        g_pictureHealth.submit(devId, frame, nowMs);
+    }
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_renderYuvFrame(
+        JNIEnv* env,
+        jobject thiz,
+        jobject yBuffer,
+        jobject uBuffer,
+        jobject vBuffer,
+        jint yRowStride,
+        jint uvRowStride,
+        jint uvPixelStride,
+        jint width,
+        jint height) {
+    Yuv420Planes planes;
+    planes.y = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    planes.u = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer));
+    planes.v = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer));
+    planes.yRowStride = yRowStride;
+    planes.uvRowStride = uvRowStride;
+    planes.uvPixelStride = uvPixelStride;
+    planes.width = width;
+    planes.height = height;
+    if (!g_yuvRenderer.isAttached() || !planes.y || !planes.u || !planes.v) {
+        return JNI_FALSE;
+    }
+    // Image 在返回后即被关闭，这里拷进池化帧一次，之后只传递引用
+    FrameRef frame = g_framePool.importFrame(planes, 0);
+    if (!frame) {
+        return JNI_FALSE;
+    }
+    submitAnalyticsFrame(currentDevId(), planes, frame, currentTimeMs());
+    return g_yuvRenderer.submitFrame(frame) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_YuvUtils_nativeImageToPacked(
+        JNIEnv* env,
+        jobject thiz,
+        jobject yBuffer,
+        jobject uBuffer,
+        jobject vBuffer,
+        jint yRowStride,
+        jint uvRowStride,
+        jint uvPixelStride,
+        jint width,
+        jint height,
+        jbyteArray dst,
+        jint format) {
+    Yuv420Planes planes;
+    planes.y = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    planes.u = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer));
+    planes.v = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer));
+    planes.yRowStride = yRowStride;
+    planes.uvRowStride = uvRowStride;
+    planes.uvPixelStride = uvPixelStride;
+    planes.width = width;
+    planes.height = height;
+    if (!planes.y || !planes.u || !planes.v || !dst) {
+        LOGE("nativeImageToPacked: invalid buffers");
+        return JNI_FALSE;
+    }
+    size_t dstSize = (size_t)env->GetArrayLength(dst);
+    void* out = env->GetPrimitiveArrayCritical(dst, nullptr);
+    if (!out) {
+        return JNI_FALSE;
+    }
+    bool ok = yuv420ToPacked(planes, static_cast<uint8_t*>(out), dstSize,
+                             format == YUV_PACKED_I420 ? YUV_PACKED_I420 : YUV_PACKED_NV21);
+    env->ReleasePrimitiveArrayCritical(dst, out, 0);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_attachMosaic(
+        JNIEnv* env,
+        jobject thiz,
+        jobject surface,
+        jint columns,
+        jint rows,
+        jint width,
+        jint height,
+        jint fps) {
+    ANativeWindow* window = surface ? ANativeWindow_fromSurface(env, surface) : nullptr;
+    if (!window) {
+        LOGE("[画面拼接] attachMosaic: invalid surface");
+        return JNI_FALSE;
+    }
+    g_mosaic.detach();
+    bool ok = g_mosaic.attach(window, columns, rows, width, height, fps);
+    // attach 内部已持有窗口引用
+    ANativeWindow_release(window);
+    LOGI("[画面拼接] attachMosaic: %dx%d, %dx%d, %s", columns, rows, width, height, ok ? "ok" : "failed");
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_detachMosaic(
+        JNIEnv* env,
+        jobject thiz) {
+    g_mosaic.detach();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_setMosaicTile(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jint index) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    bool ok = g_mosaic.assignTile(pDevId ? pDevId : "", index);
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_removeMosaicTile(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    g_mosaic.removeTile(pDevId ? pDevId : "");
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_submitMosaicFrame(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jobject yBuffer,
+        jobject uBuffer,
+        jobject vBuffer,
+        jint yRowStride,
+        jint uvRowStride,
+        jint uvPixelStride,
+        jint width,
+        jint height) {
+    Yuv420Planes planes;
+    planes.y = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    planes.u = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer));
+    planes.v = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer));
+    planes.yRowStride = yRowStride;
+    planes.uvRowStride = uvRowStride;
+    planes.uvPixelStride = uvPixelStride;
+    planes.width = width;
+    planes.height = height;
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    bool ok = g_mosaic.submitFrame(pDevId ? pDevId : "", planes);
+    if (planes.y && planes.u && planes.v) {
+        submitAnalyticsFrame(pDevId ? pDevId : "", planes, FrameRef(), currentTimeMs());
+    }
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getMosaicStats(
+        JNIEnv* env,
+        jobject thiz) {
+    MosaicCompositor::Stats stats = g_mosaic.stats();
+    jlong values[4] = {
+        (jlong)stats.submittedFrames,
+        (jlong)stats.composedFrames,
+        (jlong)stats.skippedTicks,
+        (jlong)stats.redrawnTiles,
+    };
+    jlongArray result = env->NewLongArray(4);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 4, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_reportViewSize(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jint viewId,
+        jint width,
+        jint height) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    if (pDevId) {
+        g_streamProfiles.setViewSize(pDevId, viewId, width, height, monotonicTimeUs() / 1000);
+        env->ReleaseStringUTFChars(devId, pDevId);
+    }
+    negotiateStreamProfiles();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_configureStreamProfiles(
+        JNIEnv* env,
+        jobject thiz,
+        jintArray widths,
+        jintArray heights) {
+    jsize count = env->GetArrayLength(widths);
+    if (env->GetArrayLength(heights) != count) {
+        LOGE("[码流协商] configureStreamProfiles: 宽高数量不一致");
+        return;
+    }
+    std::vector<jint> w(count);
+    std::vector<jint> h(count);
+    env->GetIntArrayRegion(widths, 0, count, w.data());
+    env->GetIntArrayRegion(heights, 0, count, h.data());
+    std::vector<StreamProfile> profiles;
+    for (jsize i = 0; i < count; i++) {
+        profiles.push_back({w[i], h[i]});
+    }
+    g_streamProfiles.setProfiles(profiles);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getStreamProfileStats(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    StreamProfileStats stats;
+    bool found = pDevId && g_streamProfiles.stats(pDevId, stats);
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    if (!found) {
+        return nullptr;
+    }
+    jlong values[8] = {
+        (jlong)stats.width,
+        (jlong)stats.height,
+        (jlong)stats.requiredWidth,
+        (jlong)stats.requiredHeight,
+        (jlong)stats.switches,
+        (jlong)stats.bytesReceived,
+        (jlong)stats.savedBytes,
+        (jlong)stats.bitrateBps,
+    };
+    jlongArray result = env->NewLongArray(8);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 8, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_mainipc_xiebaoxin_P2pVideoView_schedulePresentation(
+        JNIEnv* env,
+        jobject thiz,
+        jlong arrivalUs,
+        jlong nowNs) {
+    return g_presentationScheduler.schedule(arrivalUs, nowNs);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_P2pVideoView_onPresentationVsync(
+        JNIEnv* env,
+        jobject thiz,
+        jlong frameTimeNs,
+        jlong periodNs) {
+    g_presentationScheduler.onVsync(frameTimeNs, periodNs);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_P2pVideoView_onPresentationSuperseded(
+        JNIEnv* env,
+        jobject thiz) {
+    g_presentationScheduler.onFrameSuperseded();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_P2pVideoView_resetPresentation(
+        JNIEnv* env,
+        jobject thiz) {
+    g_presentationScheduler.reset();
+}
+
+// 单画面 MediaCodec 直接输出到 Surface，拿不到 YUV：P2pVideoView 低频回读显示内容（已缩小的 RGBA），
+// 转成池化 I420 帧后交给移动侦测和画面健康检查
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_P2pVideoView_submitDisplayedFrame(
+        JNIEnv* env,
+        jobject thiz,
+        jobject rgbaBuffer,
+        jint rowStride,
+        jint width,
+        jint height) {
+    const uint8_t* rgba = static_cast<const uint8_t*>(env->GetDirectBufferAddress(rgbaBuffer));
+    if (!rgba || width <= 0 || height <= 0 || rowStride < width * 4 ||
+        env->GetDirectBufferCapacity(rgbaBuffer) < (jlong)rowStride * height) {
+        return JNI_FALSE;
+    }
+    // 快放/快退显示的是录像关键帧，不代表实时画面
+    if (g_trickPlayer.isActive()) {
+        return JNI_FALSE;
+    }
+    FrameRef frame = g_framePool.acquire(width, height);
+    if (!frame) {
+        return JNI_FALSE;
+    }
+    const int64_t nowMs = currentTimeMs();
+    rgbaToI420(rgba, rowStride, width, height, frame->y, frame->u, frame->v);
+    frame->ptsUs = nowMs * 1000;
+    submitAnalyticsFrame(currentDevId(), frame->planes(), frame, nowMs);
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_setPresentationDelay(
+        JNIEnv* env,
+        jobject thiz,
+        jint delayMs) {
+    g_presentationScheduler.setTargetDelayMs(delayMs);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getPresentationStats(
+        JNIEnv* env,
+        jobject thiz) {
+    PresentationStats stats = g_presentationScheduler.stats();
+    jlong values[8] = {
+        (jlong)stats.scheduledFrames,
+        (jlong)stats.lateFrames,
+        (jlong)stats.earlyFrames,
+        (jlong)stats.droppedFrames,
+        (jlong)stats.resyncs,
+        (jlong)stats.delayUs,
+        (jlong)stats.jitterUs,
+        (jlong)stats.frameIntervalUs,
+    };
+    jlongArray result = env->NewLongArray(8);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 8, values);
+    }
+    return result;
+}
+
+// ---- dart:ffi 接口（lib/services/native_frame_ring.dart），按 C 符号导出，不经过 JNI ----
+
+extern "C" __attribute__((visibility("default"))) int32_t
+p2p_frame_ring_open(void* postCObject, int64_t port, int64_t capacity) {
+    if (!postCObject || capacity < 0) {
+        return 0;
+    }
+    return g_frameRing.open(reinterpret_cast<FrameRing::PostCObjectFn>(postCObject), port,
+                            static_cast<size_t>(capacity)) ? 1 : 0;
+}
+
+extern "C" __attribute__((visibility("default"))) void p2p_frame_ring_close() {
+    g_frameRing.close();
+}
+
+extern "C" __attribute__((visibility("default"))) const FrameRingHeader* p2p_frame_ring_header() {
+    return g_frameRing.header();
+}
+
+extern "C" __attribute__((visibility("default"))) int32_t
+p2p_frame_ring_read(int64_t seq, uint8_t* dst, int32_t capacity) {
+    if (seq < 0) {
+        return -1;
+    }
+    return g_frameRing.read(static_cast<uint64_t>(seq), dst, capacity);
+}
+
+extern "C" __attribute__((visibility("default"))) void p2p_frame_ring_ack(int64_t seenSeq) {
+    if (seenSeq >= 0) {
+        g_frameRing.ack(static_cast<uint64_t>(seenSeq));
+    }
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getFramePoolStats(
+        JNIEnv* env,
+        jobject thiz) {
+    FramePool::Stats stats = g_framePool.stats();
+    jlong values[10] = {
+        (jlong)stats.allocations,
+        (jlong)stats.reuses,
+        (jlong)stats.releases,
+        (jlong)stats.sizeClasses,
+        (jlong)stats.buffersInUse,
+        (jlong)stats.buffersFree,
+        (jlong)stats.bytesInUse,
+        (jlong)stats.bytesFree,
+        (jlong)stats.highWaterBytes,
+        (jlong)stats.highWaterBuffers,
+    };
+    jlongArray result = env->NewLongArray(10);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 10, values);
+    }
+    return result;
+}
+
+// 各订阅者的统计按 getFrameBusSubscribers 返回的顺序平铺，每个订阅者 5 项
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getFrameBusSubscribers(
+        JNIEnv* env,
+        jobject thiz) {
+    std::vector<BusSubscriberStats> stats = g_frameBus.stats();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray result = env->NewObjectArray((jsize)stats.size(), stringClass, nullptr);
+    env->DeleteLocalRef(stringClass);
+    if (!result) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < stats.size(); i++) {
+        jstring name = env->NewStringUTF(stats[i].name.c_str());
+        env->SetObjectArrayElement(result, (jsize)i, name);
+        env->DeleteLocalRef(name);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getFrameBusStats(
+        JNIEnv* env,
+        jobject thiz) {
+    std::vector<BusSubscriberStats> stats = g_frameBus.stats();
+    std::vector<jlong> values;
+    for (const BusSubscriberStats& subscriber : stats) {
+        values.push_back((jlong)subscriber.delivered);
+        values.push_back((jlong)subscriber.dropped);
+        values.push_back((jlong)subscriber.queuedFrames);
+        values.push_back((jlong)subscriber.queuedBytes);
+        values.push_back((jlong)subscriber.maxQueuedFrames);
+    }
+    jlongArray result = env->NewLongArray((jsize)values.size());
+    if (result && !values.empty()) {
+        env->SetLongArrayRegion(result, 0, (jsize)values.size(), values.data());
+    }
+    return result;
+}
+
+// zones 按 x, y, width, height 四个一组，坐标归一化到 0..1；为空时检测整个画面
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_configureMotionDetection(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jboolean enabled,
+        jint sensitivity,
+        jint analysisFps,
+        jfloatArray zones) {
+    static std::once_flag callbackOnce;
+    std::call_once(callbackOnce, []() { g_motionDetector.setEventCallback(onMotionEvent); });
+
+    MotionConfig config;
+    config.enabled = enabled == JNI_TRUE;
+    config.sensitivity = sensitivity;
+    config.analysisFps = analysisFps;
+    if (zones) {
+        jsize count = env->GetArrayLength(zones) / 4;
+        std::vector<jfloat> values((size_t)count * 4);
+        env->GetFloatArrayRegion(zones, 0, count * 4, values.data());
+        for (jsize i = 0; i < count; i++) {
+            MotionZone zone;
+            zone.x = values[i * 4];
+            zone.y = values[i * 4 + 1];
+            zone.width = values[i * 4 + 2];
+            zone.height = values[i * 4 + 3];
+            config.zones.push_back(zone);
+        }
+    }
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    g_motionDetector.configure(pDevId ? pDevId : "", config);
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_submitMotionFrame(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jobject yBuffer,
+        jobject uBuffer,
+        jobject vBuffer,
+        jint yRowStride,
+        jint uvRowStride,
+        jint uvPixelStride,
+        jint width,
+        jint height) {
+    Yuv420Planes planes;
+    planes.y = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    planes.u = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer));
+    planes.v = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer));
+    planes.yRowStride = yRowStride;
+    planes.uvRowStride = uvRowStride;
+    planes.uvPixelStride = uvPixelStride;
+    planes.width = width;
+    planes.height = height;
+    if (!planes.y || !planes.u || !planes.v) {
+        return JNI_FALSE;
+    }
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    // 画墙之外的设备只有移动侦测解码，这一路的画面也做健康检查
+    submitAnalyticsFrame(pDevId ? pDevId : "", planes, FrameRef(), currentTimeMs());
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getMotionStats(
+        JNIEnv* env,
+        jobject thiz) {
+    MotionStats stats = g_motionDetector.stats();
+    jlong values[6] = {
+        (jlong)stats.submittedFrames,
+        (jlong)stats.skippedFrames,
+        (jlong)stats.replacedFrames,
+        (jlong)stats.analyzedFrames,
+        (jlong)stats.events,
+        (jlong)stats.lightingResets,
+    };
+    jlongArray result = env->NewLongArray(6);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 6, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getContinuityStats(
+        JNIEnv* env,
+        jobject thiz) {
+    ContinuityStats stats = g_continuity.stats();
+    jlong values[8] = {
+        (jlong)stats.accessUnits,
+        (jlong)stats.droppedUnits,
+        (jlong)stats.frameNumGaps,
+        (jlong)stats.invalidSlices,
+        (jlong)stats.pocGaps,
+        (jlong)stats.keyframeRequests,
+        (jlong)stats.recoveries,
+        (jlong)stats.lastRecoveryMs,
+    };
+    jlongArray result = env->NewLongArray(8);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 8, values);
+    }
+    return result;
+}
+
+// 6 项：accessUnits, source, frameIntervalUs, jitterUs, missingFrames, resyncs；设备没有数据时返回 null
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getStreamClockStats(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    StreamClockStats stats;
+    bool found = g_streamClock.stats(pDevId ? pDevId : "", stats);
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    if (!found) {
+        return nullptr;
+    }
+    jlong values[6] = {
+        (jlong)stats.accessUnits,
+        (jlong)stats.source,
+        (jlong)stats.frameIntervalUs,
+        (jlong)stats.jitterUs,
+        (jlong)stats.missingFrames,
+        (jlong)stats.resyncs,
+    };
+    jlongArray result = env->NewLongArray(6);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 6, values);
+    }
+    return result;
+}
+
+// codec 为 pcmu / pcma / aac，为空时只接收 ADTS 封装的 AAC；outputRate 和 framesPerBuffer
+// 取设备原生值（AudioManager 的 PROPERTY_OUTPUT_*）才能走低延迟混音通路
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_startAudio(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jstring codec,
+        jint sampleRate,
+        jint outputRate,
+        jint framesPerBuffer,
+        jint maxDelayMs) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const char* pCodec = codec ? env->GetStringUTFChars(codec, nullptr) : nullptr;
+    const std::string deviceId = pDevId ? pDevId : "";
+    const AudioCodec audioCodec = pCodec ? audioCodecFromName(pCodec) : AUDIO_CODEC_NONE;
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    if (pCodec) env->ReleaseStringUTFChars(codec, pCodec);
+
+    AudioJitterConfig jitterConfig;
+    if (maxDelayMs > 0) {
+        jitterConfig.maxDelayMs = maxDelayMs;
+    }
+    g_audioPipeline.configureJitter(jitterConfig);
+    AudioSinkConfig sinkConfig;
+    if (outputRate > 0) {
+        sinkConfig.sampleRate = outputRate;
+    }
+    sinkConfig.framesPerBuffer = framesPerBuffer > 0 ? framesPerBuffer : sinkConfig.sampleRate / 100;
+    // 音频开始播放后视频跟随音频时钟（快放期间除外，退出快放时再接上）；音频停止超过
+    // AvSyncClock::kAudioStaleUs 后自动退回视频自身时钟
+    g_masterClock.onAudioStart();
+    g_audioPipeline.setPlayoutListener([](int64_t mediaUs, int64_t playoutUs) {
+        g_avSync.onAudioPlayout(mediaUs, playoutUs);
+    });
+    bool ok = g_audioPipeline.start(deviceId, audioCodec, sampleRate > 0 ? sampleRate : 8000, "", "", sinkConfig);
+    LOGI("[音频] startAudio devId=%s codec=%s: %s", deviceId.c_str(), audioCodecName(audioCodec), ok ? "ok" : "failed");
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_stopAudio(
+        JNIEnv* env,
+        jobject thiz) {
+    g_audioPipeline.stop();
+    g_avSync.resetAudio();
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getAudioStats(
+        JNIEnv* env,
+        jobject thiz) {
+    AudioPipelineStats stats = g_audioPipeline.stats();
+    jlong values[16] = {
+        stats.active ? 1 : 0,
+        (jlong)stats.codec,
+        (jlong)stats.sampleRate,
+        (jlong)stats.outputRate,
+        (jlong)stats.packets,
+        (jlong)stats.decodeErrors,
+        (jlong)stats.jitter.concealmentEvents,
+        (jlong)stats.jitter.concealedMs,
+        (jlong)stats.jitter.overruns,
+        (jlong)stats.jitter.stretchedMs,
+        (jlong)stats.jitter.jitterMs,
+        (jlong)stats.jitter.targetDelayMs,
+        (jlong)stats.jitter.bufferedMs,
+        (jlong)stats.jitter.latencyMs,
+        (jlong)stats.jitter.maxLatencyMs,
+        (jlong)stats.sinkLatencyMs,
+    };
+    jlongArray result = env->NewLongArray(16);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 16, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getAvSyncStats(
+        JNIEnv* env,
+        jobject thiz) {
+    AvSyncStats stats = g_avSync.stats();
+    jlong values[8] = {
+        stats.audioActive ? 1 : 0,
+        (jlong)stats.syncedFrames,
+        (jlong)stats.droppedFrames,
+        (jlong)stats.repeatedFrames,
+        (jlong)stats.resyncs,
+        (jlong)stats.offsetUs,
+        (jlong)stats.maxOffsetUs,
+        (jlong)stats.audioDelayUs,
+    };
+    jlongArray result = env->NewLongArray(8);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 8, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_startTalk(
+        JNIEnv* env,
+        jobject thiz,
+        jstring devId,
+        jstring codec,
+        jint packetMs) {
+    const char* pDevId = env->GetStringUTFChars(devId, nullptr);
+    const char* pCodec = codec ? env->GetStringUTFChars(codec, nullptr) : nullptr;
+    const std::string deviceId = pDevId ? pDevId : "";
+    const AudioCodec audioCodec = pCodec ? audioCodecFromName(pCodec) : AUDIO_CODEC_PCMA;
+    if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+    if (pCodec) env->ReleaseStringUTFChars(codec, pCodec);
+    if (deviceId.empty()) {
+        return JNI_FALSE;
+    }
+
+    TalkConfig config;
+    config.codec = audioCodec;
+    if (packetMs > 0) {
+        config.packetMs = packetMs;
+    }
+    // 采集缓冲取包长的一半，采满一包最多等一个采集缓冲
+    config.captureMs = config.packetMs / 2;
+    const std::string topic = "/yyt/" + deviceId + "/msg";
+    bool ok = g_talkUplink.start(config, "", "", [deviceId, topic](const TalkPacket& packet) {
+        return sendTalkPacket(deviceId, topic, packet);
+    });
+    LOGI("[对讲] startTalk devId=%s codec=%s: %s", deviceId.c_str(), audioCodecName(audioCodec), ok ? "ok" : "failed");
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_stopTalk(
+        JNIEnv* env,
+        jobject thiz) {
+    g_talkUplink.stop();
+    LOGI("[对讲] stopTalk");
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getTalkStats(
+        JNIEnv* env,
+        jobject thiz) {
+    TalkStats stats = g_talkUplink.stats();
+    jlong values[14] = {
+        stats.active ? 1 : 0,
+        stats.codec,
+        stats.sampleRate,
+        stats.packetMs,
+        (jlong)stats.packets,
+        (jlong)stats.sendErrors,
+        (jlong)stats.overruns,
+        stats.droppedMs,
+        stats.encodeUs,
+        stats.maxEncodeUs,
+        stats.latencyUs,
+        stats.maxLatencyUs,
+        stats.priority,
+        (jlong)stats.queueDrops,
+    };
+    jlongArray result = env->NewLongArray(14);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 14, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_configurePictureHealth(
+        JNIEnv* env,
+        jobject thiz,
+        jlong frozenMs,
+        jlong blackMs) {
+    PictureHealthConfig config;
+    if (frozenMs > 0) {
+        config.frozenMs = frozenMs;
+    }
+    if (blackMs > 0) {
+        config.blackMs = blackMs;
+    }
+    g_pictureHealth.configure(config);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getPictureHealthStats(
+        JNIEnv* env,
+        jobject thiz) {
+    PictureHealthStats stats = g_pictureHealth.stats();
+    jlong values[6] = {
+        (jlong)stats.sampledFrames,
+        (jlong)stats.skippedFrames,
+        (jlong)stats.frozenEvents,
+        (jlong)stats.blackEvents,
+        (jlong)stats.blankEvents,
+        (jlong)stats.sampleCpuUs,
+    };
+    jlongArray result = env->NewLongArray(6);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 6, values);
+    }
+    return result;
+}
+
+// 每个设备 5 项：score, active, frameBytes, baselineBytes, skipPermille；没有数据的设备 score 为 -1
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_mainipc_xiebaoxin_MainActivity_getCameraActivity(
+        JNIEnv* env,
+        jobject thiz,
+        jobjectArray devIds) {
+    jsize count = devIds ? env->GetArrayLength(devIds) : 0;
+    std::vector<jlong> values;
+    for (jsize i = 0; i < count; i++) {
+        jstring devId = (jstring)env->GetObjectArrayElement(devIds, i);
+        const char* pDevId = devId ? env->GetStringUTFChars(devId, nullptr) : nullptr;
+        CameraActivity activity;
+        bool found = pDevId && g_activityEstimator.get(pDevId, activity);
+        if (pDevId) env->ReleaseStringUTFChars(devId, pDevId);
+        if (devId) env->DeleteLocalRef(devId);
+        values.push_back(found ? (jlong)activity.score : -1);
+        values.push_back(found && activity.active ? 1 : 0);
+        values.push_back((jlong)activity.frameBytes);
+        values.push_back((jlong)activity.baselineBytes);
+        values.push_back((jlong)activity.skipPermille);
+    }
+    jlongArray result = env->NewLongArray((jsize)values.size());
+    if (result && !values.empty()) {
+        env->SetLongArrayRegion(result, 0, (jsize)values.size(), values.data());
+    }
+    return result;
+}
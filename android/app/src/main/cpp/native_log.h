@@ -0,0 +1,28 @@
+#ifndef NATIVE_LOG_H
+#define NATIVE_LOG_H
+
+// 各模块在包含本头文件前定义自己的 LOG_TAG
+#ifndef LOG_TAG
+#define LOG_TAG "NativeLib"
+#endif
+
+#ifdef __ANDROID__
+#include <android/log.h>
+
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+// 桌面端（Linux runner）共用这些模块时输出到 stderr
+#include <stdio.h>
+
+#define NATIVE_LOG_PRINT(level, ...) \
+    do { fprintf(stderr, "%s/%s: ", level, LOG_TAG); fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); } while (0)
+#define LOGD(...) NATIVE_LOG_PRINT("D", __VA_ARGS__)
+#define LOGI(...) NATIVE_LOG_PRINT("I", __VA_ARGS__)
+#define LOGW(...) NATIVE_LOG_PRINT("W", __VA_ARGS__)
+#define LOGE(...) NATIVE_LOG_PRINT("E", __VA_ARGS__)
+#endif
+
+#endif // NATIVE_LOG_H
@@ -0,0 +1,169 @@
+// OpenSL ES 音频输出，只在 Android 构建中编译。minSdk 低于 AAudio 的要求，
+// 用 Android simple buffer queue 加性能模式配置走低延迟混音通路。
+
+#include "audio_sink.h"
+
+#include <atomic>
+#include <vector>
+#include <SLES/OpenSLES.h>
+#include <SLES/OpenSLES_Android.h>
+#include <SLES/OpenSLES_AndroidConfiguration.h>
+
+#define LOG_TAG "OpenSlAudioSink"
+#include "native_log.h"
+
+namespace {
+
+// 两个缓冲轮流提交：一个在播放，一个在填充
+const int kBufferCount = 2;
+
+class OpenSlAudioSink : public AudioSink {
+public:
+    OpenSlAudioSink()
+        : m_engineObject(nullptr), m_engine(nullptr), m_mixObject(nullptr), m_playerObject(nullptr),
+          m_play(nullptr), m_queue(nullptr), m_next(0), m_running(false) {}
+
+    ~OpenSlAudioSink() override {
+        close();
+    }
+
+    const char* name() const override {
+        return "opensl";
+    }
+
+    bool open(const AudioSinkConfig& config, const AudioRenderCallback& callback) override {
+        close();
+        if (config.sampleRate <= 0 || config.framesPerBuffer <= 0 || !callback) {
+            return false;
+        }
+        m_config = config;
+        m_callback = callback;
+        for (int i = 0; i < kBufferCount; i++) {
+            m_buffers[i].assign(config.framesPerBuffer, 0);
+        }
+
+        SLresult result = slCreateEngine(&m_engineObject, 0, nullptr, 0, nullptr, nullptr);
+        if (result != SL_RESULT_SUCCESS ||
+            (*m_engineObject)->Realize(m_engineObject, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS ||
+            (*m_engineObject)->GetInterface(m_engineObject, SL_IID_ENGINE, &m_engine) != SL_RESULT_SUCCESS ||
+            (*m_engine)->CreateOutputMix(m_engine, &m_mixObject, 0, nullptr, nullptr) != SL_RESULT_SUCCESS ||
+            (*m_mixObject)->Realize(m_mixObject, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS) {
+            LOGE("OpenSL 引擎初始化失败");
+            close();
+            return false;
+        }
+
+        SLDataLocator_AndroidSimpleBufferQueue queueLocator = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, kBufferCount};
+        SLDataFormat_PCM format = {
+            SL_DATAFORMAT_PCM, 1, (SLuint32)config.sampleRate * 1000,
+            SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
+            SL_SPEAKER_FRONT_CENTER, SL_BYTEORDER_LITTLEENDIAN,
+        };
+        SLDataSource source = {&queueLocator, &format};
+        SLDataLocator_OutputMix mixLocator = {SL_DATALOCATOR_OUTPUTMIX, m_mixObject};
+        SLDataSink sink = {&mixLocator, nullptr};
+        const SLInterfaceID ids[] = {SL_IID_ANDROIDSIMPLEBUFFERQUEUE, SL_IID_ANDROIDCONFIGURATION};
+        const SLboolean required[] = {SL_BOOLEAN_TRUE, SL_BOOLEAN_FALSE};
+        if ((*m_engine)->CreateAudioPlayer(m_engine, &m_playerObject, &source, &sink, 2, ids, required) != SL_RESULT_SUCCESS) {
+            LOGE("创建播放器失败: %dHz", config.sampleRate);
+            close();
+            return false;
+        }
+
+        // 性能模式要在 Realize 之前设置；旧系统不支持时忽略
+        SLAndroidConfigurationItf configuration = nullptr;
+        if ((*m_playerObject)->GetInterface(m_playerObject, SL_IID_ANDROIDCONFIGURATION, &configuration) == SL_RESULT_SUCCESS) {
+            SLuint32 mode = SL_ANDROID_PERFORMANCE_LATENCY;
+            (*configuration)->SetConfiguration(configuration, SL_ANDROID_KEY_PERFORMANCE_MODE, &mode, sizeof(mode));
+        }
+
+        if ((*m_playerObject)->Realize(m_playerObject, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS ||
+            (*m_playerObject)->GetInterface(m_playerObject, SL_IID_PLAY, &m_play) != SL_RESULT_SUCCESS ||
+            (*m_playerObject)->GetInterface(m_playerObject, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &m_queue) != SL_RESULT_SUCCESS ||
+            (*m_queue)->RegisterCallback(m_queue, onBufferDone, this) != SL_RESULT_SUCCESS) {
+            LOGE("播放器初始化失败");
+            close();
+            return false;
+        }
+        LOGI("open: %dHz, %d 帧/缓冲", config.sampleRate, config.framesPerBuffer);
+        return true;
+    }
+
+    bool start() override {
+        if (!m_play || m_running.exchange(true)) {
+            return false;
+        }
+        // 先填满所有缓冲再开始播放
+        for (int i = 0; i < kBufferCount; i++) {
+            enqueueNext();
+        }
+        return (*m_play)->SetPlayState(m_play, SL_PLAYSTATE_PLAYING) == SL_RESULT_SUCCESS;
+    }
+
+    void stop() override {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        (*m_play)->SetPlayState(m_play, SL_PLAYSTATE_STOPPED);
+        (*m_queue)->Clear(m_queue);
+    }
+
+    // 销毁播放器会等待正在执行的回调返回
+    void close() override {
+        stop();
+        if (m_playerObject) {
+            (*m_playerObject)->Destroy(m_playerObject);
+            m_playerObject = nullptr;
+            m_play = nullptr;
+            m_queue = nullptr;
+        }
+        if (m_mixObject) {
+            (*m_mixObject)->Destroy(m_mixObject);
+            m_mixObject = nullptr;
+        }
+        if (m_engineObject) {
+            (*m_engineObject)->Destroy(m_engineObject);
+            m_engineObject = nullptr;
+            m_engine = nullptr;
+        }
+        m_callback = nullptr;
+    }
+
+    // 只能估计排队中的缓冲，混音器和 HAL 的固定延迟由调用方按设备另行补偿
+    int64_t latencyUs() const override {
+        return (int64_t)kBufferCount * m_config.framesPerBuffer * 1000000 / m_config.sampleRate;
+    }
+
+private:
+    static void onBufferDone(SLAndroidSimpleBufferQueueItf queue, void* context) {
+        OpenSlAudioSink* self = static_cast<OpenSlAudioSink*>(context);
+        if (self->m_running.load()) {
+            self->enqueueNext();
+        }
+    }
+
+    void enqueueNext() {
+        std::vector<int16_t>& buffer = m_buffers[m_next];
+        m_next = (m_next + 1) % kBufferCount;
+        m_callback(buffer.data(), (int)buffer.size());
+        (*m_queue)->Enqueue(m_queue, buffer.data(), (SLuint32)(buffer.size() * sizeof(int16_t)));
+    }
+
+    SLObjectItf m_engineObject;
+    SLEngineItf m_engine;
+    SLObjectItf m_mixObject;
+    SLObjectItf m_playerObject;
+    SLPlayItf m_play;
+    SLAndroidSimpleBufferQueueItf m_queue;
+    std::vector<int16_t> m_buffers[kBufferCount];
+    int m_next;
+    AudioSinkConfig m_config;
+    AudioRenderCallback m_callback;
+    std::atomic<bool> m_running;
+};
+
+} // namespace
+
+std::unique_ptr<AudioSink> createOpenSlAudioSink() {
+    return std::unique_ptr<AudioSink>(new OpenSlAudioSink());
+}
@@ -0,0 +1,166 @@
+// OpenSL ES 音频采集，只在 Android 构建中编译。用 VOICE_COMMUNICATION 录音预设，
+// 系统对这一路做回声消除和降噪，对讲时扬声器里摄像头的声音不会再被送回去。
+
+#include "audio_source.h"
+
+#include <time.h>
+#include <atomic>
+#include <vector>
+#include <SLES/OpenSLES.h>
+#include <SLES/OpenSLES_Android.h>
+#include <SLES/OpenSLES_AndroidConfiguration.h>
+
+#define LOG_TAG "OpenSlAudioSource"
+#include "native_log.h"
+
+namespace {
+
+// 采满的缓冲交出后立即重新入队；多排几个缓冲只是多一点调度余量，不增加延迟
+const int kBufferCount = 4;
+
+int64_t monotonicTimeUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+class OpenSlAudioSource : public AudioSource {
+public:
+    OpenSlAudioSource()
+        : m_engineObject(nullptr), m_engine(nullptr), m_recorderObject(nullptr),
+          m_record(nullptr), m_queue(nullptr), m_next(0), m_running(false) {}
+
+    ~OpenSlAudioSource() override {
+        close();
+    }
+
+    const char* name() const override {
+        return "opensl";
+    }
+
+    bool open(const AudioSourceConfig& config, const AudioCaptureCallback& callback) override {
+        close();
+        if (config.sampleRate <= 0 || config.framesPerBuffer <= 0 || !callback) {
+            return false;
+        }
+        m_config = config;
+        m_callback = callback;
+        for (int i = 0; i < kBufferCount; i++) {
+            m_buffers[i].assign(config.framesPerBuffer, 0);
+        }
+
+        if (slCreateEngine(&m_engineObject, 0, nullptr, 0, nullptr, nullptr) != SL_RESULT_SUCCESS ||
+            (*m_engineObject)->Realize(m_engineObject, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS ||
+            (*m_engineObject)->GetInterface(m_engineObject, SL_IID_ENGINE, &m_engine) != SL_RESULT_SUCCESS) {
+            LOGE("OpenSL 引擎初始化失败");
+            close();
+            return false;
+        }
+
+        SLDataLocator_IODevice deviceLocator = {
+            SL_DATALOCATOR_IODEVICE, SL_IODEVICE_AUDIOINPUT, SL_DEFAULTDEVICEID_AUDIOINPUT, nullptr,
+        };
+        SLDataSource source = {&deviceLocator, nullptr};
+        SLDataLocator_AndroidSimpleBufferQueue queueLocator = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, kBufferCount};
+        SLDataFormat_PCM format = {
+            SL_DATAFORMAT_PCM, 1, (SLuint32)config.sampleRate * 1000,
+            SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
+            SL_SPEAKER_FRONT_CENTER, SL_BYTEORDER_LITTLEENDIAN,
+        };
+        SLDataSink sink = {&queueLocator, &format};
+        const SLInterfaceID ids[] = {SL_IID_ANDROIDSIMPLEBUFFERQUEUE, SL_IID_ANDROIDCONFIGURATION};
+        const SLboolean required[] = {SL_BOOLEAN_TRUE, SL_BOOLEAN_FALSE};
+        if ((*m_engine)->CreateAudioRecorder(m_engine, &m_recorderObject, &source, &sink, 2, ids, required) != SL_RESULT_SUCCESS) {
+            LOGE("创建录音器失败: %dHz（未授予录音权限？）", config.sampleRate);
+            close();
+            return false;
+        }
+
+        // 录音预设要在 Realize 之前设置；不支持时退回默认预设
+        SLAndroidConfigurationItf configuration = nullptr;
+        if ((*m_recorderObject)->GetInterface(m_recorderObject, SL_IID_ANDROIDCONFIGURATION, &configuration) == SL_RESULT_SUCCESS) {
+            SLuint32 preset = SL_ANDROID_RECORDING_PRESET_VOICE_COMMUNICATION;
+            if ((*configuration)->SetConfiguration(configuration, SL_ANDROID_KEY_RECORDING_PRESET, &preset, sizeof(preset)) != SL_RESULT_SUCCESS) {
+                LOGW("不支持 VOICE_COMMUNICATION 录音预设");
+            }
+        }
+
+        if ((*m_recorderObject)->Realize(m_recorderObject, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS ||
+            (*m_recorderObject)->GetInterface(m_recorderObject, SL_IID_RECORD, &m_record) != SL_RESULT_SUCCESS ||
+            (*m_recorderObject)->GetInterface(m_recorderObject, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &m_queue) != SL_RESULT_SUCCESS ||
+            (*m_queue)->RegisterCallback(m_queue, onBufferDone, this) != SL_RESULT_SUCCESS) {
+            LOGE("录音器初始化失败");
+            close();
+            return false;
+        }
+        LOGI("open: %dHz, %d 帧/缓冲", config.sampleRate, config.framesPerBuffer);
+        return true;
+    }
+
+    bool start() override {
+        if (!m_record || m_running.exchange(true)) {
+            return false;
+        }
+        // 先把空缓冲全部入队再开始录音
+        m_next = 0;
+        for (int i = 0; i < kBufferCount; i++) {
+            (*m_queue)->Enqueue(m_queue, m_buffers[i].data(), (SLuint32)(m_buffers[i].size() * sizeof(int16_t)));
+        }
+        return (*m_record)->SetRecordState(m_record, SL_RECORDSTATE_RECORDING) == SL_RESULT_SUCCESS;
+    }
+
+    void stop() override {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        (*m_record)->SetRecordState(m_record, SL_RECORDSTATE_STOPPED);
+        (*m_queue)->Clear(m_queue);
+    }
+
+    // 销毁录音器会等待正在执行的回调返回
+    void close() override {
+        stop();
+        if (m_recorderObject) {
+            (*m_recorderObject)->Destroy(m_recorderObject);
+            m_recorderObject = nullptr;
+            m_record = nullptr;
+            m_queue = nullptr;
+        }
+        if (m_engineObject) {
+            (*m_engineObject)->Destroy(m_engineObject);
+            m_engineObject = nullptr;
+            m_engine = nullptr;
+        }
+        m_callback = nullptr;
+    }
+
+private:
+    // 缓冲按入队顺序依次采满
+    static void onBufferDone(SLAndroidSimpleBufferQueueItf queue, void* context) {
+        OpenSlAudioSource* self = static_cast<OpenSlAudioSource*>(context);
+        std::vector<int16_t>& buffer = self->m_buffers[self->m_next];
+        self->m_next = (self->m_next + 1) % kBufferCount;
+        if (!self->m_running.load()) {
+            return;
+        }
+        self->m_callback(buffer.data(), (int)buffer.size(), monotonicTimeUs());
+        (*queue)->Enqueue(queue, buffer.data(), (SLuint32)(buffer.size() * sizeof(int16_t)));
+    }
+
+    SLObjectItf m_engineObject;
+    SLEngineItf m_engine;
+    SLObjectItf m_recorderObject;
+    SLRecordItf m_record;
+    SLAndroidSimpleBufferQueueItf m_queue;
+    std::vector<int16_t> m_buffers[kBufferCount];
+    int m_next;
+    AudioSourceConfig m_config;
+    AudioCaptureCallback m_callback;
+    std::atomic<bool> m_running;
+};
+
+} // namespace
+
+std::unique_ptr<AudioSource> createOpenSlAudioSource() {
+    return std::unique_ptr<AudioSource>(new OpenSlAudioSource());
+}
@@ -0,0 +1,194 @@
+#include "picture_health.h"
+
+#include <math.h>
+#include <chrono>
+
+#define LOG_TAG "PictureHealth"
+#include "native_log.h"
+
+const int64_t PictureHealthMonitor::kSampleIntervalMs;
+const int64_t PictureHealthMonitor::kStaleMs;
+const int PictureHealthMonitor::kHashCols;
+const int PictureHealthMonitor::kHashRows;
+const int PictureHealthMonitor::kSampleStep;
+const int PictureHealthMonitor::kBlackMean;
+const int PictureHealthMonitor::kBlackStddev;
+const int PictureHealthMonitor::kBlankStddev;
+
+const char* pictureStateName(PictureState state) {
+    switch (state) {
+        case PICTURE_FROZEN: return "frozen";
+        case PICTURE_BLACK: return "black";
+        case PICTURE_BLANK: return "blank";
+        default: return "ok";
+    }
+}
+
+PictureHealthMonitor::PictureHealthMonitor() {
+}
+
+void PictureHealthMonitor::setEventCallback(const EventCallback& callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callback = callback;
+}
+
+void PictureHealthMonitor::configure(const PictureHealthConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    LOGI("configure: frozenMs=%lld blackMs=%lld", (long long)config.frozenMs, (long long)config.blackMs);
+}
+
+bool PictureHealthMonitor::takeSample(const uint8_t* y, int rowStride, int width, int height, Sample& sample) {
+    const int blockWidth = width / kHashCols;
+    const int blockHeight = height / kHashRows;
+    if (!y || blockWidth < kSampleStep || blockHeight < kSampleStep) {
+        return false;
+    }
+    uint32_t blockSums[kHashRows][kHashCols] = {};
+    uint64_t sum = 0;
+    uint64_t sumSquares = 0;
+    uint32_t checksum = 0;
+    for (int row = 0; row < kHashRows; row++) {
+        for (int line = row * blockHeight; line < (row + 1) * blockHeight; line += kSampleStep) {
+            const uint8_t* src = y + (size_t)line * rowStride;
+            for (int col = 0; col < kHashCols; col++) {
+                uint32_t blockSum = 0;
+                uint32_t blockSquares = 0;
+                for (int x = col * blockWidth; x < (col + 1) * blockWidth; x += kSampleStep) {
+                    const uint32_t v = src[x];
+                    blockSum += v;
+                    blockSquares += v * v;
+                    checksum = checksum * 31 + v;
+                }
+                blockSums[row][col] += blockSum;
+                sum += blockSum;
+                sumSquares += blockSquares;
+            }
+        }
+    }
+    const int perBlock = ((blockWidth + kSampleStep - 1) / kSampleStep) * ((blockHeight + kSampleStep - 1) / kSampleStep);
+    const uint64_t count = (uint64_t)perBlock * kHashCols * kHashRows;
+    const double mean = (double)sum / count;
+    const double variance = (double)sumSquares / count - mean * mean;
+
+    // dHash：每行相邻两块比较明暗，9 列得到 8 位，共 64 位；每块样本数相同，直接比较块和
+    uint64_t hash = 0;
+    for (int row = 0; row < kHashRows; row++) {
+        for (int col = 0; col + 1 < kHashCols; col++) {
+            hash = (hash << 1) | (blockSums[row][col] < blockSums[row][col + 1] ? 1 : 0);
+        }
+    }
+    sample.hash = hash;
+    sample.checksum = checksum;
+    sample.mean = (int)(mean + 0.5);
+    sample.stddev = variance > 0 ? (int)(sqrt(variance) + 0.5) : 0;
+    return true;
+}
+
+bool PictureHealthMonitor::sameImage(const Sample& a, const Sample& b) {
+    return a.hash == b.hash && a.checksum == b.checksum && a.mean == b.mean;
+}
+
+bool PictureHealthMonitor::shouldSample(const std::string& devId, int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device& device = m_devices[devId];
+    if (nowMs < device.nextSampleMs) {
+        m_stats.skippedFrames++;
+        return false;
+    }
+    // 先占住本次采样，同一设备的其它送帧线程不会重复采样
+    device.nextSampleMs = nowMs + kSampleIntervalMs;
+    return true;
+}
+
+bool PictureHealthMonitor::submit(const std::string& devId, const FrameRef& frame, int64_t nowMs) {
+    if (!frame) {
+        return false;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    Sample sample;
+    const bool ok = takeSample(frame->y, frame->width, frame->width, frame->height, sample);
+    const int64_t costUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    if (!ok) {
+        return false;
+    }
+
+    PictureHealthEvent event;
+    EventCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.sampledFrames++;
+        m_stats.sampleCpuUs += costUs;
+        Device& device = m_devices[devId];
+        const int64_t previousMs = device.lastSampleMs;
+        bool identical = device.hasLast && sameImage(sample, device.last);
+        if (device.hasLast && nowMs - previousMs > kStaleMs) {
+            // 流中断过，之前的画面不能作为冻结判断的依据
+            identical = false;
+            device.candidate = PICTURE_OK;
+        }
+
+        PictureState current = PICTURE_OK;
+        if (sample.stddev <= kBlackStddev && sample.mean <= kBlackMean) {
+            current = PICTURE_BLACK;
+        } else if (sample.stddev <= kBlankStddev) {
+            current = PICTURE_BLANK;
+        } else if (identical) {
+            current = PICTURE_FROZEN;
+        }
+        if (current != device.candidate) {
+            device.candidate = current;
+            // 冻结从上一次看到同一画面算起
+            device.candidateSinceMs = current == PICTURE_FROZEN && device.hasLast ? previousMs : nowMs;
+        }
+        device.last = sample;
+        device.hasLast = true;
+        device.lastSampleMs = nowMs;
+
+        const int64_t threshold = device.candidate == PICTURE_FROZEN ? m_config.frozenMs : m_config.blackMs;
+        if (device.candidate == device.reported ||
+            (device.candidate != PICTURE_OK && nowMs - device.candidateSinceMs < threshold)) {
+            return true;
+        }
+
+        event.devId = devId;
+        event.state = device.candidate;
+        event.previous = device.reported;
+        event.durationMs = device.candidate == PICTURE_OK ? nowMs - device.reportedSinceMs : nowMs - device.candidateSinceMs;
+        event.mean = sample.mean;
+        event.stddev = sample.stddev;
+        event.timeMs = nowMs;
+        device.reported = device.candidate;
+        device.reportedSinceMs = device.candidateSinceMs;
+        switch (event.state) {
+            case PICTURE_FROZEN: m_stats.frozenEvents++; break;
+            case PICTURE_BLACK: m_stats.blackEvents++; break;
+            case PICTURE_BLANK: m_stats.blankEvents++; break;
+            default: break;
+        }
+        callback = m_callback;
+    }
+
+    LOGI("devId=%s %s -> %s, %lldms, mean=%d stddev=%d", devId.c_str(), pictureStateName(event.previous),
+         pictureStateName(event.state), (long long)event.durationMs, event.mean, event.stddev);
+    if (callback) {
+        callback(event);
+    }
+    return true;
+}
+
+PictureState PictureHealthMonitor::state(const std::string& devId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    return it != m_devices.end() ? it->second.reported : PICTURE_OK;
+}
+
+void PictureHealthMonitor::drop(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.erase(devId);
+}
+
+PictureHealthStats PictureHealthMonitor::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,107 @@
+#ifndef PICTURE_HEALTH_H
+#define PICTURE_HEALTH_H
+
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "frame_pool.h"
+
+enum PictureState {
+    PICTURE_OK = 0,
+    PICTURE_FROZEN,   // 画面完全不变：解码器卡住或设备重复发送同一帧
+    PICTURE_BLACK,    // 全黑：镜头遮挡、传感器故障
+    PICTURE_BLANK,    // 单一颜色（灰屏、绿屏）：通常是解码出错
+};
+
+const char* pictureStateName(PictureState state);
+
+struct PictureHealthConfig {
+    int64_t frozenMs = 5000;   // 画面不变持续多久判定为冻结；摄像头一般叠加 OSD 时钟，正常画面每秒都会变
+    int64_t blackMs = 3000;    // 全黑或单色持续多久上报
+};
+
+struct PictureHealthEvent {
+    std::string devId;
+    PictureState state = PICTURE_OK;
+    PictureState previous = PICTURE_OK;
+    int64_t durationMs = 0;    // 异常状态已持续的时间；恢复事件为异常持续的总时长
+    int mean = 0;              // 采样亮度均值
+    int stddev = 0;            // 采样亮度标准差
+    int64_t timeMs = 0;
+};
+
+struct PictureHealthStats {
+    uint64_t sampledFrames = 0;
+    uint64_t skippedFrames = 0;   // 未到采样间隔
+    uint64_t frozenEvents = 0;
+    uint64_t blackEvents = 0;
+    uint64_t blankEvents = 0;
+    uint64_t sampleCpuUs = 0;     // 采样累计耗时，用于确认开销可以忽略
+};
+
+// 解码画面健康检查：按 kSampleIntervalMs 对亮度平面稀疏采样，得到 9x8 块均值、
+// 64 位差值哈希（dHash）、样本校验和以及全局均值和方差。哈希与校验和都不变即为冻结
+// （传感器噪声会让静止场景的样本逐帧变化，只有重复的同一帧才完全一致），
+// 均值低且方差小为全黑，方差小为单色。异常持续超过阈值时上报一次，恢复时再上报一次。
+// 只读池化帧的亮度平面，不再拷贝，在送帧线程上同步完成。
+class PictureHealthMonitor {
+public:
+    static const int64_t kSampleIntervalMs = 500;
+    static const int64_t kStaleMs = 3000;   // 超过这个时间没有新帧视为流中断，重新开始计时
+    static const int kHashCols = 9;
+    static const int kHashRows = 8;
+    static const int kSampleStep = 4;       // 块内每隔几个像素取一个样本
+    static const int kBlackMean = 28;       // 视频范围黑电平是 16
+    static const int kBlackStddev = 6;
+    static const int kBlankStddev = 3;
+
+    typedef std::function<void(const PictureHealthEvent&)> EventCallback;
+
+    PictureHealthMonitor();
+
+    // 回调在调用 submit 的线程上执行，不持有内部锁
+    void setEventCallback(const EventCallback& callback);
+    void configure(const PictureHealthConfig& config);
+
+    // 任意线程调用：未到采样间隔时返回 false，调用方不必准备帧；返回 true 时占住本次采样
+    bool shouldSample(const std::string& devId, int64_t nowMs);
+    // 对 shouldSample 放行的帧采样并判断状态
+    bool submit(const std::string& devId, const FrameRef& frame, int64_t nowMs);
+
+    PictureState state(const std::string& devId) const;
+    void drop(const std::string& devId);
+    PictureHealthStats stats() const;
+
+private:
+    struct Sample {
+        uint64_t hash = 0;
+        uint32_t checksum = 0;   // 全部样本的精确校验和
+        int mean = 0;
+        int stddev = 0;
+    };
+
+    struct Device {
+        Sample last;
+        bool hasLast = false;
+        int64_t lastSampleMs = 0;
+        int64_t nextSampleMs = 0;
+        PictureState candidate = PICTURE_OK;
+        int64_t candidateSinceMs = 0;
+        PictureState reported = PICTURE_OK;
+        int64_t reportedSinceMs = 0;
+    };
+
+    static bool takeSample(const uint8_t* y, int rowStride, int width, int height, Sample& sample);
+    static bool sameImage(const Sample& a, const Sample& b);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Device> m_devices;
+    PictureHealthConfig m_config;
+    EventCallback m_callback;
+    PictureHealthStats m_stats;
+};
+
+#endif // PICTURE_HEALTH_H
@@ -0,0 +1,317 @@
+#include "pre_event_recorder.h"
+#include "fmp4_recorder.h"
+#include "h264_nal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#define LOG_TAG "PreEventRecorder"
+#include "native_log.h"
+
+// 直播流中断时事件线程最多再等这么久就结束录像
+static const int64_t kStreamStallGraceUs = 2000000;
+
+static std::string sanitizeFileName(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        bool ok = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '_';
+        out.push_back(ok ? c : '_');
+    }
+    return out;
+}
+
+static int64_t wallTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+PreEventRecorder::PreEventRecorder()
+    : m_deviceBudget(kDefaultDeviceBudget),
+      m_preUs((int64_t)kDefaultPreSeconds * 1000000),
+      m_postUs((int64_t)kDefaultPostSeconds * 1000000),
+      m_activeEvents(0) {
+}
+
+PreEventRecorder::~PreEventRecorder() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (auto& it : m_devices) {
+        closeEventLocked(it.second);
+    }
+    m_cond.notify_all();
+    m_cond.wait(lock, [this]() { return m_activeEvents == 0; });
+}
+
+void PreEventRecorder::configure(size_t deviceBudgetBytes, int preSeconds, int postSeconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_deviceBudget = deviceBudgetBytes;
+    m_preUs = (int64_t)(preSeconds > 0 ? preSeconds : 0) * 1000000;
+    m_postUs = (int64_t)(postSeconds > 0 ? postSeconds : 0) * 1000000;
+    for (auto& it : m_devices) {
+        trimLocked(it.second, it.second.frames.empty() ? 0 : it.second.frames.back().ptsUs);
+    }
+    LOGI("configure: deviceBudget=%zu, pre=%ds, post=%ds", deviceBudgetBytes, preSeconds, postSeconds);
+}
+
+void PreEventRecorder::setOutputDir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_outputDir = dir;
+    while (!m_outputDir.empty() && m_outputDir.back() == '/') {
+        m_outputDir.pop_back();
+    }
+}
+
+void PreEventRecorder::setTriggerTypes(const std::set<std::string>& types) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_triggerTypes = types;
+}
+
+bool PreEventRecorder::isTriggerType(const std::string& type) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_triggerTypes.count(type) > 0;
+}
+
+void PreEventRecorder::setFinishedCallback(const FinishedCallback& callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finishedCallback = callback;
+}
+
+void PreEventRecorder::push(const std::string& devId, const uint8_t* data, int length, int64_t ptsUs) {
+    if (!data || length <= 0) {
+        return;
+    }
+    push(devId, std::make_shared<const std::vector<uint8_t>>(data, data + length), ptsUs);
+}
+
+void PreEventRecorder::push(const std::string& devId, const std::shared_ptr<const std::vector<uint8_t>>& payload,
+                            int64_t ptsUs) {
+    if (!payload || payload->empty()) {
+        return;
+    }
+    const uint8_t* data = payload->data();
+    const int length = (int)payload->size();
+    H264AccessUnitInfo info = h264InspectAccessUnit(data, length);
+    std::vector<H264NalUnit> nals;
+    if (info.hasSps || info.hasPps) {
+        h264SplitNalUnits(data, length, nals);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_deviceBudget == 0) {
+        return;
+    }
+    DeviceRing& ring = m_devices[devId];
+    for (const H264NalUnit& nal : nals) {
+        if (nal.type == H264_NAL_SPS) {
+            ring.sps.assign(nal.data, nal.data + nal.size);
+        } else if (nal.type == H264_NAL_PPS) {
+            ring.pps.assign(nal.data, nal.data + nal.size);
+        }
+    }
+    if (!info.hasSlice) {
+        return;
+    }
+    if (ring.frames.empty() && !info.hasIdr && !ring.event) {
+        // 缓冲区必须从 IDR 开始
+        return;
+    }
+
+    Frame frame;
+    frame.data = payload;
+    frame.ptsUs = ptsUs;
+    frame.idr = info.hasIdr;
+
+    // 报警录像进行中：帧同时交给事件线程，超过截止时间后结束
+    if (ring.event) {
+        Event& event = *ring.event;
+        if (ptsUs > event.deadlineUs) {
+            closeEventLocked(ring);
+        } else if (event.pendingBytes + (size_t)length > m_deviceBudget / 2) {
+            // 事件线程跟不上时丢帧，保证单设备内存上限；另一半预算留给录像器未写盘的分片
+            event.droppedFrames++;
+        } else {
+            event.pending.push_back(frame);
+            event.pendingBytes += (size_t)length;
+            m_cond.notify_all();
+        }
+    }
+
+    if (ring.frames.empty() && !info.hasIdr) {
+        return;
+    }
+    ring.frames.push_back(frame);
+    ring.bytes += (size_t)length;
+    trimLocked(ring, ptsUs);
+}
+
+void PreEventRecorder::popGopLocked(DeviceRing& ring) {
+    // 丢弃最旧的整个 GOP，保证缓冲区始终从 IDR 开始
+    do {
+        ring.bytes -= ring.frames.front().data->size();
+        ring.frames.pop_front();
+    } while (!ring.frames.empty() && !ring.frames.front().idr);
+}
+
+void PreEventRecorder::trimLocked(DeviceRing& ring, int64_t nowUs) {
+    while (!ring.frames.empty() && ring.bytes > m_deviceBudget) {
+        popGopLocked(ring);
+    }
+    // 第二个 GOP 开始时间已经早于预录窗口时，最旧的 GOP 不再需要
+    while (!ring.frames.empty()) {
+        size_t next = 1;
+        while (next < ring.frames.size() && !ring.frames[next].idr) {
+            next++;
+        }
+        if (next >= ring.frames.size() || ring.frames[next].ptsUs > nowUs - m_preUs) {
+            break;
+        }
+        popGopLocked(ring);
+    }
+}
+
+void PreEventRecorder::closeEventLocked(DeviceRing& ring) {
+    if (ring.event) {
+        ring.event->closed = true;
+        ring.event.reset();
+        m_cond.notify_all();
+    }
+}
+
+bool PreEventRecorder::trigger(const std::string& devId, const std::string& eventType, int64_t nowUs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        LOGW("trigger: no buffered video for devId=%s, type=%s", devId.c_str(), eventType.c_str());
+        return false;
+    }
+    DeviceRing& ring = it->second;
+    if (ring.event) {
+        ring.event->deadlineUs = nowUs + m_postUs;
+        LOGI("trigger: extend event for devId=%s, type=%s", devId.c_str(), eventType.c_str());
+        return true;
+    }
+    if (ring.frames.empty() || m_outputDir.empty()) {
+        LOGW("trigger: nothing to record for devId=%s (frames=%zu, dir=%s)",
+             devId.c_str(), ring.frames.size(), m_outputDir.c_str());
+        return false;
+    }
+
+    std::shared_ptr<Event> event = std::make_shared<Event>();
+    event->deadlineUs = nowUs + m_postUs;
+    ring.event = event;
+    std::vector<Frame> snapshot(ring.frames.begin(), ring.frames.end());
+    std::string path = m_outputDir + "/event_" + sanitizeFileName(devId) + "_" + sanitizeFileName(eventType) +
+                       "_" + std::to_string(wallTimeMs()) + ".mp4";
+    m_activeEvents++;
+    LOGI("trigger: devId=%s, type=%s, preFrames=%zu, preBytes=%zu, path=%s",
+         devId.c_str(), eventType.c_str(), snapshot.size(), ring.bytes, path.c_str());
+
+    std::thread(&PreEventRecorder::runEvent, this, devId, path, event, std::move(snapshot), ring.sps, ring.pps).detach();
+    return true;
+}
+
+void PreEventRecorder::runEvent(const std::string& devId, const std::string& path, std::shared_ptr<Event> event,
+                                std::vector<Frame> snapshot, std::vector<uint8_t> sps, std::vector<uint8_t> pps) {
+    size_t preBytes = 0;
+    for (const Frame& frame : snapshot) {
+        preBytes += frame.data->size();
+    }
+    size_t budget = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        budget = m_deviceBudget;
+    }
+    std::unique_ptr<Fmp4Recorder> recorder(new Fmp4Recorder());
+    // 事件线程可以阻塞：录像器用背压代替丢弃最旧的分片，预录画面再长也完整写出，
+    // 未写盘的数据（排队和正在累积的分片）限制在单设备预算的一半以内
+    recorder->setMaxQueuedBytes(std::max<size_t>(budget / 4, 1));
+    // 事件期间参数集变化时录像会切成多个文件，写线程在 stop 之前登记，stop 之后逐个通知
+    std::vector<std::string> segmentPaths;
+    recorder->setSegmentCallback([&segmentPaths](const std::string& segmentPath) {
+        segmentPaths.push_back(segmentPath);
+    });
+    bool ok = recorder->start(path, preBytes * 2 + Fmp4Recorder::kMaxFragmentBytes);
+    if (ok) {
+        recorder->setParameterSets(sps, pps);
+        for (Frame& frame : snapshot) {
+            recorder->push(frame.data->data(), (int)frame.data->size(), frame.ptsUs);
+            // 快照和环形缓冲共享数据，写出后立即释放引用，环形缓冲淘汰的帧不再被事件线程留住
+            frame.data.reset();
+        }
+    }
+    snapshot.clear();
+
+    std::deque<Frame> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            std::chrono::microseconds wait(event->deadlineUs + kStreamStallGraceUs);
+            std::chrono::steady_clock::time_point until{std::chrono::duration_cast<std::chrono::steady_clock::duration>(wait)};
+            bool ready = m_cond.wait_until(lock, until, [&event]() { return event->closed || !event->pending.empty(); });
+            if (!ready && !event->closed) {
+                // 直播流中断，截止时间后没有新帧
+                LOGW("runEvent: stream stalled, closing event for devId=%s", devId.c_str());
+                auto it = m_devices.find(devId);
+                if (it != m_devices.end() && it->second.event == event) {
+                    closeEventLocked(it->second);
+                } else {
+                    event->closed = true;
+                }
+            }
+            batch.swap(event->pending);
+            event->pendingBytes = 0;
+            if (batch.empty() && event->closed) {
+                break;
+            }
+        }
+        for (const Frame& frame : batch) {
+            if (ok) {
+                recorder->push(frame.data->data(), (int)frame.data->size(), frame.ptsUs);
+            }
+        }
+        batch.clear();
+    }
+
+    FinishedCallback callback;
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        callback = m_finishedCallback;
+        dropped = event->droppedFrames;
+    }
+    if (ok) {
+        recorder->stop();
+        Fmp4RecorderStats s = recorder->stats();
+        LOGI("runEvent: finished devId=%s, path=%s, segments=%zu, frames=%llu, bytes=%llu, droppedFrames=%llu",
+             devId.c_str(), path.c_str(), segmentPaths.size(), (unsigned long long)s.framesWritten,
+             (unsigned long long)s.bytesWritten, (unsigned long long)dropped);
+        if (callback) {
+            for (const std::string& segmentPath : segmentPaths) {
+                callback(devId, segmentPath);
+            }
+        }
+    } else {
+        LOGE("runEvent: failed to open %s", path.c_str());
+    }
+    recorder.reset();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_activeEvents--;
+    m_cond.notify_all();
+}
+
+void PreEventRecorder::drop(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        return;
+    }
+    closeEventLocked(it->second);
+    m_devices.erase(it);
+}
+
+size_t PreEventRecorder::deviceBytes(const std::string& devId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    return it == m_devices.end() ? 0 : it->second.bytes;
+}
@@ -0,0 +1,92 @@
+#ifndef PRE_EVENT_RECORDER_H
+#define PRE_EVENT_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 报警预录：每个设备在内存里保留最近 N 秒的访问单元（按 GOP 对齐，字节数有上限），
+// 收到配置的报警事件时把环形缓冲和之后 M 秒的视频写进一个 fMP4 文件。
+// 接收线程最多做一次拷贝和入队，封装和写盘都在事件线程完成。
+// 报警录像进行中时事件线程另占一份预算：待写帧最多一半，录像器未写盘的分片最多一半；
+// 预录快照只引用环形缓冲里的数据，写出一帧释放一帧。
+class PreEventRecorder {
+public:
+    static const size_t kDefaultDeviceBudget = 8 * 1024 * 1024;
+    static const int kDefaultPreSeconds = 10;
+    static const int kDefaultPostSeconds = 10;
+
+    // 录像结束回调：devId, 文件路径；参数集变化切出多个文件时每个文件回调一次
+    typedef std::function<void(const std::string&, const std::string&)> FinishedCallback;
+
+    PreEventRecorder();
+    ~PreEventRecorder();
+
+    void configure(size_t deviceBudgetBytes, int preSeconds, int postSeconds);
+    void setOutputDir(const std::string& dir);
+    void setTriggerTypes(const std::set<std::string>& types);
+    bool isTriggerType(const std::string& type) const;
+    void setFinishedCallback(const FinishedCallback& callback);
+
+    // 接收线程调用：送入一个 Annex-B 访问单元
+    void push(const std::string& devId, const uint8_t* data, int length, int64_t ptsUs);
+    // 同上，直接持有调用方已共享的数据（如帧总线上的帧），不再拷贝
+    void push(const std::string& devId, const std::shared_ptr<const std::vector<uint8_t>>& data, int64_t ptsUs);
+
+    // 报警到达：开始写预录文件，事件进行中再次触发时延长录制时间
+    bool trigger(const std::string& devId, const std::string& eventType, int64_t nowUs);
+
+    void drop(const std::string& devId);
+    size_t deviceBytes(const std::string& devId) const;
+
+private:
+    struct Frame {
+        std::shared_ptr<const std::vector<uint8_t>> data;
+        int64_t ptsUs = 0;
+        bool idr = false;
+    };
+
+    // 一次报警录像，事件线程从 pending 取帧
+    struct Event {
+        std::deque<Frame> pending;
+        size_t pendingBytes = 0;
+        int64_t deadlineUs = 0;
+        bool closed = false;
+        uint64_t droppedFrames = 0;
+    };
+
+    struct DeviceRing {
+        std::deque<Frame> frames;
+        size_t bytes = 0;
+        std::vector<uint8_t> sps;
+        std::vector<uint8_t> pps;
+        std::shared_ptr<Event> event;
+    };
+
+    void trimLocked(DeviceRing& ring, int64_t nowUs);
+    void popGopLocked(DeviceRing& ring);
+    void closeEventLocked(DeviceRing& ring);
+    void runEvent(const std::string& devId, const std::string& path, std::shared_ptr<Event> event,
+                  std::vector<Frame> snapshot, std::vector<uint8_t> sps, std::vector<uint8_t> pps);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_deviceBudget;
+    int64_t m_preUs;
+    int64_t m_postUs;
+    std::string m_outputDir;
+    std::set<std::string> m_triggerTypes;
+    FinishedCallback m_finishedCallback;
+    std::unordered_map<std::string, DeviceRing> m_devices;
+    int m_activeEvents;
+};
+
+#endif // PRE_EVENT_RECORDER_H
@@ -0,0 +1,186 @@
+#include "presentation_scheduler.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "av_sync.h"
+
+#define LOG_TAG "PresentationScheduler"
+#include "native_log.h"
+
+const int64_t PresentationScheduler::kMaxExtraDelayUs;
+const int64_t PresentationScheduler::kResyncThresholdUs;
+const int64_t PresentationScheduler::kMaxLateUs;
+
+// 还没测出帧间隔时按 25fps 处理
+static const int64_t kDefaultIntervalUs = 40000;
+
+PresentationScheduler::PresentationScheduler()
+    : m_masterClock(nullptr),
+      m_targetDelayUs((int64_t)kDefaultTargetDelayMs * 1000),
+      m_extraDelayUs(0),
+      m_lastArrivalUs(0),
+      m_smoothedUs(0),
+      m_intervalUs(0),
+      m_jitterUs(0),
+      m_lastTargetUs(0),
+      m_vsyncNs(0),
+      m_vsyncPeriodNs(0) {
+}
+
+void PresentationScheduler::setMasterClock(AvSyncClock* clock) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_masterClock = clock;
+}
+
+void PresentationScheduler::setTargetDelayMs(int delayMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targetDelayUs = (int64_t)std::max(0, std::min(delayMs, 1000)) * 1000;
+    LOGI("目标延迟: %lldms", (long long)(m_targetDelayUs / 1000));
+}
+
+int PresentationScheduler::targetDelayMs() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int)(m_targetDelayUs / 1000);
+}
+
+void PresentationScheduler::onVsync(int64_t frameTimeNs, int64_t periodNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vsyncNs = frameTimeNs;
+    if (periodNs > 0) {
+        m_vsyncPeriodNs = periodNs;
+    }
+}
+
+int64_t PresentationScheduler::schedule(int64_t arrivalUs, int64_t nowNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.scheduledFrames++;
+
+    if (m_lastArrivalUs > 0) {
+        const int64_t delta = arrivalUs - m_lastArrivalUs;
+        // 突发到达的帧间隔接近 0，只用于抖动统计，不参与帧间隔估计
+        if (delta > 5000 && delta < 1000000) {
+            m_intervalUs = m_intervalUs == 0 ? delta : (m_intervalUs * 15 + delta) / 16;
+        }
+    }
+    m_lastArrivalUs = arrivalUs;
+    const int64_t interval = m_intervalUs > 0 ? m_intervalUs : kDefaultIntervalUs;
+
+    const int64_t predicted = m_smoothedUs + interval;
+    const int64_t error = arrivalUs - predicted;
+    if (m_smoothedUs == 0 || llabs(error) > kResyncThresholdUs) {
+        if (m_smoothedUs != 0) {
+            m_stats.resyncs++;
+        }
+        m_smoothedUs = arrivalUs;
+        m_lastTargetUs = 0;
+    } else {
+        m_jitterUs = (m_jitterUs * 15 + llabs(error)) / 16;
+        if (error < -interval / 2) {
+            m_stats.earlyFrames++;
+        }
+        // 平滑时钟按帧间隔匀速前进，只缓慢跟随真实到达时间
+        m_smoothedUs = predicted + error / 8;
+    }
+
+    // 抖动大时缓冲自动加深，但不低于设定的目标延迟
+    const int64_t delay = std::max(m_targetDelayUs, std::min(m_jitterUs * 2, kMaxExtraDelayUs)) + m_extraDelayUs;
+    int64_t targetUs = m_smoothedUs + delay;
+    const int64_t nowUs = nowNs / 1000;
+    if (m_masterClock) {
+        // 有音频时以音频为准，校正量有界；丢弃的帧不改变上一帧的目标时间
+        targetUs = m_masterClock->syncVideo(arrivalUs, targetUs, interval, nowUs);
+        if (targetUs < 0) {
+            m_stats.droppedFrames++;
+            return -1;
+        }
+    }
+    if (m_lastTargetUs > 0 && targetUs < m_lastTargetUs + interval / 2) {
+        targetUs = m_lastTargetUs + interval / 2;
+    }
+
+    if (targetUs < nowUs) {
+        const int64_t lateUs = nowUs - targetUs;
+        m_stats.lateFrames++;
+        // 迟到说明缓冲不够深（通常是解码耗时），加深一个帧间隔
+        m_extraDelayUs = std::min(m_extraDelayUs + interval, kMaxExtraDelayUs);
+        if (lateUs > kMaxLateUs) {
+            m_stats.droppedFrames++;
+            m_lastTargetUs = targetUs;
+            return -1;
+        }
+        targetUs = nowUs;
+    } else if (targetUs - nowUs > interval && m_extraDelayUs > 0) {
+        // 余量充足时缓慢回落，每帧 1ms
+        m_extraDelayUs = std::max<int64_t>(0, m_extraDelayUs - 1000);
+    }
+    m_lastTargetUs = targetUs;
+
+    m_stats.delayUs = delay;
+    m_stats.jitterUs = m_jitterUs;
+    m_stats.frameIntervalUs = interval;
+    return alignToVsyncLocked(targetUs * 1000);
+}
+
+void PresentationScheduler::onFrameSuperseded() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.droppedFrames++;
+}
+
+void PresentationScheduler::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_extraDelayUs = 0;
+    m_lastArrivalUs = 0;
+    m_smoothedUs = 0;
+    m_intervalUs = 0;
+    m_jitterUs = 0;
+    m_lastTargetUs = 0;
+}
+
+PresentationStats PresentationScheduler::stats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+MasterClockSwitch::MasterClockSwitch(PresentationScheduler& scheduler, AvSyncClock& clock)
+    : m_scheduler(scheduler),
+      m_clock(clock),
+      m_trickPlay(false) {
+}
+
+void MasterClockSwitch::onAudioStart() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_clock.resetAudio();
+    if (!m_trickPlay) {
+        m_scheduler.setMasterClock(&m_clock);
+    }
+}
+
+void MasterClockSwitch::enterTrickPlay() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trickPlay = true;
+    m_scheduler.setMasterClock(nullptr);
+}
+
+void MasterClockSwitch::leaveTrickPlay() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trickPlay = false;
+    // 没有音频时 AvSyncClock 不做校正，直接接上即可
+    m_clock.resetAudio();
+    m_scheduler.setMasterClock(&m_clock);
+}
+
+bool MasterClockSwitch::inTrickPlay() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_trickPlay;
+}
+
+int64_t PresentationScheduler::alignToVsyncLocked(int64_t targetNs) const {
+    if (m_vsyncNs <= 0 || m_vsyncPeriodNs <= 0) {
+        return targetNs;
+    }
+    // 取目标时间之后的第一个 vsync
+    int64_t offset = targetNs - m_vsyncNs;
+    int64_t n = offset >= 0 ? (offset + m_vsyncPeriodNs - 1) / m_vsyncPeriodNs : -((-offset) / m_vsyncPeriodNs);
+    return m_vsyncNs + n * m_vsyncPeriodNs;
+}
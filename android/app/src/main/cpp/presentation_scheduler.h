@@ -0,0 +1,88 @@
+#ifndef PRESENTATION_SCHEDULER_H
+#define PRESENTATION_SCHEDULER_H
+
+#include <stdint.h>
+#include <mutex>
+
+class AvSyncClock;
+
+struct PresentationStats {
+    uint64_t scheduledFrames = 0;
+    uint64_t lateFrames = 0;       // 解码完成时已过目标时间
+    uint64_t earlyFrames = 0;      // 比平滑时钟提前到达（网络突发），由缓冲吸收
+    uint64_t droppedFrames = 0;    // 迟到太多直接丢弃，或被同一 vsync 内更新的帧替换
+    uint64_t resyncs = 0;          // 到达时钟跳变后重新对齐
+    int64_t delayUs = 0;           // 当前总延迟（目标延迟 + 自适应增量）
+    int64_t jitterUs = 0;          // 到达抖动估计
+    int64_t frameIntervalUs = 0;   // 平滑后的帧间隔
+};
+
+// 显示调度：用平滑后的到达时钟加一个小的自适应缓冲计算每帧的目标显示时间，并对齐到 vsync，
+// 解码输出按这个时间交给 releaseOutputBuffer(index, timestampNs)，网络突发不再直接表现为画面抖动。
+// 时间都基于 CLOCK_MONOTONIC（与 System.nanoTime 一致）。
+class PresentationScheduler {
+public:
+    static const int kDefaultTargetDelayMs = 60;
+    static const int64_t kMaxExtraDelayUs = 250000;   // 自适应增量上限
+    static const int64_t kResyncThresholdUs = 500000; // 到达时间偏离预测超过该值时重新对齐
+    static const int64_t kMaxLateUs = 200000;         // 迟到超过该值的帧直接丢弃
+
+    PresentationScheduler();
+
+    // 设置后视频以音频为主时钟，目标显示时间交给 clock 校正；传 nullptr 取消
+    void setMasterClock(AvSyncClock* clock);
+
+    void setTargetDelayMs(int delayMs);
+    int targetDelayMs();
+
+    // Choreographer 回调，记录最近一次 vsync 时间和周期
+    void onVsync(int64_t frameTimeNs, int64_t periodNs);
+
+    // 解码输出一帧：arrivalUs 为该帧的 PTS（到达时钟域），返回目标显示时间（ns，已对齐 vsync），-1 表示丢弃
+    int64_t schedule(int64_t arrivalUs, int64_t nowNs);
+
+    // 同一 vsync 内有更新的帧，旧帧未显示就被替换
+    void onFrameSuperseded();
+
+    // 解码器重建或切换设备时清空时钟状态
+    void reset();
+
+    PresentationStats stats();
+
+private:
+    int64_t alignToVsyncLocked(int64_t targetNs) const;
+
+    std::mutex m_mutex;
+    AvSyncClock* m_masterClock;
+    int64_t m_targetDelayUs;
+    int64_t m_extraDelayUs;   // 迟到时增加，持续准时时缓慢回落
+    int64_t m_lastArrivalUs;
+    int64_t m_smoothedUs;     // 平滑后的到达时钟
+    int64_t m_intervalUs;
+    int64_t m_jitterUs;
+    int64_t m_lastTargetUs;
+    int64_t m_vsyncNs;
+    int64_t m_vsyncPeriodNs;
+    PresentationStats m_stats;
+};
+
+// 显示调度主时钟的切换：直播时跟随音频时钟；快放/快退送的是录像帧，PTS 与直播音频无关，期间断开，
+// 这时启动或重启音频也不接上；退出快放时重置音频时钟再接上，校正量从新的播放报告重新建立
+class MasterClockSwitch {
+public:
+    MasterClockSwitch(PresentationScheduler& scheduler, AvSyncClock& clock);
+
+    // 音频开始播放
+    void onAudioStart();
+    void enterTrickPlay();
+    void leaveTrickPlay();
+    bool inTrickPlay() const;
+
+private:
+    mutable std::mutex m_mutex;
+    PresentationScheduler& m_scheduler;
+    AvSyncClock& m_clock;
+    bool m_trickPlay;
+};
+
+#endif // PRESENTATION_SCHEDULER_H
@@ -0,0 +1,112 @@
+#include "record_benchmark.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "fmp4_recorder.h"
+#include "h264_nal.h"
+
+#define LOG_TAG "RecordBenchmark"
+#include "native_log.h"
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[64 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static double processCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+RecordBenchmarkResult runRecordBenchmark(const std::string& path, const RecordBenchmarkOptions& options) {
+    RecordBenchmarkResult result;
+    if (options.fps <= 0 || options.fps > 240) {
+        LOGE("帧率无效: %d", options.fps);
+        return result;
+    }
+    std::vector<uint8_t> stream;
+    if (!readFile(path, stream) || stream.empty()) {
+        LOGE("无法读取码流文件: %s", path.c_str());
+        return result;
+    }
+    std::vector<std::pair<int, int>> units;
+    h264SplitAccessUnits(stream.data(), (int)stream.size(), units);
+    if (units.empty()) {
+        LOGE("文件中没有 H.264 访问单元: %s", path.c_str());
+        return result;
+    }
+
+    const std::string outputPath =
+        options.outputPath.empty() ? "/tmp/record-bench-" + std::to_string(getpid()) + ".mp4" : options.outputPath;
+    Fmp4Recorder recorder;
+    if (!options.realtime) {
+        // 背压而不是丢分片，测的是写盘能跟上的最大吞吐；分片上限与默认策略相同
+        recorder.setMaxQueuedBytes(Fmp4Recorder::kMaxFragmentBytes * 2);
+    }
+    if (!recorder.start(outputPath)) {
+        return result;
+    }
+
+    const int64_t frameUs = 1000000 / options.fps;
+    const int loops = options.loops > 0 ? options.loops : 1;
+    const double cpuStart = processCpuSeconds();
+    const auto wallStart = std::chrono::steady_clock::now();
+    // PTS 从 1s 开始，跨轮次保持单调
+    int64_t ptsUs = 1000000;
+    for (int loop = 0; loop < loops; loop++) {
+        for (const auto& unit : units) {
+            if (options.realtime) {
+                std::this_thread::sleep_until(wallStart + std::chrono::microseconds(ptsUs - 1000000));
+            }
+            recorder.push(stream.data() + unit.first, unit.second, ptsUs);
+            ptsUs += frameUs;
+        }
+    }
+    recorder.stop();
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double cpu = processCpuSeconds() - cpuStart;
+
+    const Fmp4RecorderStats stats = recorder.stats();
+    if (options.outputPath.empty()) {
+        for (uint32_t i = 0; i < std::max<uint64_t>(stats.segments, 1); i++) {
+            unlink(Fmp4Recorder::segmentPath(outputPath, i).c_str());
+        }
+    }
+    if (stats.fragmentsWritten == 0) {
+        LOGE("没有写出分片（码流中没有 SPS/PPS 或 IDR？）: %s", path.c_str());
+        return result;
+    }
+    result.ok = true;
+    result.accessUnits = (uint64_t)units.size() * loops;
+    result.frames = stats.framesWritten;
+    result.fragments = stats.fragmentsWritten;
+    result.droppedFragments = stats.droppedFragments;
+    result.segments = stats.segments;
+    result.bytes = stats.bytesWritten;
+    result.mediaSeconds = (double)result.accessUnits * frameUs / 1e6;
+    result.wallSeconds = wall;
+    result.cpuSeconds = cpu;
+    result.mbPerSecond = wall > 0 ? stats.bytesWritten / wall / (1024 * 1024) : 0;
+    result.muxUsPerFragment = (double)stats.muxTimeUs / stats.fragmentsWritten;
+    result.writeUsPerFragment = (double)stats.writeTimeUs / stats.fragmentsWritten;
+    LOGI("%llu 帧 %llu 个分片 %.1fMB, 墙钟 %.2fs %.1fMB/s, CPU %.2fs",
+         (unsigned long long)result.frames, (unsigned long long)result.fragments,
+         stats.bytesWritten / (1024.0 * 1024), wall, result.mbPerSecond, cpu);
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef RECORD_BENCHMARK_H
+#define RECORD_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+
+struct RecordBenchmarkOptions {
+    int fps = 25;               // 编造时间戳的帧率，realtime 时也是送帧节奏
+    int loops = 1;              // 整段码流重复送入的次数
+    bool realtime = false;      // 按帧率送帧，写盘跟不上时按录像的默认策略丢分片；否则背压、尽快送入
+    std::string outputPath;     // 为空时写到临时文件，结束后删除
+};
+
+struct RecordBenchmarkResult {
+    bool ok = false;
+    uint64_t accessUnits = 0;
+    uint64_t frames = 0;
+    uint64_t fragments = 0;
+    uint64_t droppedFragments = 0;
+    uint64_t segments = 0;
+    uint64_t bytes = 0;
+    double mediaSeconds = 0;
+    double wallSeconds = 0;     // 从第一次送帧到 stop 返回（剩余分片全部落盘）
+    double cpuSeconds = 0;      // 进程 CPU 时间，包括送帧线程和写线程
+    double mbPerSecond = 0;     // 按墙钟时间
+    double muxUsPerFragment = 0;
+    double writeUsPerFragment = 0;  // write + fdatasync
+};
+
+// 无界面录像基准：把回放用的 Annex-B 码流切分成访问单元送进 Fmp4Recorder，
+// 统计写盘吞吐、每个分片的封装和写盘耗时以及 CPU 时间
+RecordBenchmarkResult runRecordBenchmark(const std::string& path, const RecordBenchmarkOptions& options);
+
+#endif // RECORD_BENCHMARK_H
@@ -0,0 +1,241 @@
+#include "stream_clock.h"
+
+#include <math.h>
+#include <vector>
+
+#include "h264_nal.h"
+
+#define LOG_TAG "StreamClock"
+#include "native_log.h"
+
+const int64_t StreamClock::kResyncThresholdUs;
+const int64_t StreamClock::kMinFrameIntervalUs;
+const int64_t StreamClock::kMaxFrameIntervalUs;
+const int64_t StreamClock::kDefaultFrameIntervalUs;
+const int StreamClock::kSkipConfirmFrames;
+
+// 锁相环增益：相位每帧修正误差的 1/20，频率修正更慢，单帧的网络抖动只留下很小的影响
+static const double kPhaseGain = 0.05;
+static const double kFrequencyGain = 0.002;
+static const double kWarmupPhaseGain = 0.25;
+// SEI 时钟本身准确，偏移只跟随两端时钟的漂移
+static const double kSeiOffsetGain = 0.01;
+static const double kObservedAlpha = 0.05;
+static const double kJitterAlpha = 1.0 / 16;
+// VUI 帧率与实际到达间隔相差超过这个比例时不再采用（例如夜间降帧但 VUI 不变）
+static const double kNominalTolerance = 0.2;
+static const double kNominalDriftLimit = 0.02;
+static const uint64_t kWarmupFrames = 30;
+
+static double clampInterval(double intervalUs) {
+    if (intervalUs < StreamClock::kMinFrameIntervalUs) {
+        return StreamClock::kMinFrameIntervalUs;
+    }
+    return intervalUs > StreamClock::kMaxFrameIntervalUs ? StreamClock::kMaxFrameIntervalUs : intervalUs;
+}
+
+// VUI 的帧间隔：一帧为两个 tick（帧编码时每帧两场）
+static int64_t vuiFrameIntervalUs(const H264Sps& sps) {
+    if (!sps.timingInfoPresent || sps.timeScale == 0 || sps.numUnitsInTick == 0) {
+        return 0;
+    }
+    int64_t intervalUs = (int64_t)sps.numUnitsInTick * 2 * 1000000 / sps.timeScale;
+    if (intervalUs < StreamClock::kMinFrameIntervalUs || intervalUs > StreamClock::kMaxFrameIntervalUs) {
+        return 0;
+    }
+    return intervalUs;
+}
+
+void StreamClock::resync(Device& device, int64_t arrivalUs) {
+    device.phaseUs = (double)arrivalUs;
+    device.hasSeiBase = false;
+    device.stats.resyncs++;
+}
+
+int64_t StreamClock::stampArrival(Device& device, int64_t arrivalUs) {
+    const double predicted = device.phaseUs + device.intervalUs;
+    double error = arrivalUs - predicted;
+    if (fabs(error) > kResyncThresholdUs) {
+        LOGW("stampArrival: 到达时间偏离 %.0fms，重新对齐", error / 1000);
+        resync(device, arrivalUs);
+        return arrivalUs;
+    }
+    double phase = predicted;
+    // 设备少发了帧（降帧、编码端丢帧）与网络延迟在单帧上无法区分：误差超过 1.5 个帧间隔时先挂起，
+    // 之后连续 kSkipConfirmFrames 帧都推后同样的帧数才按整数帧前进；延迟恢复时后续帧会提前到达，挂起取消。
+    // 挂起期间相位按帧间隔前进，不用这些帧修正锁相环。
+    if (device.pendingSkip > 0) {
+        if (error >= (device.pendingSkip - 0.5) * device.intervalUs) {
+            if (++device.pendingFrames < kSkipConfirmFrames) {
+                device.phaseUs = predicted;
+                return (int64_t)predicted;
+            }
+            phase += device.pendingSkip * device.intervalUs;
+            error -= device.pendingSkip * device.intervalUs;
+            device.stats.missingFrames += device.pendingSkip;
+        }
+        device.pendingSkip = 0;
+        device.pendingFrames = 0;
+    } else if (error > device.intervalUs * 1.5 && device.stats.accessUnits >= kWarmupFrames) {
+        device.pendingSkip = (int)floor(error / device.intervalUs + 0.5);
+        device.pendingFrames = 1;
+        device.phaseUs = predicted;
+        return (int64_t)predicted;
+    }
+    if (device.stats.accessUnits < kWarmupFrames) {
+        // 起步阶段相位快速跟随，帧间隔直接用到达间隔的均值，避免锁相环从默认值慢慢收敛
+        device.phaseUs = phase + kWarmupPhaseGain * error;
+        if (device.nominalIntervalUs == 0) {
+            device.intervalUs = device.observedIntervalUs;
+        }
+    } else {
+        device.phaseUs = phase + kPhaseGain * error;
+        device.intervalUs = clampInterval(device.intervalUs + kFrequencyGain * error);
+        if (device.nominalIntervalUs > 0) {
+            // 有标称帧率时只允许跟随时钟漂移
+            const double low = device.nominalIntervalUs * (1.0 - kNominalDriftLimit);
+            const double high = device.nominalIntervalUs * (1.0 + kNominalDriftLimit);
+            device.intervalUs = device.intervalUs < low ? low : (device.intervalUs > high ? high : device.intervalUs);
+        }
+    }
+    device.jitterUs += (fabs(error) - device.jitterUs) * kJitterAlpha;
+    return (int64_t)device.phaseUs;
+}
+
+int64_t StreamClock::stampSei(Device& device, int64_t ticks, int64_t arrivalUs) {
+    if (!device.hasSeiBase || ticks < device.lastSeiTicks) {
+        // 第一次出现或编码端时钟回绕、重置
+        device.hasSeiBase = true;
+        device.seiBaseTicks = ticks;
+        device.seiOffsetUs = (double)arrivalUs;
+        device.lastSeiTicks = ticks;
+        device.phaseUs = (double)arrivalUs;
+        return arrivalUs;
+    }
+    const int64_t mediaUs = (ticks - device.seiBaseTicks) * 1000000 / device.sps.timeScale;
+    const int64_t frameUs = (ticks - device.lastSeiTicks) * 1000000 / device.sps.timeScale;
+    device.lastSeiTicks = ticks;
+    double error = arrivalUs - (mediaUs + device.seiOffsetUs);
+    if (fabs(error) > kResyncThresholdUs) {
+        LOGW("stampSei: 编码端时钟与到达时间偏离 %.0fms，重新对齐", error / 1000);
+        resync(device, arrivalUs);
+        device.hasSeiBase = true;
+        device.seiBaseTicks = ticks;
+        device.seiOffsetUs = (double)arrivalUs;
+        return arrivalUs;
+    }
+    device.seiOffsetUs += kSeiOffsetGain * error;
+    device.jitterUs += (fabs(error) - device.jitterUs) * kJitterAlpha;
+    if (frameUs >= kMinFrameIntervalUs && frameUs <= kMaxFrameIntervalUs) {
+        device.intervalUs = (double)frameUs;
+    }
+    device.phaseUs = mediaUs + device.seiOffsetUs;
+    return (int64_t)device.phaseUs;
+}
+
+int64_t StreamClock::stamp(const std::string& devId, const uint8_t* data, int length, int64_t arrivalUs) {
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device& device = m_devices[devId];
+    bool hasSeiClock = false;
+    int64_t seiTicks = 0;
+    for (const H264NalUnit& nal : nals) {
+        if (nal.type == H264_NAL_SPS) {
+            H264Sps sps;
+            if (h264ParseSps(nal.data, nal.size, sps)) {
+                const int64_t nominal = vuiFrameIntervalUs(sps);
+                if (nominal != vuiFrameIntervalUs(device.sps) && nominal > 0) {
+                    LOGI("stamp: devId=%s VUI 帧间隔 %lldus", devId.c_str(), (long long)nominal);
+                    device.nominalIntervalUs = nominal;
+                }
+                device.sps = sps;
+            }
+        } else if (nal.type == H264_NAL_SEI && device.sps.valid) {
+            if (h264ParsePicTimingClock(nal.data, nal.size, device.sps, device.clock)) {
+                hasSeiClock = true;
+                seiTicks = h264ClockTimestampTicks(device.clock, device.sps);
+            }
+        }
+    }
+
+    if (device.started) {
+        if (device.stats.accessUnits < kWarmupFrames) {
+            // 起步阶段对 (帧序号, 到达时间) 做最小二乘拟合，斜率即帧间隔，开头几帧突发或延迟的影响被摊薄
+            const double x = (double)device.stats.accessUnits;
+            const double y = (double)(arrivalUs - device.firstArrivalUs);
+            device.fitN += 1;
+            device.fitX += x;
+            device.fitY += y;
+            device.fitXX += x * x;
+            device.fitXY += x * y;
+            const double denominator = device.fitN * device.fitXX - device.fitX * device.fitX;
+            if (denominator > 0) {
+                device.observedIntervalUs =
+                        clampInterval((device.fitN * device.fitXY - device.fitX * device.fitY) / denominator);
+            }
+        } else {
+            const double delta = clampInterval((double)(arrivalUs - device.lastArrivalUs));
+            device.observedIntervalUs += (delta - device.observedIntervalUs) * kObservedAlpha;
+        }
+        if (device.nominalIntervalUs > 0 && device.stats.accessUnits >= kWarmupFrames &&
+            fabs(device.observedIntervalUs - device.nominalIntervalUs) > device.nominalIntervalUs * kNominalTolerance) {
+            LOGW("stamp: devId=%s 实际帧间隔 %.0fus 与 VUI %lldus 不符，改用到达时间估计", devId.c_str(),
+                 device.observedIntervalUs, (long long)device.nominalIntervalUs);
+            device.nominalIntervalUs = 0;
+            device.intervalUs = device.observedIntervalUs;
+        }
+    }
+    device.lastArrivalUs = arrivalUs;
+
+    int64_t ptsUs;
+    if (!device.started) {
+        device.started = true;
+        device.firstArrivalUs = arrivalUs;
+        device.fitN = 1;
+        device.intervalUs = device.nominalIntervalUs > 0 ? device.nominalIntervalUs : kDefaultFrameIntervalUs;
+        device.phaseUs = (double)arrivalUs;
+        ptsUs = arrivalUs;
+        if (hasSeiClock) {
+            stampSei(device, seiTicks, arrivalUs);
+        }
+    } else if (hasSeiClock) {
+        ptsUs = stampSei(device, seiTicks, arrivalUs);
+    } else {
+        if (device.hasSeiBase) {
+            // SEI 中断，回到锁相环，从当前相位继续
+            device.hasSeiBase = false;
+        }
+        ptsUs = stampArrival(device, arrivalUs);
+    }
+
+    // PTS 必须单调递增，MediaCodec 和 fMP4 都依赖这一点
+    if (ptsUs <= device.lastPtsUs) {
+        ptsUs = device.lastPtsUs + 1;
+    }
+    device.lastPtsUs = ptsUs;
+
+    StreamClockStats& stats = device.stats;
+    stats.accessUnits++;
+    stats.source = device.hasSeiBase ? CLOCK_SOURCE_SEI
+                                     : (device.nominalIntervalUs > 0 ? CLOCK_SOURCE_VUI : CLOCK_SOURCE_ARRIVAL);
+    stats.frameIntervalUs = (int64_t)device.intervalUs;
+    stats.jitterUs = (int64_t)device.jitterUs;
+    return ptsUs;
+}
+
+bool StreamClock::stats(const std::string& devId, StreamClockStats& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        return false;
+    }
+    out = it->second.stats;
+    return true;
+}
+
+void StreamClock::reset(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.erase(devId);
+}
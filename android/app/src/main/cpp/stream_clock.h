@@ -0,0 +1,77 @@
+#ifndef STREAM_CLOCK_H
+#define STREAM_CLOCK_H
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "h264_bitstream.h"
+
+// 时间戳的来源，按可信程度从低到高
+enum StreamClockSource {
+    CLOCK_SOURCE_ARRIVAL = 0,   // 只有到达时间，帧间隔由锁相环估计
+    CLOCK_SOURCE_VUI = 1,       // SPS VUI 的 timing_info 给出标称帧率
+    CLOCK_SOURCE_SEI = 2,       // pic_timing SEI 携带编码端时钟
+};
+
+struct StreamClockStats {
+    uint64_t accessUnits = 0;
+    int source = CLOCK_SOURCE_ARRIVAL;
+    int64_t frameIntervalUs = 0;  // 当前使用的帧间隔
+    int64_t jitterUs = 0;         // 到达时间相对媒体时钟的平均偏差
+    uint64_t missingFrames = 0;   // 按帧间隔推断设备少发的帧
+    uint64_t resyncs = 0;         // 偏差过大或时钟回退后重新对齐
+};
+
+// 直播流时间戳：接收回调入口处用单调时钟记录到达时间，再按码流里的时间信息生成平滑的 PTS。
+// 有 pic_timing SEI 时用编码端时钟，有 VUI timing_info 时用标称帧间隔，都没有时用二阶锁相环
+// 从到达时间估计帧间隔和相位。PTS 与到达时间同在 CLOCK_MONOTONIC 域（微秒），
+// 解码器、录像和显示调度使用同一个值；到达抖动只会缓慢地影响相位，不会逐帧体现在 PTS 上。
+class StreamClock {
+public:
+    static const int64_t kResyncThresholdUs = 500000;   // 偏差超过该值时直接对齐到达时间
+    static const int64_t kMinFrameIntervalUs = 5000;
+    static const int64_t kMaxFrameIntervalUs = 1000000;
+    static const int64_t kDefaultFrameIntervalUs = 40000;
+    // 到达时间整体推后若干帧且持续这么多帧才认为设备少发了帧，否则按网络延迟处理
+    static const int kSkipConfirmFrames = 8;
+
+    // 接收线程调用：返回该访问单元的 PTS（微秒，CLOCK_MONOTONIC 域），保证单调递增
+    int64_t stamp(const std::string& devId, const uint8_t* data, int length, int64_t arrivalUs);
+
+    bool stats(const std::string& devId, StreamClockStats& out) const;
+    void reset(const std::string& devId);
+
+private:
+    struct Device {
+        H264Sps sps;                  // 最近一个 SPS，pic_timing 按它解析
+        H264ClockTimestamp clock;
+        bool started = false;
+        int64_t lastPtsUs = 0;
+        int64_t lastArrivalUs = 0;
+        int64_t firstArrivalUs = 0;
+        double fitN = 0, fitX = 0, fitY = 0, fitXX = 0, fitXY = 0;  // 起步阶段帧间隔的最小二乘累加量
+        double phaseUs = 0;           // 锁相环的相位：最近一帧在到达时钟上的平滑位置
+        double intervalUs = 0;        // 锁相环的频率：帧间隔
+        int64_t nominalIntervalUs = 0;  // VUI 给出的标称帧间隔，0 表示没有或与实际不符
+        double observedIntervalUs = 0;  // 到达间隔的滑动平均，用于校验 VUI 帧率
+        int64_t lastSeiTicks = 0;
+        bool hasSeiBase = false;
+        int64_t seiBaseTicks = 0;     // 第一个 SEI 时钟及其对应的 PTS
+        double seiOffsetUs = 0;
+        double jitterUs = 0;
+        int pendingSkip = 0;          // 疑似少发的帧数，等后续帧确认
+        int pendingFrames = 0;
+        StreamClockStats stats;
+    };
+
+    int64_t stampArrival(Device& device, int64_t arrivalUs);
+    int64_t stampSei(Device& device, int64_t ticks, int64_t arrivalUs);
+    void resync(Device& device, int64_t arrivalUs);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Device> m_devices;
+};
+
+#endif // STREAM_CLOCK_H
@@ -0,0 +1,197 @@
+#include "stream_continuity.h"
+
+#include <vector>
+
+#include "h264_nal.h"
+
+#define LOG_TAG "StreamContinuity"
+#include "native_log.h"
+
+const int64_t StreamContinuityChecker::kKeyframeRequestIntervalMs;
+
+void StreamContinuityChecker::breakChain(const std::string& devId, Device& device, int64_t nowMs, const char* reason) {
+    if (!device.broken) {
+        device.broken = true;
+        device.brokenSinceMs = nowMs;
+        LOGW("devId=%s 参考链断开: %s，等待 IDR", devId.c_str(), reason);
+    }
+}
+
+// 只在没有 B 帧的码流上按 POC 增量估计丢失的非参考帧；POC 类型 1/2 由 frame_num 推导，已被 frame_num 检查覆盖
+void StreamContinuityChecker::checkPoc(const std::string& devId, Device& device, const H264Sps& sps,
+                                       const H264SliceHeader& header) {
+    if (sps.picOrderCntType != 0 || device.seenBSlice || header.fieldPic) {
+        device.lastPocLsb = -1;
+        return;
+    }
+    if (device.lastPocLsb >= 0) {
+        const uint32_t maxPocLsb = 1u << sps.log2MaxPocLsb;
+        const uint32_t delta = (header.pocLsb + maxPocLsb - (uint32_t)device.lastPocLsb) % maxPocLsb;
+        if (delta > 0 && (device.pocStep == 0 || delta < device.pocStep)) {
+            device.pocStep = delta;
+        } else if (device.pocStep > 0 && delta > device.pocStep && delta % device.pocStep == 0) {
+            m_stats.pocGaps += delta / device.pocStep - 1;
+            LOGI("devId=%s 丢失 %u 个非参考帧 (POC %lld -> %u)", devId.c_str(), delta / device.pocStep - 1,
+                 (long long)device.lastPocLsb, header.pocLsb);
+        }
+    }
+    // MMCO 5 之后 POC 重新计数
+    device.lastPocLsb = header.hasMmco5 ? -1 : (int64_t)header.pocLsb;
+}
+
+bool StreamContinuityChecker::onAccessUnit(const std::string& devId, const uint8_t* data, int length, int64_t nowMs,
+                                           bool* requestKeyframe) {
+    if (requestKeyframe) {
+        *requestKeyframe = false;
+    }
+    if (!data || length <= 0) {
+        return true;
+    }
+    std::vector<H264NalUnit> nals;
+    h264SplitNalUnits(data, length, nals);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.accessUnits++;
+    Device& device = m_devices[devId];
+    std::vector<const H264NalUnit*> slices;
+    bool idr = false;
+    for (const H264NalUnit& nal : nals) {
+        if (nal.type == H264_NAL_SPS) {
+            H264Sps sps;
+            if (h264ParseSps(nal.data, nal.size, sps)) {
+                device.sps[sps.spsId] = sps;
+            }
+        } else if (nal.type == H264_NAL_PPS) {
+            H264Pps pps;
+            if (h264ParsePps(nal.data, nal.size, pps)) {
+                device.pps[pps.ppsId] = pps;
+            }
+        } else if (nal.type == H264_NAL_SLICE || nal.type == H264_NAL_IDR) {
+            idr = idr || nal.type == H264_NAL_IDR;
+            slices.push_back(&nal);
+        }
+    }
+    if (slices.empty()) {
+        return true;
+    }
+
+    // 逐个 slice 校验头部：参数集存在、同一帧 frame_num 一致、第一个 slice 从宏块 0 开始
+    H264SliceHeader first;
+    const H264Sps* sps = nullptr;
+    const char* invalid = nullptr;
+    bool parsed = true;
+    bool allIntra = true;
+    for (size_t i = 0; i < slices.size() && !invalid; i++) {
+        uint32_t ppsId = 0;
+        if (!h264PeekSlicePpsId(slices[i]->data, slices[i]->size, ppsId)) {
+            parsed = false;
+            break;
+        }
+        auto ppsIt = device.pps.find(ppsId);
+        auto spsIt = ppsIt != device.pps.end() ? device.sps.find(ppsIt->second.spsId) : device.sps.end();
+        if (ppsIt == device.pps.end() || spsIt == device.sps.end()) {
+            invalid = "slice 引用的参数集不存在";
+            break;
+        }
+        H264SliceHeader header;
+        if (!h264ParseSliceHeader(slices[i]->data, slices[i]->size, spsIt->second, ppsIt->second, header)) {
+            parsed = false;
+            break;
+        }
+        if (header.sliceType == H264_SLICE_B) {
+            device.seenBSlice = true;
+        }
+        allIntra = allIntra && (header.sliceType == H264_SLICE_I || header.sliceType == H264_SLICE_SI);
+        if (i == 0) {
+            first = header;
+            sps = &spsIt->second;
+            if (header.firstMb != 0) {
+                invalid = "缺少帧开头的 slice";
+            }
+        } else if (header.frameNum != first.frameNum) {
+            invalid = "同一帧的 slice frame_num 不一致";
+        }
+    }
+
+    // 有的设备周期性发非 IDR 的 I 帧，完整的 I 帧同样可以作为恢复点
+    const bool intraResync = !idr && parsed && !invalid && sps && allIntra && (device.broken || !device.sawIdr);
+    bool feed = true;
+    if (idr || intraResync) {
+        if (device.broken) {
+            m_stats.recoveries++;
+            m_stats.lastRecoveryMs = nowMs - device.brokenSinceMs;
+            LOGI("devId=%s 收到%s，参考链恢复，用时 %lldms", devId.c_str(), idr ? " IDR" : " I 帧",
+                 (long long)m_stats.lastRecoveryMs);
+        }
+        device.sawIdr = true;
+        device.broken = false;
+        device.nextRequestMs = 0;
+        device.synced = parsed && !invalid && sps;
+        if (device.synced) {
+            device.prevRefFrameNum = first.hasMmco5 ? 0 : first.frameNum;
+            device.lastPocLsb = -1;
+            device.pocStep = 0;
+            device.seenBSlice = first.sliceType == H264_SLICE_B;
+            checkPoc(devId, device, *sps, first);
+        } else {
+            LOGW("devId=%s IDR 的参数集或 slice 头无法解析，不做连续性检查", devId.c_str());
+        }
+        return true;
+    }
+
+    if (!device.sawIdr) {
+        // 从 GOP 中间开始收流，没有参考帧可用
+        breakChain(devId, device, nowMs, "尚未收到 IDR");
+        feed = false;
+    } else if (!device.synced || !parsed) {
+        feed = !device.broken;
+    } else if (device.broken) {
+        feed = false;
+    } else if (invalid) {
+        m_stats.invalidSlices++;
+        breakChain(devId, device, nowMs, invalid);
+        feed = false;
+    } else {
+        const uint32_t maxFrameNum = 1u << sps->log2MaxFrameNum;
+        const uint32_t expected = (device.prevRefFrameNum + 1) % maxFrameNum;
+        if (first.frameNum != device.prevRefFrameNum && first.frameNum != expected && !sps->gapsInFrameNumAllowed) {
+            m_stats.frameNumGaps++;
+            LOGW("devId=%s frame_num 跳变 %u -> %u", devId.c_str(), device.prevRefFrameNum, first.frameNum);
+            breakChain(devId, device, nowMs, "frame_num 不连续");
+            feed = false;
+        } else {
+            if (first.nalRefIdc != 0) {
+                device.prevRefFrameNum = first.hasMmco5 ? 0 : first.frameNum;
+            }
+            checkPoc(devId, device, *sps, first);
+        }
+    }
+
+    if (!feed) {
+        m_stats.droppedUnits++;
+        if (device.broken && nowMs >= device.nextRequestMs) {
+            device.nextRequestMs = nowMs + kKeyframeRequestIntervalMs;
+            m_stats.keyframeRequests++;
+            if (requestKeyframe) {
+                *requestKeyframe = true;
+            }
+        }
+    }
+    return feed;
+}
+
+bool StreamContinuityChecker::isBroken(const std::string& devId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    return it != m_devices.end() && it->second.broken;
+}
+
+void StreamContinuityChecker::drop(const std::string& devId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.erase(devId);
+}
+
+ContinuityStats StreamContinuityChecker::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,61 @@
+#ifndef STREAM_CONTINUITY_H
+#define STREAM_CONTINUITY_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "h264_bitstream.h"
+
+struct ContinuityStats {
+    uint64_t accessUnits = 0;
+    uint64_t droppedUnits = 0;      // 参考链断开后未送解码的访问单元
+    uint64_t frameNumGaps = 0;      // frame_num 不连续，丢了参考帧
+    uint64_t invalidSlices = 0;     // slice 头引用了不存在的参数集、丢了开头的 slice 或同一帧 frame_num 不一致
+    uint64_t pocGaps = 0;           // 只从 POC 看出的非参考帧丢失，不影响后续解码，只计数
+    uint64_t keyframeRequests = 0;
+    uint64_t recoveries = 0;        // 断开后收到 IDR 恢复
+    int64_t lastRecoveryMs = 0;     // 最近一次从断开到恢复的时间
+};
+
+// 码流连续性检查：逐个访问单元解析 slice 头，跟踪 frame_num / POC 以及参数集引用。
+// 发现参考帧丢失后不再送依赖它的帧（解码器只会输出花屏），直到下一个 IDR，
+// 同时按限速要求调用方向设备请求关键帧，把恢复时间从一个 GOP 缩短到一次往返。
+// 参数集无法解析时放行，不影响原有的显示路径。
+class StreamContinuityChecker {
+public:
+    static const int64_t kKeyframeRequestIntervalMs = 1000;   // 往返之内不重复请求
+
+    // 接收线程调用：返回 false 表示该访问单元不应送解码；需要发关键帧请求时 requestKeyframe 置为 true
+    bool onAccessUnit(const std::string& devId, const uint8_t* data, int length, int64_t nowMs, bool* requestKeyframe);
+
+    bool isBroken(const std::string& devId) const;
+    void drop(const std::string& devId);
+    ContinuityStats stats() const;
+
+private:
+    struct Device {
+        std::map<uint32_t, H264Sps> sps;
+        std::map<uint32_t, H264Pps> pps;
+        bool sawIdr = false;
+        bool synced = false;         // 从可解析的 IDR 开始跟踪；IDR 无法解析时不检查，全部放行
+        bool broken = false;
+        int64_t brokenSinceMs = 0;
+        int64_t nextRequestMs = 0;   // 下一次允许发关键帧请求的时间
+        uint32_t prevRefFrameNum = 0;
+        int64_t lastPocLsb = -1;
+        uint32_t pocStep = 0;        // 相邻帧 POC 的最小增量，一般为 2
+        bool seenBSlice = false;     // 有 B 帧时输出顺序与解码顺序不同，不按 POC 判断丢帧
+    };
+
+    void breakChain(const std::string& devId, Device& device, int64_t nowMs, const char* reason);
+    void checkPoc(const std::string& devId, Device& device, const H264Sps& sps, const H264SliceHeader& header);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Device> m_devices;
+    ContinuityStats m_stats;
+};
+
+#endif // STREAM_CONTINUITY_H
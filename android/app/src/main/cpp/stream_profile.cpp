@@ -0,0 +1,187 @@
+#include "stream_profile.h"
+
+#include <algorithm>
+
+#define LOG_TAG "StreamProfile"
+#include "native_log.h"
+
+const int64_t StreamProfileNegotiator::kUpgradeHoldMs;
+const int64_t StreamProfileNegotiator::kDowngradeHoldMs;
+const int64_t StreamProfileNegotiator::kMinSwitchIntervalMs;
+
+StreamProfileNegotiator::StreamProfileNegotiator() {
+    setProfiles({{320, 180}, {640, 360}, {1280, 720}, {1920, 1080}});
+}
+
+void StreamProfileNegotiator::setProfiles(const std::vector<StreamProfile>& profiles) {
+    std::vector<StreamProfile> sorted;
+    for (const auto& profile : profiles) {
+        if (profile.width > 0 && profile.height > 0) {
+            sorted.push_back(profile);
+        }
+    }
+    if (sorted.empty()) {
+        return;
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const StreamProfile& a, const StreamProfile& b) {
+        return (int64_t)a.width * a.height < (int64_t)b.width * b.height;
+    });
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profiles = sorted;
+    m_profileBitrate.assign(m_profiles.size(), 0);
+    // 规格表变了，原来的下标不再有效，重新从设备默认开始协商
+    for (auto& item : m_devices) {
+        item.second.current = -1;
+        item.second.candidate = -1;
+    }
+}
+
+void StreamProfileNegotiator::setViewSize(const std::string& devId, int viewId, int width, int height, int64_t nowMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device& device = m_devices[devId];
+    if (width <= 0 || height <= 0) {
+        device.views.erase(viewId);
+    } else {
+        device.views[viewId] = std::make_pair(width, height);
+    }
+    if (device.windowStartMs == 0) {
+        device.windowStartMs = nowMs;
+    }
+}
+
+void StreamProfileNegotiator::onData(const std::string& devId, int length, int64_t nowMs) {
+    if (length <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device& device = m_devices[devId];
+    device.bytes += length;
+    device.windowBytes += length;
+    if (device.windowStartMs == 0) {
+        device.windowStartMs = nowMs;
+        return;
+    }
+
+    // 每秒结算一次码率和节省量
+    const int64_t elapsedMs = nowMs - device.windowStartMs;
+    if (elapsedMs < 1000) {
+        return;
+    }
+    const int64_t bitrate = (int64_t)(device.windowBytes * 8 * 1000 / elapsedMs);
+    device.bitrateBps = device.bitrateBps == 0 ? bitrate : (device.bitrateBps * 3 + bitrate) / 4;
+
+    const int index = currentIndexLocked(device);
+    const int top = (int)m_profiles.size() - 1;
+    // 刚切换后的窗口里混有旧规格的数据，不计入该规格的实测码率
+    if (nowMs - device.lastSwitchMs > 2000 || device.switches == 0) {
+        int64_t& measured = m_profileBitrate[index];
+        measured = measured == 0 ? bitrate : (measured * 7 + bitrate) / 8;
+    }
+    if (index < top) {
+        // 最高规格测到过码率就按实测，否则按像素数比例粗略估计
+        double topBytes;
+        if (m_profileBitrate[top] > 0) {
+            topBytes = (double)m_profileBitrate[top] / 8 * elapsedMs / 1000;
+        } else {
+            const double ratio = (double)m_profiles[top].width * m_profiles[top].height /
+                                 ((double)m_profiles[index].width * m_profiles[index].height);
+            topBytes = (double)device.windowBytes * ratio;
+        }
+        if (topBytes > device.windowBytes) {
+            device.savedBytes += topBytes - device.windowBytes;
+        }
+    }
+    device.windowStartMs = nowMs;
+    device.windowBytes = 0;
+}
+
+bool StreamProfileNegotiator::poll(int64_t nowMs, ResolutionRequest& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& item : m_devices) {
+        Device& device = item.second;
+        int width = 0;
+        int height = 0;
+        if (requiredSizeLocked(device, width, height) == 0) {
+            // 没有画面时保持现状，交给会话关闭处理
+            device.candidate = -1;
+            continue;
+        }
+
+        const int current = currentIndexLocked(device);
+        int target = smallestCoveringLocked(width, height);
+        if (target < current) {
+            // 降档要求余量，避免画面尺寸在两档边界附近时来回切换
+            const int margined = smallestCoveringLocked(width * kDowngradeMarginPercent / 100,
+                                                        height * kDowngradeMarginPercent / 100);
+            target = std::min(margined, current);
+        }
+        if (target == current) {
+            device.candidate = -1;
+            continue;
+        }
+        if (target != device.candidate) {
+            device.candidate = target;
+            device.candidateSinceMs = nowMs;
+            continue;
+        }
+        const int64_t holdMs = target > current ? kUpgradeHoldMs : kDowngradeHoldMs;
+        if (nowMs - device.candidateSinceMs < holdMs ||
+            (device.lastSwitchMs != 0 && nowMs - device.lastSwitchMs < kMinSwitchIntervalMs)) {
+            continue;
+        }
+
+        device.current = target;
+        device.candidate = -1;
+        device.lastSwitchMs = nowMs;
+        device.switches++;
+        out.devId = item.first;
+        out.width = m_profiles[target].width;
+        out.height = m_profiles[target].height;
+        LOGI("devId=%s 所需 %dx%d, 切换到 %dx%d", item.first.c_str(), width, height, out.width, out.height);
+        return true;
+    }
+    return false;
+}
+
+bool StreamProfileNegotiator::stats(const std::string& devId, StreamProfileStats& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(devId);
+    if (it == m_devices.end()) {
+        return false;
+    }
+    const Device& device = it->second;
+    const StreamProfile& profile = m_profiles[currentIndexLocked(device)];
+    out.width = profile.width;
+    out.height = profile.height;
+    requiredSizeLocked(device, out.requiredWidth, out.requiredHeight);
+    out.switches = device.switches;
+    out.bytesReceived = device.bytes;
+    out.savedBytes = (uint64_t)device.savedBytes;
+    out.bitrateBps = device.bitrateBps;
+    return true;
+}
+
+int StreamProfileNegotiator::requiredSizeLocked(const Device& device, int& width, int& height) const {
+    width = 0;
+    height = 0;
+    for (const auto& view : device.views) {
+        width = std::max(width, view.second.first);
+        height = std::max(height, view.second.second);
+    }
+    return (int)device.views.size();
+}
+
+int StreamProfileNegotiator::smallestCoveringLocked(int width, int height) const {
+    for (size_t i = 0; i < m_profiles.size(); i++) {
+        if (m_profiles[i].width >= width && m_profiles[i].height >= height) {
+            return (int)i;
+        }
+    }
+    return (int)m_profiles.size() - 1;
+}
+
+int StreamProfileNegotiator::currentIndexLocked(const Device& device) const {
+    // 未协商过的设备按默认的最高规格推流处理
+    return device.current >= 0 ? device.current : (int)m_profiles.size() - 1;
+}
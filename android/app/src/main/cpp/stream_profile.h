@@ -0,0 +1,87 @@
+#ifndef STREAM_PROFILE_H
+#define STREAM_PROFILE_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 设备可切换的码流规格
+struct StreamProfile {
+    int width;
+    int height;
+};
+
+// 需要发给设备的 set_resolution 指令
+struct ResolutionRequest {
+    std::string devId;
+    int width = 0;
+    int height = 0;
+};
+
+struct StreamProfileStats {
+    int width = 0;               // 当前协商的规格
+    int height = 0;
+    int requiredWidth = 0;       // 各画面实际像素尺寸的最大值
+    int requiredHeight = 0;
+    uint64_t switches = 0;       // 已发出的切换指令数
+    uint64_t bytesReceived = 0;
+    uint64_t savedBytes = 0;     // 相对最高规格估算节省的字节数
+    int64_t bitrateBps = 0;      // 最近的接收码率
+};
+
+// 按各画面在屏幕上的实际像素尺寸，为每个设备选能覆盖最大画面的最小规格。
+// 升档等待短暂稳定后立即执行，降档要求留有余量且持续更久，两次指令之间有最小间隔，避免来回切换。
+// 只做决策和统计，指令由调用方通过 MQTT 发送。
+class StreamProfileNegotiator {
+public:
+    static const int64_t kUpgradeHoldMs = 500;
+    static const int64_t kDowngradeHoldMs = 5000;
+    static const int64_t kMinSwitchIntervalMs = 3000;
+    // 降档时要求所需尺寸再放大 1/4 仍能被较小规格覆盖
+    static const int kDowngradeMarginPercent = 125;
+
+    StreamProfileNegotiator();
+
+    // 设备支持的规格，内部按像素数升序排列；默认 1080p / 720p / 360p / 180p
+    void setProfiles(const std::vector<StreamProfile>& profiles);
+
+    // 画面尺寸变化（物理像素），宽高为 0 表示画面已移除
+    void setViewSize(const std::string& devId, int viewId, int width, int height, int64_t nowMs);
+
+    // 接收线程调用，用于码率统计
+    void onData(const std::string& devId, int length, int64_t nowMs);
+
+    // 检查所有设备，有到期的切换时填充 out 并返回 true；调用方循环调用直到返回 false
+    bool poll(int64_t nowMs, ResolutionRequest& out);
+
+    bool stats(const std::string& devId, StreamProfileStats& out);
+
+private:
+    struct Device {
+        std::map<int, std::pair<int, int>> views;  // viewId -> 宽高
+        int current = -1;           // 当前规格下标，-1 表示沿用设备默认（按最高规格统计）
+        int candidate = -1;         // 等待稳定的目标规格
+        int64_t candidateSinceMs = 0;
+        int64_t lastSwitchMs = 0;
+        uint64_t switches = 0;
+        uint64_t bytes = 0;
+        double savedBytes = 0;
+        int64_t windowStartMs = 0;
+        uint64_t windowBytes = 0;
+        int64_t bitrateBps = 0;
+    };
+
+    int requiredSizeLocked(const Device& device, int& width, int& height) const;
+    int smallestCoveringLocked(int width, int height) const;
+    int currentIndexLocked(const Device& device) const;
+
+    std::mutex m_mutex;
+    std::vector<StreamProfile> m_profiles;
+    std::vector<int64_t> m_profileBitrate;  // 各规格实测码率，0 表示尚未测到
+    std::unordered_map<std::string, Device> m_devices;
+};
+
+#endif // STREAM_PROFILE_H
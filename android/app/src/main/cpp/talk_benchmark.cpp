@@ -0,0 +1,93 @@
+#include "talk_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "talk_uplink.h"
+
+#define LOG_TAG "TalkBenchmark"
+#include "native_log.h"
+
+namespace {
+
+int64_t steadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t percentile(std::vector<int64_t>& values, int percent) {
+    if (values.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(values.size() - 1, values.size() * percent / 100);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+} // namespace
+
+TalkBenchmarkResult runTalkBenchmark(const std::string& path, const TalkBenchmarkOptions& options) {
+    TalkBenchmarkResult result;
+    TalkConfig config;
+    config.codec = options.codec;
+    config.sampleRate = options.sampleRate;
+    config.packetMs = options.packetMs;
+    config.captureMs = options.captureMs;
+    AudioSourceConfig sourceConfig;
+    sourceConfig.realtime = options.realtime;
+
+    // 传输回调在发送线程上，预留足够的空间，避免测量期间扩容
+    std::vector<int64_t> encodeUs;
+    std::vector<int64_t> latencyUs;
+    encodeUs.reserve(1 << 16);
+    latencyUs.reserve(1 << 16);
+    uint64_t bytes = 0;
+    uint64_t samples = 0;
+    TalkTransport transport = [&](const TalkPacket& packet) {
+        const int64_t nowUs = steadyTimeUs();
+        encodeUs.push_back(packet.encodeUs);
+        latencyUs.push_back(nowUs - packet.captureUs);
+        bytes += packet.length;
+        samples = packet.timestamp + packet.length;   // G.711 每个样本一个字节
+        return true;
+    };
+
+    TalkUplink uplink;
+    const auto start = std::chrono::steady_clock::now();
+    if (!uplink.start(config, "file", path, transport, sourceConfig)) {
+        LOGE("无法启动对讲上行: %s", path.c_str());
+        return result;
+    }
+    while (!uplink.finished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const TalkStats stats = uplink.stats();
+    uplink.stop();
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (encodeUs.empty()) {
+        LOGE("文件中没有 PCM 数据: %s", path.c_str());
+        return result;
+    }
+    result.ok = true;
+    result.packets = encodeUs.size();
+    result.bytes = bytes;
+    result.overruns = stats.overruns;
+    result.queueDrops = stats.queueDrops;
+    result.audioMs = (int64_t)(samples * 1000 / options.sampleRate);
+    result.priority = stats.priority;
+    for (size_t i = 0; i < encodeUs.size(); i++) {
+        result.encodeUsAvg += encodeUs[i];
+        result.latencyUsAvg += latencyUs[i];
+    }
+    result.encodeUsAvg /= encodeUs.size();
+    result.latencyUsAvg /= latencyUs.size();
+    result.encodeUsMax = *std::max_element(encodeUs.begin(), encodeUs.end());
+    result.latencyUsMax = *std::max_element(latencyUs.begin(), latencyUs.end());
+    result.encodeUsP50 = percentile(encodeUs, 50);
+    result.encodeUsP99 = percentile(encodeUs, 99);
+    result.latencyUsP99 = percentile(latencyUs, 99);
+    return result;
+}
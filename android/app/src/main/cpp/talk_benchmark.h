@@ -0,0 +1,40 @@
+#ifndef TALK_BENCHMARK_H
+#define TALK_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+
+#include "audio_codec.h"
+
+struct TalkBenchmarkOptions {
+    AudioCodec codec = AUDIO_CODEC_PCMA;
+    int sampleRate = 8000;        // 裸 PCM 的采样率；WAV 必须与之一致
+    int packetMs = 20;
+    int captureMs = 10;
+    bool realtime = false;        // 按采集节奏读取文件；否则尽快读取，只看编码开销
+};
+
+struct TalkBenchmarkResult {
+    bool ok = false;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t overruns = 0;
+    uint64_t queueDrops = 0;     // 发送队列满丢弃的包
+    int64_t audioMs = 0;
+    double wallSeconds = 0;
+    // 每包编码耗时和从采集到交给传输层的时间（微秒）
+    double encodeUsAvg = 0;
+    int64_t encodeUsP50 = 0;
+    int64_t encodeUsP99 = 0;
+    int64_t encodeUsMax = 0;
+    double latencyUsAvg = 0;
+    int64_t latencyUsP99 = 0;
+    int64_t latencyUsMax = 0;
+    int priority = 0;
+};
+
+// 无界面对讲上行基准：用 file 输入读取 WAV 或 16 位裸 PCM，经 TalkUplink 采集、编码、打包，
+// 发送线程上的传输层只记录每包的编码耗时和采集到发出的延迟。
+TalkBenchmarkResult runTalkBenchmark(const std::string& path, const TalkBenchmarkOptions& options);
+
+#endif // TALK_BENCHMARK_H
@@ -0,0 +1,342 @@
+#include "talk_uplink.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "TalkUplink"
+#include "native_log.h"
+
+namespace {
+
+int64_t steadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Android 的 THREAD_PRIORITY_URGENT_AUDIO
+const int kUrgentAudioNice = -19;
+
+// 先尝试 SCHED_FIFO；普通应用没有实时调度权限，退回提高 nice 值（应用进程的 RLIMIT_NICE 允许）
+int raiseThreadPriority() {
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+        return 2;
+    }
+    if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), kUrgentAudioNice) == 0) {
+        return 1;
+    }
+    LOGW("无法提高打包线程优先级");
+    return 0;
+}
+
+} // namespace
+
+TalkUplink::TalkUplink()
+    : m_running(false),
+      m_inputEnded(false),
+      m_finished(false),
+      m_ringStart(0),
+      m_ringSize(0),
+      m_lastCaptureUs(0),
+      m_sequence(0),
+      m_timestamp(0),
+      m_sendWrite(0),
+      m_sendRead(0),
+      m_sendRunning(false),
+      m_packetizerDone(false),
+      m_encodeUs(0),
+      m_latencyUs(0),
+      m_droppedUs(0) {
+}
+
+TalkUplink::~TalkUplink() {
+    stop();
+}
+
+bool TalkUplink::start(const TalkConfig& config, const std::string& sourceName, const std::string& sourcePath,
+                       const TalkTransport& transport, const AudioSourceConfig& sourceConfig) {
+    stop();
+    if (config.sampleRate <= 0 || !transport) {
+        return false;
+    }
+    std::unique_ptr<AudioEncoder> encoder = createAudioEncoder(config.codec);
+    if (!encoder || !encoder->open(config.codec, config.sampleRate)) {
+        return false;
+    }
+
+    TalkConfig effective = config;
+    effective.packetMs = std::max(10, std::min(config.packetMs, 60));
+    effective.captureMs = std::max(5, std::min(config.captureMs, effective.packetMs));
+    const int packetSamples = effective.sampleRate * effective.packetMs / 1000;
+    const size_t ringSamples = std::max<size_t>((size_t)effective.sampleRate * effective.queueMs / 1000,
+                                                (size_t)packetSamples * 2);
+
+    std::unique_ptr<AudioSource> source = createAudioSource(sourceName, sourcePath);
+    if (!source) {
+        return false;
+    }
+    AudioSourceConfig captureConfig = sourceConfig;
+    captureConfig.sampleRate = effective.sampleRate;
+    captureConfig.framesPerBuffer = effective.sampleRate * effective.captureMs / 1000;
+    if (!source->open(captureConfig, [this](const int16_t* pcm, int frames, int64_t captureUs) {
+            onCapture(pcm, frames, captureUs);
+        })) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config = effective;
+        m_encoder = std::move(encoder);
+        m_transport = transport;
+        m_ring.assign(ringSamples, 0);
+        m_ringStart = 0;
+        m_ringSize = 0;
+        m_lastCaptureUs = 0;
+        m_pcm.assign(packetSamples, 0);
+        m_sendSlots.resize((size_t)std::max(2, effective.sendQueuePackets));
+        for (SendSlot& slot : m_sendSlots) {
+            slot.packet = TalkPacket();
+            slot.payload.assign(m_encoder->maxEncodedBytes(packetSamples), 0);
+        }
+        m_sendWrite.store(0);
+        m_sendRead.store(0);
+        m_sendRunning.store(true);
+        m_packetizerDone.store(false);
+        m_sequence = 0;
+        m_timestamp = 0;
+        m_stats = TalkStats();
+        m_stats.codec = effective.codec;
+        m_stats.sampleRate = effective.sampleRate;
+        m_stats.packetMs = effective.packetMs;
+        m_encodeUs = 0;
+        m_latencyUs = 0;
+        m_droppedUs = 0;
+        m_inputEnded = false;
+        m_finished = false;
+        m_running = true;
+    }
+    m_sendThread = std::thread([this]() { sendLoop(); });
+    m_thread = std::thread([this]() { run(); });
+
+    m_source = std::move(source);
+    if (!m_source->start()) {
+        LOGE("音频采集启动失败: %s", m_source->name());
+        stop();
+        return false;
+    }
+    LOGI("start: %s %dHz, 每包 %dms, 采集缓冲 %dms, 输入 %s", audioCodecName(effective.codec), effective.sampleRate,
+         effective.packetMs, effective.captureMs, m_source->name());
+    return true;
+}
+
+void TalkUplink::stop() {
+    // 先停采集，保证停线程之后不会再有回调写入环形缓冲
+    if (m_source) {
+        m_source->stop();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    // 队列里还没发出的包直接丢弃，停止对讲后不再往外发旧音频
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_sendRunning.store(false);
+    }
+    m_sendCond.notify_all();
+    if (m_sendThread.joinable()) {
+        m_sendThread.join();
+        LOGI("stop: packets=%llu", (unsigned long long)m_stats.packets);
+    }
+    if (m_source) {
+        m_source->close();
+        m_source.reset();
+    }
+    if (m_encoder) {
+        m_encoder->close();
+        m_encoder.reset();
+    }
+}
+
+void TalkUplink::onCapture(const int16_t* pcm, int frames, int64_t captureUs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        if (frames <= 0) {
+            m_inputEnded = true;
+        } else {
+            const size_t capacity = m_ring.size();
+            size_t count = (size_t)frames;
+            if (count > capacity) {
+                pcm += count - capacity;
+                count = capacity;
+            }
+            // 打包线程跟不上：丢掉最旧的样本，保证对讲延迟不累积
+            const size_t overflow = m_ringSize + count > capacity ? m_ringSize + count - capacity : 0;
+            if (overflow > 0) {
+                m_ringStart = (m_ringStart + overflow) % capacity;
+                m_ringSize -= overflow;
+                m_stats.overruns++;
+                m_droppedUs += (double)overflow * 1000000 / m_config.sampleRate;
+            }
+            size_t tail = (m_ringStart + m_ringSize) % capacity;
+            for (size_t i = 0; i < count; i++) {
+                m_ring[tail] = pcm[i];
+                tail = tail + 1 == capacity ? 0 : tail + 1;
+            }
+            m_ringSize += count;
+            m_lastCaptureUs = captureUs;
+        }
+    }
+    m_cond.notify_one();
+}
+
+void TalkUplink::run() {
+    const int priority = raiseThreadPriority();
+    const size_t packetSamples = m_pcm.size();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.priority = priority;
+    }
+
+    while (true) {
+        size_t samples = 0;
+        int64_t captureUs = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this, packetSamples]() {
+                return !m_running || m_ringSize >= packetSamples || m_inputEnded;
+            });
+            if (!m_running) {
+                break;
+            }
+            if (m_ringSize == 0) {
+                // 输入结束且没有剩余样本，由发送线程发完队列后置 m_finished
+                break;
+            }
+            // 输入结束时最后不足一包的样本也发出去
+            samples = std::min(m_ringSize, packetSamples);
+            const size_t capacity = m_ring.size();
+            for (size_t i = 0; i < samples; i++) {
+                m_pcm[i] = m_ring[(m_ringStart + i) % capacity];
+            }
+            m_ringStart = (m_ringStart + samples) % capacity;
+            m_ringSize -= samples;
+            // 环形缓冲里排在这一包之后的样本按采样间隔倒推出本包最后一个样本的采集时间
+            captureUs = m_lastCaptureUs - (int64_t)(m_ringSize * 1000000 / m_config.sampleRate);
+        }
+
+        const uint64_t write = m_sendWrite.load(std::memory_order_relaxed);
+        if (write - m_sendRead.load(std::memory_order_acquire) >= m_sendSlots.size()) {
+            // 发送线程阻塞在网络上：丢掉这一包而不是等待，序号不变，接收端从时间戳的跳变看出缺口
+            m_timestamp += (uint32_t)samples;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.queueDrops++;
+            continue;
+        }
+        SendSlot& slot = m_sendSlots[write % m_sendSlots.size()];
+        const int64_t encodeStartUs = steadyTimeUs();
+        const int length = m_encoder->encode(m_pcm.data(), (int)samples, slot.payload.data(), (int)slot.payload.size());
+        const int64_t encodeUs = steadyTimeUs() - encodeStartUs;
+        if (length <= 0) {
+            m_timestamp += (uint32_t)samples;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.sendErrors++;
+            continue;
+        }
+        slot.packet.data = slot.payload.data();
+        slot.packet.length = length;
+        slot.packet.codec = m_config.codec;
+        slot.packet.sampleRate = m_config.sampleRate;
+        slot.packet.sequence = m_sequence++;
+        slot.packet.timestamp = m_timestamp;
+        slot.packet.captureUs = captureUs;
+        slot.packet.encodeUs = encodeUs;
+        m_timestamp += (uint32_t)samples;
+        m_sendWrite.store(write + 1, std::memory_order_release);
+        // 空的临界区保证发送线程要么还没检查条件、要么已经在等待，不会漏掉通知；发送线程只在检查条件时持锁
+        { std::lock_guard<std::mutex> lock(m_sendMutex); }
+        m_sendCond.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_packetizerDone.store(true);
+    }
+    m_sendCond.notify_one();
+}
+
+void TalkUplink::sendLoop() {
+    while (true) {
+        const uint64_t read = m_sendRead.load(std::memory_order_relaxed);
+        {
+            std::unique_lock<std::mutex> lock(m_sendMutex);
+            m_sendCond.wait(lock, [this, read]() {
+                return !m_sendRunning.load() || m_packetizerDone.load() ||
+                       m_sendWrite.load(std::memory_order_acquire) != read;
+            });
+        }
+        if (!m_sendRunning.load()) {
+            break;
+        }
+        if (m_sendWrite.load(std::memory_order_acquire) == read) {
+            // 打包线程已退出且队列已空：file 输入全部发完（stop 引起的退出由 m_sendRunning 处理）
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_inputEnded) {
+                m_finished = true;
+            }
+            break;
+        }
+
+        const TalkPacket& packet = m_sendSlots[read % m_sendSlots.size()].packet;
+        const bool sent = m_transport(packet);
+        const int64_t latencyUs = steadyTimeUs() - packet.captureUs;
+        const int64_t encodeUs = packet.encodeUs;
+        m_sendRead.store(read + 1, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!sent) {
+            m_stats.sendErrors++;
+            continue;
+        }
+        m_stats.packets++;
+        m_encodeUs += (encodeUs - m_encodeUs) / m_stats.packets;
+        m_latencyUs += (latencyUs - m_latencyUs) / m_stats.packets;
+        m_stats.maxEncodeUs = std::max(m_stats.maxEncodeUs, encodeUs);
+        m_stats.maxLatencyUs = std::max(m_stats.maxLatencyUs, latencyUs);
+    }
+}
+
+bool TalkUplink::isActive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running && !m_finished;
+}
+
+bool TalkUplink::finished() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_finished;
+}
+
+TalkStats TalkUplink::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TalkStats result = m_stats;
+    result.active = m_running && !m_finished;
+    result.encodeUs = (int64_t)m_encodeUs;
+    result.latencyUs = (int64_t)m_latencyUs;
+    result.droppedMs = (int64_t)(m_droppedUs / 1000);
+    return result;
+}
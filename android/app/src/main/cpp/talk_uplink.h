@@ -0,0 +1,123 @@
+#ifndef TALK_UPLINK_H
+#define TALK_UPLINK_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_codec.h"
+#include "audio_source.h"
+
+// 交给传输层的一个编码包；data 只在回调期间有效
+struct TalkPacket {
+    const uint8_t* data = nullptr;
+    int length = 0;
+    AudioCodec codec = AUDIO_CODEC_NONE;
+    int sampleRate = 0;
+    uint32_t sequence = 0;
+    uint32_t timestamp = 0;      // 按采样数递增的媒体时间戳（RTP 约定）
+    int64_t captureUs = 0;       // 包内最后一个样本的采集时间
+    int64_t encodeUs = 0;        // 本包编码耗时
+};
+
+// 传输回调，在普通优先级的发送线程上调用，可以序列化、阻塞在网络发送上；返回 false 计为发送失败
+typedef std::function<bool(const TalkPacket& packet)> TalkTransport;
+
+struct TalkConfig {
+    AudioCodec codec = AUDIO_CODEC_PCMA;
+    int sampleRate = 8000;
+    int packetMs = 20;           // 每包时长
+    int captureMs = 10;          // 采集缓冲时长，不大于包长
+    int queueMs = 200;           // 采集与打包之间的环形缓冲，打包线程跟不上时丢弃最旧的样本
+    int sendQueuePackets = 16;   // 打包与发送之间的队列槽数，发送线程跟不上时丢弃新编码的包
+};
+
+struct TalkStats {
+    bool active = false;
+    int codec = AUDIO_CODEC_NONE;
+    int sampleRate = 0;
+    int packetMs = 0;
+    uint64_t packets = 0;
+    uint64_t sendErrors = 0;
+    uint64_t overruns = 0;       // 环形缓冲满、丢弃旧样本的次数
+    int64_t droppedMs = 0;
+    uint64_t queueDrops = 0;     // 发送队列满、丢弃编码包的次数
+    int64_t encodeUs = 0;        // 平均每包编码耗时
+    int64_t maxEncodeUs = 0;
+    int64_t latencyUs = 0;       // 包内最后一个样本从采集到交给传输层的平均时间
+    int64_t maxLatencyUs = 0;
+    int priority = 0;            // 打包线程的调度：0 普通，1 提高 nice 值，2 SCHED_FIFO
+};
+
+// 对讲上行：采集回调只把样本拷进预分配的环形缓冲，独立的高优先级打包线程凑满一包后编码进
+// 预分配的发送队列槽位、打上序号和时间戳，普通优先级的发送线程再把包交给传输层。采集和打包路径上
+// 都不分配内存，也不经过 Java 层；传输层的序列化和阻塞发送不会占用高优先级线程。
+class TalkUplink {
+public:
+    TalkUplink();
+    ~TalkUplink();
+
+    // sourceName 为空时用平台默认输入；sourcePath 只对 file 输入有效
+    bool start(const TalkConfig& config, const std::string& sourceName, const std::string& sourcePath,
+               const TalkTransport& transport, const AudioSourceConfig& sourceConfig = AudioSourceConfig());
+    void stop();
+
+    bool isActive() const;
+    // file 输入读完且剩余样本全部发出后返回 true
+    bool finished() const;
+    TalkStats stats() const;
+
+private:
+    void onCapture(const int16_t* pcm, int frames, int64_t captureUs);
+    void run();
+    void sendLoop();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    TalkConfig m_config;
+    std::unique_ptr<AudioSource> m_source;
+    std::unique_ptr<AudioEncoder> m_encoder;
+    TalkTransport m_transport;
+    std::thread m_thread;
+    bool m_running;
+    bool m_inputEnded;
+    bool m_finished;
+
+    // 环形缓冲：m_ringStart 起的 m_ringSize 个样本待发，最新样本的采集时间为 m_lastCaptureUs
+    std::vector<int16_t> m_ring;
+    size_t m_ringStart;
+    size_t m_ringSize;
+    int64_t m_lastCaptureUs;
+
+    std::vector<int16_t> m_pcm;
+    uint32_t m_sequence;
+    uint32_t m_timestamp;
+
+    // 打包线程到发送线程的单生产者单消费者队列：槽位和负载缓冲在 start 时按最大编码长度分配，
+    // 打包线程直接编码进槽位；m_sendWrite 只由打包线程递增，m_sendRead 只由发送线程递增
+    struct SendSlot {
+        TalkPacket packet;
+        std::vector<uint8_t> payload;
+    };
+    std::vector<SendSlot> m_sendSlots;
+    std::atomic<uint64_t> m_sendWrite;
+    std::atomic<uint64_t> m_sendRead;
+    std::atomic<bool> m_sendRunning;
+    std::atomic<bool> m_packetizerDone;
+    std::mutex m_sendMutex;
+    std::condition_variable m_sendCond;
+    std::thread m_sendThread;
+
+    TalkStats m_stats;
+    double m_encodeUs;
+    double m_latencyUs;
+    double m_droppedUs;
+};
+
+#endif // TALK_UPLINK_H
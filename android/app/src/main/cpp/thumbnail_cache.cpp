@@ -0,0 +1,249 @@
+#include "thumbnail_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "ThumbnailCache"
+#include "native_log.h"
+
+// 缩略图文件格式：定长头 + 设备ID + 编码后的图片，载荷连续存放，便于 mmap 后直接读取
+struct ThumbnailFileHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int64_t timestampMs;
+    uint32_t devIdLength;
+    uint32_t payloadLength;
+};
+
+static const char kThumbnailMagic[4] = {'T', 'H', 'M', 'B'};
+static const uint32_t kThumbnailVersion = 1;
+
+// FNV-1a，用于把任意设备ID映射为安全的文件名
+static uint64_t hashDevId(const std::string& devId) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : devId) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool writeFully(int fd, const void* data, size_t length) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+ThumbnailCache::ThumbnailCache()
+    : m_memoryBudget(kDefaultMemoryBudget),
+      m_memoryBytes(0),
+      m_refreshIntervalMs(kDefaultRefreshIntervalMs) {
+}
+
+bool ThumbnailCache::open(const std::string& dir) {
+    if (dir.empty()) {
+        return false;
+    }
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        LOGE("open: mkdir %s failed: %s", dir.c_str(), strerror(errno));
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dir = dir;
+    LOGI("open: dir=%s", dir.c_str());
+    return true;
+}
+
+void ThumbnailCache::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryBudget = bytes;
+    evictLocked();
+}
+
+void ThumbnailCache::setRefreshInterval(int64_t intervalMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_refreshIntervalMs = intervalMs;
+}
+
+bool ThumbnailCache::shouldRefresh(const std::string& devId, int64_t nowMs) {
+    if (devId.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lastRequestMs.find(devId);
+    if (it != m_lastRequestMs.end() && nowMs - it->second < m_refreshIntervalMs) {
+        return false;
+    }
+    m_lastRequestMs[devId] = nowMs;
+    return true;
+}
+
+std::string ThumbnailCache::pathForLocked(const std::string& devId) const {
+    if (m_dir.empty()) {
+        return std::string();
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.thumb", (unsigned long long)hashDevId(devId));
+    return m_dir + name;
+}
+
+void ThumbnailCache::evictLocked() {
+    while (m_memoryBytes > m_memoryBudget && !m_lru.empty()) {
+        auto it = m_entries.find(m_lru.back());
+        m_memoryBytes -= it->second.data.size();
+        m_entries.erase(it);
+        m_lru.pop_back();
+    }
+}
+
+void ThumbnailCache::insertLocked(const std::string& devId, std::vector<uint8_t>&& data, const ThumbnailInfo& info) {
+    auto it = m_entries.find(devId);
+    if (it != m_entries.end()) {
+        m_memoryBytes -= it->second.data.size();
+        m_lru.erase(it->second.lruIt);
+        m_entries.erase(it);
+    }
+    m_lru.push_front(devId);
+    Entry& entry = m_entries[devId];
+    entry.data = std::move(data);
+    entry.info = info;
+    entry.lruIt = m_lru.begin();
+    m_memoryBytes += entry.data.size();
+    evictLocked();
+}
+
+bool ThumbnailCache::put(const std::string& devId, const uint8_t* data, size_t length, const ThumbnailInfo& info) {
+    if (devId.empty() || !data || length == 0) {
+        return false;
+    }
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        insertLocked(devId, std::vector<uint8_t>(data, data + length), info);
+        path = pathForLocked(devId);
+    }
+    // 磁盘写入不持锁
+    if (!path.empty() && !writeToDisk(path, devId, data, length, info)) {
+        LOGW("put: write %s failed", path.c_str());
+    }
+    return true;
+}
+
+bool ThumbnailCache::get(const std::string& devId, std::vector<uint8_t>& out, ThumbnailInfo* info) {
+    out.clear();
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(devId);
+        if (it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruIt);
+            out = it->second.data;
+            if (info) *info = it->second.info;
+            return true;
+        }
+        path = pathForLocked(devId);
+    }
+    if (path.empty()) {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    ThumbnailInfo diskInfo;
+    if (!loadFromDisk(path, devId, data, diskInfo)) {
+        return false;
+    }
+    out = data;
+    if (info) *info = diskInfo;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.find(devId) == m_entries.end()) {
+        insertLocked(devId, std::move(data), diskInfo);
+    }
+    return true;
+}
+
+bool ThumbnailCache::loadFromDisk(const std::string& path, const std::string& devId, std::vector<uint8_t>& out, ThumbnailInfo& info) const {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ThumbnailFileHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t fileSize = (size_t)st.st_size;
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LOGW("loadFromDisk: mmap %s failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    bool ok = false;
+    const uint8_t* base = static_cast<const uint8_t*>(mapped);
+    ThumbnailFileHeader header;
+    memcpy(&header, base, sizeof(header));
+    size_t expected = sizeof(header) + (size_t)header.devIdLength + (size_t)header.payloadLength;
+    if (memcmp(header.magic, kThumbnailMagic, sizeof(kThumbnailMagic)) == 0 &&
+        header.version == kThumbnailVersion &&
+        header.payloadLength > 0 &&
+        expected == fileSize &&
+        header.devIdLength == devId.size() &&
+        memcmp(base + sizeof(header), devId.data(), devId.size()) == 0) {
+        const uint8_t* payload = base + sizeof(header) + header.devIdLength;
+        out.assign(payload, payload + header.payloadLength);
+        info.width = header.width;
+        info.height = header.height;
+        info.timestampMs = header.timestampMs;
+        ok = true;
+    }
+    munmap(mapped, fileSize);
+    return ok;
+}
+
+bool ThumbnailCache::writeToDisk(const std::string& path, const std::string& devId, const uint8_t* data, size_t length, const ThumbnailInfo& info) const {
+    ThumbnailFileHeader header;
+    memcpy(header.magic, kThumbnailMagic, sizeof(kThumbnailMagic));
+    header.version = kThumbnailVersion;
+    header.width = info.width;
+    header.height = info.height;
+    header.timestampMs = info.timestampMs;
+    header.devIdLength = (uint32_t)devId.size();
+    header.payloadLength = (uint32_t)length;
+
+    // 先写临时文件再 rename，崩溃时不会留下半个缩略图
+    std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeFully(fd, &header, sizeof(header)) &&
+              writeFully(fd, devId.data(), devId.size()) &&
+              writeFully(fd, data, length);
+    close(fd);
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t ThumbnailCache::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryBytes;
+}
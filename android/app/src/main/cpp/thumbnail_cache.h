@@ -0,0 +1,63 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ThumbnailInfo {
+    int width = 0;
+    int height = 0;
+    int64_t timestampMs = 0;
+};
+
+// 设备列表缩略图缓存：内存中按 LRU 保存编码后的 JPEG/WebP，
+// 同时落盘为定长头 + 载荷的文件，冷启动时通过 mmap 读回，首页无需打开视频流即可显示预览。
+class ThumbnailCache {
+public:
+    static const size_t kDefaultMemoryBudget = 4 * 1024 * 1024;
+    static const int64_t kDefaultRefreshIntervalMs = 60 * 1000;
+
+    ThumbnailCache();
+
+    // 设置落盘目录，目录不存在时创建
+    bool open(const std::string& dir);
+    void setMemoryBudget(size_t bytes);
+    void setRefreshInterval(int64_t intervalMs);
+
+    // 该设备距上次生成缩略图是否已超过刷新间隔；返回 true 时记录本次请求时间
+    bool shouldRefresh(const std::string& devId, int64_t nowMs);
+
+    bool put(const std::string& devId, const uint8_t* data, size_t length, const ThumbnailInfo& info);
+    bool get(const std::string& devId, std::vector<uint8_t>& out, ThumbnailInfo* info);
+
+    size_t memoryBytes() const;
+
+private:
+    struct Entry {
+        std::vector<uint8_t> data;
+        ThumbnailInfo info;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    std::string pathForLocked(const std::string& devId) const;
+    bool loadFromDisk(const std::string& path, const std::string& devId, std::vector<uint8_t>& out, ThumbnailInfo& info) const;
+    bool writeToDisk(const std::string& path, const std::string& devId, const uint8_t* data, size_t length, const ThumbnailInfo& info) const;
+    void insertLocked(const std::string& devId, std::vector<uint8_t>&& data, const ThumbnailInfo& info);
+    void evictLocked();
+
+    mutable std::mutex m_mutex;
+    std::string m_dir;
+    size_t m_memoryBudget;
+    size_t m_memoryBytes;
+    int64_t m_refreshIntervalMs;
+    std::list<std::string> m_lru;  // 队首为最近使用
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<std::string, int64_t> m_lastRequestMs;
+};
+
+#endif // THUMBNAIL_CACHE_H
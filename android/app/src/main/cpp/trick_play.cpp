@@ -0,0 +1,343 @@
+#include "trick_play.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "TrickPlayer"
+#include "native_log.h"
+
+const int TrickPlayer::kMaxSpeed;
+const int TrickPlayer::kDefaultMaxFps;
+
+namespace {
+
+// 初始化段（ftyp + moov）的大小上限，只有一条视频轨时远小于这个值
+const size_t kMaxInitBytes = 1024 * 1024;
+
+const uint8_t kStartCode[4] = {0, 0, 0, 1};
+
+int64_t steadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t readBe32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// 沿 moov/trak/mdia/minf/stbl/stsd/avc1 找到 avcC 的载荷
+bool findAvcC(const uint8_t* data, size_t length, const uint8_t** payload, size_t* payloadLength) {
+    size_t offset = 0;
+    while (offset + 8 <= length) {
+        const size_t size = readBe32(data + offset);
+        if (size < 8 || size > length - offset) {
+            return false;
+        }
+        const uint8_t* type = data + offset + 4;
+        const uint8_t* body = data + offset + 8;
+        const size_t bodyLength = size - 8;
+        if (memcmp(type, "avcC", 4) == 0) {
+            *payload = body;
+            *payloadLength = bodyLength;
+            return true;
+        }
+        size_t skip = SIZE_MAX;
+        if (memcmp(type, "moov", 4) == 0 || memcmp(type, "trak", 4) == 0 || memcmp(type, "mdia", 4) == 0 ||
+            memcmp(type, "minf", 4) == 0 || memcmp(type, "stbl", 4) == 0) {
+            skip = 0;
+        } else if (memcmp(type, "stsd", 4) == 0) {
+            skip = 8;    // version/flags + entry_count
+        } else if (memcmp(type, "avc1", 4) == 0) {
+            skip = 78;   // VisualSampleEntry 的固定字段
+        }
+        if (skip != SIZE_MAX && bodyLength >= skip && findAvcC(body + skip, bodyLength - skip, payload, payloadLength)) {
+            return true;
+        }
+        offset += size;
+    }
+    return false;
+}
+
+// avcC 中的 SPS/PPS 转成带起始码的 Annex-B
+bool avcCToAnnexB(const uint8_t* data, size_t length, std::vector<uint8_t>& out) {
+    out.clear();
+    if (length < 6 || data[0] != 1) {
+        return false;
+    }
+    size_t offset = 5;
+    for (int pass = 0; pass < 2; pass++) {
+        if (offset >= length) {
+            return false;
+        }
+        const int count = pass == 0 ? (data[offset] & 0x1F) : data[offset];
+        offset++;
+        for (int i = 0; i < count; i++) {
+            if (offset + 2 > length) {
+                return false;
+            }
+            const size_t size = (data[offset] << 8) | data[offset + 1];
+            offset += 2;
+            if (offset + size > length) {
+                return false;
+            }
+            out.insert(out.end(), kStartCode, kStartCode + 4);
+            out.insert(out.end(), data + offset, data + offset + size);
+            offset += size;
+        }
+    }
+    return !out.empty();
+}
+
+bool preadFully(int fd, uint8_t* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        const ssize_t n = pread(fd, data, length, (off_t)offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return true;
+}
+
+} // namespace
+
+TrickPlayer::TrickPlayer()
+    : m_running(false),
+      m_speed(0),
+      m_intervalUs(0),
+      m_anchorUs(0),
+      m_anchorClockUs(0),
+      m_fd(-1),
+      m_segmentId(UINT32_MAX),
+      m_readUs(0) {
+}
+
+TrickPlayer::~TrickPlayer() {
+    stop();
+}
+
+bool TrickPlayer::start(const std::shared_ptr<KeyframeIndex>& index, int64_t startUs, int speed, int maxFps,
+                        const FrameCallback& callback) {
+    stop();
+    if (!index || index->size() == 0 || !callback || abs(speed) < 2 || abs(speed) > kMaxSpeed) {
+        return false;
+    }
+    if (maxFps <= 0) {
+        maxFps = kDefaultMaxFps;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_index = index;
+        m_callback = callback;
+        m_speed = speed;
+        m_intervalUs = 1000000 / std::max(1, std::min(maxFps, 30));
+        m_anchorUs = startUs;
+        m_anchorClockUs = steadyTimeUs();
+        m_stats = TrickPlayStats();
+        m_stats.active = true;
+        m_stats.speed = speed;
+        m_stats.positionUs = startUs;
+        m_readUs = 0;
+        m_running = true;
+    }
+    m_thread = std::thread([this]() { run(); });
+    LOGI("start: %dx, 每秒最多 %lld 帧", speed, (long long)(1000000 / m_intervalUs));
+    return true;
+}
+
+bool TrickPlayer::setSpeed(int speed) {
+    if (abs(speed) < 2 || abs(speed) > kMaxSpeed) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return false;
+        }
+        const int64_t nowUs = steadyTimeUs();
+        m_anchorUs = positionLocked(nowUs);
+        m_anchorClockUs = nowUs;
+        m_speed = speed;
+        m_stats.speed = speed;
+        m_stats.ended = false;
+    }
+    m_cond.notify_all();
+    LOGI("setSpeed: %dx", speed);
+    return true;
+}
+
+void TrickPlayer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        m_stats.active = false;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+        LOGI("stop: delivered=%llu skipped=%llu", (unsigned long long)m_stats.deliveredFrames,
+             (unsigned long long)m_stats.skippedKeyframes);
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_segmentId = UINT32_MAX;
+    m_index.reset();
+    m_callback = nullptr;
+}
+
+bool TrickPlayer::isActive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+int64_t TrickPlayer::positionLocked(int64_t nowUs) const {
+    return m_anchorUs + (nowUs - m_anchorClockUs) * m_speed;
+}
+
+void TrickPlayer::run() {
+    long lastIndex = -1;
+    auto next = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        const int64_t nowUs = steadyTimeUs();
+        const int64_t positionUs = positionLocked(nowUs);
+        const bool forward = m_speed > 0;
+        lock.unlock();
+
+        KeyframeEntry entry;
+        const long index = m_index->seek(positionUs, &entry);
+        const size_t count = m_index->size();
+        bool delivered = false;
+        bool readOk = true;
+        double readUs = 0;
+        if (index >= 0 && index != lastIndex) {
+            const int64_t readStartUs = steadyTimeUs();
+            readOk = readKeyframe(entry);
+            readUs = (double)(steadyTimeUs() - readStartUs);
+            if (readOk) {
+                m_callback(m_frame.data(), (int)m_frame.size(), steadyTimeUs());
+                delivered = true;
+            }
+        }
+
+        lock.lock();
+        if (delivered) {
+            if (lastIndex >= 0) {
+                m_stats.skippedKeyframes += (uint64_t)(labs(index - lastIndex) - 1);
+            }
+            m_stats.deliveredFrames++;
+            m_stats.lastFrameTimeUs = entry.timeUs;
+            m_readUs += (readUs - m_readUs) / m_stats.deliveredFrames;
+            lastIndex = index;
+        } else if (!readOk) {
+            m_stats.readErrors++;
+            lastIndex = index;
+        }
+        m_stats.positionUs = positionUs;
+
+        // 正放越过最后一个关键帧、倒放越过第一个关键帧即到头，停在那里等改变方向或停止
+        const bool atEnd = index < 0 || (forward ? (size_t)index + 1 >= count && positionUs > entry.timeUs
+                                                 : index == 0 && positionUs < entry.timeUs);
+        if (atEnd) {
+            if (!m_stats.ended) {
+                LOGI("回放到达%s", forward ? "结尾" : "开头");
+            }
+            m_stats.ended = true;
+            m_anchorUs = index < 0 ? positionUs : entry.timeUs;
+            m_anchorClockUs = nowUs;
+            const int speed = m_speed;
+            m_cond.wait(lock, [this, speed]() { return !m_running || m_speed != speed || !m_stats.ended; });
+            next = std::chrono::steady_clock::now();
+            continue;
+        }
+        next += std::chrono::microseconds(m_intervalUs);
+        m_cond.wait_until(lock, next, [this]() { return !m_running; });
+    }
+}
+
+bool TrickPlayer::loadSegment(uint32_t segmentId) {
+    if (segmentId == m_segmentId && m_fd >= 0) {
+        return true;
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_segmentId = UINT32_MAX;
+    const std::string path = m_index->segmentPath(segmentId);
+    m_fd = path.empty() ? -1 : open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        LOGE("无法打开录像文件 %u: %s", segmentId, path.c_str());
+        return false;
+    }
+
+    // 初始化段是开头的 ftyp 和 moov 两个盒子
+    uint8_t header[8];
+    uint64_t offset = 0;
+    for (int i = 0; i < 2; i++) {
+        if (!preadFully(m_fd, header, sizeof(header), offset)) {
+            break;
+        }
+        offset += readBe32(header);
+    }
+    bool ok = offset >= 16 && offset <= kMaxInitBytes;
+    if (ok) {
+        m_sample.resize((size_t)offset);
+        ok = preadFully(m_fd, m_sample.data(), m_sample.size(), 0);
+    }
+    const uint8_t* avcC = nullptr;
+    size_t avcCLength = 0;
+    if (!ok || !findAvcC(m_sample.data(), m_sample.size(), &avcC, &avcCLength) ||
+        !avcCToAnnexB(avcC, avcCLength, m_parameterSets)) {
+        LOGE("录像文件没有可用的 avcC: %s", path.c_str());
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_segmentId = segmentId;
+    return true;
+}
+
+// 读出 IDR 样本，4 字节长度前缀换成起始码，前面补上参数集
+bool TrickPlayer::readKeyframe(const KeyframeEntry& entry) {
+    if (!loadSegment(entry.segmentId) || entry.sampleSize < 5) {
+        return false;
+    }
+    m_sample.resize(entry.sampleSize);
+    if (!preadFully(m_fd, m_sample.data(), m_sample.size(), entry.sampleOffset)) {
+        LOGE("读取关键帧失败: offset=%llu size=%u", (unsigned long long)entry.sampleOffset, entry.sampleSize);
+        return false;
+    }
+    m_frame.assign(m_parameterSets.begin(), m_parameterSets.end());
+    size_t offset = 0;
+    while (offset + 4 <= m_sample.size()) {
+        const size_t size = readBe32(m_sample.data() + offset);
+        offset += 4;
+        if (size == 0 || size > m_sample.size() - offset) {
+            return false;
+        }
+        m_frame.insert(m_frame.end(), kStartCode, kStartCode + 4);
+        m_frame.insert(m_frame.end(), m_sample.data() + offset, m_sample.data() + offset + size);
+        offset += size;
+    }
+    return offset == m_sample.size();
+}
+
+TrickPlayStats TrickPlayer::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TrickPlayStats result = m_stats;
+    result.readUs = (int64_t)m_readUs;
+    return result;
+}
@@ -0,0 +1,80 @@
+#ifndef TRICK_PLAY_H
+#define TRICK_PLAY_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "keyframe_index.h"
+
+struct TrickPlayStats {
+    bool active = false;
+    bool ended = false;            // 到达索引的开头或结尾
+    int speed = 0;
+    uint64_t deliveredFrames = 0;
+    uint64_t skippedKeyframes = 0; // 倍速超过送帧上限时跳过的关键帧
+    uint64_t readErrors = 0;
+    int64_t positionUs = 0;        // 当前回放位置（墙上时间）
+    int64_t lastFrameTimeUs = 0;   // 最近送出的关键帧的墙上时间
+    int64_t readUs = 0;            // 平均每帧读取和转换耗时
+};
+
+// 关键帧快放/快退：不解码中间帧，只按关键帧索引取出 IDR 送给解码器。
+// 回放位置按 speed 倍速随时间推进（负值为倒放），送帧线程以固定节拍取位置上不晚于它的关键帧，
+// 和上一帧相同则不送；节拍即每秒送帧上限，倍速再高解码负载也不超过它。
+// 送出的帧以送出时刻（CLOCK_MONOTONIC）为 PTS，由显示调度按普通直播帧平滑并对齐 vsync。
+class TrickPlayer {
+public:
+    static const int kMaxSpeed = 64;
+    static const int kDefaultMaxFps = 8;
+
+    // 送帧回调：Annex-B 访问单元（SPS、PPS、IDR），在送帧线程上调用
+    typedef std::function<void(const uint8_t* data, int length, int64_t ptsUs)> FrameCallback;
+
+    TrickPlayer();
+    ~TrickPlayer();
+
+    // 从墙上时间 startUs 开始以 speed 倍速回放；|speed| 须在 2 到 kMaxSpeed 之间
+    bool start(const std::shared_ptr<KeyframeIndex>& index, int64_t startUs, int speed, int maxFps,
+               const FrameCallback& callback);
+    // 从当前位置改变倍速或方向
+    bool setSpeed(int speed);
+    void stop();
+
+    bool isActive() const;
+    TrickPlayStats stats() const;
+
+private:
+    void run();
+    int64_t positionLocked(int64_t nowUs) const;
+    bool readKeyframe(const KeyframeEntry& entry);
+    bool loadSegment(uint32_t segmentId);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::shared_ptr<KeyframeIndex> m_index;
+    FrameCallback m_callback;
+    std::thread m_thread;
+    bool m_running;
+    int m_speed;
+    int64_t m_intervalUs;
+    int64_t m_anchorUs;            // 改变倍速时的回放位置
+    int64_t m_anchorClockUs;       // 以及当时的单调时钟
+
+    // 送帧线程状态
+    int m_fd;
+    uint32_t m_segmentId;
+    std::vector<uint8_t> m_parameterSets;   // 当前录像文件的 SPS/PPS，Annex-B
+    std::vector<uint8_t> m_sample;
+    std::vector<uint8_t> m_frame;
+
+    TrickPlayStats m_stats;
+    double m_readUs;
+};
+
+#endif // TRICK_PLAY_H
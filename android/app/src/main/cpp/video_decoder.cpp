@@ -0,0 +1,43 @@
+#include "video_decoder.h"
+
+#define LOG_TAG "VideoDecoder"
+#include "native_log.h"
+
+#ifdef HAVE_LIBAVCODEC
+std::unique_ptr<VideoDecoder> createLibavcodecDecoder();
+#endif
+
+namespace {
+
+struct DecoderBackend {
+    const char* name;
+    std::unique_ptr<VideoDecoder> (*create)();
+};
+
+// 按优先级排列，构建时找到对应依赖才会编译进来
+const DecoderBackend kBackends[] = {
+#ifdef HAVE_LIBAVCODEC
+    {"libavcodec", createLibavcodecDecoder},
+#endif
+    {nullptr, nullptr},
+};
+
+} // namespace
+
+std::unique_ptr<VideoDecoder> createVideoDecoder(const std::string& backend) {
+    for (const DecoderBackend* it = kBackends; it->name != nullptr; it++) {
+        if (backend.empty() || backend == it->name) {
+            return it->create();
+        }
+    }
+    LOGE("没有可用的解码后端: %s", backend.empty() ? "(默认)" : backend.c_str());
+    return nullptr;
+}
+
+std::vector<std::string> videoDecoderBackends() {
+    std::vector<std::string> names;
+    for (const DecoderBackend* it = kBackends; it->name != nullptr; it++) {
+        names.push_back(it->name);
+    }
+    return names;
+}
@@ -0,0 +1,54 @@
+#ifndef VIDEO_DECODER_H
+#define VIDEO_DECODER_H
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "yuv_convert.h"
+
+// 解码输出的一帧，平面数据只在回调期间有效，需要保留时自行拷贝
+struct DecodedFrame {
+    Yuv420Planes planes;
+    int64_t ptsUs;
+};
+
+typedef std::function<void(const DecodedFrame&)> DecodedFrameCallback;
+
+struct VideoDecoderConfig {
+    int threads = 0;        // 解码线程数，0 表示按 CPU 核数
+    bool lowDelay = true;   // 实时预览只用 slice 线程，不引入帧线程的多帧延迟；基准测试用帧线程追求吞吐
+};
+
+struct VideoDecoderStats {
+    uint64_t packets = 0;
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+    int threads = 0;        // 实际使用的解码线程数
+};
+
+// 可插拔的 H.264 解码后端。Android 上仍由 MediaCodec（Kotlin）解码，这里的后端用于桌面端和无界面基准测试。
+// 同一个实例只能在一个线程上使用。
+class VideoDecoder {
+public:
+    virtual ~VideoDecoder() {}
+
+    virtual const char* name() const = 0;
+    virtual bool open(const VideoDecoderConfig& config, const DecodedFrameCallback& callback) = 0;
+    // 送入一个 Annex-B 访问单元，解出的帧在调用线程上通过回调输出
+    virtual bool decode(const uint8_t* data, int length, int64_t ptsUs) = 0;
+    // 输出解码器内部缓存的所有帧，之后可以继续送入新的码流
+    virtual void flush() = 0;
+    virtual void close() = 0;
+    virtual VideoDecoderStats stats() const = 0;
+};
+
+// 按名称创建解码后端，名称为空时返回第一个可用后端；没有可用后端时返回空指针
+std::unique_ptr<VideoDecoder> createVideoDecoder(const std::string& backend);
+
+// 当前构建中编译进来的后端名称
+std::vector<std::string> videoDecoderBackends();
+
+#endif // VIDEO_DECODER_H
@@ -0,0 +1,226 @@
+#include "yuv_benchmark.h"
+
+#include <stdio.h>
+#include <chrono>
+
+#include "yuv_convert.h"
+
+#define LOG_TAG "YuvBenchmark"
+#include "native_log.h"
+
+namespace {
+
+struct Resolution {
+    int width;
+    int height;
+};
+
+// 常见摄像头分辨率，外加一个奇数尺寸检查行尾和色度向上取整
+const Resolution kResolutions[] = {
+    {640, 360}, {1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160}, {1279, 717},
+};
+
+const char* const kSimdKernels[] = {"neon", "avx2", "sse2"};
+
+enum Layout {
+    LAYOUT_I420 = 0,
+    LAYOUT_NV12 = 1,
+    LAYOUT_NV21 = 2,
+};
+
+const char* layoutName(Layout layout) {
+    return layout == LAYOUT_I420 ? "i420" : layout == LAYOUT_NV12 ? "nv12" : "nv21";
+}
+
+int alignUp(int value, int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 一帧源数据，行跨度按 64 字节对齐后再留一段填充，和硬件解码器的输出相似
+struct SourceFrame {
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+    std::vector<uint8_t> uv;
+    Yuv420Planes planes;
+};
+
+void fillRandom(std::vector<uint8_t>& buffer, uint32_t& seed) {
+    for (uint8_t& b : buffer) {
+        seed = seed * 1664525u + 1013904223u;
+        b = (uint8_t)(seed >> 24);
+    }
+}
+
+void makeSource(int width, int height, Layout layout, SourceFrame& frame) {
+    uint32_t seed = (uint32_t)(width * 31 + height * 7 + layout);
+    const int chromaW = (width + 1) / 2;
+    const int chromaH = (height + 1) / 2;
+    frame.planes.width = width;
+    frame.planes.height = height;
+    frame.planes.yRowStride = alignUp(width, 64) + 32;
+    frame.y.resize((size_t)frame.planes.yRowStride * height);
+    fillRandom(frame.y, seed);
+    frame.planes.y = frame.y.data();
+    if (layout == LAYOUT_I420) {
+        frame.planes.uvRowStride = alignUp(chromaW, 64) + 32;
+        frame.planes.uvPixelStride = 1;
+        frame.u.resize((size_t)frame.planes.uvRowStride * chromaH);
+        frame.v.resize(frame.u.size());
+        fillRandom(frame.u, seed);
+        fillRandom(frame.v, seed);
+        frame.planes.u = frame.u.data();
+        frame.planes.v = frame.v.data();
+    } else {
+        frame.planes.uvRowStride = alignUp(chromaW * 2, 64) + 32;
+        frame.planes.uvPixelStride = 2;
+        frame.uv.resize((size_t)frame.planes.uvRowStride * chromaH);
+        fillRandom(frame.uv, seed);
+        frame.planes.u = frame.uv.data() + (layout == LAYOUT_NV12 ? 0 : 1);
+        frame.planes.v = frame.uv.data() + (layout == LAYOUT_NV12 ? 1 : 0);
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 用 kernel 转换 loops 次，返回每帧毫秒数，out 为最后一次的输出
+double timeConvert(const char* kernel, const Yuv420Planes& src, int dstWidth, int dstHeight, YuvDstFormat format,
+                   int loops, std::vector<uint8_t>& out) {
+    yuvConvertSelectKernel(kernel);
+    out.assign((size_t)dstWidth * dstHeight * 4, 0);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; i++) {
+        yuv420ToRgbaScale(src, out.data(), dstWidth * 4, dstWidth, dstHeight, format);
+    }
+    return secondsSince(start) * 1000 / loops;
+}
+
+// 逐像素按行跨度/像素跨度读取的紧凑打包，作为 yuv420ToPacked 的参考实现和计时基线
+void packReference(const Yuv420Planes& src, YuvPackedFormat format, uint8_t* dst) {
+    const int chromaW = (src.width + 1) / 2;
+    const int chromaH = (src.height + 1) / 2;
+    for (int row = 0; row < src.height; row++) {
+        for (int x = 0; x < src.width; x++) {
+            *dst++ = src.y[(long)row * src.yRowStride + x];
+        }
+    }
+    uint8_t* u = dst;
+    uint8_t* v = dst + (size_t)chromaW * chromaH;
+    for (int row = 0; row < chromaH; row++) {
+        for (int x = 0; x < chromaW; x++) {
+            const long offset = (long)row * src.uvRowStride + (long)x * src.uvPixelStride;
+            if (format == YUV_PACKED_NV21) {
+                *dst++ = src.v[offset];
+                *dst++ = src.u[offset];
+            } else {
+                *u++ = src.u[offset];
+                *v++ = src.v[offset];
+            }
+        }
+    }
+}
+
+double timePack(bool reference, const Yuv420Planes& src, YuvPackedFormat format, int loops,
+                std::vector<uint8_t>& out) {
+    out.assign(yuv420PackedSize(src.width, src.height), 0);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; i++) {
+        if (reference) {
+            packReference(src, format, out.data());
+        } else {
+            yuv420ToPacked(src, out.data(), out.size(), format);
+        }
+    }
+    return secondsSince(start) * 1000 / loops;
+}
+
+uint64_t countMismatches(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    uint64_t mismatches = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        mismatches += a[i] != b[i];
+    }
+    return mismatches;
+}
+
+} // namespace
+
+YuvBenchmarkResult runYuvBenchmark(const YuvBenchmarkOptions& options) {
+    YuvBenchmarkResult result;
+    const int loops = options.loops > 0 ? options.loops : 1;
+    std::vector<std::string> kernels;
+    if (!options.kernel.empty()) {
+        if (!yuvConvertSelectKernel(options.kernel.c_str())) {
+            LOGE("当前 CPU 不支持行内核: %s", options.kernel.c_str());
+            return result;
+        }
+        kernels.push_back(options.kernel);
+    } else {
+        for (const char* name : kSimdKernels) {
+            if (yuvConvertSelectKernel(name)) {
+                kernels.push_back(name);
+            }
+        }
+    }
+    if (kernels.empty()) {
+        LOGW("没有可用的 SIMD 行内核，只有标量实现");
+    }
+
+    SourceFrame source;
+    std::vector<uint8_t> simdOut;
+    std::vector<uint8_t> scalarOut;
+    for (const Resolution& res : kResolutions) {
+        for (int l = LAYOUT_I420; l <= LAYOUT_NV21; l++) {
+            const Layout layout = (Layout)l;
+            makeSource(res.width, res.height, layout, source);
+            // 原尺寸 RGBA（GL 纹理上传）；NV12 另测缩小一半的 BGRA（缩略图和多画面格子）
+            for (int scaled = 0; scaled <= (layout == LAYOUT_NV12 ? 1 : 0); scaled++) {
+                const int dstWidth = scaled ? (res.width + 1) / 2 : res.width;
+                const int dstHeight = scaled ? (res.height + 1) / 2 : res.height;
+                const YuvDstFormat format = scaled ? YUV_DST_BGRA : YUV_DST_RGBA;
+                char name[96];
+                snprintf(name, sizeof(name), "%s %dx%d %s -> %dx%d", scaled ? "bgra" : "rgba", res.width,
+                         res.height, layoutName(layout), dstWidth, dstHeight);
+                const double scalarMs =
+                    timeConvert("scalar", source.planes, dstWidth, dstHeight, format, loops, scalarOut);
+                for (const std::string& kernel : kernels) {
+                    YuvBenchmarkCase c;
+                    c.name = name;
+                    c.kernel = kernel;
+                    c.scalarMs = scalarMs;
+                    c.kernelMs =
+                        timeConvert(kernel.c_str(), source.planes, dstWidth, dstHeight, format, loops, simdOut);
+                    c.mismatchedBytes = countMismatches(simdOut, scalarOut);
+                    if (c.mismatchedBytes > 0) {
+                        result.mismatchedCases++;
+                        LOGE("%s [%s]: %llu 字节与标量实现不一致", name, kernel.c_str(),
+                             (unsigned long long)c.mismatchedBytes);
+                    }
+                    result.cases.push_back(c);
+                }
+            }
+            // 紧凑打包（YuvUtils.imageToNv21/imageToI420）：向量化的交错/拆分/字节对交换在编译期选定
+            for (int f = YUV_PACKED_NV21; f <= YUV_PACKED_I420; f++) {
+                const YuvPackedFormat format = (YuvPackedFormat)f;
+                YuvBenchmarkCase c;
+                char name[96];
+                snprintf(name, sizeof(name), "pack %s %dx%d %s", format == YUV_PACKED_NV21 ? "nv21" : "i420",
+                         res.width, res.height, layoutName(layout));
+                c.name = name;
+                c.kernel = "packed";
+                c.scalarMs = timePack(true, source.planes, format, loops, scalarOut);
+                c.kernelMs = timePack(false, source.planes, format, loops, simdOut);
+                c.mismatchedBytes = countMismatches(simdOut, scalarOut);
+                if (c.mismatchedBytes > 0) {
+                    result.mismatchedCases++;
+                    LOGE("%s: %llu 字节与参考实现不一致", name, (unsigned long long)c.mismatchedBytes);
+                }
+                result.cases.push_back(c);
+            }
+        }
+    }
+    yuvConvertSelectKernel(nullptr);
+    result.ok = true;
+    return result;
+}
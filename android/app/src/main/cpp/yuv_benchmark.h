@@ -0,0 +1,33 @@
+#ifndef YUV_BENCHMARK_H
+#define YUV_BENCHMARK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct YuvBenchmarkOptions {
+    int loops = 20;         // 每个用例计时的帧数
+    std::string kernel;     // 只测这个行内核，为空时测当前 CPU 支持的所有 SIMD 内核
+};
+
+// 一个分辨率、一种输入布局、一种输出上的结果
+struct YuvBenchmarkCase {
+    std::string name;               // 如 "rgba 1920x1080 nv12 -> 960x540"
+    std::string kernel;
+    double kernelMs = 0;            // 每帧耗时
+    double scalarMs = 0;            // 标量（打包为逐像素）参考实现每帧耗时
+    uint64_t mismatchedBytes = 0;   // 与标量参考不一致的字节数，必须为 0
+};
+
+struct YuvBenchmarkResult {
+    bool ok = false;
+    std::vector<YuvBenchmarkCase> cases;
+    uint64_t mismatchedCases = 0;
+};
+
+// 无界面 YUV 转换基准：在常见摄像头分辨率（含奇数尺寸和带填充的行跨度）上，
+// 把 SIMD 行内核的输出与标量实现、紧凑打包的输出与逐像素参考实现逐字节比较并分别计时。
+// 输入为固定种子的伪随机数据。
+YuvBenchmarkResult runYuvBenchmark(const YuvBenchmarkOptions& options);
+
+#endif // YUV_BENCHMARK_H
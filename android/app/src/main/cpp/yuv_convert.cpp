@@ -0,0 +1,610 @@
+#include "yuv_convert.h"
+
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define YUV_HAVE_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YUV_HAVE_X86 1
+#endif
+
+static inline uint8_t clampToByte(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// BT.601 有限范围，系数放大 2^10；SIMD 内核使用相同的整数运算，保证逐位一致
+static const int kYuvYG = 1192;
+static const int kYuvVR = 1634;
+static const int kYuvUG = -401;
+static const int kYuvVG = -832;
+static const int kYuvUB = 2066;
+
+static inline void yuvToRgb(int y, int u, int v, uint8_t& r, uint8_t& g, uint8_t& b) {
+    int c = (y - 16) * kYuvYG + 512;
+    int d = u - 128;
+    int e = v - 128;
+    r = clampToByte((c + kYuvVR * e) >> 10);
+    g = clampToByte((c + kYuvUG * d + kYuvVG * e) >> 10);
+    b = clampToByte((c + kYuvUB * d) >> 10);
+}
+
+static inline uint32_t yuvToArgb(int y, int u, int v) {
+    uint8_t r, g, b;
+    yuvToRgb(y, u, v, r, g, b);
+    return 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+void yuv420ToArgbBoxScale(const Yuv420Planes& src, uint32_t* dst, int dstWidth, int dstHeight) {
+    if (!src.y || !src.u || !src.v || !dst || src.width <= 0 || src.height <= 0 || dstWidth <= 0 || dstHeight <= 0) {
+        return;
+    }
+    for (int dy = 0; dy < dstHeight; dy++) {
+        int sy0 = dy * src.height / dstHeight;
+        int sy1 = (dy + 1) * src.height / dstHeight;
+        if (sy1 <= sy0) sy1 = sy0 + 1;
+        for (int dx = 0; dx < dstWidth; dx++) {
+            int sx0 = dx * src.width / dstWidth;
+            int sx1 = (dx + 1) * src.width / dstWidth;
+            if (sx1 <= sx0) sx1 = sx0 + 1;
+
+            // 亮度取区域平均，色度取区域中心采样
+            int sum = 0;
+            for (int sy = sy0; sy < sy1; sy++) {
+                const uint8_t* row = src.y + (long)sy * src.yRowStride;
+                for (int sx = sx0; sx < sx1; sx++) {
+                    sum += row[sx];
+                }
+            }
+            int luma = sum / ((sy1 - sy0) * (sx1 - sx0));
+            int cx = ((sx0 + sx1) >> 1) >> 1;
+            int cy = ((sy0 + sy1) >> 1) >> 1;
+            long uvOffset = (long)cy * src.uvRowStride + (long)cx * src.uvPixelStride;
+            dst[(long)dy * dstWidth + dx] = yuvToArgb(luma, src.u[uvOffset], src.v[uvOffset]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 行内核：一行 width 个像素，u/v 为平面色度（每两个像素一个样本）
+
+typedef void (*YuvRowFunc)(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, bool bgra);
+
+static void yuvRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, bool bgra) {
+    const int ri = bgra ? 2 : 0;
+    const int bi = bgra ? 0 : 2;
+    for (int x = 0; x < width; x++) {
+        uint8_t r, g, b;
+        yuvToRgb(y[x], u[x >> 1], v[x >> 1], r, g, b);
+        dst[ri] = r;
+        dst[1] = g;
+        dst[bi] = b;
+        dst[3] = 0xFF;
+        dst += 4;
+    }
+}
+
+#if defined(YUV_HAVE_NEON)
+
+// 4 个像素的 32 位定点运算，饱和收窄等价于标量的 clamp
+static inline uint16x4_t neonChannel(int32x4_t c, int16x4_t d, int16_t kd, int16x4_t e, int16_t ke) {
+    int32x4_t acc = vmlal_n_s16(c, d, kd);
+    acc = vmlal_n_s16(acc, e, ke);
+    return vqshrun_n_s32(acc, 10);
+}
+
+static void yuvRowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, bool bgra) {
+    const int16x8_t y16 = vdupq_n_s16(16);
+    const int16x8_t uv128 = vdupq_n_s16(128);
+    const int32x4_t round = vdupq_n_s32(512);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t yy = vld1q_u8(y + x);
+        uint8x8x2_t uu = vzip_u8(vld1_u8(u + (x >> 1)), vld1_u8(u + (x >> 1)));
+        uint8x8x2_t vv = vzip_u8(vld1_u8(v + (x >> 1)), vld1_u8(v + (x >> 1)));
+
+        int16x8_t yl = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(yy))), y16);
+        int16x8_t yh = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(yy))), y16);
+        int16x8_t ul = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uu.val[0])), uv128);
+        int16x8_t uh = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uu.val[1])), uv128);
+        int16x8_t vl = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vv.val[0])), uv128);
+        int16x8_t vh = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vv.val[1])), uv128);
+
+        const int16x8_t ys[2] = {yl, yh};
+        const int16x8_t us[2] = {ul, uh};
+        const int16x8_t vs[2] = {vl, vh};
+        uint8x8_t r8[2], g8[2], b8[2];
+        for (int h = 0; h < 2; h++) {
+            int32x4_t c0 = vmlal_n_s16(round, vget_low_s16(ys[h]), kYuvYG);
+            int32x4_t c1 = vmlal_n_s16(round, vget_high_s16(ys[h]), kYuvYG);
+            int16x4_t d0 = vget_low_s16(us[h]), d1 = vget_high_s16(us[h]);
+            int16x4_t e0 = vget_low_s16(vs[h]), e1 = vget_high_s16(vs[h]);
+            r8[h] = vqmovn_u16(vcombine_u16(neonChannel(c0, d0, 0, e0, kYuvVR), neonChannel(c1, d1, 0, e1, kYuvVR)));
+            g8[h] = vqmovn_u16(vcombine_u16(neonChannel(c0, d0, kYuvUG, e0, kYuvVG), neonChannel(c1, d1, kYuvUG, e1, kYuvVG)));
+            b8[h] = vqmovn_u16(vcombine_u16(neonChannel(c0, d0, kYuvUB, e0, 0), neonChannel(c1, d1, kYuvUB, e1, 0)));
+        }
+        uint8x16x4_t px;
+        uint8x16_t r = vcombine_u8(r8[0], r8[1]);
+        uint8x16_t b = vcombine_u8(b8[0], b8[1]);
+        px.val[0] = bgra ? b : r;
+        px.val[1] = vcombine_u8(g8[0], g8[1]);
+        px.val[2] = bgra ? r : b;
+        px.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + x * 4, px);
+    }
+    if (x < width) {
+        yuvRowScalar(y + x, u + (x >> 1), v + (x >> 1), dst + x * 4, width - x, bgra);
+    }
+}
+
+#endif // YUV_HAVE_NEON
+
+#if defined(YUV_HAVE_X86)
+
+// 8 个像素的 32 位定点运算：madd 算 (Y', 1)·(YG, 512) 和 (U', V')·(kU, kV)，
+// packs/packus 饱和打包等价于标量的 clamp
+static inline void sse2Channels(__m128i y16, __m128i u16, __m128i v16, __m128i& r, __m128i& g, __m128i& b) {
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i kY = _mm_set_epi16(512, kYuvYG, 512, kYuvYG, 512, kYuvYG, 512, kYuvYG);
+    const __m128i kR = _mm_set_epi16(kYuvVR, 0, kYuvVR, 0, kYuvVR, 0, kYuvVR, 0);
+    const __m128i kG = _mm_set_epi16(kYuvVG, kYuvUG, kYuvVG, kYuvUG, kYuvVG, kYuvUG, kYuvVG, kYuvUG);
+    const __m128i kB = _mm_set_epi16(0, kYuvUB, 0, kYuvUB, 0, kYuvUB, 0, kYuvUB);
+
+    __m128i yLo = _mm_madd_epi16(_mm_unpacklo_epi16(y16, one), kY);
+    __m128i yHi = _mm_madd_epi16(_mm_unpackhi_epi16(y16, one), kY);
+    __m128i uvLo = _mm_unpacklo_epi16(u16, v16);
+    __m128i uvHi = _mm_unpackhi_epi16(u16, v16);
+    r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(uvLo, kR)), 10),
+                        _mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(uvHi, kR)), 10));
+    g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(uvLo, kG)), 10),
+                        _mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(uvHi, kG)), 10));
+    b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(uvLo, kB)), 10),
+                        _mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(uvHi, kB)), 10));
+}
+
+static void yuvRowSse2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, bool bgra) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i y16 = _mm_set1_epi16(16);
+    const __m128i uv128 = _mm_set1_epi16(128);
+    const __m128i alpha = _mm_set1_epi8((char)0xFF);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int32_t u4, v4;
+        memcpy(&u4, u + (x >> 1), 4);
+        memcpy(&v4, v + (x >> 1), 4);
+        __m128i yy = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(y + x)), zero), y16);
+        __m128i uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero), uv128);
+        __m128i vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero), uv128);
+        uu = _mm_unpacklo_epi16(uu, uu);
+        vv = _mm_unpacklo_epi16(vv, vv);
+
+        __m128i r, g, b;
+        sse2Channels(yy, uu, vv, r, g, b);
+        __m128i c0 = _mm_packus_epi16(bgra ? b : r, zero);
+        __m128i c1 = _mm_packus_epi16(g, zero);
+        __m128i c2 = _mm_packus_epi16(bgra ? r : b, zero);
+        __m128i c01 = _mm_unpacklo_epi8(c0, c1);
+        __m128i c23 = _mm_unpacklo_epi8(c2, alpha);
+        _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_unpacklo_epi16(c01, c23));
+        _mm_storeu_si128((__m128i*)(dst + x * 4 + 16), _mm_unpackhi_epi16(c01, c23));
+    }
+    if (x < width) {
+        yuvRowScalar(y + x, u + (x >> 1), v + (x >> 1), dst + x * 4, width - x, bgra);
+    }
+}
+
+// AVX2：16 个像素一组，unpack 按 128 位通道进行，最后用 permute2x128 恢复像素顺序
+__attribute__((target("avx2")))
+static void yuvRowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, bool bgra) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i y16 = _mm256_set1_epi16(16);
+    const __m256i uv128 = _mm256_set1_epi16(128);
+    const __m256i alpha = _mm256_set1_epi8((char)0xFF);
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i kY = _mm256_set1_epi32((512 << 16) | kYuvYG);
+    const __m256i kR = _mm256_set1_epi32((int32_t)((uint32_t)kYuvVR << 16));
+    const __m256i kG = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)kYuvVG << 16) | (uint16_t)kYuvUG));
+    const __m256i kB = _mm256_set1_epi32(kYuvUB);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i yy = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + x))), y16);
+        __m128i u8 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(u + (x >> 1))), _mm_setzero_si128());
+        __m128i v8 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(v + (x >> 1))), _mm_setzero_si128());
+        __m256i uu = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(u8, u8)), _mm_unpackhi_epi16(u8, u8), 1);
+        __m256i vv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(v8, v8)), _mm_unpackhi_epi16(v8, v8), 1);
+        uu = _mm256_sub_epi16(uu, uv128);
+        vv = _mm256_sub_epi16(vv, uv128);
+
+        __m256i yLo = _mm256_madd_epi16(_mm256_unpacklo_epi16(yy, one), kY);
+        __m256i yHi = _mm256_madd_epi16(_mm256_unpackhi_epi16(yy, one), kY);
+        __m256i uvLo = _mm256_unpacklo_epi16(uu, vv);
+        __m256i uvHi = _mm256_unpackhi_epi16(uu, vv);
+        __m256i r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(uvLo, kR)), 10),
+                                       _mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(uvHi, kR)), 10));
+        __m256i g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(uvLo, kG)), 10),
+                                       _mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(uvHi, kG)), 10));
+        __m256i b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(uvLo, kB)), 10),
+                                       _mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(uvHi, kB)), 10));
+
+        __m256i c0 = _mm256_packus_epi16(bgra ? b : r, zero);
+        __m256i c1 = _mm256_packus_epi16(g, zero);
+        __m256i c2 = _mm256_packus_epi16(bgra ? r : b, zero);
+        __m256i c01 = _mm256_unpacklo_epi8(c0, c1);
+        __m256i c23 = _mm256_unpacklo_epi8(c2, alpha);
+        __m256i lo = _mm256_unpacklo_epi16(c01, c23);  // 像素 0-3 | 8-11
+        __m256i hi = _mm256_unpackhi_epi16(c01, c23);  // 像素 4-7 | 12-15
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    if (x < width) {
+        yuvRowSse2(y + x, u + (x >> 1), v + (x >> 1), dst + x * 4, width - x, bgra);
+    }
+}
+
+#endif // YUV_HAVE_X86
+
+struct YuvKernel {
+    YuvRowFunc row;
+    const char* name;
+};
+
+static YuvKernel selectKernel() {
+#if defined(YUV_HAVE_NEON)
+    // arm64 和 NDK 的 armeabi-v7a 都以 NEON 为基线，无需运行时检测
+    return YuvKernel{yuvRowNeon, "neon"};
+#elif defined(YUV_HAVE_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return YuvKernel{yuvRowAvx2, "avx2"};
+    }
+    return YuvKernel{yuvRowSse2, "sse2"};
+#else
+    return YuvKernel{yuvRowScalar, "scalar"};
+#endif
+}
+
+// yuvConvertSelectKernel 指定的内核，为空时按 CPU 自动选择
+static std::atomic<const YuvKernel*> g_kernelOverride(nullptr);
+
+static const YuvKernel& kernel() {
+    static const YuvKernel k = selectKernel();
+    const YuvKernel* forced = g_kernelOverride.load(std::memory_order_relaxed);
+    return forced ? *forced : k;
+}
+
+const char* yuvConvertKernelName() {
+    return kernel().name;
+}
+
+bool yuvConvertSelectKernel(const char* name) {
+    static const YuvKernel scalar{yuvRowScalar, "scalar"};
+#if defined(YUV_HAVE_NEON)
+    static const YuvKernel neon{yuvRowNeon, "neon"};
+#elif defined(YUV_HAVE_X86)
+    static const YuvKernel sse2{yuvRowSse2, "sse2"};
+    static const YuvKernel avx2{yuvRowAvx2, "avx2"};
+#endif
+    const YuvKernel* forced = nullptr;
+    if (!name || !*name) {
+        forced = nullptr;
+    } else if (strcmp(name, "scalar") == 0) {
+        forced = &scalar;
+#if defined(YUV_HAVE_NEON)
+    } else if (strcmp(name, "neon") == 0) {
+        forced = &neon;
+#elif defined(YUV_HAVE_X86)
+    } else if (strcmp(name, "sse2") == 0) {
+        forced = &sse2;
+    } else if (strcmp(name, "avx2") == 0) {
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("avx2")) {
+            return false;
+        }
+        forced = &avx2;
+#endif
+    } else {
+        return false;
+    }
+    g_kernelOverride.store(forced, std::memory_order_relaxed);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// 双线性缩放：先按 8 位小数权重在两行间插值，再在行内按预计算的位置插值
+
+struct BilinearTap {
+    int index;
+    int frac;  // 0..256
+};
+
+// 目标采样点中心映射回源坐标（半像素对齐）
+static void buildTaps(int srcSize, int dstSize, std::vector<BilinearTap>& taps) {
+    taps.resize((size_t)dstSize);
+    for (int i = 0; i < dstSize; i++) {
+        int64_t pos = ((int64_t)(2 * i + 1) * srcSize * 256) / (2 * dstSize) - 128;
+        if (pos < 0) pos = 0;
+        int index = (int)(pos >> 8);
+        int frac = (int)(pos & 0xFF);
+        if (index >= srcSize - 1) {
+            index = srcSize - 1;
+            frac = 0;
+        }
+        taps[(size_t)i].index = index;
+        taps[(size_t)i].frac = frac;
+    }
+}
+
+static inline const uint8_t* pixelAt(const uint8_t* row, int x, int step) {
+    return row + (long)x * step;
+}
+
+// 把一行（可带像素跨度）按纵向权重混合两行，再横向采样到 out
+static void scaleRow(const uint8_t* row0, const uint8_t* row1, int step, int vfrac,
+                     const std::vector<BilinearTap>& taps, int srcSize, uint8_t* out) {
+    const int w1 = vfrac;
+    const int w0 = 256 - vfrac;
+    for (size_t i = 0; i < taps.size(); i++) {
+        int x0 = taps[i].index;
+        int x1 = x0 + 1 < srcSize ? x0 + 1 : x0;
+        int a = (*pixelAt(row0, x0, step) * w0 + *pixelAt(row1, x0, step) * w1 + 128) >> 8;
+        int b = (*pixelAt(row0, x1, step) * w0 + *pixelAt(row1, x1, step) * w1 + 128) >> 8;
+        out[i] = (uint8_t)((a * (256 - taps[i].frac) + b * taps[i].frac + 128) >> 8);
+    }
+}
+
+struct YuvScratch {
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+    std::vector<BilinearTap> lumaTaps;
+    std::vector<BilinearTap> chromaTaps;
+    std::vector<BilinearTap> lumaRows;
+    std::vector<BilinearTap> chromaRows;
+};
+
+void yuv420ToRgbaScale(const Yuv420Planes& src, uint8_t* dst, int dstStride, int dstWidth, int dstHeight,
+                       YuvDstFormat format) {
+    if (!src.y || !src.u || !src.v || !dst || src.width <= 0 || src.height <= 0 || dstWidth <= 0 || dstHeight <= 0 ||
+        dstStride < dstWidth * 4) {
+        return;
+    }
+    // 每个线程复用一份行缓冲，避免每帧分配
+    static thread_local YuvScratch scratch;
+    const YuvRowFunc row = kernel().row;
+    const bool bgra = format == YUV_DST_BGRA;
+    const int chromaW = (src.width + 1) / 2;
+    const int chromaH = (src.height + 1) / 2;
+    const int dstChromaW = (dstWidth + 1) / 2;
+
+    if (dstWidth == src.width && dstHeight == src.height) {
+        // 不缩放：I420 直接按行转换，半平面格式先拆分色度行
+        scratch.u.resize((size_t)chromaW);
+        scratch.v.resize((size_t)chromaW);
+        for (int dy = 0; dy < dstHeight; dy++) {
+            const uint8_t* yRow = src.y + (long)dy * src.yRowStride;
+            const uint8_t* uRow = src.u + (long)(dy >> 1) * src.uvRowStride;
+            const uint8_t* vRow = src.v + (long)(dy >> 1) * src.uvRowStride;
+            if (src.uvPixelStride != 1) {
+                for (int i = 0; i < chromaW; i++) {
+                    scratch.u[(size_t)i] = uRow[(long)i * src.uvPixelStride];
+                    scratch.v[(size_t)i] = vRow[(long)i * src.uvPixelStride];
+                }
+                uRow = scratch.u.data();
+                vRow = scratch.v.data();
+            }
+            row(yRow, uRow, vRow, dst + (long)dy * dstStride, dstWidth, bgra);
+        }
+        return;
+    }
+
+    scratch.y.resize((size_t)dstWidth);
+    scratch.u.resize((size_t)dstChromaW);
+    scratch.v.resize((size_t)dstChromaW);
+    buildTaps(src.width, dstWidth, scratch.lumaTaps);
+    buildTaps(chromaW, dstChromaW, scratch.chromaTaps);
+    buildTaps(src.height, dstHeight, scratch.lumaRows);
+    buildTaps(chromaH, (dstHeight + 1) / 2, scratch.chromaRows);
+
+    for (int dy = 0; dy < dstHeight; dy++) {
+        const BilinearTap& ly = scratch.lumaRows[(size_t)dy];
+        int ly1 = ly.index + 1 < src.height ? ly.index + 1 : ly.index;
+        scaleRow(src.y + (long)ly.index * src.yRowStride, src.y + (long)ly1 * src.yRowStride, 1, ly.frac,
+                 scratch.lumaTaps, src.width, scratch.y.data());
+
+        // 色度每两行目标行更新一次
+        if ((dy & 1) == 0) {
+            const BilinearTap& cy = scratch.chromaRows[(size_t)(dy >> 1)];
+            int cy1 = cy.index + 1 < chromaH ? cy.index + 1 : cy.index;
+            long off0 = (long)cy.index * src.uvRowStride;
+            long off1 = (long)cy1 * src.uvRowStride;
+            scaleRow(src.u + off0, src.u + off1, src.uvPixelStride, cy.frac, scratch.chromaTaps, chromaW, scratch.u.data());
+            scaleRow(src.v + off0, src.v + off1, src.uvPixelStride, cy.frac, scratch.chromaTaps, chromaW, scratch.v.data());
+        }
+        row(scratch.y.data(), scratch.u.data(), scratch.v.data(), dst + (long)dy * dstStride, dstWidth, bgra);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 紧凑打包：色度交错/拆分/字节对交换
+
+// dst = a0 b0 a1 b1 ...，n 为样本对数
+static void interleaveRow(const uint8_t* a, const uint8_t* b, uint8_t* dst, int n) {
+    int i = 0;
+#if defined(YUV_HAVE_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x2_t ab;
+        ab.val[0] = vld1q_u8(a + i);
+        ab.val[1] = vld1q_u8(b + i);
+        vst2q_u8(dst + i * 2, ab);
+    }
+#elif defined(YUV_HAVE_X86)
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_unpacklo_epi8(va, vb));
+        _mm_storeu_si128((__m128i*)(dst + i * 2 + 16), _mm_unpackhi_epi8(va, vb));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i * 2] = a[i];
+        dst[i * 2 + 1] = b[i];
+    }
+}
+
+// src = a0 b0 a1 b1 ...，拆成两个平面
+static void deinterleaveRow(const uint8_t* src, uint8_t* a, uint8_t* b, int n) {
+    int i = 0;
+#if defined(YUV_HAVE_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x2_t ab = vld2q_u8(src + i * 2);
+        vst1q_u8(a + i, ab.val[0]);
+        vst1q_u8(b + i, ab.val[1]);
+    }
+#elif defined(YUV_HAVE_X86)
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    for (; i + 16 <= n; i += 16) {
+        __m128i s0 = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        __m128i s1 = _mm_loadu_si128((const __m128i*)(src + i * 2 + 16));
+        _mm_storeu_si128((__m128i*)(a + i), _mm_packus_epi16(_mm_and_si128(s0, lowMask), _mm_and_si128(s1, lowMask)));
+        _mm_storeu_si128((__m128i*)(b + i), _mm_packus_epi16(_mm_srli_epi16(s0, 8), _mm_srli_epi16(s1, 8)));
+    }
+#endif
+    for (; i < n; i++) {
+        a[i] = src[i * 2];
+        b[i] = src[i * 2 + 1];
+    }
+}
+
+// 交换每个字节对：UVUV -> VUVU
+static void swapPairsRow(const uint8_t* src, uint8_t* dst, int n) {
+    int i = 0;
+#if defined(YUV_HAVE_NEON)
+    for (; i + 8 <= n; i += 8) {
+        vst1q_u8(dst + i * 2, vrev16q_u8(vld1q_u8(src + i * 2)));
+    }
+#elif defined(YUV_HAVE_X86)
+    for (; i + 8 <= n; i += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_or_si128(_mm_slli_epi16(s, 8), _mm_srli_epi16(s, 8)));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i * 2] = src[i * 2 + 1];
+        dst[i * 2 + 1] = src[i * 2];
+    }
+}
+
+size_t yuv420PackedSize(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    size_t chroma = (size_t)((width + 1) / 2) * (size_t)((height + 1) / 2);
+    return (size_t)width * height + chroma * 2;
+}
+
+bool yuv420ToPacked(const Yuv420Planes& src, uint8_t* dst, size_t dstSize, YuvPackedFormat format) {
+    if (!src.y || !src.u || !src.v || !dst || src.width <= 0 || src.height <= 0 ||
+        dstSize < yuv420PackedSize(src.width, src.height)) {
+        return false;
+    }
+    const int w = src.width;
+    const int h = src.height;
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+    const int ps = src.uvPixelStride;
+
+    uint8_t* out = dst;
+    for (int row = 0; row < h; row++) {
+        memcpy(out, src.y + (long)row * src.yRowStride, (size_t)w);
+        out += w;
+    }
+
+    // 半平面来源 U/V 指针相邻；每行最后一对单独处理，避免读到平面缓冲区之外
+    const bool nv12Layout = ps == 2 && src.v == src.u + 1;
+    const bool nv21Layout = ps == 2 && src.u == src.v + 1;
+    for (int row = 0; row < ch; row++) {
+        const uint8_t* uRow = src.u + (long)row * src.uvRowStride;
+        const uint8_t* vRow = src.v + (long)row * src.uvRowStride;
+        const long last = (long)(cw - 1) * ps;
+        if (format == YUV_PACKED_NV21) {
+            uint8_t* vu = dst + (size_t)w * h + (size_t)row * cw * 2;
+            if (nv21Layout) {
+                memcpy(vu, vRow, (size_t)cw * 2 - 1);
+            } else if (nv12Layout) {
+                swapPairsRow(uRow, vu, cw - 1);
+            } else if (ps == 1) {
+                interleaveRow(vRow, uRow, vu, cw);
+            } else {
+                for (int i = 0; i < cw - 1; i++) {
+                    vu[i * 2] = vRow[(long)i * ps];
+                    vu[i * 2 + 1] = uRow[(long)i * ps];
+                }
+            }
+            vu[cw * 2 - 2] = vRow[last];
+            vu[cw * 2 - 1] = uRow[last];
+        } else {
+            uint8_t* uOut = dst + (size_t)w * h + (size_t)row * cw;
+            uint8_t* vOut = dst + (size_t)w * h + (size_t)cw * ch + (size_t)row * cw;
+            if (ps == 1) {
+                memcpy(uOut, uRow, (size_t)cw);
+                memcpy(vOut, vRow, (size_t)cw);
+                continue;
+            }
+            if (nv12Layout) {
+                deinterleaveRow(uRow, uOut, vOut, cw - 1);
+            } else if (nv21Layout) {
+                deinterleaveRow(vRow, vOut, uOut, cw - 1);
+            } else {
+                for (int i = 0; i < cw - 1; i++) {
+                    uOut[i] = uRow[(long)i * ps];
+                    vOut[i] = vRow[(long)i * ps];
+                }
+            }
+            uOut[cw - 1] = uRow[last];
+            vOut[cw - 1] = vRow[last];
+        }
+    }
+    return true;
+}
+
+void rgbaToI420(const uint8_t* src, int srcStride, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v) {
+    const int cw = (width + 1) / 2;
+    const int ch = (height + 1) / 2;
+    for (int row = 0; row < height; row++) {
+        const uint8_t* in = src + (long)row * srcStride;
+        uint8_t* out = y + (long)row * width;
+        for (int x = 0; x < width; x++) {
+            const int r = in[x * 4];
+            const int g = in[x * 4 + 1];
+            const int b = in[x * 4 + 2];
+            out[x] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int row = 0; row < ch; row++) {
+        const int y0 = row * 2;
+        const int y1 = y0 + 1 < height ? y0 + 1 : y0;
+        for (int x = 0; x < cw; x++) {
+            const int x0 = x * 2;
+            const int x1 = x0 + 1 < width ? x0 + 1 : x0;
+            int r = 0, g = 0, b = 0;
+            const int ys[2] = {y0, y1};
+            const int xs[2] = {x0, x1};
+            for (int yy : ys) {
+                for (int xx : xs) {
+                    const uint8_t* p = src + (long)yy * srcStride + xx * 4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            u[(long)row * cw + x] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            v[(long)row * cw + x] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// YUV420 平面描述：支持 I420 / NV12 / NV21 以及 Android Image 的任意行跨度和像素跨度
+struct Yuv420Planes {
+    const uint8_t* y;
+    const uint8_t* u;
+    const uint8_t* v;
+    int yRowStride;
+    int uvRowStride;
+    int uvPixelStride;  // I420 为 1，NV12/NV21 为 2
+    int width;
+    int height;
+};
+
+// 输出像素的字节顺序
+enum YuvDstFormat {
+    YUV_DST_RGBA = 0,  // GL_RGBA / FlPixelBufferTexture
+    YUV_DST_BGRA = 1,  // 小端下与 Android ARGB_8888 的 int 像素一致
+};
+
+// 按区域平均缩小并转换为 ARGB_8888（与 Android Bitmap 的 int 像素格式一致），BT.601 有限范围
+void yuv420ToArgbBoxScale(const Yuv420Planes& src, uint32_t* dst, int dstWidth, int dstHeight);
+
+// 转换为 RGBA/BGRA，同时双线性缩放到目标尺寸（尺寸相同时不缩放），dstStride 以字节计。
+// 按 CPU 特性选择 NEON / AVX2 / SSE2 行内核，结果与标量实现逐位一致。
+void yuv420ToRgbaScale(const Yuv420Planes& src, uint8_t* dst, int dstStride, int dstWidth, int dstHeight,
+                       YuvDstFormat format);
+
+// 紧凑排列的输出格式：Y 平面后接 VU 交错（NV21）或 U、V 两个平面（I420）
+enum YuvPackedFormat {
+    YUV_PACKED_NV21 = 0,
+    YUV_PACKED_I420 = 1,
+};
+
+// 紧凑排列所需字节数，色度尺寸向上取整
+size_t yuv420PackedSize(int width, int height);
+
+// 按行跨度/像素跨度读取平面，写成紧凑的 NV21/I420，dstSize 不足时返回 false
+bool yuv420ToPacked(const Yuv420Planes& src, uint8_t* dst, size_t dstSize, YuvPackedFormat format);
+
+// RGBA 转紧凑的 I420（BT.601 有限范围，色度取 2x2 平均），srcStride 以字节计。
+// 标量实现，只用于低频、小尺寸的画面回读
+void rgbaToI420(const uint8_t* src, int srcStride, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v);
+
+// 当前选用的行内核名称，用于日志
+const char* yuvConvertKernelName();
+
+// 强制使用指定的行内核（"scalar"、"neon"、"sse2"、"avx2"），为空时恢复按 CPU 自动选择；
+// 当前 CPU 不支持时返回 false。进程内全局生效，只用于基准和一致性检查
+bool yuvConvertSelectKernel(const char* name);
+
+#endif // YUV_CONVERT_H
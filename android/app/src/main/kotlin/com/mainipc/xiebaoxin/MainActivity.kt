@@ -13,6 +13,13 @@ import android.view.Surface
 import io.flutter.view.TextureRegistry
 import android.os.Handler
 import android.os.Looper
+import java.io.File
+import java.nio.ByteBuffer
+import android.media.Image
+import android.media.AudioManager
+import android.Manifest
+import android.content.pm.PackageManager
+import android.os.Build
 
 class MainActivity: FlutterActivity() {
     private val TAG = "MainActivity"
@@ -23,6 +30,12 @@ class MainActivity: FlutterActivity() {
     private var surfaceEntryP2p: TextureRegistry.SurfaceTextureEntry? = null
     private var cameraStreamer: CameraH264Streamer? = null
     private var methodChannel: MethodChannel? = null
+    private val thumbnailGenerator = ThumbnailGenerator()
+    private var mosaicEntry: TextureRegistry.SurfaceTextureEntry? = null
+    private var mosaicSurface: Surface? = null
+    private val mosaicDecoders = HashMap<String, MosaicTileDecoder>()
+    // 开启本地移动侦测、但没有拼接格子的设备各有一个 ByteBuffer 模式的分析解码器
+    private val motionDecoders = HashMap<String, MosaicTileDecoder>()
 
     init {
         System.loadLibrary("native-lib")
@@ -36,6 +49,58 @@ class MainActivity: FlutterActivity() {
     external fun nativeRecbVideoData(data: ByteArray, len: Int)
     private external fun bindNative()
     private external fun sendJsonMsg(json: String, topic: String): Int
+    private external fun configureGopCache(totalBytes: Long, perDeviceBytes: Long)
+    private external fun initThumbnailCache(dir: String)
+    private external fun putThumbnail(devId: String, data: ByteArray, width: Int, height: Int)
+    private external fun getThumbnail(devId: String): ByteArray?
+    private external fun startRecording(path: String): Boolean
+    private external fun stopRecording()
+    private external fun getRecordingStats(): LongArray
+    private external fun setKeyframeIndexDir(dir: String)
+    private external fun seekRecording(devId: String, timeMs: Long): LongArray
+    private external fun getRecordingSegmentPath(devId: String, segmentId: Int): String?
+    private external fun getKeyframeIndexStats(devId: String): LongArray
+    private external fun pruneKeyframeIndex(devId: String, path: String?): Long
+    private external fun startTrickPlay(devId: String, startTimeMs: Long, speed: Int, maxFps: Int): Boolean
+    private external fun setTrickPlaySpeed(speed: Int): Boolean
+    private external fun stopTrickPlay()
+    private external fun getTrickPlayStats(): LongArray
+    private external fun attachYuvRenderer(surface: Surface): Boolean
+    private external fun detachYuvRenderer()
+    external fun renderYuvFrame(y: ByteBuffer, u: ByteBuffer, v: ByteBuffer, yRowStride: Int, uvRowStride: Int, uvPixelStride: Int, width: Int, height: Int): Boolean
+    private external fun attachMosaic(surface: Surface, columns: Int, rows: Int, width: Int, height: Int, fps: Int): Boolean
+    private external fun detachMosaic()
+    private external fun setMosaicTile(devId: String, index: Int): Boolean
+    private external fun removeMosaicTile(devId: String)
+    private external fun submitMosaicFrame(devId: String, y: ByteBuffer, u: ByteBuffer, v: ByteBuffer, yRowStride: Int, uvRowStride: Int, uvPixelStride: Int, width: Int, height: Int): Boolean
+    private external fun getMosaicStats(): LongArray
+    private external fun reportViewSize(devId: String, viewId: Int, width: Int, height: Int)
+    private external fun configureStreamProfiles(widths: IntArray, heights: IntArray)
+    private external fun getStreamProfileStats(devId: String): LongArray?
+    private external fun setPresentationDelay(delayMs: Int)
+    private external fun getPresentationStats(): LongArray
+    private external fun getFramePoolStats(): LongArray
+    private external fun getFrameBusSubscribers(): Array<String>
+    private external fun getFrameBusStats(): LongArray
+    private external fun configureMotionDetection(devId: String, enabled: Boolean, sensitivity: Int, analysisFps: Int, zones: FloatArray?)
+    private external fun submitMotionFrame(devId: String, y: ByteBuffer, u: ByteBuffer, v: ByteBuffer, yRowStride: Int, uvRowStride: Int, uvPixelStride: Int, width: Int, height: Int): Boolean
+    private external fun getMotionStats(): LongArray
+    private external fun getCameraActivity(devIds: Array<String>): LongArray
+    private external fun getContinuityStats(): LongArray
+    private external fun getStreamClockStats(devId: String): LongArray?
+    private external fun startAudio(devId: String, codec: String?, sampleRate: Int, outputRate: Int, framesPerBuffer: Int, maxDelayMs: Int): Boolean
+    private external fun stopAudio()
+    private external fun getAudioStats(): LongArray
+    private external fun getAvSyncStats(): LongArray
+    private external fun startTalk(devId: String, codec: String?, packetMs: Int): Boolean
+    private external fun stopTalk()
+    private external fun getTalkStats(): LongArray
+    private external fun configurePictureHealth(frozenMs: Long, blackMs: Long)
+    private external fun getPictureHealthStats(): LongArray
+    private external fun configurePreEventRecording(outputDir: String, eventTypes: Array<String>, perDeviceBytes: Long, preSeconds: Int, postSeconds: Int)
+
+    private fun eventRecordingDir(): File =
+        (getExternalFilesDir("events") ?: File(filesDir, "events")).also { it.mkdirs() }
 
     override fun configureFlutterEngine(@NonNull flutterEngine: FlutterEngine) {
         super.configureFlutterEngine(flutterEngine)
@@ -47,6 +112,9 @@ class MainActivity: FlutterActivity() {
         p2pView = P2pVideoView(this, messenger, MethodChannel(messenger, "p2p_video_view_manual"), 0, null)
         
         bindNative()
+        initThumbnailCache(File(cacheDir, "thumbnails").absolutePath)
+        // 默认对移动侦测和报警消息做预录，Flutter 层可以重新配置
+        configurePreEventRecording(eventRecordingDir().absolutePath, arrayOf("motion", "alarm"), 8L * 1024 * 1024, 10, 10)
         
         methodChannel = MethodChannel(messenger, CHANNEL)
         methodChannel?.setMethodCallHandler { call, result ->
@@ -108,6 +176,9 @@ class MainActivity: FlutterActivity() {
                         h264DecoderP2p = null
                         surfaceP2p?.release()
                         surfaceP2p = null
+                        stopTrickPlay()
+                        stopTalk()
+                        stopAudio()
                         stopP2pVideo()
                         Log.d(TAG, "[CALL] stopP2pVideo 调用后")
                         result.success(null)
@@ -162,6 +233,128 @@ class MainActivity: FlutterActivity() {
                     val ret = sendJsonMsg(json, topic)
                     result.success(ret)
                 }
+                "configureGopCache" -> {
+                    val totalBytes = call.argument<Number>("totalBytes")?.toLong() ?: (16L * 1024 * 1024)
+                    val perDeviceBytes = call.argument<Number>("perDeviceBytes")?.toLong() ?: (4L * 1024 * 1024)
+                    configureGopCache(totalBytes, perDeviceBytes)
+                    result.success(null)
+                }
+                "configurePreEventRecording" -> {
+                    val eventTypes = call.argument<List<String>>("eventTypes") ?: listOf("motion", "alarm")
+                    val perDeviceBytes = call.argument<Number>("perDeviceBytes")?.toLong() ?: (8L * 1024 * 1024)
+                    val preSeconds = call.argument<Int>("preSeconds") ?: 10
+                    val postSeconds = call.argument<Int>("postSeconds") ?: 10
+                    configurePreEventRecording(eventRecordingDir().absolutePath, eventTypes.toTypedArray(), perDeviceBytes, preSeconds, postSeconds)
+                    result.success(null)
+                }
+                "getThumbnail" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    result.success(getThumbnail(devId))
+                }
+                "startRecording" -> {
+                    val path = call.argument<String>("path") ?: File(
+                        getExternalFilesDir("recordings") ?: File(filesDir, "recordings"),
+                        "rec_${System.currentTimeMillis()}.mp4"
+                    ).also { it.parentFile?.mkdirs() }.absolutePath
+                    // 打开文件和预分配放到后台线程
+                    Thread {
+                        val ok = startRecording(path)
+                        Handler(Looper.getMainLooper()).post {
+                            if (ok) result.success(path) else result.error("RECORD_ERROR", "Failed to start recording: $path", null)
+                        }
+                    }.start()
+                }
+                "stopRecording" -> {
+                    Thread {
+                        stopRecording()
+                        Handler(Looper.getMainLooper()).post { result.success(null) }
+                    }.start()
+                }
+                "getRecordingStats" -> {
+                    val stats = getRecordingStats()
+                    result.success(mapOf(
+                        "bytesWritten" to stats[0],
+                        "fragmentsWritten" to stats[1],
+                        "framesWritten" to stats[2],
+                        "droppedFragments" to stats[3],
+                        "muxTimeUs" to stats[4],
+                        "writeTimeUs" to stats[5],
+                        "segments" to stats[6]
+                    ))
+                }
+                "setKeyframeIndexDir" -> {
+                    val dir = call.argument<String>("dir") ?: ""
+                    setKeyframeIndexDir(dir)
+                    result.success(null)
+                }
+                "seekRecording" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val timeMs = call.argument<Number>("timeMs")?.toLong() ?: 0L
+                    val entry = seekRecording(devId, timeMs)
+                    if (entry[0] < 0) {
+                        result.success(null)
+                    } else {
+                        result.success(mapOf(
+                            "index" to entry[0],
+                            "timeMs" to entry[1],
+                            "path" to getRecordingSegmentPath(devId, entry[2].toInt()),
+                            "fragmentOffset" to entry[3],
+                            "sampleOffset" to entry[4],
+                            "sampleSize" to entry[5],
+                            "lookupUs" to entry[6]
+                        ))
+                    }
+                }
+                "getKeyframeIndexStats" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val stats = getKeyframeIndexStats(devId)
+                    result.success(mapOf(
+                        "entries" to stats[0],
+                        "segments" to stats[1],
+                        "recoveredRecords" to stats[2],
+                        "clampedRecords" to stats[3],
+                        "firstTimeMs" to stats[4],
+                        "lastTimeMs" to stats[5],
+                        "fileBytes" to stats[6],
+                        "prunedRecords" to stats[7]
+                    ))
+                }
+                "pruneKeyframeIndex" -> {
+                    // 删除录像文件后调用；不给 path 时清理所有已不存在的录像文件的记录
+                    val devId = call.argument<String>("devId") ?: ""
+                    val path = call.argument<String>("path")
+                    result.success(pruneKeyframeIndex(devId, path))
+                }
+                "startTrickPlay" -> {
+                    // speed 取 ±8、±16、±32 等，负值为快退
+                    val devId = call.argument<String>("devId") ?: ""
+                    val startTimeMs = call.argument<Number>("startTimeMs")?.toLong() ?: 0L
+                    val speed = call.argument<Int>("speed") ?: 8
+                    val maxFps = call.argument<Int>("maxFps") ?: 0
+                    result.success(startTrickPlay(devId, startTimeMs, speed, maxFps))
+                }
+                "setTrickPlaySpeed" -> {
+                    val speed = call.argument<Int>("speed") ?: 8
+                    result.success(setTrickPlaySpeed(speed))
+                }
+                "stopTrickPlay" -> {
+                    stopTrickPlay()
+                    result.success(null)
+                }
+                "getTrickPlayStats" -> {
+                    val stats = getTrickPlayStats()
+                    result.success(mapOf(
+                        "active" to (stats[0] != 0L),
+                        "ended" to (stats[1] != 0L),
+                        "speed" to stats[2],
+                        "deliveredFrames" to stats[3],
+                        "skippedKeyframes" to stats[4],
+                        "readErrors" to stats[5],
+                        "positionMs" to stats[6],
+                        "lastFrameTimeMs" to stats[7],
+                        "readUs" to stats[8]
+                    ))
+                }
                 "createTexture" -> {
                     if (surfaceEntryP2p != null) {
                         surfaceEntryP2p?.release()
@@ -171,7 +364,347 @@ class MainActivity: FlutterActivity() {
                     val textureId = surfaceEntryP2p?.id()
                     result.success(textureId)
                 }
+                "attachYuvRenderer" -> {
+                    // 软解/原始 YUV 来源：由原生 GL 渲染器直接绘制到纹理，不能与 MediaCodec 同时输出到同一个 Surface
+                    val surfaceTexture = surfaceEntryP2p?.surfaceTexture()
+                    if (surfaceTexture == null) {
+                        result.error("TEXTURE_ERROR", "Texture not created", null)
+                    } else {
+                        h264DecoderP2p?.release()
+                        h264DecoderP2p = null
+                        surfaceP2p?.release()
+                        surfaceP2p = Surface(surfaceTexture)
+                        result.success(attachYuvRenderer(surfaceP2p!!))
+                    }
+                }
+                "detachYuvRenderer" -> {
+                    detachYuvRenderer()
+                    result.success(null)
+                }
+                "setPresentationDelay" -> {
+                    // 显示调度的目标缓冲延迟，越大越平滑、延迟越高
+                    setPresentationDelay(call.argument<Int>("delayMs") ?: 60)
+                    result.success(null)
+                }
+                "getPresentationStats" -> {
+                    val stats = getPresentationStats()
+                    result.success(mapOf(
+                        "scheduledFrames" to stats[0],
+                        "lateFrames" to stats[1],
+                        "earlyFrames" to stats[2],
+                        "droppedFrames" to stats[3],
+                        "resyncs" to stats[4],
+                        "delayUs" to stats[5],
+                        "jitterUs" to stats[6],
+                        "frameIntervalUs" to stats[7]
+                    ))
+                }
+                "getFramePoolStats" -> {
+                    val stats = getFramePoolStats()
+                    result.success(mapOf(
+                        "allocations" to stats[0],
+                        "reuses" to stats[1],
+                        "releases" to stats[2],
+                        "sizeClasses" to stats[3],
+                        "buffersInUse" to stats[4],
+                        "buffersFree" to stats[5],
+                        "bytesInUse" to stats[6],
+                        "bytesFree" to stats[7],
+                        "highWaterBytes" to stats[8],
+                        "highWaterBuffers" to stats[9]
+                    ))
+                }
+                "configureMotionDetection" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val enabled = call.argument<Boolean>("enabled") ?: false
+                    val sensitivity = call.argument<Int>("sensitivity") ?: 50
+                    val analysisFps = call.argument<Int>("analysisFps") ?: 2
+                    // zones: [[x, y, width, height], ...]，坐标归一化到 0..1
+                    val zones = call.argument<List<List<Number>>>("zones")
+                        ?.filter { it.size == 4 }
+                        ?.flatMap { zone -> zone.map { it.toFloat() } }
+                        ?.toFloatArray()
+                    configureMotionDetection(devId, enabled, sensitivity, analysisFps, zones)
+                    synchronized(motionDecoders) {
+                        if (enabled) {
+                            if (!motionDecoders.containsKey(devId)) {
+                                motionDecoders[devId] = MosaicTileDecoder(devId, motionFrameSink)
+                            }
+                        } else {
+                            motionDecoders.remove(devId)?.release()
+                        }
+                    }
+                    result.success(null)
+                }
+                "getMotionStats" -> {
+                    val stats = getMotionStats()
+                    result.success(mapOf(
+                        "submittedFrames" to stats[0],
+                        "skippedFrames" to stats[1],
+                        "replacedFrames" to stats[2],
+                        "analyzedFrames" to stats[3],
+                        "events" to stats[4],
+                        "lightingResets" to stats[5]
+                    ))
+                }
+                "getStreamClockStats" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val stats = getStreamClockStats(devId)
+                    if (stats == null) {
+                        result.success(null)
+                    } else {
+                        result.success(mapOf(
+                            "accessUnits" to stats[0],
+                            "source" to when (stats[1].toInt()) { 2 -> "sei"; 1 -> "vui"; else -> "arrival" },
+                            "frameIntervalUs" to stats[2],
+                            "jitterUs" to stats[3],
+                            "missingFrames" to stats[4],
+                            "resyncs" to stats[5]
+                        ))
+                    }
+                }
+                "getContinuityStats" -> {
+                    val stats = getContinuityStats()
+                    result.success(mapOf(
+                        "accessUnits" to stats[0],
+                        "droppedUnits" to stats[1],
+                        "frameNumGaps" to stats[2],
+                        "invalidSlices" to stats[3],
+                        "pocGaps" to stats[4],
+                        "keyframeRequests" to stats[5],
+                        "recoveries" to stats[6],
+                        "lastRecoveryMs" to stats[7]
+                    ))
+                }
+                "startAudio" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val codec = call.argument<String>("codec")
+                    val sampleRate = call.argument<Int>("sampleRate") ?: 8000
+                    val maxDelayMs = call.argument<Int>("maxDelayMs") ?: 0
+                    // 按设备原生采样率和缓冲大小输出，才能走低延迟混音通路
+                    val audioManager = getSystemService(Context.AUDIO_SERVICE) as AudioManager
+                    val outputRate = audioManager.getProperty(AudioManager.PROPERTY_OUTPUT_SAMPLE_RATE)?.toIntOrNull() ?: 48000
+                    val framesPerBuffer = audioManager.getProperty(AudioManager.PROPERTY_OUTPUT_FRAMES_PER_BUFFER)?.toIntOrNull() ?: 0
+                    result.success(startAudio(devId, codec, sampleRate, outputRate, framesPerBuffer, maxDelayMs))
+                }
+                "stopAudio" -> {
+                    stopAudio()
+                    result.success(null)
+                }
+                "getAudioStats" -> {
+                    val stats = getAudioStats()
+                    result.success(mapOf(
+                        "active" to (stats[0] != 0L),
+                        "codec" to when (stats[1].toInt()) { 1 -> "pcmu"; 2 -> "pcma"; 3 -> "aac"; else -> "none" },
+                        "sampleRate" to stats[2],
+                        "outputRate" to stats[3],
+                        "packets" to stats[4],
+                        "decodeErrors" to stats[5],
+                        "concealmentEvents" to stats[6],
+                        "concealedMs" to stats[7],
+                        "overruns" to stats[8],
+                        "stretchedMs" to stats[9],
+                        "jitterMs" to stats[10],
+                        "targetDelayMs" to stats[11],
+                        "bufferedMs" to stats[12],
+                        "latencyMs" to stats[13],
+                        "maxLatencyMs" to stats[14],
+                        "sinkLatencyMs" to stats[15]
+                    ))
+                }
+                "getAvSyncStats" -> {
+                    val stats = getAvSyncStats()
+                    result.success(mapOf(
+                        "audioActive" to (stats[0] != 0L),
+                        "syncedFrames" to stats[1],
+                        "droppedFrames" to stats[2],
+                        "repeatedFrames" to stats[3],
+                        "resyncs" to stats[4],
+                        "offsetUs" to stats[5],
+                        "maxOffsetUs" to stats[6],
+                        "audioDelayUs" to stats[7]
+                    ))
+                }
+                "startTalk" -> {
+                    // 这里不弹权限对话框：调用方要先申请 RECORD_AUDIO 运行时权限（Dart 侧目前还没有对讲入口），
+                    // 未授权时直接报错，而不是让采集打开失败后只返回 false
+                    if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.M &&
+                        checkSelfPermission(Manifest.permission.RECORD_AUDIO) != PackageManager.PERMISSION_GRANTED) {
+                        result.error("PERMISSION_DENIED", "RECORD_AUDIO permission not granted", null)
+                        return@setMethodCallHandler
+                    }
+                    val devId = call.argument<String>("devId") ?: ""
+                    val codec = call.argument<String>("codec")
+                    val packetMs = call.argument<Int>("packetMs") ?: 0
+                    result.success(startTalk(devId, codec, packetMs))
+                }
+                "stopTalk" -> {
+                    stopTalk()
+                    result.success(null)
+                }
+                "getTalkStats" -> {
+                    val stats = getTalkStats()
+                    result.success(mapOf(
+                        "active" to (stats[0] != 0L),
+                        "codec" to when (stats[1].toInt()) { 1 -> "pcmu"; 2 -> "pcma"; else -> "none" },
+                        "sampleRate" to stats[2],
+                        "packetMs" to stats[3],
+                        "packets" to stats[4],
+                        "sendErrors" to stats[5],
+                        "overruns" to stats[6],
+                        "droppedMs" to stats[7],
+                        "encodeUs" to stats[8],
+                        "maxEncodeUs" to stats[9],
+                        "latencyUs" to stats[10],
+                        "maxLatencyUs" to stats[11],
+                        "priority" to stats[12],
+                        "queueDrops" to stats[13]
+                    ))
+                }
+                "configurePictureHealth" -> {
+                    val frozenMs = call.argument<Number>("frozenMs")?.toLong() ?: 0L
+                    val blackMs = call.argument<Number>("blackMs")?.toLong() ?: 0L
+                    configurePictureHealth(frozenMs, blackMs)
+                    result.success(null)
+                }
+                "getPictureHealthStats" -> {
+                    val stats = getPictureHealthStats()
+                    result.success(mapOf(
+                        "sampledFrames" to stats[0],
+                        "skippedFrames" to stats[1],
+                        "frozenEvents" to stats[2],
+                        "blackEvents" to stats[3],
+                        "blankEvents" to stats[4],
+                        "sampleCpuUs" to stats[5]
+                    ))
+                }
+                "getCameraActivity" -> {
+                    val devIds = (call.argument<List<String>>("devIds") ?: emptyList()).toTypedArray()
+                    val stats = getCameraActivity(devIds)
+                    val activity = HashMap<String, Map<String, Any>>()
+                    devIds.forEachIndexed { i, devId ->
+                        if (stats[i * 5] >= 0) {
+                            activity[devId] = mapOf(
+                                "score" to stats[i * 5],
+                                "active" to (stats[i * 5 + 1] != 0L),
+                                "frameBytes" to stats[i * 5 + 2],
+                                "baselineBytes" to stats[i * 5 + 3],
+                                "skipPermille" to stats[i * 5 + 4]
+                            )
+                        }
+                    }
+                    result.success(activity)
+                }
+                "getFrameBusStats" -> {
+                    // 两次调用之间订阅者列表可能变化，按较短的一方对齐
+                    val names = getFrameBusSubscribers()
+                    val stats = getFrameBusStats()
+                    val count = minOf(names.size, stats.size / 5)
+                    result.success((0 until count).associate { i ->
+                        names[i] to mapOf(
+                            "delivered" to stats[i * 5],
+                            "dropped" to stats[i * 5 + 1],
+                            "queuedFrames" to stats[i * 5 + 2],
+                            "queuedBytes" to stats[i * 5 + 3],
+                            "maxQueuedFrames" to stats[i * 5 + 4]
+                        )
+                    })
+                }
+                "reportViewSize" -> {
+                    // 画面的物理像素尺寸，native 据此协商设备码流规格
+                    val devId = call.argument<String>("devId") ?: ""
+                    val viewId = call.argument<Int>("viewId") ?: 0
+                    val width = call.argument<Int>("width") ?: 0
+                    val height = call.argument<Int>("height") ?: 0
+                    reportViewSize(devId, viewId, width, height)
+                    result.success(null)
+                }
+                "configureStreamProfiles" -> {
+                    val widths = call.argument<List<Int>>("widths") ?: emptyList()
+                    val heights = call.argument<List<Int>>("heights") ?: emptyList()
+                    configureStreamProfiles(widths.toIntArray(), heights.toIntArray())
+                    result.success(null)
+                }
+                "getStreamProfileStats" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val stats = getStreamProfileStats(devId)
+                    if (stats == null) {
+                        result.success(null)
+                    } else {
+                        result.success(mapOf(
+                            "width" to stats[0],
+                            "height" to stats[1],
+                            "requiredWidth" to stats[2],
+                            "requiredHeight" to stats[3],
+                            "switches" to stats[4],
+                            "bytesReceived" to stats[5],
+                            "savedBytes" to stats[6],
+                            "bitrateBps" to stats[7]
+                        ))
+                    }
+                }
+                "createMosaicTexture" -> {
+                    // 多画面墙：所有设备拼接到同一个纹理，由 native 按刷新率只重绘变化的格子
+                    val columns = call.argument<Int>("columns") ?: 2
+                    val rows = call.argument<Int>("rows") ?: 2
+                    val width = call.argument<Int>("width") ?: 1280
+                    val height = call.argument<Int>("height") ?: 720
+                    releaseMosaic()
+                    val entry = P2pTexturePlugin.textureRegistry?.createSurfaceTexture()
+                    if (entry == null) {
+                        result.error("TEXTURE_ERROR", "Texture registry not available", null)
+                    } else {
+                        entry.surfaceTexture().setDefaultBufferSize(width, height)
+                        val surface = Surface(entry.surfaceTexture())
+                        @Suppress("DEPRECATION")
+                        val fps = windowManager.defaultDisplay.refreshRate.toInt()
+                        if (attachMosaic(surface, columns, rows, width, height, fps)) {
+                            mosaicEntry = entry
+                            mosaicSurface = surface
+                            result.success(entry.id())
+                        } else {
+                            surface.release()
+                            entry.release()
+                            result.error("MOSAIC_ERROR", "Failed to attach mosaic compositor", null)
+                        }
+                    }
+                }
+                "setMosaicTile" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    val index = call.argument<Int>("index") ?: -1
+                    val ok = setMosaicTile(devId, index)
+                    if (ok) {
+                        synchronized(mosaicDecoders) {
+                            if (!mosaicDecoders.containsKey(devId)) {
+                                mosaicDecoders[devId] = MosaicTileDecoder(devId, mosaicFrameSink)
+                            }
+                        }
+                    }
+                    result.success(ok)
+                }
+                "removeMosaicTile" -> {
+                    val devId = call.argument<String>("devId") ?: ""
+                    removeMosaicTile(devId)
+                    synchronized(mosaicDecoders) {
+                        mosaicDecoders.remove(devId)?.release()
+                    }
+                    result.success(null)
+                }
+                "getMosaicStats" -> {
+                    val stats = getMosaicStats()
+                    result.success(mapOf(
+                        "submittedFrames" to stats[0],
+                        "composedFrames" to stats[1],
+                        "skippedTicks" to stats[2],
+                        "redrawnTiles" to stats[3]
+                    ))
+                }
+                "disposeMosaicTexture" -> {
+                    releaseMosaic()
+                    result.success(null)
+                }
                 "disposeTexture" -> {
+                    detachYuvRenderer()
                     surfaceEntryP2p?.release()
                     surfaceEntryP2p = null
                     result.success(null)
@@ -185,8 +718,99 @@ class MainActivity: FlutterActivity() {
         super.onDestroy()
         cameraStreamer?.release()
         cameraStreamer = null
+        thumbnailGenerator.release()
+        releaseMosaic()
+        synchronized(motionDecoders) {
+            motionDecoders.values.forEach { it.release() }
+            motionDecoders.clear()
+        }
+    }
+
+    // 未到分析间隔的帧在 native 侧直接跳过，不拷贝
+    private val motionFrameSink = object : MosaicTileDecoder.FrameSink {
+        override fun onFrame(devId: String, image: Image): Boolean {
+            val planes = image.planes
+            return submitMotionFrame(devId, planes[0].buffer, planes[1].buffer, planes[2].buffer,
+                planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride, image.width, image.height)
+        }
+    }
+
+    private val mosaicFrameSink = object : MosaicTileDecoder.FrameSink {
+        override fun onFrame(devId: String, image: Image): Boolean {
+            val planes = image.planes
+            return submitMosaicFrame(devId, planes[0].buffer, planes[1].buffer, planes[2].buffer,
+                planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride, image.width, image.height)
+        }
+    }
+
+    private fun releaseMosaic() {
+        detachMosaic()
+        synchronized(mosaicDecoders) {
+            mosaicDecoders.values.forEach { it.release() }
+            mosaicDecoders.clear()
+        }
+        mosaicSurface?.release()
+        mosaicSurface = null
+        mosaicEntry?.release()
+        mosaicEntry = null
+    }
+
+    // 开启移动侦测且没有拼接格子的设备收到视频帧时由 C++ 调用
+    fun onMotionVideoFrame(devId: String, data: ByteArray, isKeyframe: Boolean, ptsUs: Long) {
+        val decoder = synchronized(motionDecoders) { motionDecoders[devId] } ?: return
+        decoder.queue(data, isKeyframe, ptsUs)
+    }
+
+    // 已分配格子的设备收到视频帧时由 C++ 调用
+    fun onMosaicVideoFrame(devId: String, data: ByteArray, isKeyframe: Boolean, ptsUs: Long) {
+        val decoder = synchronized(mosaicDecoders) { mosaicDecoders[devId] } ?: return
+        decoder.queue(data, isKeyframe, ptsUs)
+    }
+
+    // 收到新的关键帧且缩略图过期时由 C++ 调用
+    fun onThumbnailKeyframe(devId: String, keyframe: ByteArray) {
+        thumbnailGenerator.submit(devId, keyframe, object : ThumbnailGenerator.OnThumbnailCallback {
+            override fun onThumbnail(devId: String, jpeg: ByteArray, width: Int, height: Int) {
+                putThumbnail(devId, jpeg, width, height)
+            }
+        })
     }
     
+    // 报警预录文件写完，由 C++ 事件线程调用
+    fun onEventRecordingFinished(devId: String, path: String) {
+        Log.d(TAG, "Event recording finished: devId=$devId, path=$path")
+        Handler(Looper.getMainLooper()).post {
+            methodChannel?.invokeMethod("onEventRecording", mapOf(
+                "devId" to devId,
+                "path" to path
+            ))
+        }
+    }
+
+    // 压缩域活动度估计判断设备进入或离开活跃状态，由 C++ 接收线程调用
+    fun onCameraActivity(devId: String, active: Boolean, score: Int) {
+        Handler(Looper.getMainLooper()).post {
+            methodChannel?.invokeMethod("onCameraActivity", mapOf(
+                "devId" to devId,
+                "active" to active,
+                "score" to score
+            ))
+        }
+    }
+
+    // 解码画面冻结、全黑、单色或恢复正常，由 C++ 送帧线程调用
+    fun onPictureHealth(devId: String, state: String, previous: String, durationMs: Long) {
+        Log.w(TAG, "Picture health $devId: $previous -> $state (${durationMs}ms)")
+        Handler(Looper.getMainLooper()).post {
+            methodChannel?.invokeMethod("onPictureHealth", mapOf(
+                "devId" to devId,
+                "state" to state,
+                "previous" to previous,
+                "durationMs" to durationMs
+            ))
+        }
+    }
+
     // MQTT 消息回调方法，由 C++ 调用
     fun onMqttMessage(data: ByteArray, length: Int) {
         Log.d(TAG, "Received MQTT message, length: $length")
@@ -0,0 +1,117 @@
+package com.mainipc.xiebaoxin
+
+import android.media.Image
+import android.media.MediaCodec
+import android.media.MediaCodecInfo
+import android.media.MediaFormat
+import android.util.Log
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
+import java.util.concurrent.RejectedExecutionException
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * 多画面墙中一路设备的解码器：MediaCodec 以 ByteBuffer 模式输出 YUV，
+ * 每帧直接交给 native 拼接器缩小到所在格子，不占用单独的 Surface 和纹理。
+ * 单线程串行解码，积压超过 [maxPendingFrames] 时丢弃非关键帧。
+ * 本地移动侦测也用它作为分析解码器，帧按分析间隔进入 native 的池化帧。
+ */
+class MosaicTileDecoder(
+    private val devId: String,
+    private val sink: FrameSink,
+    private val maxPendingFrames: Int = 4
+) {
+    private val TAG = "MosaicTileDecoder"
+    private val executor: ExecutorService = Executors.newSingleThreadExecutor()
+    private val pendingFrames = AtomicInteger(0)
+    private var decoder: MediaCodec? = null
+    private var released = false
+
+    interface FrameSink {
+        fun onFrame(devId: String, image: Image): Boolean
+    }
+
+    // ptsUs 为 native 生成的 PTS，与显示路径使用同一时钟
+    fun queue(data: ByteArray, isKeyframe: Boolean, ptsUs: Long) {
+        if (executor.isShutdown) {
+            return
+        }
+        if (!isKeyframe && pendingFrames.get() >= maxPendingFrames) {
+            return
+        }
+        pendingFrames.incrementAndGet()
+        try {
+            executor.execute {
+                try {
+                    decode(data, ptsUs)
+                } catch (e: Exception) {
+                    Log.e(TAG, "decode failed: devId=$devId", e)
+                    releaseDecoder()
+                } finally {
+                    pendingFrames.decrementAndGet()
+                }
+            }
+        } catch (e: RejectedExecutionException) {
+            // 已在 release 过程中
+            pendingFrames.decrementAndGet()
+        }
+    }
+
+    fun release() {
+        executor.execute {
+            released = true
+            releaseDecoder()
+        }
+        executor.shutdown()
+    }
+
+    private fun decode(data: ByteArray, ptsUs: Long) {
+        if (released) {
+            return
+        }
+        val codec = decoder ?: createDecoder(data.size).also { decoder = it }
+        val inputIndex = codec.dequeueInputBuffer(10_000L)
+        if (inputIndex >= 0) {
+            codec.getInputBuffer(inputIndex)?.apply {
+                clear()
+                put(data)
+            }
+            codec.queueInputBuffer(inputIndex, 0, data.size, ptsUs, 0)
+        } else {
+            Log.w(TAG, "no input buffer, dropping frame: devId=$devId")
+        }
+
+        val bufferInfo = MediaCodec.BufferInfo()
+        var outputIndex = codec.dequeueOutputBuffer(bufferInfo, 0)
+        while (outputIndex >= 0 || outputIndex == MediaCodec.INFO_OUTPUT_FORMAT_CHANGED) {
+            if (outputIndex >= 0) {
+                codec.getOutputImage(outputIndex)?.use { image -> sink.onFrame(devId, image) }
+                codec.releaseOutputBuffer(outputIndex, false)
+            }
+            outputIndex = codec.dequeueOutputBuffer(bufferInfo, 0)
+        }
+    }
+
+    private fun createDecoder(maxInputSize: Int): MediaCodec {
+        val codec = MediaCodec.createDecoderByType(MediaFormat.MIMETYPE_VIDEO_AVC)
+        // 实际尺寸以 SPS 为准
+        val format = MediaFormat.createVideoFormat(MediaFormat.MIMETYPE_VIDEO_AVC, 1920, 1080).apply {
+            setInteger(MediaFormat.KEY_COLOR_FORMAT, MediaCodecInfo.CodecCapabilities.COLOR_FormatYUV420Flexible)
+            setInteger(MediaFormat.KEY_MAX_INPUT_SIZE, maxOf(maxInputSize, 512 * 1024))
+        }
+        codec.configure(format, null, null, 0)
+        codec.start()
+        Log.d(TAG, "decoder started: devId=$devId")
+        return codec
+    }
+
+    private fun releaseDecoder() {
+        try {
+            decoder?.stop()
+        } catch (e: Exception) {
+            Log.w(TAG, "decoder stop failed", e)
+        }
+        decoder?.release()
+        decoder = null
+    }
+}
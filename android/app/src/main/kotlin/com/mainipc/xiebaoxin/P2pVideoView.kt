@@ -42,6 +42,8 @@ import android.renderscript.*
 import java.nio.ByteOrder
 import android.graphics.Bitmap
 import android.opengl.GLES20
+import android.view.Choreographer
+import android.view.WindowManager
 
 class P2pVideoViewFactory(private val messenger: BinaryMessenger) : PlatformViewFactory(StandardMessageCodec.INSTANCE) {
     override fun create(context: Context, id: Int, args: Any?): PlatformView {
@@ -64,13 +66,21 @@ class P2pVideoView(
     private var mediaCodec: MediaCodec? = null
     private var surface: Surface? = null
     private var surfaceTexture: SurfaceTexture? = null
-    private var frameQueue = LinkedBlockingQueue<ByteBuffer>(30)
+    private var frameQueue = LinkedBlockingQueue<QueuedFrame>(30)
+    // 已解码、等待到点显示的输出缓冲，按目标显示时间排列
+    private val pendingOutputs = ArrayDeque<PendingOutput>()
+    private var isVsyncRunning = false
+    private val vsyncPeriodNs: Long
     private var isProcessingFrames = AtomicBoolean(false)
     private var frameHandler: Handler
     private var lastFrameTime: Long = 0
     private var frameCheckHandler: Handler
     private lateinit var frameCheckRunnable: Runnable
     private var isFrameCheckRunning = false
+    // 画面分析回读：MediaCodec 直接输出到 Surface，低频把显示内容缩小读回，供 native 做移动侦测和健康检查
+    private lateinit var analyticsTapRunnable: Runnable
+    private var analyticsBitmap: Bitmap? = null
+    private var analyticsBuffer: ByteBuffer? = null
     private var isDisposed = AtomicBoolean(false)
     private var frameCount = AtomicInteger(0)
     private var errorCount = AtomicInteger(0)
@@ -78,8 +88,30 @@ class P2pVideoView(
     private var videoHeight = 720  // 默认高度
     private var isCodecInitialized = false
 
+    // ptsUs 由 native StreamClock 生成（CLOCK_MONOTONIC 域）；为 0 表示缓存 GOP 回放帧，解码后立即显示，不参与显示调度
+    private class QueuedFrame(val data: ByteBuffer, val ptsUs: Long)
+
+    private class PendingOutput(val index: Int, val targetNs: Long)
+
     companion object {
         private var instance: P2pVideoView? = null
+        // 同时持有的输出缓冲上限，超过时丢弃最早的一帧，避免占满解码器的输出缓冲
+        private const val MAX_PENDING_OUTPUTS = 6
+        // 回读间隔与 native 画面健康检查的采样间隔一致；宽度够移动侦测缩小到 160 宽
+        private const val ANALYTICS_TAP_INTERVAL_MS = 500L
+        private const val ANALYTICS_TAP_WIDTH = 320
+    }
+
+    private val vsyncCallback = object : Choreographer.FrameCallback {
+        override fun doFrame(frameTimeNanos: Long) {
+            if (isDisposed.get() || !isVsyncRunning) {
+                isVsyncRunning = false
+                return
+            }
+            onPresentationVsync(frameTimeNanos, vsyncPeriodNs)
+            releaseDueOutputs(frameTimeNanos)
+            Choreographer.getInstance().postFrameCallback(this)
+        }
     }
 
     init {
@@ -108,6 +140,9 @@ class P2pVideoView(
         })
 
         frameHandler = Handler(Looper.getMainLooper())
+        @Suppress("DEPRECATION")
+        val refreshRate = (context.getSystemService(Context.WINDOW_SERVICE) as WindowManager).defaultDisplay.refreshRate
+        vsyncPeriodNs = (1_000_000_000L / (if (refreshRate > 0f) refreshRate else 60f)).toLong()
         frameCheckHandler = Handler(Looper.getMainLooper())
         
         frameCheckRunnable = object : Runnable {
@@ -123,6 +158,15 @@ class P2pVideoView(
             }
         }
 
+        analyticsTapRunnable = object : Runnable {
+            override fun run() {
+                if (isFrameCheckRunning) {
+                    tapDisplayedFrame()
+                    frameCheckHandler.postDelayed(this, ANALYTICS_TAP_INTERVAL_MS)
+                }
+            }
+        }
+
         creationParams?.let {
             // Use the existing initialization logic
         }
@@ -155,7 +199,8 @@ class P2pVideoView(
         }
     }
 
-    private fun processFrame(frame: ByteBuffer) {
+    private fun processFrame(queued: QueuedFrame) {
+        val frame = queued.data
         if (isDisposed.get()) {
             Log.d(TAG, "processFrame: view is disposed")
             return
@@ -173,11 +218,12 @@ class P2pVideoView(
                 frame.rewind()
                 inputBuffer?.put(frame)
                 Log.d(TAG, "[流程] 输入帧送入MediaCodec, inputBufferIndex=$inputBufferIndex, size=${frame.limit()}")
+                // native 平滑后的 PTS，解码输出时据此计算显示时间
                 mediaCodec!!.queueInputBuffer(
                     inputBufferIndex,
                     0,
                     frame.limit(),
-                    System.nanoTime() / 1000,
+                    queued.ptsUs,
                     0
                 )
             } else {
@@ -188,7 +234,7 @@ class P2pVideoView(
             var outputCount = 0
             while (outputBufferIndex >= 0) {
                 Log.d(TAG, "[流程] 解码输出帧, outputBufferIndex=$outputBufferIndex, size=${bufferInfo.size}")
-                mediaCodec!!.releaseOutputBuffer(outputBufferIndex, true)
+                scheduleOutput(outputBufferIndex, bufferInfo.presentationTimeUs)
                 outputBufferIndex = mediaCodec!!.dequeueOutputBuffer(bufferInfo, 0)
                 outputCount++
             }
@@ -204,31 +250,19 @@ class P2pVideoView(
         }
     }
 
-    fun onVideoFrame(data: ByteArray) {
+    fun onVideoFrame(data: ByteArray, ptsUs: Long) {
         if (isDisposed.get()) {
             Log.d(TAG, "onVideoFrame: view is disposed")
             return
         }
         Log.d(TAG, "[流程] onVideoFrame 被调用, data.length=${data.size}")
         try {
-            // 同时发送到Flutter层和本地处理
-            Handler(Looper.getMainLooper()).post {
-                try {
-                    // 发送到Flutter层的video_frame_channel
-                    val videoChannel = MethodChannel(binaryMessenger, "video_frame_channel")
-                    videoChannel.invokeMethod("onVideoFrame", data)
-                    Log.d(TAG, "[流程] 视频帧已发送到Flutter层")
-                } catch (e: Exception) {
-                    Log.e(TAG, "Error sending frame to Flutter", e)
-                }
-            }
-            
-            // 本地处理
+            // Flutter 层通过 native 帧环形缓冲（dart:ffi）获取帧计数和关键帧通知，这里只做本地解码
             val length = data.size
             val buffer = ByteBuffer.allocate(length)
             buffer.put(data, 0, length)
             buffer.flip()
-            if (!frameQueue.offer(buffer)) {
+            if (!frameQueue.offer(QueuedFrame(buffer, ptsUs))) {
                 Log.w(TAG, "[流程] Frame queue is full, dropping frame")
             } else {
                 Log.d(TAG, "[流程] Frame 入队成功, queue.size=${frameQueue.size}")
@@ -246,6 +280,91 @@ class P2pVideoView(
         }
     }
 
+    // 由 native 回放缓存的 GOP 时调用，只送本地解码器，队列满时短暂等待而不是丢帧
+    fun onCachedVideoFrame(data: ByteArray) {
+        if (isDisposed.get()) {
+            return
+        }
+        val buffer = ByteBuffer.allocate(data.size)
+        buffer.put(data, 0, data.size)
+        buffer.flip()
+        if (!frameQueue.offer(QueuedFrame(buffer, 0L), 100, TimeUnit.MILLISECONDS)) {
+            Log.w(TAG, "[GOP缓存] Frame queue is full, dropping cached frame")
+            return
+        }
+        if (frameCount.get() == 0) {
+            Handler(Looper.getMainLooper()).post {
+                statusTextView.text = "显示最近画面，等待实时视频流..."
+            }
+        }
+    }
+
+    // 计算目标显示时间后交给 vsync 回调到点释放；TextureView 总是取最新的一帧，不能提前释放
+    private fun scheduleOutput(index: Int, ptsUs: Long) {
+        val codec = mediaCodec ?: return
+        if (ptsUs <= 0L) {
+            codec.releaseOutputBuffer(index, true)
+            return
+        }
+        val targetNs = schedulePresentation(ptsUs, System.nanoTime())
+        if (targetNs < 0) {
+            codec.releaseOutputBuffer(index, false)
+            return
+        }
+        synchronized(pendingOutputs) {
+            pendingOutputs.addLast(PendingOutput(index, targetNs))
+            while (pendingOutputs.size > MAX_PENDING_OUTPUTS) {
+                codec.releaseOutputBuffer(pendingOutputs.removeFirst().index, false)
+                onPresentationSuperseded()
+            }
+        }
+        startVsync()
+    }
+
+    // 释放在下一个 vsync 之前到期的帧，同一周期内多帧到期时只显示最新的一帧
+    private fun releaseDueOutputs(frameTimeNanos: Long) {
+        val codec = mediaCodec ?: return
+        synchronized(pendingOutputs) {
+            try {
+                var due: PendingOutput? = null
+                while (pendingOutputs.isNotEmpty() && pendingOutputs.first().targetNs <= frameTimeNanos + vsyncPeriodNs) {
+                    due?.let {
+                        codec.releaseOutputBuffer(it.index, false)
+                        onPresentationSuperseded()
+                    }
+                    due = pendingOutputs.removeFirst()
+                }
+                due?.let { codec.releaseOutputBuffer(it.index, it.targetNs) }
+            } catch (e: IllegalStateException) {
+                // 解码器正在释放
+                pendingOutputs.clear()
+            }
+        }
+    }
+
+    private fun startVsync() {
+        frameHandler.post {
+            if (!isVsyncRunning && !isDisposed.get()) {
+                isVsyncRunning = true
+                Choreographer.getInstance().postFrameCallback(vsyncCallback)
+            }
+        }
+    }
+
+    private fun stopVsync() {
+        frameHandler.post {
+            isVsyncRunning = false
+            Choreographer.getInstance().removeFrameCallback(vsyncCallback)
+        }
+    }
+
+    // 解码器停止后输出缓冲全部失效
+    private fun clearPendingOutputs() {
+        synchronized(pendingOutputs) {
+            pendingOutputs.clear()
+        }
+    }
+
     fun onError(message: String) {
         Handler(Looper.getMainLooper()).post {
             try {
@@ -289,18 +408,49 @@ class P2pVideoView(
         }.start()
         isFrameCheckRunning = true
         frameCheckHandler.post(frameCheckRunnable)
+        frameCheckHandler.removeCallbacks(analyticsTapRunnable)
+        frameCheckHandler.post(analyticsTapRunnable)
     }
 
     private fun startFrameCheck() {
         if (!isFrameCheckRunning && !isDisposed.get()) {
             isFrameCheckRunning = true
             frameCheckHandler.post(frameCheckRunnable)
+            frameCheckHandler.removeCallbacks(analyticsTapRunnable)
+            frameCheckHandler.post(analyticsTapRunnable)
         }
     }
 
     private fun stopFrameCheck() {
         isFrameCheckRunning = false
         frameCheckHandler.removeCallbacks(frameCheckRunnable)
+        frameCheckHandler.removeCallbacks(analyticsTapRunnable)
+    }
+
+    // 主线程调用。只在持续收到数据时回读：有数据但画面冻结或全黑正是健康检查要发现的情况，
+    // 没有数据由流状态判断。回读尺寸很小，位图和缓冲复用
+    private fun tapDisplayedFrame() {
+        if (!isCodecInitialized || !textureView.isAvailable || textureView.width <= 0 ||
+            System.currentTimeMillis() - lastFrameTime > 3000) {
+            return
+        }
+        val width = ANALYTICS_TAP_WIDTH
+        val height = maxOf(2, (width.toLong() * textureView.height / textureView.width).toInt() and 1.inv())
+        val bitmap = analyticsBitmap?.takeIf { it.width == width && it.height == height }
+            ?: Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888).also {
+                analyticsBitmap?.recycle()
+                analyticsBitmap = it
+                analyticsBuffer = ByteBuffer.allocateDirect(it.byteCount)
+            }
+        val buffer = analyticsBuffer ?: return
+        try {
+            textureView.getBitmap(bitmap)
+            buffer.rewind()
+            bitmap.copyPixelsToBuffer(buffer)
+            submitDisplayedFrame(buffer, bitmap.rowBytes, width, height)
+        } catch (e: Exception) {
+            Log.w(TAG, "tapDisplayedFrame failed", e)
+        }
     }
 
     override fun dispose() {
@@ -314,8 +464,14 @@ class P2pVideoView(
             
             // 清理其他资源
             frameCheckHandler.removeCallbacks(frameCheckRunnable)
+            frameCheckHandler.removeCallbacks(analyticsTapRunnable)
             isFrameCheckRunning = false
+            analyticsBitmap?.recycle()
+            analyticsBitmap = null
+            analyticsBuffer = null
             
+            stopVsync()
+            clearPendingOutputs()
             mediaCodec?.stop()
             mediaCodec?.release()
             mediaCodec = null
@@ -428,6 +584,7 @@ class P2pVideoView(
             surface = Surface(surfaceTexture)
             mediaCodec?.configure(format, surface, null, 0)
             mediaCodec?.start()
+            resetPresentation()
             Log.d(TAG, "[流程] MediaCodec 初始化完成")
             startFrameProcessing()
             isCodecInitialized = true
@@ -440,6 +597,8 @@ class P2pVideoView(
     private fun releaseMediaCodec() {
         try {
             isProcessingFrames.set(false)
+            stopVsync()
+            clearPendingOutputs()
             mediaCodec?.stop()
             mediaCodec?.release()
             mediaCodec = null
@@ -456,4 +615,9 @@ class P2pVideoView(
     private external fun startP2pVideo()
     private external fun setDisplayMode(mode: Int)
     private external fun setTextureId(textureId: Long)
+    private external fun schedulePresentation(arrivalUs: Long, nowNs: Long): Long
+    private external fun onPresentationVsync(frameTimeNs: Long, periodNs: Long)
+    private external fun onPresentationSuperseded()
+    private external fun resetPresentation()
+    private external fun submitDisplayedFrame(rgba: ByteBuffer, rowStride: Int, width: Int, height: Int): Boolean
 } 
\ No newline at end of file
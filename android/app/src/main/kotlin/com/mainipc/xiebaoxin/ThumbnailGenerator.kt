@@ -0,0 +1,119 @@
+package com.mainipc.xiebaoxin
+
+import android.graphics.Bitmap
+import android.media.MediaCodec
+import android.media.MediaCodecInfo
+import android.media.MediaFormat
+import android.util.Log
+import java.io.ByteArrayOutputStream
+import java.nio.ByteBuffer
+import java.util.concurrent.Executors
+
+/**
+ * 把 native 提交的关键帧解码并缩小为 JPEG 缩略图，结果写回 native 缩略图缓存。
+ * 单线程串行处理，同一时间只占用一个解码器实例。
+ */
+class ThumbnailGenerator(private val maxWidth: Int = 320, private val quality: Int = 75) {
+    private val TAG = "ThumbnailGenerator"
+    private val executor = Executors.newSingleThreadExecutor()
+
+    interface OnThumbnailCallback {
+        fun onThumbnail(devId: String, jpeg: ByteArray, width: Int, height: Int)
+    }
+
+    fun submit(devId: String, keyframe: ByteArray, callback: OnThumbnailCallback) {
+        executor.execute {
+            try {
+                val bitmap = decodeKeyframe(keyframe) ?: return@execute
+                val out = ByteArrayOutputStream()
+                bitmap.compress(Bitmap.CompressFormat.JPEG, quality, out)
+                callback.onThumbnail(devId, out.toByteArray(), bitmap.width, bitmap.height)
+                bitmap.recycle()
+                Log.d(TAG, "thumbnail generated: devId=$devId, ${bitmap.width}x${bitmap.height}, size=${out.size()}")
+            } catch (e: Exception) {
+                Log.e(TAG, "Error generating thumbnail for $devId", e)
+            }
+        }
+    }
+
+    fun release() {
+        executor.shutdownNow()
+    }
+
+    private fun decodeKeyframe(keyframe: ByteArray): Bitmap? {
+        val decoder = MediaCodec.createDecoderByType(MediaFormat.MIMETYPE_VIDEO_AVC)
+        try {
+            // 实际尺寸以 SPS 为准，这里只用于分配输入缓冲
+            val format = MediaFormat.createVideoFormat(MediaFormat.MIMETYPE_VIDEO_AVC, 1920, 1080).apply {
+                setInteger(MediaFormat.KEY_COLOR_FORMAT, MediaCodecInfo.CodecCapabilities.COLOR_FormatYUV420Flexible)
+                setInteger(MediaFormat.KEY_MAX_INPUT_SIZE, keyframe.size)
+            }
+            decoder.configure(format, null, null, 0)
+            decoder.start()
+
+            val inputIndex = decoder.dequeueInputBuffer(100_000L)
+            if (inputIndex < 0) {
+                Log.w(TAG, "decodeKeyframe: no input buffer")
+                return null
+            }
+            decoder.getInputBuffer(inputIndex)?.apply {
+                clear()
+                put(keyframe)
+            }
+            decoder.queueInputBuffer(inputIndex, 0, keyframe.size, 0, MediaCodec.BUFFER_FLAG_END_OF_STREAM)
+
+            val bufferInfo = MediaCodec.BufferInfo()
+            val deadline = System.currentTimeMillis() + 1000
+            while (System.currentTimeMillis() < deadline) {
+                val outputIndex = decoder.dequeueOutputBuffer(bufferInfo, 50_000L)
+                if (outputIndex < 0) {
+                    continue
+                }
+                val image = decoder.getOutputImage(outputIndex)
+                var bitmap: Bitmap? = null
+                if (image != null) {
+                    val width = image.width
+                    val height = image.height
+                    val dstWidth = minOf(maxWidth, width)
+                    val dstHeight = maxOf(1, height * dstWidth / width)
+                    val pixels = IntArray(dstWidth * dstHeight)
+                    val planes = image.planes
+                    if (convertYuvToArgb(
+                            planes[0].buffer, planes[1].buffer, planes[2].buffer,
+                            planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride,
+                            width, height, pixels, dstWidth, dstHeight)) {
+                        bitmap = Bitmap.createBitmap(pixels, dstWidth, dstHeight, Bitmap.Config.ARGB_8888)
+                    }
+                    image.close()
+                }
+                decoder.releaseOutputBuffer(outputIndex, false)
+                if (bitmap != null || (bufferInfo.flags and MediaCodec.BUFFER_FLAG_END_OF_STREAM) != 0) {
+                    return bitmap
+                }
+            }
+            Log.w(TAG, "decodeKeyframe: timed out")
+            return null
+        } finally {
+            try {
+                decoder.stop()
+            } catch (e: Exception) {
+                Log.w(TAG, "decoder stop failed", e)
+            }
+            decoder.release()
+        }
+    }
+
+    private external fun convertYuvToArgb(
+        yBuffer: ByteBuffer,
+        uBuffer: ByteBuffer,
+        vBuffer: ByteBuffer,
+        yRowStride: Int,
+        uvRowStride: Int,
+        uvPixelStride: Int,
+        width: Int,
+        height: Int,
+        dst: IntArray,
+        dstWidth: Int,
+        dstHeight: Int
+    ): Boolean
+}
@@ -1,19 +1,59 @@
 package com.mainipc.xiebaoxin
 
 import android.media.Image
+import java.util.ArrayDeque
 
 object YuvUtils {
-    fun imageToNv21(image: Image): ByteArray {
-        val yBuffer = image.planes[0].buffer
-        val uBuffer = image.planes[1].buffer
-        val vBuffer = image.planes[2].buffer
-        val ySize = yBuffer.remaining()
-        val uSize = uBuffer.remaining()
-        val vSize = vBuffer.remaining()
-        val nv21 = ByteArray(ySize + uSize + vSize)
-        yBuffer.get(nv21, 0, ySize)
-        vBuffer.get(nv21, ySize, vSize)
-        uBuffer.get(nv21, ySize + vSize, uSize)
-        return nv21
+    const val FORMAT_NV21 = 0
+    const val FORMAT_I420 = 1
+
+    // 每种尺寸最多缓存的缓冲区数量
+    private const val MAX_POOLED_PER_SIZE = 3
+
+    private val pool = HashMap<Int, ArrayDeque<ByteArray>>()
+
+    private external fun nativeImageToPacked(
+        y: java.nio.ByteBuffer, u: java.nio.ByteBuffer, v: java.nio.ByteBuffer,
+        yRowStride: Int, uvRowStride: Int, uvPixelStride: Int,
+        width: Int, height: Int, dst: ByteArray, format: Int
+    ): Boolean
+
+    fun packedSize(width: Int, height: Int): Int =
+        width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2)
+
+    // 从池中取缓冲区，用完后调用 recycle 归还
+    fun obtain(size: Int): ByteArray = synchronized(pool) {
+        pool[size]?.pollFirst()
+    } ?: ByteArray(size)
+
+    fun recycle(buffer: ByteArray) {
+        synchronized(pool) {
+            val queue = pool.getOrPut(buffer.size) { ArrayDeque() }
+            if (queue.size < MAX_POOLED_PER_SIZE) {
+                queue.addFirst(buffer)
+            }
+        }
+    }
+
+    // 按平面的 rowStride/pixelStride 转换 YUV_420_888 Image，返回池中的缓冲区
+    fun imageToPacked(image: Image, format: Int): ByteArray {
+        val planes = image.planes
+        val width = image.width
+        val height = image.height
+        val out = obtain(packedSize(width, height))
+        val ok = nativeImageToPacked(
+            planes[0].buffer, planes[1].buffer, planes[2].buffer,
+            planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride,
+            width, height, out, format
+        )
+        if (!ok) {
+            recycle(out)
+            throw IllegalArgumentException("Unsupported image planes: ${width}x$height")
+        }
+        return out
     }
-} 
\ No newline at end of file
+
+    fun imageToNv21(image: Image): ByteArray = imageToPacked(image, FORMAT_NV21)
+
+    fun imageToI420(image: Image): ByteArray = imageToPacked(image, FORMAT_I420)
+}
@@ -1,4 +1,7 @@
+import 'dart:typed_data';
+
 import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
 import 'package:ipcso_main/gen_l10n/app_localizations.dart';
 import 'p2p_video_page.dart';
 
@@ -281,7 +284,22 @@ class _DeviceCard extends StatelessWidget {
                   ),
                 ],
               ),
-              if (isGrid) const Spacer(),
+              if (type == 'camera' && isGrid)
+                Expanded(
+                  child: Padding(
+                    padding: const EdgeInsets.only(top: 8),
+                    child: _DeviceThumbnail(devId: devId),
+                  ),
+                ),
+              if (type == 'camera' && !isGrid)
+                Padding(
+                  padding: const EdgeInsets.only(top: 8),
+                  child: AspectRatio(
+                    aspectRatio: 16 / 9,
+                    child: _DeviceThumbnail(devId: devId),
+                  ),
+                ),
+              if (isGrid && type != 'camera') const Spacer(),
               Padding(
                 padding: const EdgeInsets.only(top: 8),
                 child: Text(
@@ -300,6 +318,70 @@ class _DeviceCard extends StatelessWidget {
   }
 }
 
+// 设备缩略图：来自 native 缓存的最近关键帧，不需要打开视频流
+class _DeviceThumbnail extends StatefulWidget {
+  final String devId;
+  const _DeviceThumbnail({required this.devId});
+  @override
+  State<_DeviceThumbnail> createState() => _DeviceThumbnailState();
+}
+
+class _DeviceThumbnailState extends State<_DeviceThumbnail> {
+  static const MethodChannel _channel = MethodChannel('p2p_video_channel');
+  Uint8List? _thumbnail;
+
+  @override
+  void initState() {
+    super.initState();
+    _loadThumbnail();
+  }
+
+  @override
+  void didUpdateWidget(covariant _DeviceThumbnail oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (oldWidget.devId != widget.devId) {
+      _loadThumbnail();
+    }
+  }
+
+  Future<void> _loadThumbnail() async {
+    try {
+      final Uint8List? data = await _channel
+          .invokeMethod<Uint8List>('getThumbnail', {'devId': widget.devId});
+      if (mounted) {
+        setState(() {
+          _thumbnail = data;
+        });
+      }
+    } catch (e) {
+      debugPrint('[HomePage] getThumbnail error: $e');
+    }
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    final colorScheme = Theme.of(context).colorScheme;
+    return ClipRRect(
+      borderRadius: BorderRadius.circular(10),
+      child: Container(
+        color: colorScheme.onSurface.withOpacity(0.06),
+        child: _thumbnail == null
+            ? Center(
+                child: Icon(Icons.videocam_off_outlined,
+                    color: colorScheme.onSurface.withOpacity(0.3)),
+              )
+            : Image.memory(
+                _thumbnail!,
+                fit: BoxFit.cover,
+                gaplessPlayback: true,
+                width: double.infinity,
+                height: double.infinity,
+              ),
+      ),
+    );
+  }
+}
+
 class _TestDeviceCard extends StatelessWidget {
   final VoidCallback onTap;
   final bool isGrid;
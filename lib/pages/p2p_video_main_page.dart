@@ -4,6 +4,8 @@ import 'dart:developer';
 import 'package:flutter/foundation.dart';
 import 'package:permission_handler/permission_handler.dart';
 import 'dart:async';
+import '../services/native_frame_ring.dart';
+import '../widgets/view_size_reporter.dart';
 
 class P2pVideoMainPage extends StatefulWidget {
   final String devId;
@@ -16,8 +18,6 @@ class P2pVideoMainPage extends StatefulWidget {
 
 class _P2pVideoMainPageState extends State<P2pVideoMainPage> {
   static const MethodChannel _channel = MethodChannel('p2p_video_channel');
-  static const MethodChannel _videoChannel =
-      MethodChannel('video_frame_channel');
   String _status = 'Idle';
   late final TextEditingController _devIdController;
   bool _videoStarted = false;
@@ -32,6 +32,8 @@ class _P2pVideoMainPageState extends State<P2pVideoMainPage> {
   int? _textureId;
   int? _platformViewId; // 新增：保存PlatformView的id
   bool _videoStreamAvailable = false;
+  String? _pictureFault; // native 画面检查报告的异常：frozen/black/blank
+  StreamSubscription<FrameRingEvent>? _frameSubscription;
 
   @override
   void initState() {
@@ -66,32 +68,21 @@ class _P2pVideoMainPageState extends State<P2pVideoMainPage> {
       }
     });
 
-    _videoChannel.setMethodCallHandler((call) async {
-      if (call.method == 'onVideoFrame') {
-        final Uint8List h264Frame = call.arguments;
-        print('[Flutter] onVideoFrame received, len=h264Frame.length}');
-        // 只要收到帧，立即变绿
-        if (!_videoStreamAvailable) {
-          setState(() {
-            _videoStreamAvailable = true;
-            _statusDetail = '收到视频帧，红点变绿';
-          });
-          log('[Flutter] 收到 onVideoFrame，红点变绿');
-        }
-        _lastFrameTime = DateTime.now();
-        if (!_decoderInitialized || _decoderSource != 'p2p') {
-          await _initDecoder(640, 480, source: 'p2p');
-          setState(() {
-            _statusDetail = '收到onVideoFrame, 初始化解码器';
-          });
-        }
-        await _videoChannel.invokeMethod('queueH264', {
-          'data': h264Frame,
-          'pts': DateTime.now().millisecondsSinceEpoch,
-          'source': 'p2p',
+    // 帧数据留在 native 环形缓冲，这里只接收合并后的计数通知
+    _frameSubscription = NativeFrameRing.instance.events.listen((event) async {
+      // 只要收到帧，立即变绿；画面异常时有数据也保持红色，等 native 报告恢复
+      if (!_videoStreamAvailable && _pictureFault == null) {
+        setState(() {
+          _videoStreamAvailable = true;
+          _statusDetail = '收到视频帧，红点变绿';
         });
+        log('[Flutter] 收到帧通知，红点变绿');
+      }
+      _lastFrameTime = DateTime.now();
+      if (!_decoderInitialized || _decoderSource != 'p2p') {
+        await _initDecoder(640, 480, source: 'p2p');
         setState(() {
-          _statusDetail = 'queueH264已调用(p2p), len=${h264Frame.length}';
+          _statusDetail = '收到视频帧, 初始化解码器';
         });
       }
     });
@@ -126,30 +117,38 @@ class _P2pVideoMainPageState extends State<P2pVideoMainPage> {
     switch (call.method) {
       case 'onTextureFrame':
         if (_textureId != null) {
-          try {
-            // 获取视频帧数据
-            final yuvData = call.arguments['yuvData'] as List<int>;
-            final width = call.arguments['width'] as int;
-            final height = call.arguments['height'] as int;
-
-            // 更新视频流状态
-            if (mounted) {
-              setState(() {
-                _statusDetail = '收到视频帧，红点变绿';
-              });
-            }
-
-            // 通知Texture更新
-            await _channel.invokeMethod('updateTexture', {
-              'textureId': _textureId,
-              'yuvData': yuvData,
-              'width': width,
-              'height': height,
+          // 帧已由原生层转换并写入纹理，这里只更新状态，不再把整帧 YUV 经 MethodChannel 往返
+          final width = call.arguments['width'] as int;
+          final height = call.arguments['height'] as int;
+          if (mounted) {
+            setState(() {
+              _statusDetail = '收到视频帧，红点变绿';
             });
-
-            log('[Flutter] Received video frame: ${width}x${height}, data size: ${yuvData.length}');
-          } catch (e) {
-            log('[Flutter] updateTexture error: $e');
+          }
+          log('[Flutter] Received video frame: ${width}x$height');
+        }
+        break;
+      case 'onPictureHealth':
+        final devId = call.arguments['devId'] as String;
+        if (devId != _devIdController.text || !mounted) break;
+        final state = call.arguments['state'] as String;
+        final durationMs = call.arguments['durationMs'] as int;
+        log('[Flutter] 画面检查: ${call.arguments['previous']} -> $state (${durationMs}ms)');
+        if (state == 'ok') {
+          setState(() {
+            _pictureFault = null;
+            _videoStreamAvailable = true;
+            _statusDetail = '画面恢复正常，红点变绿';
+          });
+        } else {
+          setState(() {
+            _pictureFault = state;
+            _videoStreamAvailable = false;
+            _statusDetail = '画面异常($state) ${durationMs ~/ 1000}秒，红点变红';
+          });
+          // 冻结多半是解码卡住，重开视频流；全黑或单色可能是镜头遮挡，只提示
+          if (state == 'frozen' && _videoStarted) {
+            _stopP2pVideo().then((_) => _startP2pVideo());
           }
         }
         break;
@@ -364,7 +363,7 @@ class _P2pVideoMainPageState extends State<P2pVideoMainPage> {
   void dispose() {
     _isDisposed = true;
     _channel.setMethodCallHandler(null);
-    _videoChannel.setMethodCallHandler(null);
+    _frameSubscription?.cancel();
 
     // 1. 停止视频流并释放资源（同步等待）
     _releaseAllResources().then((_) {
@@ -546,17 +545,20 @@ class _P2pVideoMainPageState extends State<P2pVideoMainPage> {
       width: 320,
       height: 240,
       child: _videoStarted
-          ? (_displayMode == 1 && _textureId != null
-              ? Texture(textureId: _textureId!)
-              : AndroidView(
-                  viewType: 'p2p_video_view',
-                  onPlatformViewCreated: (int id) {
-                    _platformViewId = id;
-                    _startP2pVideoOnPlatformView();
-                  },
-                  creationParams: const {},
-                  creationParamsCodec: const StandardMessageCodec(),
-                ))
+          ? ViewSizeReporter(
+              devId: _devIdController.text,
+              child: _displayMode == 1 && _textureId != null
+                  ? Texture(textureId: _textureId!)
+                  : AndroidView(
+                      viewType: 'p2p_video_view',
+                      onPlatformViewCreated: (int id) {
+                        _platformViewId = id;
+                        _startP2pVideoOnPlatformView();
+                      },
+                      creationParams: const {},
+                      creationParamsCodec: const StandardMessageCodec(),
+                    ),
+            )
           : Container(
               color: Colors.black12,
               alignment: Alignment.center,
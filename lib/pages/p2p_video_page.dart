@@ -5,6 +5,8 @@ import 'dart:async';
 import '../providers/message_monitor.dart';
 import '../providers/device_event_notifier.dart';
 import '../services/mqtt_service.dart';
+import '../services/native_frame_ring.dart';
+import '../widgets/view_size_reporter.dart';
 
 class P2pVideoPage extends StatefulWidget {
   final String devId;
@@ -17,8 +19,6 @@ class P2pVideoPage extends StatefulWidget {
 }
 
 class _P2pVideoPageState extends State<P2pVideoPage> {
-  static const MethodChannel _videoChannel =
-      MethodChannel('video_frame_channel');
 
   String _status = 'Idle';
   bool _videoStarted = false;
@@ -28,13 +28,15 @@ class _P2pVideoPageState extends State<P2pVideoPage> {
   String _statusDetail = '';
   int? _platformViewId;
   bool _videoStreamAvailable = false;
+  StreamSubscription<FrameRingEvent>? _frameSubscription;
 
   String _bitrate = '-- kb/s';
 
   @override
   void initState() {
     super.initState();
-    _videoChannel.setMethodCallHandler(_handleVideoMethod);
+    _frameSubscription =
+        NativeFrameRing.instance.events.listen(_onFrameRingEvent);
     WidgetsBinding.instance.addPostFrameCallback((_) {
       _startP2pVideoFull();
     });
@@ -154,7 +156,7 @@ class _P2pVideoPageState extends State<P2pVideoPage> {
   @override
   void dispose() {
     // 1. 解绑 MethodChannel 回调，防止回调到已销毁对象
-    _videoChannel.setMethodCallHandler(null);
+    _frameSubscription?.cancel();
     // 2. 释放 native 资源（同步/异步）
     _stopP2pVideo().catchError((e) {
       log('[P2pVideoPage] dispose error: $e');
@@ -385,7 +387,8 @@ class _P2pVideoPageState extends State<P2pVideoPage> {
                     .where((e) =>
                         e.type == DeviceEventType.online ||
                         e.type == DeviceEventType.offline ||
-                        e.type == DeviceEventType.statusChanged)
+                        e.type == DeviceEventType.statusChanged ||
+                        e.type == DeviceEventType.motion)
                     .toList();
                 if (events.isEmpty) return SizedBox.shrink();
                 return Container(
@@ -436,32 +439,32 @@ class _P2pVideoPageState extends State<P2pVideoPage> {
     return SizedBox(
       width: 320,
       height: 240,
-      child: AndroidView(
-        viewType: 'p2p_video_view',
-        onPlatformViewCreated: (int id) {
-          _platformViewId = id;
-          _startP2pVideoOnPlatformView();
-        },
-        creationParams: const {},
-        creationParamsCodec: const StandardMessageCodec(),
+      child: ViewSizeReporter(
+        devId: widget.devId,
+        child: AndroidView(
+          viewType: 'p2p_video_view',
+          onPlatformViewCreated: (int id) {
+            _platformViewId = id;
+            _startP2pVideoOnPlatformView();
+          },
+          creationParams: const {},
+          creationParamsCodec: const StandardMessageCodec(),
+        ),
       ),
     );
   }
 
-  Future<dynamic> _handleVideoMethod(MethodCall call) async {
-    if (call.method == 'onVideoFrame') {
-      final Uint8List h264Frame = call.arguments;
-      _lastFrameTime = DateTime.now();
-      if (!_videoStarted) {
-        setState(() {
-          _videoStarted = true;
-        });
-      }
+  void _onFrameRingEvent(FrameRingEvent event) {
+    _lastFrameTime = DateTime.now();
+    if (!_videoStarted) {
       setState(() {
-        _videoStreamAvailable = true;
-        _statusDetail = '已收到视频流，len=${h264Frame.length}';
+        _videoStarted = true;
       });
     }
+    setState(() {
+      _videoStreamAvailable = true;
+      _statusDetail = '已收到视频流，len=${event.lastFrameSize}';
+    });
   }
 }
 
@@ -0,0 +1,55 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+import '../services/mqtt_service.dart';
+
+class CameraActivity {
+  final String deviceId;
+  final bool active;
+  final int score;
+  final DateTime time;
+  CameraActivity(this.deviceId, this.active, this.score, {DateTime? time})
+      : time = time ?? DateTime.now();
+}
+
+/// 压缩域活动度：native 只看码流估计每路画面的运动程度，不需要解码。
+/// 画面墙可以监听 [activeDevices]，把活跃的设备提升为完整解码，其余只显示缩略图。
+class CameraActivityNotifier extends ChangeNotifier {
+  final Map<String, CameraActivity> _devices = {};
+
+  Map<String, CameraActivity> get devices => Map.unmodifiable(_devices);
+
+  List<String> get activeDevices => _devices.values
+      .where((e) => e.active)
+      .map((e) => e.deviceId)
+      .toList();
+
+  bool isActive(String deviceId) => _devices[deviceId]?.active ?? false;
+
+  void update(String deviceId, {required bool active, required int score}) {
+    _devices[deviceId] = CameraActivity(deviceId, active, score);
+    notifyListeners();
+  }
+
+  /// 主动拉取分数；状态变化时 native 会推送 onCameraActivity，这里用于刷新分数显示
+  Future<void> refresh(List<String> deviceIds) async {
+    try {
+      final result = await MqttService.channel
+          .invokeMethod<Map>('getCameraActivity', {'devIds': deviceIds});
+      if (result == null) return;
+      result.forEach((key, value) {
+        final info = value as Map;
+        _devices[key as String] = CameraActivity(
+          key,
+          info['active'] as bool,
+          info['score'] as int,
+        );
+      });
+      notifyListeners();
+    } on PlatformException catch (e) {
+      debugPrint('[CameraActivity] refresh failed: ${e.message}');
+    }
+  }
+}
+
+final cameraActivityNotifier = CameraActivityNotifier();
@@ -1,6 +1,6 @@
 import 'package:flutter/foundation.dart';
 
-enum DeviceEventType { online, offline, statusChanged, mqtt, send }
+enum DeviceEventType { online, offline, statusChanged, mqtt, send, motion }
 
 class DeviceEvent {
   final DeviceEventType type;
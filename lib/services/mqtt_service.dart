@@ -1,7 +1,9 @@
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
+import 'dart:convert';
 import 'dart:developer';
 import '../providers/message_monitor.dart';
+import '../providers/camera_activity_notifier.dart';
 import '../providers/device_event_notifier.dart';
 
 class MqttService {
@@ -51,6 +53,12 @@ class MqttService {
                   : msg.length;
           print("[MQTT Service]<<<==" + messageData);
           log('[MQTT Service] 收到 MQTT 消息: $messageData (长度: $length)');
+          // 本地移动侦测（native 解码帧分析）与设备消息走同一通道
+          final motion = _parseMotionEvent(messageData);
+          if (motion != null) {
+            deviceEventNotifier.addEvent(motion);
+            break;
+          }
           // 新增：收到MQTT消息时，推送设备事件（默认devId='camId123'）
           deviceEventNotifier.addEvent(DeviceEvent(
             DeviceEventType.online,
@@ -62,10 +70,39 @@ class MqttService {
           // if(call.arguments['data']['online']==1)
           //   DeviceEventType.
           break;
+        case 'onCameraActivity':
+          final args = call.arguments as Map;
+          cameraActivityNotifier.update(
+            args['devId'] as String,
+            active: args['active'] as bool,
+            score: args['score'] as int,
+          );
+          break;
       }
     });
   }
 
+  // 解析 {"type":"motion","devId":...,"zones":[...]}，不是移动侦测消息时返回 null
+  DeviceEvent? _parseMotionEvent(String message) {
+    try {
+      final data = jsonDecode(message);
+      if (data is! Map || data['type'] != 'motion') return null;
+      final zones = (data['zones'] as List?)?.join(',') ?? '';
+      final source = data['source'] == 'local' ? '本地侦测' : '设备上报';
+      final time = data['time'] is num
+          ? DateTime.fromMillisecondsSinceEpoch((data['time'] as num).toInt())
+          : null;
+      return DeviceEvent(
+        DeviceEventType.motion,
+        data['devId']?.toString() ?? '',
+        '移动侦测($source) 区域: $zones',
+        time: time,
+      );
+    } catch (_) {
+      return null;
+    }
+  }
+
   // 启动 MQTT 连接
   Future<bool> startMqtt(String userId) async {
     log('[MQTT Service] startMqtt called for user: $userId');
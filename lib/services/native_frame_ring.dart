@@ -0,0 +1,169 @@
+import 'dart:async';
+import 'dart:developer';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+// 与 android/app/src/main/cpp/frame_ring.h 中 FrameRingHeader 的布局一致
+final class _FrameRingHeader extends Struct {
+  @Uint64()
+  external int writeSeq;
+  @Uint64()
+  external int writeBytes;
+  @Uint64()
+  external int keyframes;
+  @Uint64()
+  external int lastKeyframeSeq;
+  @Uint64()
+  external int overwrittenFrames;
+  @Uint64()
+  external int postedEvents;
+  @Int64()
+  external int lastPtsUs;
+  @Uint32()
+  external int lastFrameSize;
+  @Uint32()
+  external int capacity;
+}
+
+typedef _OpenNative = Int32 Function(
+    Pointer<NativeFunction<Int8 Function(Int64, Pointer<Dart_CObject>)>>,
+    Int64,
+    Int64);
+typedef _OpenDart = int Function(
+    Pointer<NativeFunction<Int8 Function(Int64, Pointer<Dart_CObject>)>>,
+    int,
+    int);
+typedef _HeaderNative = Pointer<_FrameRingHeader> Function();
+typedef _ReadNative = Int32 Function(Int64, Pointer<Uint8>, Int32);
+typedef _ReadDart = int Function(int, Pointer<Uint8>, int);
+typedef _AckNative = Void Function(Int64);
+typedef _AckDart = void Function(int);
+typedef _CloseNative = Void Function();
+typedef _CloseDart = void Function();
+
+/// 一次新帧通知：多帧到达时合并为一次，只携带计数，不携带帧数据
+class FrameRingEvent {
+  final int latestSeq;
+  final bool keyframeSinceLast;
+  final int totalFrames;
+  final int totalBytes;
+  final int keyframes;
+  final int overwrittenFrames;
+  final int lastFrameSize;
+
+  const FrameRingEvent({
+    required this.latestSeq,
+    required this.keyframeSinceLast,
+    required this.totalFrames,
+    required this.totalBytes,
+    required this.keyframes,
+    required this.overwrittenFrames,
+    required this.lastFrameSize,
+  });
+}
+
+/// native 帧环形缓冲的 dart:ffi 封装。
+/// 接收线程写入 H.264 帧后通过 Dart_PostCObject 通知本 isolate，
+/// 帧数据留在 native，需要时按序号用 [readFrame] 取出。
+class NativeFrameRing {
+  static NativeFrameRing? _instance;
+
+  factory NativeFrameRing() {
+    _instance ??= NativeFrameRing._internal();
+    return _instance!;
+  }
+
+  NativeFrameRing._internal();
+
+  static NativeFrameRing get instance => NativeFrameRing();
+
+  final StreamController<FrameRingEvent> _controller =
+      StreamController<FrameRingEvent>.broadcast();
+  ReceivePort? _port;
+  Pointer<_FrameRingHeader>? _header;
+  _ReadDart? _read;
+  _AckDart? _ack;
+  _CloseDart? _close;
+
+  bool get isSupported => Platform.isAndroid;
+
+  /// 新帧通知，首次订阅时自动打开环形缓冲
+  Stream<FrameRingEvent> get events {
+    _ensureOpen();
+    return _controller.stream;
+  }
+
+  void _ensureOpen() {
+    if (_port != null || !isSupported) return;
+    try {
+      final lib = DynamicLibrary.open('libnative-lib.so');
+      final open = lib.lookupFunction<_OpenNative, _OpenDart>(
+          'p2p_frame_ring_open');
+      _header = lib.lookupFunction<_HeaderNative, _HeaderNative>(
+          'p2p_frame_ring_header')();
+      _read = lib.lookupFunction<_ReadNative, _ReadDart>('p2p_frame_ring_read');
+      _ack = lib.lookupFunction<_AckNative, _AckDart>('p2p_frame_ring_ack');
+      _close =
+          lib.lookupFunction<_CloseNative, _CloseDart>('p2p_frame_ring_close');
+
+      final port = ReceivePort();
+      port.listen(_onMessage);
+      if (open(NativeApi.postCObject, port.sendPort.nativePort, 0) == 0) {
+        port.close();
+        log('[NativeFrameRing] 打开环形缓冲失败');
+        return;
+      }
+      _port = port;
+      log('[NativeFrameRing] 环形缓冲已打开');
+    } catch (e) {
+      log('[NativeFrameRing] 加载 native 接口失败: $e');
+    }
+  }
+
+  void _onMessage(dynamic message) {
+    if (message is! int) return;
+    final seq = message >> 1;
+    final header = _header!.ref;
+    final event = FrameRingEvent(
+      latestSeq: seq,
+      keyframeSinceLast: (message & 1) != 0,
+      totalFrames: header.writeSeq,
+      totalBytes: header.writeBytes,
+      keyframes: header.keyframes,
+      overwrittenFrames: header.overwrittenFrames,
+      lastFrameSize: header.lastFrameSize,
+    );
+    if (_controller.hasListener) {
+      _controller.add(event);
+    }
+    // 确认后 native 才会发送下一次通知
+    _ack!(seq);
+  }
+
+  /// 按序号拷出一帧，帧已被覆盖时返回 null
+  Uint8List? readFrame(int seq) {
+    final read = _read;
+    if (read == null) return null;
+    final required = read(seq, nullptr, 0);
+    if (required >= -1) return null;
+    final size = -required - 1;
+    final buffer = malloc<Uint8>(size);
+    try {
+      final n = read(seq, buffer, size);
+      if (n <= 0) return null;
+      return Uint8List.fromList(buffer.asTypedList(n));
+    } finally {
+      malloc.free(buffer);
+    }
+  }
+
+  void close() {
+    _close?.call();
+    _port?.close();
+    _port = null;
+  }
+}
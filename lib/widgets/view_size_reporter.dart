@@ -0,0 +1,74 @@
+import 'dart:developer';
+import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
+
+/// 把视频画面在屏幕上的物理像素尺寸上报给 native，
+/// native 按所有画面中最大的尺寸为设备选择够用的最小码流规格。
+class ViewSizeReporter extends StatefulWidget {
+  final String devId;
+  final Widget child;
+
+  const ViewSizeReporter({
+    Key? key,
+    required this.devId,
+    required this.child,
+  }) : super(key: key);
+
+  @override
+  State<ViewSizeReporter> createState() => _ViewSizeReporterState();
+}
+
+class _ViewSizeReporterState extends State<ViewSizeReporter> {
+  static const MethodChannel _channel = MethodChannel('p2p_video_channel');
+  Size _reported = Size.zero;
+  String? _reportedDevId;
+
+  int get _viewId => identityHashCode(this);
+
+  void _report(String devId, Size size) {
+    _channel.invokeMethod('reportViewSize', {
+      'devId': devId,
+      'viewId': _viewId,
+      'width': size.width.round(),
+      'height': size.height.round(),
+    }).catchError((e) {
+      log('[ViewSizeReporter] reportViewSize error: $e');
+    });
+  }
+
+  void _update(Size logicalSize) {
+    final ratio = MediaQuery.of(context).devicePixelRatio;
+    final size = Size(logicalSize.width * ratio, logicalSize.height * ratio);
+    if (_reportedDevId == widget.devId && size == _reported) return;
+    // 设备变了，先撤销旧设备上的画面
+    if (_reportedDevId != null && _reportedDevId != widget.devId) {
+      _report(_reportedDevId!, Size.zero);
+    }
+    _reported = size;
+    _reportedDevId = widget.devId;
+    _report(widget.devId, size);
+  }
+
+  @override
+  void dispose() {
+    if (_reportedDevId != null) {
+      _report(_reportedDevId!, Size.zero);
+    }
+    super.dispose();
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return LayoutBuilder(
+      builder: (context, constraints) {
+        final size = constraints.biggest;
+        if (size.isFinite) {
+          WidgetsBinding.instance.addPostFrameCallback((_) {
+            if (mounted) _update(size);
+          });
+        }
+        return widget.child;
+      },
+    );
+  }
+}
@@ -1,6 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_benchmark.h"
+#include "av_sync_benchmark.h"
+#include "decode_benchmark.h"
 #include "my_application.h"
+#include "p2p_video_plugin.h"
+#include "record_benchmark.h"
+#include "talk_benchmark.h"
+#include "yuv_benchmark.h"
+
+// Headless decode benchmark:
+//   music_app_framework --decode-bench FILE.h264 [--backend NAME]
+//                       [--threads N] [--loops N] [--low-delay]
+// Decodes the Annex-B file as fast as possible without creating a window and
+// prints throughput, including frames per second per core of CPU time.
+static int run_decode_benchmark(int argc, char** argv) {
+  const char* path = nullptr;
+  DecodeBenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--decode-bench") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+      options.backend = argv[++i];
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      options.threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+      options.loops = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--low-delay") == 0) {
+      options.lowDelay = true;
+    }
+  }
+  if (path == nullptr) {
+    fprintf(stderr, "--decode-bench requires a file\n");
+    return 2;
+  }
+
+  DecodeBenchmarkResult result = runDecodeBenchmark(path, options);
+  if (!result.ok) {
+    return 1;
+  }
+  printf("backend=%s threads=%d frames=%llu errors=%llu size=%dx%d\n",
+         result.backend.c_str(), result.threads,
+         static_cast<unsigned long long>(result.frames),
+         static_cast<unsigned long long>(result.errors), result.width,
+         result.height);
+  printf("wall=%.3fs fps=%.1f cpu=%.3fs fps_per_core=%.1f\n",
+         result.wallSeconds, result.fps, result.cpuSeconds,
+         result.fpsPerCore);
+  return 0;
+}
+
+// Headless recording benchmark:
+//   music_app_framework --record-bench FILE.h264 [--fps N] [--loops N]
+//                       [--realtime] [--out FILE.mp4]
+// Feeds the same Annex-B file used by --replay through Fmp4Recorder and
+// prints disk throughput, mux and write time per fragment, and process CPU
+// time. By default frames are pushed as fast as the writer accepts them;
+// --realtime paces them at the given rate with the app's drop-oldest policy.
+// The output goes to a temporary file unless --out is given.
+static int run_record_benchmark(int argc, char** argv) {
+  const char* path = nullptr;
+  RecordBenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--record-bench") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+      options.fps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+      options.loops = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--realtime") == 0) {
+      options.realtime = true;
+    } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      options.outputPath = argv[++i];
+    }
+  }
+  if (path == nullptr) {
+    fprintf(stderr, "--record-bench requires a file\n");
+    return 2;
+  }
+
+  RecordBenchmarkResult result = runRecordBenchmark(path, options);
+  if (!result.ok) {
+    return 1;
+  }
+  printf("frames=%llu fragments=%llu dropped=%llu segments=%llu "
+         "bytes=%llu media=%.1fs\n",
+         static_cast<unsigned long long>(result.frames),
+         static_cast<unsigned long long>(result.fragments),
+         static_cast<unsigned long long>(result.droppedFragments),
+         static_cast<unsigned long long>(result.segments),
+         static_cast<unsigned long long>(result.bytes), result.mediaSeconds);
+  printf("wall=%.3fs throughput=%.1fMB/s cpu=%.3fs\n", result.wallSeconds,
+         result.mbPerSecond, result.cpuSeconds);
+  printf("mux=%.1fus/fragment write=%.1fus/fragment\n",
+         result.muxUsPerFragment, result.writeUsPerFragment);
+  return 0;
+}
+
+// Headless audio receive benchmark:
+//   music_app_framework --audio-bench FILE [--codec pcmu|pcma|aac]
+//                       [--rate HZ] [--packet-ms N] [--jitter-ms N]
+//                       [--loss PERCENT] [--max-delay-ms N] [--out FILE.wav]
+// Packetizes the file, simulates network arrival with the given jitter and
+// loss, and plays it through the jitter buffer into a null or WAV sink on a
+// virtual clock. Prints buffering latency and concealment statistics.
+static int run_audio_benchmark(int argc, char** argv) {
+  const char* path = nullptr;
+  AudioBenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--audio-bench") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else if (strcmp(argv[i], "--codec") == 0 && i + 1 < argc) {
+      options.codec = audioCodecFromName(argv[++i]);
+    } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+      options.sampleRate = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--packet-ms") == 0 && i + 1 < argc) {
+      options.packetMs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--jitter-ms") == 0 && i + 1 < argc) {
+      options.jitterMs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+      options.lossPercent = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--max-delay-ms") == 0 && i + 1 < argc) {
+      options.jitter.maxDelayMs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      options.outputPath = argv[++i];
+    }
+  }
+  if (path == nullptr || options.codec == AUDIO_CODEC_NONE) {
+    fprintf(stderr, "--audio-bench requires a file and a known --codec\n");
+    return 2;
+  }
+
+  AudioBenchmarkResult result = runAudioBenchmark(path, options);
+  if (!result.ok) {
+    return 1;
+  }
+  const AudioJitterStats& jitter = result.jitter;
+  printf("codec=%s packets=%llu lost=%llu audio=%lldms wall=%.3fs\n",
+         audioCodecName(options.codec),
+         static_cast<unsigned long long>(result.packets),
+         static_cast<unsigned long long>(result.lostPackets),
+         static_cast<long long>(result.audioMs), result.wallSeconds);
+  printf("latency=%lldms max_latency=%lldms target=%lldms jitter=%lldms\n",
+         static_cast<long long>(jitter.latencyMs),
+         static_cast<long long>(jitter.maxLatencyMs),
+         static_cast<long long>(jitter.targetDelayMs),
+         static_cast<long long>(jitter.jitterMs));
+  printf("concealments=%llu concealed=%lldms overruns=%llu dropped=%lldms "
+         "stretched=%lldms\n",
+         static_cast<unsigned long long>(jitter.concealmentEvents),
+         static_cast<long long>(jitter.concealedMs),
+         static_cast<unsigned long long>(jitter.overruns),
+         static_cast<long long>(jitter.droppedMs),
+         static_cast<long long>(jitter.stretchedMs));
+  printf("decode=%.2fus/packet read=%.2fus/buffer\n", result.decodeUsPerPacket,
+         result.readUsPerBuffer);
+  return 0;
+}
+
+// Headless talkback uplink benchmark:
+//   music_app_framework --talk-bench FILE [--codec pcmu|pcma] [--rate HZ]
+//                       [--packet-ms N] [--capture-ms N] [--realtime]
+// Reads 16-bit PCM (WAV or raw) through the file capture source, encodes and
+// packetizes it on the uplink thread, and prints per-packet encode time and
+// capture-to-transport latency. Without --realtime the file is read as fast as
+// possible, so latency mostly reflects queueing rather than capture pacing.
+static int run_talk_benchmark(int argc, char** argv) {
+  const char* path = nullptr;
+  TalkBenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--talk-bench") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else if (strcmp(argv[i], "--codec") == 0 && i + 1 < argc) {
+      options.codec = audioCodecFromName(argv[++i]);
+    } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+      options.sampleRate = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--packet-ms") == 0 && i + 1 < argc) {
+      options.packetMs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--capture-ms") == 0 && i + 1 < argc) {
+      options.captureMs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--realtime") == 0) {
+      options.realtime = true;
+    }
+  }
+  if (path == nullptr || (options.codec != AUDIO_CODEC_PCMU &&
+                          options.codec != AUDIO_CODEC_PCMA)) {
+    fprintf(stderr, "--talk-bench requires a file and a G.711 --codec\n");
+    return 2;
+  }
+
+  TalkBenchmarkResult result = runTalkBenchmark(path, options);
+  if (!result.ok) {
+    return 1;
+  }
+  printf("codec=%s packets=%llu bytes=%llu audio=%lldms wall=%.3fs "
+         "overruns=%llu queue_drops=%llu priority=%d\n",
+         audioCodecName(options.codec),
+         static_cast<unsigned long long>(result.packets),
+         static_cast<unsigned long long>(result.bytes),
+         static_cast<long long>(result.audioMs), result.wallSeconds,
+         static_cast<unsigned long long>(result.overruns),
+         static_cast<unsigned long long>(result.queueDrops), result.priority);
+  printf("encode=%.2fus/packet p50=%lldus p99=%lldus max=%lldus\n",
+         result.encodeUsAvg, static_cast<long long>(result.encodeUsP50),
+         static_cast<long long>(result.encodeUsP99),
+         static_cast<long long>(result.encodeUsMax));
+  printf("latency=%.0fus p99=%lldus max=%lldus\n", result.latencyUsAvg,
+         static_cast<long long>(result.latencyUsP99),
+         static_cast<long long>(result.latencyUsMax));
+  return 0;
+}
+
+// Headless YUV conversion check and benchmark:
+//   music_app_framework --yuv-bench [--kernel neon|avx2|sse2] [--loops N]
+// Converts pseudo-random frames at common camera resolutions with every SIMD
+// row kernel the CPU supports and with the scalar reference, and packs them to
+// NV21/I420 with the YuvUtils packer and a per-pixel reference. Prints the
+// time per frame for both sides. Any byte that differs from the reference
+// output is a failure and makes the command exit with status 1.
+static int run_yuv_benchmark(int argc, char** argv) {
+  YuvBenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+      options.kernel = argv[++i];
+    } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+      options.loops = atoi(argv[++i]);
+    }
+  }
+
+  YuvBenchmarkResult result = runYuvBenchmark(options);
+  if (!result.ok) {
+    return 1;
+  }
+  for (const YuvBenchmarkCase& c : result.cases) {
+    printf("%-34s %-6s %7.3fms scalar=%7.3fms speedup=%4.1fx mismatched=%llu\n",
+           c.name.c_str(), c.kernel.c_str(), c.kernelMs, c.scalarMs,
+           c.kernelMs > 0 ? c.scalarMs / c.kernelMs : 0.0,
+           static_cast<unsigned long long>(c.mismatchedBytes));
+  }
+  printf("cases=%zu mismatched=%llu\n", result.cases.size(),
+         static_cast<unsigned long long>(result.mismatchedCases));
+  return result.mismatchedCases == 0 ? 0 : 1;
+}
+
+// Headless lip-sync check:
+//   music_app_framework --avsync-bench [--fps N] [--seconds N]
+// Simulates audio playout reports and display scheduling on a virtual clock
+// and runs them through AvSyncClock with skewed timelines: video clock drift,
+// audio delay steps, jittery playout reports, an audio gap, and audio being
+// restarted in the middle of trick play (recording frames must stay off the
+// audio clock until trick play ends). Prints the steady-state offset and the
+// dropped/repeated frame counts per scenario and exits with status 1 when the
+// offset or the number of corrections exceeds its bound, or when the expected
+// resync count does not match.
+static int run_av_sync_benchmark(int argc, char** argv) {
+  AvSyncBenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+      options.fps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      options.seconds = atoi(argv[++i]);
+    }
+  }
+
+  AvSyncBenchmarkResult result = runAvSyncBenchmark(options);
+  if (!result.ok) {
+    return 2;
+  }
+  for (const AvSyncBenchmarkCase& c : result.cases) {
+    printf("%-24s frames=%llu offset=%6lldus (<=%lldus) dropped=%llu "
+           "repeated=%llu (<=%llu) resyncs=%llu %s\n",
+           c.name.c_str(), static_cast<unsigned long long>(c.frames),
+           static_cast<long long>(c.maxOffsetUs),
+           static_cast<long long>(c.offsetLimitUs),
+           static_cast<unsigned long long>(c.droppedFrames),
+           static_cast<unsigned long long>(c.repeatedFrames),
+           static_cast<unsigned long long>(c.maxCorrections),
+           static_cast<unsigned long long>(c.resyncs),
+           c.passed ? "ok" : "FAIL");
+  }
+  printf("cases=%zu failed=%llu\n", result.cases.size(),
+         static_cast<unsigned long long>(result.failedCases));
+  return result.failedCases == 0 ? 0 : 1;
+}
+
+// Desktop ingest from a file instead of a P2P device:
+//   music_app_framework --replay FILE.h264 [--replay-fps N] [--replay-loop]
+// Starts the normal UI and feeds the Annex-B file into the video texture at
+// the given rate (25 fps by default), so the live view can be exercised
+// without the Android-only P2P stack. The flags are still passed on to Dart,
+// which ignores them.
+static gboolean start_replay(int argc, char** argv) {
+  const char* path = nullptr;
+  int fps = 0;
+  gboolean loop = FALSE;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else if (strcmp(argv[i], "--replay-fps") == 0 && i + 1 < argc) {
+      fps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--replay-loop") == 0) {
+      loop = TRUE;
+    }
+  }
+  return path != nullptr && p2p_video_plugin_start_replay(path, fps, loop);
+}
 
 int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--decode-bench") == 0) {
+      return run_decode_benchmark(argc, argv);
+    }
+    if (strcmp(argv[i], "--record-bench") == 0) {
+      return run_record_benchmark(argc, argv);
+    }
+    if (strcmp(argv[i], "--audio-bench") == 0) {
+      return run_audio_benchmark(argc, argv);
+    }
+    if (strcmp(argv[i], "--talk-bench") == 0) {
+      return run_talk_benchmark(argc, argv);
+    }
+    if (strcmp(argv[i], "--yuv-bench") == 0) {
+      return run_yuv_benchmark(argc, argv);
+    }
+    if (strcmp(argv[i], "--avsync-bench") == 0) {
+      return run_av_sync_benchmark(argc, argv);
+    }
+  }
+
+  const gboolean replaying = start_replay(argc, argv);
   g_autoptr(MyApplication) app = my_application_new();
-  return g_application_run(G_APPLICATION(app), argc, argv);
+  const int status = g_application_run(G_APPLICATION(app), argc, argv);
+  if (replaying) {
+    p2p_video_plugin_stop_replay();
+  }
+  return status;
 }
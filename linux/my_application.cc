@@ -6,6 +6,7 @@
 #endif
 
 #include "flutter/generated_plugin_registrant.h"
+#include "p2p_video_plugin.h"
 
 struct _MyApplication {
   GtkApplication parent_instance;
@@ -58,6 +59,10 @@ static void my_application_activate(GApplication* application) {
   gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
+  g_autoptr(FlPluginRegistrar) p2p_video_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(FL_PLUGIN_REGISTRY(view),
+                                                  "P2pVideoPlugin");
+  p2p_video_plugin_register_with_registrar(p2p_video_registrar);
 
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
@@ -0,0 +1,386 @@
+#include "p2p_video_plugin.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "h264_nal.h"
+#include "video_decoder.h"
+
+namespace {
+
+const char kChannelName[] = "p2p_video_channel";
+
+struct RgbaFrame {
+  std::vector<uint8_t> pixels;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// Frame handoff between the ingest thread and the raster thread.
+//
+// The producer only ever touches |back| and the raster thread only ever
+// touches |front|; |ready| is the mailbox between them and is swapped under
+// |mutex|, so neither side holds the lock while converting or uploading.
+// copy_pixels() hands Flutter a pointer into |front| that is uploaded after
+// the callback returns, which is why the producer cannot write into the
+// buffer the consumer is reading from directly.
+struct FrameBuffers {
+  std::mutex producer_mutex;  // Serializes concurrent producers on |back|.
+  RgbaFrame back;
+
+  std::mutex mutex;
+  RgbaFrame ready;
+  bool has_ready = false;
+
+  RgbaFrame front;
+};
+
+}  // namespace
+
+struct _P2pVideoTexture {
+  FlPixelBufferTexture parent_instance;
+  FrameBuffers* buffers;
+};
+
+G_DEFINE_TYPE(P2pVideoTexture, p2p_video_texture,
+              fl_pixel_buffer_texture_get_type())
+
+// Called on the raster thread whenever the engine samples the texture.
+static gboolean p2p_video_texture_copy_pixels(FlPixelBufferTexture* texture,
+                                              const uint8_t** out_buffer,
+                                              uint32_t* width,
+                                              uint32_t* height,
+                                              GError** error) {
+  FrameBuffers* buffers = P2P_VIDEO_TEXTURE(texture)->buffers;
+  {
+    std::lock_guard<std::mutex> lock(buffers->mutex);
+    if (buffers->has_ready) {
+      std::swap(buffers->front, buffers->ready);
+      buffers->has_ready = false;
+    }
+  }
+  if (buffers->front.pixels.empty()) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_PENDING, "No video frame yet");
+    return FALSE;
+  }
+  *out_buffer = buffers->front.pixels.data();
+  *width = buffers->front.width;
+  *height = buffers->front.height;
+  return TRUE;
+}
+
+static void p2p_video_texture_finalize(GObject* object) {
+  P2pVideoTexture* self = P2P_VIDEO_TEXTURE(object);
+  delete self->buffers;
+  self->buffers = nullptr;
+  G_OBJECT_CLASS(p2p_video_texture_parent_class)->finalize(object);
+}
+
+static void p2p_video_texture_class_init(P2pVideoTextureClass* klass) {
+  FL_PIXEL_BUFFER_TEXTURE_CLASS(klass)->copy_pixels =
+      p2p_video_texture_copy_pixels;
+  G_OBJECT_CLASS(klass)->finalize = p2p_video_texture_finalize;
+}
+
+static void p2p_video_texture_init(P2pVideoTexture* self) {
+  self->buffers = new FrameBuffers();
+}
+
+// Converts |planes| into the back buffer and publishes it as the newest frame.
+static void p2p_video_texture_publish(P2pVideoTexture* self,
+                                      const Yuv420Planes& planes) {
+  FrameBuffers* buffers = self->buffers;
+  std::lock_guard<std::mutex> producer_lock(buffers->producer_mutex);
+  RgbaFrame& back = buffers->back;
+  back.width = static_cast<uint32_t>(planes.width);
+  back.height = static_cast<uint32_t>(planes.height);
+  back.pixels.resize(static_cast<size_t>(back.width) * back.height * 4);
+
+  yuv420ToRgbaScale(planes, back.pixels.data(), planes.width * 4, planes.width,
+                    planes.height, YUV_DST_RGBA);
+
+  std::lock_guard<std::mutex> lock(buffers->mutex);
+  std::swap(buffers->back, buffers->ready);
+  buffers->has_ready = true;
+}
+
+struct _P2pVideoPlugin {
+  GObject parent_instance;
+  FlTextureRegistrar* texture_registrar;
+  P2pVideoTexture* texture;
+  std::atomic<bool>* notify_pending;
+};
+
+G_DEFINE_TYPE(P2pVideoPlugin, p2p_video_plugin, g_object_get_type())
+
+// The plugin that ingest threads publish into. Guarded by |g_plugin_mutex| so
+// submit_frame() can take a reference from any thread.
+static std::mutex g_plugin_mutex;
+static P2pVideoPlugin* g_plugin = nullptr;
+
+static void p2p_video_plugin_dispose_texture(P2pVideoPlugin* self) {
+  P2pVideoTexture* texture = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_plugin_mutex);
+    texture = self->texture;
+    self->texture = nullptr;
+  }
+  if (texture != nullptr) {
+    fl_texture_registrar_unregister_texture(self->texture_registrar,
+                                            FL_TEXTURE(texture));
+    g_object_unref(texture);
+  }
+}
+
+static FlMethodResponse* p2p_video_plugin_create_texture(
+    P2pVideoPlugin* self) {
+  // Only one live view is shown at a time, matching the Android side.
+  p2p_video_plugin_dispose_texture(self);
+
+  P2pVideoTexture* texture = P2P_VIDEO_TEXTURE(
+      g_object_new(p2p_video_texture_get_type(), nullptr));
+  if (!fl_texture_registrar_register_texture(self->texture_registrar,
+                                             FL_TEXTURE(texture))) {
+    g_object_unref(texture);
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "TEXTURE_ERROR", "Failed to register texture", nullptr));
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_plugin_mutex);
+    self->texture = texture;
+  }
+  g_autoptr(FlValue) result =
+      fl_value_new_int(fl_texture_get_id(FL_TEXTURE(texture)));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static void p2p_video_plugin_handle_method_call(P2pVideoPlugin* self,
+                                                FlMethodCall* method_call) {
+  g_autoptr(FlMethodResponse) response = nullptr;
+  const gchar* method = fl_method_call_get_name(method_call);
+
+  if (strcmp(method, "createTexture") == 0) {
+    response = p2p_video_plugin_create_texture(self);
+  } else if (strcmp(method, "disposeTexture") == 0) {
+    p2p_video_plugin_dispose_texture(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  P2pVideoPlugin* plugin = P2P_VIDEO_PLUGIN(user_data);
+  p2p_video_plugin_handle_method_call(plugin, method_call);
+}
+
+static void p2p_video_plugin_dispose(GObject* object) {
+  P2pVideoPlugin* self = P2P_VIDEO_PLUGIN(object);
+  {
+    std::lock_guard<std::mutex> lock(g_plugin_mutex);
+    if (g_plugin == self) {
+      g_plugin = nullptr;
+    }
+  }
+  if (self->texture_registrar != nullptr) {
+    p2p_video_plugin_dispose_texture(self);
+  }
+  g_clear_object(&self->texture_registrar);
+  G_OBJECT_CLASS(p2p_video_plugin_parent_class)->dispose(object);
+}
+
+static void p2p_video_plugin_finalize(GObject* object) {
+  P2pVideoPlugin* self = P2P_VIDEO_PLUGIN(object);
+  delete self->notify_pending;
+  self->notify_pending = nullptr;
+  G_OBJECT_CLASS(p2p_video_plugin_parent_class)->finalize(object);
+}
+
+static void p2p_video_plugin_class_init(P2pVideoPluginClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = p2p_video_plugin_dispose;
+  G_OBJECT_CLASS(klass)->finalize = p2p_video_plugin_finalize;
+}
+
+static void p2p_video_plugin_init(P2pVideoPlugin* self) {
+  self->notify_pending = new std::atomic<bool>(false);
+}
+
+// Runs on the GTK main loop; coalesces frame-available notifications so a
+// fast producer queues at most one idle callback.
+static gboolean notify_frame_available_cb(gpointer user_data) {
+  P2pVideoPlugin* self = P2P_VIDEO_PLUGIN(user_data);
+  self->notify_pending->store(false);
+  P2pVideoTexture* texture = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_plugin_mutex);
+    if (self->texture != nullptr) {
+      texture = P2P_VIDEO_TEXTURE(g_object_ref(self->texture));
+    }
+  }
+  if (texture != nullptr) {
+    fl_texture_registrar_mark_texture_frame_available(self->texture_registrar,
+                                                      FL_TEXTURE(texture));
+    g_object_unref(texture);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+gboolean p2p_video_plugin_submit_frame(const Yuv420Planes* planes) {
+  if (planes == nullptr || planes->y == nullptr || planes->width <= 0 ||
+      planes->height <= 0) {
+    return FALSE;
+  }
+
+  P2pVideoPlugin* plugin = nullptr;
+  P2pVideoTexture* texture = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_plugin_mutex);
+    if (g_plugin == nullptr || g_plugin->texture == nullptr) {
+      return FALSE;
+    }
+    plugin = P2P_VIDEO_PLUGIN(g_object_ref(g_plugin));
+    texture = P2P_VIDEO_TEXTURE(g_object_ref(g_plugin->texture));
+  }
+
+  p2p_video_texture_publish(texture, *planes);
+  g_object_unref(texture);
+
+  if (!plugin->notify_pending->exchange(true)) {
+    g_idle_add_full(G_PRIORITY_HIGH_IDLE, notify_frame_available_cb, plugin,
+                    g_object_unref);
+  } else {
+    g_object_unref(plugin);
+  }
+  return TRUE;
+}
+
+// Software decoder for compressed input. Created lazily so builds without a
+// decoder backend only fail when compressed frames actually arrive.
+static std::mutex g_decoder_mutex;
+static std::unique_ptr<VideoDecoder> g_decoder;
+static bool g_decoder_failed = false;
+
+gboolean p2p_video_plugin_submit_access_unit(const uint8_t* data, size_t length,
+                                             int64_t pts_us) {
+  if (data == nullptr || length == 0) {
+    return FALSE;
+  }
+  std::lock_guard<std::mutex> lock(g_decoder_mutex);
+  if (!g_decoder && !g_decoder_failed) {
+    g_decoder = createVideoDecoder("");
+    VideoDecoderConfig config;
+    if (!g_decoder || !g_decoder->open(config, [](const DecodedFrame& frame) {
+          p2p_video_plugin_submit_frame(&frame.planes);
+        })) {
+      g_decoder.reset();
+      g_decoder_failed = true;
+    }
+  }
+  if (!g_decoder) {
+    return FALSE;
+  }
+  return g_decoder->decode(data, static_cast<int>(length), pts_us) ? TRUE
+                                                                  : FALSE;
+}
+
+// File replay ingest. The thread owns its copy of the stream; |g_replay_stop|
+// is the only state shared with the controlling thread.
+static std::mutex g_replay_mutex;
+static std::thread g_replay_thread;
+static std::atomic<bool> g_replay_stop(false);
+
+static void replay_loop(std::vector<uint8_t> stream,
+                        std::vector<std::pair<int, int>> units, int fps,
+                        bool loop) {
+  const auto interval = std::chrono::microseconds(1000000 / fps);
+  auto next = std::chrono::steady_clock::now();
+  int64_t pts_us = 0;
+  uint64_t failed = 0;
+  do {
+    for (const auto& unit : units) {
+      if (g_replay_stop.load()) {
+        return;
+      }
+      if (!p2p_video_plugin_submit_access_unit(stream.data() + unit.first,
+                                               unit.second, pts_us)) {
+        failed++;
+      }
+      pts_us += interval.count();
+      next += interval;
+      std::this_thread::sleep_until(next);
+    }
+  } while (loop);
+  g_message("Replay finished: %zu access units, %llu not decoded",
+            units.size(), static_cast<unsigned long long>(failed));
+}
+
+gboolean p2p_video_plugin_start_replay(const char* path, int fps,
+                                       gboolean loop) {
+  p2p_video_plugin_stop_replay();
+  if (path == nullptr) {
+    return FALSE;
+  }
+  gchar* contents = nullptr;
+  gsize length = 0;
+  g_autoptr(GError) error = nullptr;
+  if (!g_file_get_contents(path, &contents, &length, &error)) {
+    g_warning("Replay: %s", error->message);
+    return FALSE;
+  }
+  std::vector<uint8_t> stream(reinterpret_cast<uint8_t*>(contents),
+                              reinterpret_cast<uint8_t*>(contents) + length);
+  g_free(contents);
+  std::vector<std::pair<int, int>> units;
+  h264SplitAccessUnits(stream.data(), static_cast<int>(stream.size()), units);
+  if (units.empty()) {
+    g_warning("Replay: no H.264 access units in %s", path);
+    return FALSE;
+  }
+
+  g_message("Replaying %s: %zu access units at %d fps%s", path, units.size(),
+            fps > 0 ? fps : 25, loop ? ", looped" : "");
+  std::lock_guard<std::mutex> lock(g_replay_mutex);
+  g_replay_stop.store(false);
+  g_replay_thread = std::thread(replay_loop, std::move(stream),
+                                std::move(units), fps > 0 ? fps : 25,
+                                loop != FALSE);
+  return TRUE;
+}
+
+void p2p_video_plugin_stop_replay() {
+  std::lock_guard<std::mutex> lock(g_replay_mutex);
+  if (g_replay_thread.joinable()) {
+    g_replay_stop.store(true);
+    g_replay_thread.join();
+  }
+}
+
+void p2p_video_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  P2pVideoPlugin* plugin = P2P_VIDEO_PLUGIN(
+      g_object_new(p2p_video_plugin_get_type(), nullptr));
+  plugin->texture_registrar = FL_TEXTURE_REGISTRAR(
+      g_object_ref(fl_plugin_registrar_get_texture_registrar(registrar)));
+  {
+    std::lock_guard<std::mutex> lock(g_plugin_mutex);
+    g_plugin = plugin;
+  }
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  g_autoptr(FlMethodChannel) channel =
+      fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                            kChannelName, FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(channel, method_call_cb,
+                                            g_object_ref(plugin),
+                                            g_object_unref);
+
+  g_object_unref(plugin);
+}
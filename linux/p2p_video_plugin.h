@@ -0,0 +1,78 @@
+#ifndef FLUTTER_P2P_VIDEO_PLUGIN_H_
+#define FLUTTER_P2P_VIDEO_PLUGIN_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include "yuv_convert.h"
+
+G_DECLARE_FINAL_TYPE(P2pVideoTexture, p2p_video_texture, P2P, VIDEO_TEXTURE,
+                     FlPixelBufferTexture)
+
+G_DECLARE_FINAL_TYPE(P2pVideoPlugin, p2p_video_plugin, P2P, VIDEO_PLUGIN,
+                     GObject)
+
+/**
+ * p2p_video_plugin_register_with_registrar:
+ * @registrar: the registrar of the #FlView hosting the video pages.
+ *
+ * Registers the `p2p_video_channel` texture methods (`createTexture`,
+ * `disposeTexture`) that the Android embedding also implements, so the same
+ * `Texture` widget path works on Linux.
+ */
+void p2p_video_plugin_register_with_registrar(FlPluginRegistrar* registrar);
+
+/**
+ * p2p_video_plugin_submit_frame:
+ * @planes: a decoded YUV420 frame (I420/NV12/NV21, any stride).
+ *
+ * Converts the frame into the texture's back buffer and publishes it. Safe to
+ * call from any decode or ingest thread; it never waits on the GTK main loop
+ * or the raster thread, and the newest frame wins if several arrive between
+ * two vsyncs.
+ *
+ * Returns: %FALSE if no texture has been created yet.
+ */
+gboolean p2p_video_plugin_submit_frame(const Yuv420Planes* planes);
+
+/**
+ * p2p_video_plugin_submit_access_unit:
+ * @data: one H.264 Annex-B access unit, start codes included.
+ * @length: size of @data in bytes.
+ * @pts_us: presentation timestamp in microseconds.
+ *
+ * Decodes the access unit with the default software backend (created on first
+ * use) and submits every decoded frame through
+ * p2p_video_plugin_submit_frame(). Calls are serialized; feed it from a single
+ * ingest thread.
+ *
+ * Returns: %FALSE if no decoder backend is available or decoding failed.
+ */
+gboolean p2p_video_plugin_submit_access_unit(const uint8_t* data, size_t length,
+                                             int64_t pts_us);
+
+/**
+ * p2p_video_plugin_start_replay:
+ * @path: an H.264 Annex-B elementary stream file.
+ * @fps: playback rate in frames per second, or 0 for 25.
+ * @loop: whether to start over from the first access unit at end of file.
+ *
+ * Stands in for the P2P receive path on desktop: a background ingest thread
+ * splits the file into access units and feeds them through
+ * p2p_video_plugin_submit_access_unit() at @fps, so the `Texture` widget
+ * shows live-paced video. Frames decoded before Dart creates the texture are
+ * discarded. Any replay already running is stopped first.
+ *
+ * Returns: %FALSE if the file cannot be read or holds no access units.
+ */
+gboolean p2p_video_plugin_start_replay(const char* path, int fps,
+                                       gboolean loop);
+
+/**
+ * p2p_video_plugin_stop_replay:
+ *
+ * Stops the replay thread started by p2p_video_plugin_start_replay() and
+ * waits for it to exit. Does nothing if no replay is running.
+ */
+void p2p_video_plugin_stop_replay();
+
+#endif  // FLUTTER_P2P_VIDEO_PLUGIN_H_